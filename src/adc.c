@@ -10,6 +10,7 @@
 #include "types.h"
 #include "adc.h"
 #include "interrupts.h"
+#include "timers.h"
 
 // ad7923 control register
 #define AD7923_CTL_WRITE  (1 << 11)
@@ -38,8 +39,8 @@
 
 
 // perform a conversion on all 4 channels
-void adc_convert(U16 (*dst)[4]) {
-  U16 cmd, val;
+void adc_convert(u16 (*dst)[4]) {
+  u16 cmd, val;
 
   u8 irq_flags = irqs_pause();
 
@@ -104,3 +105,127 @@ void init_adc(void) {
   spi_unselectChip(ADC_SPI, ADC_SPI_NPCS );
 
 }
+
+
+//-----------------------------
+//---- acquisition service
+
+// fractional bits of the lowpass state. with at least as many as the
+// largest iir_shift, whatever the update truncates stays below a sixteenth
+// of a step, so rounding settles exactly on a steady input
+#define ADC_IIR_FRAC 12
+
+typedef struct {
+  u8 filter;
+  u8 iir_shift;
+  u16 threshold;
+  u16 sum;        // oversampling accumulator
+  u32 iir;        // lowpass state, 12.ADC_IIR_FRAC
+  u16 hist[3];    // recent values for the median
+  u16 value;      // filtered
+  u16 posted;     // last value sent as an event
+  bool primed;    // filter state seeded from a first value
+} adc_channel_t;
+
+static adc_channel_t adc_ch[ADC_CHANNELS];
+static u8 adc_oversample;
+static u8 adc_sample_ct;
+static softTimer_t adc_timer = { .next = NULL, .prev = NULL };
+
+static u16 median3(u16 a, u16 b, u16 c) {
+  if (a > b) { u16 t = a; a = b; b = t; }
+  if (b > c) { b = c; }
+  return a > b ? a : b;
+}
+
+static u16 adc_filter(adc_channel_t* c, u16 x) {
+  if (!c->primed) {
+    c->primed = true;
+    c->iir = (u32)x << ADC_IIR_FRAC;
+    c->hist[0] = c->hist[1] = c->hist[2] = x;
+    return x;
+  }
+
+  switch (c->filter) {
+  case kAdcFilterIir:
+    c->iir += ((s32)((u32)x << ADC_IIR_FRAC) - (s32)c->iir) >> c->iir_shift;
+    return (c->iir + (1 << (ADC_IIR_FRAC - 1))) >> ADC_IIR_FRAC;
+  case kAdcFilterMedian:
+    c->hist[0] = c->hist[1];
+    c->hist[1] = c->hist[2];
+    c->hist[2] = x;
+    return median3(c->hist[0], c->hist[1], c->hist[2]);
+  default:
+    return x;
+  }
+}
+
+void adc_service_sample(u16 (*raw)[4]) {
+  event_t e;
+  adc_channel_t* c;
+  u16 d;
+
+  for (u8 i = 0; i < ADC_CHANNELS; i++) {
+    adc_ch[i].sum += (*raw)[i];
+  }
+  if (++adc_sample_ct < (1 << adc_oversample)) {
+    return;
+  }
+  adc_sample_ct = 0;
+
+  for (u8 i = 0; i < ADC_CHANNELS; i++) {
+    c = &adc_ch[i];
+    c->value = adc_filter(c, c->sum >> adc_oversample);
+    c->sum = 0;
+
+    // hysteresis: the value has to leave the band around the last post
+    d = c->value > c->posted ? c->value - c->posted : c->posted - c->value;
+    if (d >= c->threshold) {
+      c->posted = c->value;
+      e.type = kEventAdc0 + i;
+      e.data = c->value;
+      event_post(&e);
+    }
+  }
+}
+
+static void adc_timer_callback(void* o) {
+  u16 raw[4];
+  adc_convert(&raw);
+  adc_service_sample(&raw);
+}
+
+void adc_service_start(u32 ticks, u8 oversample) {
+  if (oversample > ADC_OVERSAMPLE_MAX) {
+    oversample = ADC_OVERSAMPLE_MAX;
+  }
+  adc_oversample = oversample;
+  adc_sample_ct = 0;
+  for (u8 i = 0; i < ADC_CHANNELS; i++) {
+    adc_ch[i].sum = 0;
+    adc_ch[i].primed = false;
+    // post every channel's first value
+    adc_ch[i].posted = 0xffff;
+    if (adc_ch[i].threshold == 0) {
+      adc_ch[i].threshold = ADC_THRESHOLD_DEFAULT;
+    }
+  }
+  timer_add(&adc_timer, ticks, &adc_timer_callback, NULL);
+}
+
+void adc_service_stop(void) {
+  timer_remove(&adc_timer);
+}
+
+void adc_set_filter(u8 ch, adc_filter_t filter, u8 iir_shift) {
+  adc_ch[ch].filter = filter;
+  adc_ch[ch].iir_shift = iir_shift > 8 ? 8 : iir_shift;
+}
+
+void adc_set_threshold(u8 ch, u16 threshold) {
+  adc_ch[ch].threshold = threshold > 0 ? threshold : 1;
+}
+
+u16 adc_get_value(u8 ch) {
+  return adc_ch[ch].value;
+}
@@ -9,5 +9,35 @@ extern void init_adc(void);
 
 extern void adc_convert(u16 (*dst)[4]);
 
+//------------------------------
+//----- acquisition service
+//
+// converts all channels from a timer, averages 2^oversample conversions,
+// filters the result and posts kEventAdc0 + channel (data = value) only when
+// a channel moves at least its threshold away from the last posted value.
+
+#define ADC_CHANNELS 4
+#define ADC_OVERSAMPLE_MAX 4   // log2 of the most conversions averaged
+#define ADC_THRESHOLD_DEFAULT 8
+
+typedef enum {
+  kAdcFilterNone,
+  kAdcFilterIir,     // one pole lowpass, strength set by iir_shift
+  kAdcFilterMedian,  // median of the last three values, for spikes
+} adc_filter_t;
+
+// convert every ticks ms, averaging 2^oversample conversions per value
+extern void adc_service_start(u32 ticks, u8 oversample);
+extern void adc_service_stop(void);
+
+extern void adc_set_filter(u8 ch, adc_filter_t filter, u8 iir_shift);
+extern void adc_set_threshold(u8 ch, u16 threshold);
+
+// latest filtered value, whether or not it was posted
+extern u16 adc_get_value(u8 ch);
+
+// feed one conversion through the service; called from the service timer
+extern void adc_service_sample(u16 (*raw)[4]);
+
 #endif
 
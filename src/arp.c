@@ -22,6 +22,8 @@ static void arp_seq_build_converge(arp_seq_t *s, chord_t *c);
 static void arp_seq_build_diverge(arp_seq_t *s, chord_t *c);
 static void arp_seq_build_random(arp_seq_t *s, chord_t *c);
 static void arp_seq_build_played(arp_seq_t *s, note_pool_t *n);
+static u8 arp_seq_plan(arp_seq_t *s, chord_t *c, u8 k, random_state_t *r,
+											 arp_seq_op_t *ops);
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -45,65 +47,75 @@ bool chord_contains(chord_t *c, u8 num) {
 	return false;
 }
 
-bool chord_note_add(chord_t *c, u8 num, u8 vel) {
-	u8 i, j;
+// returns the index the note was inserted at or -1 if it wasn't added
+static s8 chord_note_insert(chord_t *c, u8 num, u8 vel) {
+	u8 lo, hi, mid, j;
 
 	if (c->note_count == CHORD_MAX_NOTES) {
-		return false;
+		return -1;
 	}
 
-	// empty, insert head
-	if (c->note_count == 0) {
-		c->notes[0].num = num;
-		c->notes[0].vel = vel;
-		c->note_count++;
-		return true;
-	}
-
-	// not empty, find insert point
-	for (i = 0; i < c->note_count; i++) {
-		if (num == c->notes[i].num) {
-			// matches existing note, nothing to do
-			return false;
+	// binary search for insert point
+	lo = 0;
+	hi = c->note_count;
+	while (lo < hi) {
+		mid = (lo + hi) >> 1;
+		if (c->notes[mid].num < num) {
+			lo = mid + 1;
 		}
+		else {
+			hi = mid;
+		}
+	}
 
-		if (num < c->notes[i].num) break;
+	if (lo < c->note_count && c->notes[lo].num == num) {
+		// matches existing note, nothing to do
+		return -1;
 	}
 
 	// shift up to make space
-	for (j = c->note_count; j > i; j--) {
+	for (j = c->note_count; j > lo; j--) {
 		c->notes[j] = c->notes[j - 1];
 	}
 
 	// insert new values
-	c->notes[i].num = num;
-	c->notes[i].vel = vel;
+	c->notes[lo].num = num;
+	c->notes[lo].vel = vel;
 	c->note_count++;
 
-	return true;
+	return lo;
 }
 
-bool chord_note_release(chord_t *c, u8 num) {
+// returns the index the note was removed from or -1 if it wasn't found
+static s8 chord_note_remove(chord_t *c, u8 num) {
 	u8 i, j;
-	bool found = false;
 
 	// find index for num
 	for (i = 0; i < c->note_count; i++) {
 		if (c->notes[i].num == num) {
-			found = true;
 			break;
 		}
 	}
 
+	if (i == c->note_count) {
+		return -1;
+	}
+
 	// shift down (to overwrite)
-	if (found) {
-		for (j = i; j < c->note_count; j++) {
-			c->notes[j] = c->notes[j + 1];
-		}
-		c->note_count--;
+	for (j = i; j < c->note_count - 1; j++) {
+		c->notes[j] = c->notes[j + 1];
 	}
+	c->note_count--;
+
+	return i;
+}
+
+bool chord_note_add(chord_t *c, u8 num, u8 vel) {
+	return chord_note_insert(c, num, vel) >= 0;
+}
 
-	return found;
+bool chord_note_release(chord_t *c, u8 num) {
+	return chord_note_remove(c, num) >= 0;
 }
 
 s8 chord_note_low(chord_t *c) {
@@ -126,6 +138,7 @@ void arp_seq_init(arp_seq_t* s) {
 		s->notes[i].note.vel = 0;
 		s->notes[i].empty = 1;
 		s->notes[i].gate_length = default_gate;
+		s->notes[i].ratchet = 1;
 	}
 	s->length = 0;
 	s->state = eSeqFree;
@@ -195,7 +208,8 @@ void arp_seq_build(arp_seq_t *s, arp_style style, chord_t *c, note_pool_t *n) {
 static void arp_seq_build_up(arp_seq_t *s, chord_t *c) {
 	for (u8 u = 0; u < c->note_count; u++) {
 		s->notes[u].note = c->notes[u];
-		s->notes[u].gate_length = 1;
+		s->notes[u].gate_length = ARP_PPQ;
+		s->notes[u].ratchet = 1;
 		s->notes[u].empty = 0;
 	}
 
@@ -207,7 +221,8 @@ static void arp_seq_build_down(arp_seq_t *s, chord_t *c) {
 	u8 d = c->note_count - 1;
 	for (u8 i = 0; i < c->note_count; i++) {
 		s->notes[d].note = c->notes[i];
-		s->notes[d].gate_length = 1;
+		s->notes[d].gate_length = ARP_PPQ;
+		s->notes[d].ratchet = 1;
 		s->notes[d].empty = 0;
 		d--;
 	}
@@ -224,14 +239,16 @@ static void arp_seq_build_up_down(arp_seq_t *s, chord_t *c, arp_style style) {
 	u = 0;
 	for (i = 0; i < c->note_count; i++) {
 		s->notes[u].note = c->notes[i];
-		s->notes[u].gate_length = 1;
+		s->notes[u].gate_length = ARP_PPQ;
+		s->notes[u].ratchet = 1;
 		s->notes[u].empty = 0;
 		u++;
 	}
 	if (c->note_count > 1) {
 		for (i = c->note_count - 1 - d; i >= 0 + d; --i) {
 			s->notes[u].note = c->notes[i];
-			s->notes[u].gate_length = 1;
+			s->notes[u].gate_length = ARP_PPQ;
+			s->notes[u].ratchet = 1;
 			s->notes[u].empty = 0;
 			u++;
 		}
@@ -254,7 +271,8 @@ static void arp_seq_build_converge(arp_seq_t *s, chord_t *c) {
 			j = take_high ? high_idx-- : low_idx++;
 			take_high = !take_high;
 			s->notes[i].note = c->notes[j];
-			s->notes[i].gate_length = 1;
+			s->notes[i].gate_length = ARP_PPQ;
+			s->notes[i].ratchet = 1;
 			s->notes[i].empty = 0;
 			i++;
 		} while (low_idx <= high_idx);
@@ -270,7 +288,8 @@ static void arp_seq_build_diverge(arp_seq_t *s, chord_t *c) {
 
 	if (c->note_count == 1) {
 		s->notes[0].note = c->notes[0];
-		s->notes[0].gate_length = 1;
+		s->notes[0].gate_length = ARP_PPQ;
+		s->notes[0].ratchet = 1;
 		s->notes[0].empty = 0;
 	}
 	else if (c->note_count > 1) {
@@ -287,7 +306,8 @@ static void arp_seq_build_diverge(arp_seq_t *s, chord_t *c) {
 			j = take_high ? high_idx++ : low_idx--;
 			take_high = !take_high;
 			s->notes[i].note = c->notes[j];
-			s->notes[i].gate_length = 1;
+			s->notes[i].gate_length = ARP_PPQ;
+			s->notes[i].ratchet = 1;
 			s->notes[i].empty = 0;
 		}
 	}
@@ -314,13 +334,14 @@ static void arp_seq_build_random(arp_seq_t *s, chord_t *c) {
 	// go through each note, pick a random index within the sequence,
 	// place note at next free index...
 	for (i = 0; i < count; i++) {
-		ri = random_next(&r) % upper;
+		ri = random_range(&r, upper);
 		while (!s->notes[ri].empty) {
 			ri++;
 			if (ri == count) ri = 0;
 		}
 		s->notes[ri].note = c->notes[i];
-		s->notes[ri].gate_length = 1;
+		s->notes[ri].gate_length = ARP_PPQ;
+		s->notes[ri].ratchet = 1;
 		s->notes[ri].empty = 0;
 	}
 
@@ -345,7 +366,8 @@ static void arp_seq_build_played(arp_seq_t *s, note_pool_t *p) {
 	while (n) {
 		s->notes[pos].note.num = n->num;
 		s->notes[pos].note.vel = n->vel;
-		s->notes[pos].gate_length = 1;
+		s->notes[pos].gate_length = ARP_PPQ;
+		s->notes[pos].ratchet = 1;
 		s->notes[pos].empty = 0;
 		pos--;
 		n = notes_iter_next(&i);
@@ -355,6 +377,551 @@ static void arp_seq_build_played(arp_seq_t *s, note_pool_t *p) {
 	s->length = c;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+///// arp seq: incremental edits
+
+static void arp_seq_insert(arp_seq_t *s, u8 pos, const held_note_t *n) {
+	for (u8 i = s->length; i > pos; i--) {
+		s->notes[i] = s->notes[i - 1];
+	}
+	s->notes[pos].note = *n;
+	s->notes[pos].gate_length = ARP_PPQ;
+	s->notes[pos].ratchet = 1;
+	s->notes[pos].empty = 0;
+	s->length++;
+}
+
+static void arp_seq_remove(arp_seq_t *s, u8 pos) {
+	for (u8 i = pos; i < s->length - 1; i++) {
+		s->notes[i] = s->notes[i + 1];
+	}
+	s->length--;
+	s->notes[s->length].empty = 1;
+}
+
+static s8 arp_seq_find(arp_seq_t *s, u8 num) {
+	for (u8 i = 0; i < s->length; i++) {
+		if (s->notes[i].note.num == num) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+static inline void arp_seq_op(arp_seq_op_t *op, u8 pos, const held_note_t *n) {
+	op->pos = pos;
+	op->note = *n;
+}
+
+// work out the steps which have to be inserted into s (built from c without
+// c->notes[k]) to produce the pattern for c. the steps are returned in the
+// order they have to be inserted; removing a note is the same steps removed
+// in reverse. returns 0 if the style reorders the whole pattern and has to be
+// rebuilt.
+static u8 arp_seq_plan(arp_seq_t *s, chord_t *c, u8 k, random_state_t *r,
+											 arp_seq_op_t *ops) {
+	u8 n = c->note_count;
+	held_note_t *x = &(c->notes[k]);
+
+	switch (s->style) {
+	case eStylePlayed:
+		arp_seq_op(&ops[0], s->length, x);
+		return 1;
+
+	case eStyleRandom:
+		arp_seq_op(&ops[0], random_range(r, s->length + 1), x);
+		return 1;
+
+	case eStyleUp:
+		arp_seq_op(&ops[0], k, x);
+		return 1;
+
+	case eStyleDown:
+		arp_seq_op(&ops[0], n - 1 - k, x);
+		return 1;
+
+	case eStyleUpDown:
+		// up: 0 .. n-1, down: n-2 .. 1
+		arp_seq_op(&ops[0], k, x);
+		if (n < 3) {
+			return 1;
+		}
+		if (k == 0) {
+			// new low note, previous low note joins the end of the down run
+			arp_seq_op(&ops[1], 2 * n - 3, &(c->notes[1]));
+		}
+		else if (k == n - 1) {
+			// new high note, previous high note starts the down run
+			arp_seq_op(&ops[1], n, &(c->notes[n - 2]));
+		}
+		else {
+			arp_seq_op(&ops[1], 2 * n - 2 - k, x);
+		}
+		return 2;
+
+	case eStyleUpAndDown:
+		// up: 0 .. n-1, down: n-1 .. 0 (only once there are two notes)
+		arp_seq_op(&ops[0], k, x);
+		if (n == 1) {
+			return 1;
+		}
+		if (n == 2) {
+			arp_seq_op(&ops[1], 2, &(c->notes[1]));
+			arp_seq_op(&ops[2], 3, &(c->notes[0]));
+			return 3;
+		}
+		arp_seq_op(&ops[1], 2 * n - 1 - k, x);
+		return 2;
+
+	default:
+		// converge/diverge interleave from both ends; every step moves
+		return 0;
+	}
+}
+
+static arp_seq_t *arp_seq_buf_back(arp_seq_buf_t *b) {
+	arp_seq_t *back = &(b->seqs[b->front ^ 1]);
+	back->state = eSeqBuilding;
+	return back;
+}
+
+static void arp_seq_buf_publish(arp_seq_buf_t *b, arp_seq_edit_t *e,
+																arp_player_t *players, u8 player_count) {
+	u8 back = b->front ^ 1;
+	u8 irq_flags, i;
+
+	b->seqs[back].state = b->seqs[back].length ? eSeqPlaying : eSeqFree;
+
+	// disable timer interrupts
+	irq_flags = irqs_pause();
+
+	b->front = back;
+	for (i = 0; i < player_count; i++) {
+		arp_player_apply_edit(&(players[i]), e);
+	}
+
+	// enable timer interrupts
+	irqs_resume(irq_flags);
+
+	// bring the (new) back sequence up to date for the next edit
+	b->seqs[back ^ 1] = b->seqs[back];
+}
+
+void arp_seq_buf_init(arp_seq_buf_t *b, arp_style style) {
+	arp_seq_init(&(b->seqs[0]));
+	arp_seq_init(&(b->seqs[1]));
+	b->seqs[0].style = style;
+	b->seqs[1].style = style;
+	b->front = 0;
+	random_seed(&(b->random), time_now());
+}
+
+arp_seq_t *arp_seq_buf_front(arp_seq_buf_t *b) {
+	return &(b->seqs[b->front]);
+}
+
+void arp_seq_buf_build(arp_seq_buf_t *b, arp_style style, chord_t *c, note_pool_t *n,
+											 arp_player_t *players, u8 player_count) {
+	arp_seq_t *back = arp_seq_buf_back(b);
+	arp_seq_edit_t e;
+
+	back->style = style;
+	arp_seq_build(back, style, c, n);
+
+	e.op_count = 0;
+	e.remove = false;
+	e.rebuilt = true;
+	arp_seq_buf_publish(b, &e, players, player_count);
+}
+
+bool arp_seq_buf_note_add(arp_seq_buf_t *b, chord_t *c, u8 num, u8 vel,
+													arp_player_t *players, u8 player_count) {
+	arp_seq_t *back;
+	arp_seq_edit_t e;
+	s8 k;
+
+	k = chord_note_insert(c, num, vel);
+	if (k < 0) {
+		return false;
+	}
+
+	back = arp_seq_buf_back(b);
+	e.op_count = arp_seq_plan(back, c, k, &(b->random), e.ops);
+	e.remove = false;
+	e.rebuilt = e.op_count == 0;
+
+	if (e.rebuilt) {
+		arp_seq_build(back, back->style, c, NULL);
+	}
+	else {
+		for (u8 i = 0; i < e.op_count; i++) {
+			arp_seq_insert(back, e.ops[i].pos, &(e.ops[i].note));
+		}
+	}
+
+	arp_seq_buf_publish(b, &e, players, player_count);
+	return true;
+}
+
+bool arp_seq_buf_note_release(arp_seq_buf_t *b, chord_t *c, u8 num,
+															arp_player_t *players, u8 player_count) {
+	arp_seq_t *back;
+	arp_seq_edit_t e;
+	arp_seq_op_t ops[ARP_SEQ_EDIT_MAX];
+	s8 k, pos;
+	u8 i;
+
+	// find the note while the chord still holds it; the plan is worked out
+	// against the chord the note was inserted into
+	k = -1;
+	for (i = 0; i < c->note_count; i++) {
+		if (c->notes[i].num == num) {
+			k = i;
+			break;
+		}
+	}
+	if (k < 0) {
+		return false;
+	}
+
+	back = arp_seq_buf_back(b);
+	e.remove = true;
+	e.rebuilt = false;
+
+	switch (back->style) {
+	case eStylePlayed:
+	case eStyleRandom:
+		// position depends on history, look it up
+		pos = arp_seq_find(back, num);
+		e.op_count = pos < 0 ? 0 : 1;
+		if (pos >= 0) {
+			arp_seq_op(&(e.ops[0]), pos, &(c->notes[k]));
+		}
+		break;
+	default:
+		e.op_count = arp_seq_plan(back, c, k, NULL, ops);
+		e.rebuilt = e.op_count == 0;
+		for (i = 0; i < e.op_count; i++) {
+			e.ops[i] = ops[e.op_count - 1 - i];
+		}
+		break;
+	}
+
+	chord_note_remove(c, num);
+
+	if (e.rebuilt) {
+		arp_seq_build(back, back->style, c, NULL);
+	}
+	else {
+		for (i = 0; i < e.op_count; i++) {
+			arp_seq_remove(back, e.ops[i].pos);
+		}
+	}
+
+	arp_seq_buf_publish(b, &e, players, player_count);
+	return true;
+}
+
+static void arp_player_update_mask(arp_player_t *p) {
+	p->gate_mask = euclidean_mask(arp_player_get_fill(p), p->division, p->rotation);
+}
+
+static inline bool arp_player_gate(arp_player_t *p) {
+	return p->div_count < 32 && ((p->gate_mask >> p->div_count) & 1);
+}
+
+static inline void arp_event(arp_event_t *ev, arp_event_type type, u8 ch, u8 num, u8 vel) {
+	ev->type = type;
+	ev->ch = ch;
+	ev->num = num;
+	ev->vel = vel;
+}
+
+// advance one player by one clock phase, writing any resulting note events
+// to ev. returns the number of events written (at most two)
+static u8 arp_player_advance(arp_player_t *p, arp_seq_t *s, u8 phase, arp_event_t *ev) {
+	u8 i, g, v;
+	u8 count = 0;
+
+	if (phase) {
+		if (arp_player_gate(p)) {
+			// release any active note
+			if (p->active_note >= 0) {
+				// TODO: how to handle tied note?
+				arp_event(&ev[count++], eArpNoteOff, p->ch, p->active_note, 0);
+				p->active_note = -1;
+			}
+
+			if (s->length > 0) {
+				// ensure if seq got shorter we don't go off the end
+				if (p->index >= s->length) {
+					p->index = 0;
+					p->step_count = 0;
+				}
+
+				i = p->index;
+
+				// determine velocity
+				switch (p->velocity) {
+				case eVelocityPlayed:
+					v = s->notes[i].note.vel;
+					break;
+				case eVelocityFixed:
+				default:
+					v = p->fixed_velocity;
+					break;
+				}
+
+				// determine gate length
+				switch (p->gate) {
+				case eGateVariable:
+					// note gate is [0-ARP_PPQ], scale to division like fixed_gate
+					g = (s->notes[i].gate_length * p->division) / ARP_PPQ;
+					break;
+				case eGateFixed:
+				default:
+					g = p->fixed_gate;
+					break;
+				}
+
+				p->active_note = uclip(s->notes[i].note.num + (p->step_count * p->offset),
+															 0, MIDI_NOTE_MAX);
+				p->active_gate = g;
+				arp_event(&ev[count++], eArpNoteOn, p->ch, p->active_note, v);
+
+				// advance seq
+				p->index++;
+
+				if (p->index >= s->length) {
+					p->index = 0;
+					p->step_count++;
+					if (p->step_count > p->steps) {
+						p->step_count = 0;
+					}
+				}
+			}
+		}
+
+		// always advance div_count
+		p->div_count++;
+		if (p->div_count >= p->division) {
+			p->div_count = 0;
+		}
+	}
+	else {
+		// clock low, look for notes to turn off
+		if (p->active_note >= 0 && p->div_count >= p->active_gate) {
+			arp_event(&ev[count++], eArpNoteOff, p->ch, p->active_note, 0);
+			p->active_note = -1;
+		}
+	}
+
+	return count;
+}
+
+static void arp_events_dispatch(arp_event_t *ev, u8 count, midi_behavior_t *b) {
+	for (u8 i = 0; i < count; i++) {
+		if (ev[i].type == eArpNoteOn) {
+			b->note_on(ev[i].ch, ev[i].num, ev[i].vel);
+		}
+		else {
+			b->note_off(ev[i].ch, ev[i].num, ev[i].vel);
+		}
+	}
+}
+
+static void arp_queue_clear(arp_queue_t *q) {
+	q->count = 0;
+}
+
+static void arp_queue_push(arp_queue_t *q, u32 due, arp_event_t *ev) {
+	u8 j;
+
+	if (q->count == ARP_QUEUE_SIZE) {
+		return;
+	}
+
+	// events due at the same tick fire in the order they were queued
+	j = q->count;
+	while (j > 0 && (s32)(q->items[j - 1].due - due) <= 0) {
+		q->items[j] = q->items[j - 1];
+		j--;
+	}
+	q->items[j].due = due;
+	q->items[j].ev = *ev;
+	q->count++;
+}
+
+static inline arp_event_t *arp_queue_peek(arp_queue_t *q, u32 now) {
+	if (q->count && (s32)(now - q->items[q->count - 1].due) >= 0) {
+		return &(q->items[q->count - 1].ev);
+	}
+	return NULL;
+}
+
+static inline void arp_queue_drop(arp_queue_t *q) {
+	q->count--;
+}
+
+// schedule the note(s) for one gated step starting at p->now
+static void arp_player_schedule(arp_player_t *p, arp_seq_t *s) {
+	arp_event_t on, off;
+	u8 i, v, r, span, interval;
+	u16 g, gate, division_ticks;
+	bool swung;
+	u32 t;
+
+	// ensure if seq got shorter we don't go off the end
+	if (p->index >= s->length) {
+		p->index = 0;
+		p->step_count = 0;
+	}
+
+	i = p->index;
+
+	// determine velocity
+	switch (p->velocity) {
+	case eVelocityPlayed:
+		v = s->notes[i].note.vel;
+		break;
+	case eVelocityFixed:
+	default:
+		v = p->fixed_velocity;
+		break;
+	}
+
+	// determine gate length and repeats, in ticks. like the pulse path the
+	// gate is a fraction of the division, not of one step. a zero gate ties
+	// the note over until the next gated step
+	division_ticks = (u16)p->division * ARP_PPQ;
+	switch (p->gate) {
+	case eGateVariable:
+		g = (u16)s->notes[i].gate_length * p->division;
+		r = s->notes[i].ratchet;
+		break;
+	case eGateFixed:
+	default:
+		if (p->fixed_gate >= p->division) {
+			g = 0;
+		}
+		else {
+			g = ((u32)p->fixed_width * division_ticks) >> 7;
+			if (g == 0) g = 1;
+		}
+		r = p->ratchet;
+		break;
+	}
+	r = uclip(r, 1, ARP_RATCHET_MAX);
+
+	// a swung step starts late but the next one doesn't, so repeats fit in
+	// what is left of it
+	swung = p->swing_count & 1;
+	p->swing_count++;
+	span = swung ? ARP_PPQ - p->swing : ARP_PPQ;
+
+	interval = span / r;
+	gate = g;
+	if (r > 1 && g) {
+		gate = ((u32)g * interval) / division_ticks;
+		if (gate == 0) gate = 1;
+	}
+
+	arp_event(&on, eArpNoteOn, p->ch,
+						uclip(s->notes[i].note.num + (p->step_count * p->offset), 0, MIDI_NOTE_MAX),
+						v);
+	arp_event(&off, eArpNoteOff, p->ch, on.num, 0);
+
+	t = p->now;
+	if (swung) {
+		t += p->swing;
+	}
+
+	for (i = 0; i < r; i++) {
+		arp_queue_push(&(p->queue), t, &on);
+		if (gate) {
+			arp_queue_push(&(p->queue), t + gate, &off);
+		}
+		t += interval;
+	}
+
+	// advance seq
+	p->index++;
+
+	if (p->index >= s->length) {
+		p->index = 0;
+		p->step_count++;
+		if (p->step_count > p->steps) {
+			p->step_count = 0;
+		}
+	}
+}
+
+// advance one player by one tick (ARP_PPQ ticks per step), writing any note
+// events which fall due to ev. returns the number of events written, at most
+// ARP_TICK_EVENTS_MAX; anything beyond that fires on the next tick.
+u8 arp_player_tick_events(arp_player_t *p, arp_seq_t *s, arp_event_t *ev) {
+	arp_event_t *due;
+	u8 count = 0;
+
+	if (p->tick == 0) {
+		if (arp_player_gate(p) &&
+				(p->probability >= ARP_PROBABILITY_MAX ||
+				 (random_next(&(p->random)) & (ARP_PROBABILITY_MAX - 1)) < p->probability)) {
+			// new step cuts short whatever is left of the previous one
+			arp_queue_clear(&(p->queue));
+			if (p->active_note >= 0) {
+				arp_event(&ev[count++], eArpNoteOff, p->ch, p->active_note, 0);
+				p->active_note = -1;
+			}
+
+			if (s->length > 0) {
+				arp_player_schedule(p, s);
+			}
+		}
+
+		// always advance div_count
+		p->div_count++;
+		if (p->div_count >= p->division) {
+			p->div_count = 0;
+		}
+	}
+
+	while ((due = arp_queue_peek(&(p->queue), p->now))) {
+		if (due->type == eArpNoteOn) {
+			// repeats of a tied note need the previous one released first
+			if (p->active_note >= 0) {
+				if (count + 2 > ARP_TICK_EVENTS_MAX) break;
+				arp_event(&ev[count++], eArpNoteOff, p->ch, p->active_note, 0);
+			}
+			else if (count == ARP_TICK_EVENTS_MAX) {
+				break;
+			}
+			p->active_note = due->num;
+			ev[count++] = *due;
+		}
+		else if (p->active_note == due->num) {
+			if (count == ARP_TICK_EVENTS_MAX) break;
+			p->active_note = -1;
+			ev[count++] = *due;
+		}
+		arp_queue_drop(&(p->queue));
+	}
+
+	p->now++;
+	p->tick++;
+	if (p->tick >= ARP_PPQ) {
+		p->tick = 0;
+	}
+
+	return count;
+}
+
+void arp_player_tick(arp_player_t *p, arp_seq_t *s, midi_behavior_t *b) {
+	arp_event_t ev[ARP_TICK_EVENTS_MAX];
+	arp_events_dispatch(ev, arp_player_tick_events(p, s, ev), b);
+}
+
 void arp_player_init(arp_player_t *p, u8 ch, u8 division) {
 	p->ch = ch;
 
@@ -372,6 +939,16 @@ void arp_player_init(arp_player_t *p, u8 ch, u8 division) {
 	p->step_count = 0;
 	p->offset = 12;
 
+	p->division = 0;
+	p->fill = 1;
+	p->rotation = 0;
+
+	p->now = 0;
+	p->swing = 0;
+	p->probability = ARP_PROBABILITY_MAX;
+	p->ratchet = 1;
+	random_seed(&(p->random), time_now() + ch);
+
 	arp_player_set_division(p, division, NULL);
 	arp_player_set_fill(p, 1);
 	arp_player_set_rotation(p, 0);
@@ -412,8 +989,9 @@ inline u8 arp_player_get_gate_width(arp_player_t *p) {
 	return p->fixed_width;
 }
 
-inline void arp_player_set_fill(arp_player_t *p, u8 fill) {
+void arp_player_set_fill(arp_player_t *p, u8 fill) {
 	p->fill = fill;
+	arp_player_update_mask(p);
 }
 
 inline u8 arp_player_get_fill(arp_player_t *p) {
@@ -441,102 +1019,183 @@ inline u8 arp_player_get_division(arp_player_t *p) {
 	return p->division;
 }
 
-inline void arp_player_set_rotation(arp_player_t *p, s8 r) {
+void arp_player_set_rotation(arp_player_t *p, s8 r) {
 	p->rotation = r;
+	arp_player_update_mask(p);
 }
 
 inline s8 arp_player_get_rotation(arp_player_t *p) {
 	return p->rotation;
 }
 
+void arp_player_set_swing(arp_player_t *p, u8 ticks) {
+	p->swing = uclip(ticks, 0, ARP_PPQ >> 1);
+}
+
+inline u8 arp_player_get_swing(arp_player_t *p) {
+	return p->swing;
+}
+
+void arp_player_set_probability(arp_player_t *p, u8 probability) {
+	p->probability = uclip(probability, 0, ARP_PROBABILITY_MAX);
+}
+
+inline u8 arp_player_get_probability(arp_player_t *p) {
+	return p->probability;
+}
+
+void arp_player_set_ratchet(arp_player_t *p, u8 ratchet) {
+	p->ratchet = uclip(ratchet, 1, ARP_RATCHET_MAX);
+}
+
+inline u8 arp_player_get_ratchet(arp_player_t *p) {
+	return p->ratchet;
+}
+
 bool arp_player_at_end(arp_player_t *p, arp_seq_t *s) {
 	return p->index >= s->length - 1;
 }
 
 void arp_player_pulse(arp_player_t *p, arp_seq_t *s, midi_behavior_t *b, u8 phase) {
-	u8 i, g, v, f;
+	arp_event_t ev[2];
+	arp_events_dispatch(ev, arp_player_advance(p, s, phase, ev), b);
+}
 
-	if (phase) {
-		f = arp_player_get_fill(p);
+void arp_player_reset(arp_player_t *p, midi_behavior_t *b) {
+	p->index = 0;
+	p->div_count = 0;
+	p->step_count = 0;
+	p->tick = 0;
+	p->swing_count = 0;
+	arp_queue_clear(&(p->queue));
 
-		if (euclidean(f, p->division, p->div_count - p->rotation)) {
-			// release any active note
-			if (p->active_note >= 0) {
-				// TODO: how to handle tied note?
-				b->note_off(p->ch, p->active_note, 0);
-				p->active_note = -1;
+	if (b && p->active_note >= 0) {
+		b->note_off(p->ch, p->active_note, 0);
+		p->active_note = -1;
+	}
+}
+
+// shift the playback position across a published edit so the step which
+// would have played next still does
+void arp_player_apply_edit(arp_player_t *p, arp_seq_edit_t *e) {
+	if (e->rebuilt) {
+		// nothing to map; pulse clamps index to the new length
+		return;
+	}
+
+	for (u8 i = 0; i < e->op_count; i++) {
+		// an insert at the play position goes in front of the next
+		// step; a remove there takes the next step out
+		if (e->remove) {
+			if (e->ops[i].pos < p->index) {
+				p->index--;
 			}
+		}
+		else if (e->ops[i].pos <= p->index) {
+			p->index++;
+		}
+	}
+}
 
-			if (s->length > 0) {
-				// ensure if seq got shorter we don't go off the end
-				if (p->index >= s->length) {
-					p->index = 0;
-					p->step_count = 0;
-				}
+////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+///// arp engine: implementation
 
-				i = p->index;
+void arp_engine_init(arp_engine_t *e, u8 lane_count, arp_style style, u8 division) {
+	if (lane_count > ARP_ENGINE_LANES_MAX) {
+		lane_count = ARP_ENGINE_LANES_MAX;
+	}
 
-				// determine velocity
-				switch (p->velocity) {
-				case eVelocityPlayed:
-					v = s->notes[i].note.vel;
-					break;
-				case eVelocityFixed:
-				default:
-					v = p->fixed_velocity;
-					break;
-				}
+	for (u8 i = 0; i < lane_count; i++) {
+		arp_player_init(&(e->players[i]), i, division);
+	}
+	e->lane_count = lane_count;
 
-				// determine gate length
-				switch (p->gate) {
-				case eGateVariable:
-					g = s->notes[i].gate_length;
-				case eGateFixed:
-				default:
-					g = p->fixed_gate;
-					break;
-				}
+	chord_init(&(e->chord));
+	arp_seq_buf_init(&(e->seq), style);
 
-				p->active_note = uclip(s->notes[i].note.num + (p->step_count * p->offset),
-															 0, MIDI_NOTE_MAX);
-				p->active_gate = g;
-				b->note_on(p->ch, p->active_note, v);
+	e->event_count = 0;
+}
 
-				// advance seq
-				p->index++;
+arp_player_t *arp_engine_player(arp_engine_t *e, u8 lane) {
+	return lane < e->lane_count ? &(e->players[lane]) : NULL;
+}
 
-				if (p->index >= s->length) {
-					p->index = 0;
-					p->step_count++;
-					if (p->step_count > p->steps) {
-						p->step_count = 0;
-					}
-				}
-			}
-		}
+void arp_engine_set_style(arp_engine_t *e, arp_style style, note_pool_t *n) {
+	arp_seq_buf_build(&(e->seq), style, &(e->chord), n, e->players, e->lane_count);
+}
 
-		// always advance div_count
-		p->div_count++;
-		if (p->div_count >= p->division) {
-			p->div_count = 0;
+bool arp_engine_note_add(arp_engine_t *e, u8 num, u8 vel) {
+	return arp_seq_buf_note_add(&(e->seq), &(e->chord), num, vel,
+															e->players, e->lane_count);
+}
+
+bool arp_engine_note_release(arp_engine_t *e, u8 num) {
+	return arp_seq_buf_note_release(&(e->seq), &(e->chord), num,
+																	e->players, e->lane_count);
+}
+
+// advance every lane by one clock phase. the resulting note events are left
+// in e->events (note offs for a lane ahead of its note on) and their count is
+// returned.
+u8 arp_engine_pulse(arp_engine_t *e, u8 phase) {
+	arp_seq_t *s = arp_seq_buf_front(&(e->seq));
+	arp_player_t *p = e->players;
+	u8 count = 0;
+	u8 lane, n;
+
+	for (lane = 0; lane < e->lane_count; lane++, p++) {
+		// nothing to do on the low phase without a sounding note
+		if (!phase && p->active_note < 0) continue;
+
+		n = arp_player_advance(p, s, phase, &(e->events[count]));
+		while (n--) {
+			e->events[count++].lane = lane;
 		}
 	}
-	else {
-		// clock low, look for notes to turn off
-		if (p->active_note >= 0 && p->div_count >= p->active_gate) {
-			b->note_off(p->ch, p->active_note, 0);
-			p->active_note = -1;
+
+	e->event_count = count;
+	return count;
+}
+
+// advance every lane by one tick (ARP_PPQ per step); see arp_engine_pulse
+u8 arp_engine_tick(arp_engine_t *e) {
+	arp_seq_t *s = arp_seq_buf_front(&(e->seq));
+	arp_player_t *p = e->players;
+	u8 count = 0;
+	u8 lane, n;
+
+	for (lane = 0; lane < e->lane_count; lane++, p++) {
+		n = arp_player_tick_events(p, s, &(e->events[count]));
+		while (n--) {
+			e->events[count++].lane = lane;
 		}
 	}
+
+	e->event_count = count;
+	return count;
 }
 
-void arp_player_reset(arp_player_t *p, midi_behavior_t *b) {
-	p->index = 0;
-	p->div_count = 0;
-	p->step_count = 0;
+// reset every lane to the start of the sequence, releasing active notes
+// through e->events
+u8 arp_engine_reset(arp_engine_t *e) {
+	arp_player_t *p = e->players;
+	u8 count = 0;
 
-	if (b && p->active_note >= 0) {
-		b->note_off(p->ch, p->active_note, 0);
+	for (u8 lane = 0; lane < e->lane_count; lane++, p++) {
+		if (p->active_note >= 0) {
+			arp_event(&(e->events[count]), eArpNoteOff, p->ch, p->active_note, 0);
+			e->events[count++].lane = lane;
+		}
+		arp_player_reset(p, NULL);
 		p->active_note = -1;
 	}
+
+	e->event_count = count;
+	return count;
+}
+
+void arp_engine_dispatch(arp_engine_t *e, midi_behavior_t *b) {
+	arp_events_dispatch(e->events, e->event_count, b);
+	e->event_count = 0;
 }
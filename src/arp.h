@@ -3,6 +3,7 @@
 
 #include "notes.h"
 #include "midi_common.h"
+#include "random.h"
 
 #include "compiler.h"   // for bool; shouldn't this be "types.h"
 
@@ -16,7 +17,30 @@
 #define ARP_MAX_OCTAVE 4
 #define ARP_MAX_LENGTH (2 * CHORD_MAX_NOTES)
 
-#define ARP_PPQ 1
+// sub-step resolution for arp_player_tick; gate lengths, ratchets and swing
+// are expressed in these ticks
+#ifndef ARP_PPQ
+#define ARP_PPQ 24
+#endif
+
+#define ARP_RATCHET_MAX 8
+#define ARP_PROBABILITY_MAX 128
+
+// pending note on/off per ratchet plus the note off for a tied note
+#define ARP_QUEUE_SIZE (2 * ARP_RATCHET_MAX + 1)
+
+// most events a single lane produces per tick or pulse
+#define ARP_TICK_EVENTS_MAX 2
+
+// most sequence steps a single chord edit can insert or remove
+#define ARP_SEQ_EDIT_MAX 3
+
+#ifndef ARP_ENGINE_LANES_MAX
+#define ARP_ENGINE_LANES_MAX 4
+#endif
+
+// a lane can release one note and start another per pulse
+#define ARP_ENGINE_EVENTS_MAX (ARP_TICK_EVENTS_MAX * ARP_ENGINE_LANES_MAX)
 
 
 //-----------------------------
@@ -45,6 +69,11 @@ typedef enum {
 	eGateVariable
 } arp_gate;
 
+typedef enum {
+	eArpNoteOff,
+	eArpNoteOn
+} arp_event_type;
+
 typedef enum {
 	eSeqFree,
 	eSeqBuilding,
@@ -62,7 +91,8 @@ typedef struct {
 
 typedef struct {
 	held_note_t note;
-	u8 gate_length;    // [0-ARP_PPQ], 0 is tie, 1-ARP_PPQ is fraction of quater note
+	u8 gate_length;    // [0-ARP_PPQ], 0 is tie, 1-ARP_PPQ is fraction of the division
+	u8 ratchet;        // [1-ARP_RATCHET_MAX] repeats within the step (eGateVariable)
 	u8 empty : 1;
 } arp_note_t;
 
@@ -72,7 +102,49 @@ typedef struct {
 	u8 length;
 	arp_seq_state state;
 } arp_seq_t;
+
+typedef struct {
+	u8 pos;
+	held_note_t note;
+} arp_seq_op_t;
+
+// record of the steps inserted (or removed) by one chord edit, in the order
+// they were applied. if rebuilt is set the pattern was reordered and step
+// positions do not carry over.
+typedef struct {
+	arp_seq_op_t ops[ARP_SEQ_EDIT_MAX];
+	u8 op_count;
+	bool remove;
+	bool rebuilt;
+} arp_seq_edit_t;
+
+// double buffered sequence; edits are applied to the back sequence and
+// published with a single swap so players only ever see a complete pattern.
+typedef struct {
+	arp_seq_t seqs[2];
+	volatile u8 front;
+	random_state_t random;
+} arp_seq_buf_t;
 	
+typedef struct {
+	arp_event_type type;
+	u8 lane;
+	u8 ch;
+	u8 num;
+	u8 vel;
+} arp_event_t;
+
+typedef struct {
+	u32 due;              // player tick the event fires on
+	arp_event_t ev;
+} arp_queued_t;
+
+// pending events ordered latest first, so the next one due is at the end
+typedef struct {
+	arp_queued_t items[ARP_QUEUE_SIZE];
+	u8 count;
+} arp_queue_t;
+
 typedef struct {
 	u8 ch;                // channel; passed to midi behavior
 	u8 index;             // current note index
@@ -81,6 +153,7 @@ typedef struct {
 	u8 division;          // er; len (was pulses per note)
 	s8 rotation;          // er; offset/rotation
 	u16 div_count;        // current note division
+	u32 gate_mask;        // euclidean pattern for fill/division/rotation; bit n is div_count n
 
 	arp_velocity velocity;
 	arp_gate gate;
@@ -95,8 +168,32 @@ typedef struct {
 	u8 steps;             // number of steps (repeats?) of the arp pattern
 	u8 step_count;        // current step number
 	s8 offset;            // number of semitones to transpose by per step; [-24,24] or voltage offsets?
+
+	// sub-step playback (arp_player_tick)
+	u8 tick;              // position within the current step [0-ARP_PPQ)
+	u32 now;              // ticks since init; time base for queue
+	u8 swing;             // delay of odd steps in ticks [0-ARP_PPQ/2]
+	u8 swing_count;       // steps scheduled since reset; odd ones are swung
+	u8 probability;       // chance a gated step plays [0-ARP_PROBABILITY_MAX]
+	u8 ratchet;           // repeats within each step [1-ARP_RATCHET_MAX] (eGateFixed)
+	arp_queue_t queue;    // scheduled note on/offs
+	random_state_t random;
 } arp_player_t;
 
+// a set of players (lanes) following one shared sequence from one clock.
+// each pulse advances every lane and collects the resulting note events so
+// they can be dispatched together.
+typedef struct {
+	arp_player_t players[ARP_ENGINE_LANES_MAX];
+	u8 lane_count;
+
+	chord_t chord;
+	arp_seq_buf_t seq;
+
+	arp_event_t events[ARP_ENGINE_EVENTS_MAX];
+	u8 event_count;
+} arp_engine_t;
+
 
 //-----------------------------
 //----- functions
@@ -113,6 +210,15 @@ bool arp_seq_set_state(arp_seq_t *s, arp_seq_state state);
 arp_seq_state arp_seq_get_state(arp_seq_t *s);
 void arp_seq_build(arp_seq_t *a, arp_style style, chord_t *c, note_pool_t *n);
 
+void arp_seq_buf_init(arp_seq_buf_t *b, arp_style style);
+arp_seq_t *arp_seq_buf_front(arp_seq_buf_t *b);
+void arp_seq_buf_build(arp_seq_buf_t *b, arp_style style, chord_t *c, note_pool_t *n,
+											 arp_player_t *players, u8 player_count);
+bool arp_seq_buf_note_add(arp_seq_buf_t *b, chord_t *c, u8 num, u8 vel,
+													arp_player_t *players, u8 player_count);
+bool arp_seq_buf_note_release(arp_seq_buf_t *b, chord_t *c, u8 num,
+															arp_player_t *players, u8 player_count);
+
 void arp_player_init(arp_player_t *p, u8 ch, u8 division);
 
 void arp_player_set_steps(arp_player_t *p, u8 steps);
@@ -133,8 +239,30 @@ u8 arp_player_get_division(arp_player_t *p);
 void arp_player_set_rotation(arp_player_t *p, s8 rotation);
 s8   arp_player_get_rotation(arp_player_t *p);
 
+void arp_player_set_swing(arp_player_t *p, u8 ticks);
+u8   arp_player_get_swing(arp_player_t *p);
+
+void arp_player_set_probability(arp_player_t *p, u8 probability);
+u8   arp_player_get_probability(arp_player_t *p);
+
+void arp_player_set_ratchet(arp_player_t *p, u8 ratchet);
+u8   arp_player_get_ratchet(arp_player_t *p);
+
 bool arp_player_at_end(arp_player_t *p, arp_seq_t *s);
 void arp_player_pulse(arp_player_t *p, arp_seq_t *s, midi_behavior_t *b, u8 phase);
+u8   arp_player_tick_events(arp_player_t *p, arp_seq_t *s, arp_event_t *ev);
+void arp_player_tick(arp_player_t *p, arp_seq_t *s, midi_behavior_t *b);
 void arp_player_reset(arp_player_t *a, midi_behavior_t *b);
+void arp_player_apply_edit(arp_player_t *p, arp_seq_edit_t *e);
+
+void arp_engine_init(arp_engine_t *e, u8 lane_count, arp_style style, u8 division);
+arp_player_t *arp_engine_player(arp_engine_t *e, u8 lane);
+void arp_engine_set_style(arp_engine_t *e, arp_style style, note_pool_t *n);
+bool arp_engine_note_add(arp_engine_t *e, u8 num, u8 vel);
+bool arp_engine_note_release(arp_engine_t *e, u8 num);
+u8   arp_engine_pulse(arp_engine_t *e, u8 phase);
+u8   arp_engine_tick(arp_engine_t *e);
+u8   arp_engine_reset(arp_engine_t *e);
+void arp_engine_dispatch(arp_engine_t *e, midi_behavior_t *b);
 
 #endif // __ARP_H__
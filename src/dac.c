@@ -1,28 +1,237 @@
 #include "types.h"
 
 #include "spi.h"
+#include "libfixmath/fix16.h"
 
 #include "dac.h"
 
 #include "conf_board.h"
 #include "interrupts.h"
+#include "random.h"
 
 
+// slew progress is 8.24 fixed point, DAC_SLEW_ONE is a completed slew
+#define DAC_SLEW_ONE (1 << 24)
+#define DAC_SLEW_CURVE_BITS 6
+#define DAC_SLEW_CURVE_LEN (1 << DAC_SLEW_CURVE_BITS)
+
 struct {
     u16 value;
     u16 now;
     u16 off;
     u16 target;
-    u16 slew;
+    u16 start;
     u16 slew_ms;
-    u16 step;
-    s32 delta;
-    u32 a;
+    u32 inc;        // progress per dac tick, from slew_ms
+    u32 progress;   // [0-DAC_SLEW_ONE] through the current slew
+    u8 shape;
+    u16 sent;       // code last written to the dac, 0xffff forces a write
 } aout[4];
 
 static bool is_slewing[4];
 
+// calibration, compiled to one segment per volt so applying it is a multiply
+// and a shift. zeroed tables are the identity, so outputs work uncalibrated
+// before anything is loaded.
+#define DAC_CAL_SEGMENTS (DAC_CAL_POINTS - 1)
+
+// first dac value of each segment, ceil(i * 16384 / 10) so that
+// (v * 10) >> 14 always lands in the segment containing v
+static const u16 cal_x[DAC_CAL_POINTS] = {
+    0, 1639, 3277, 4916, 6554, 8192, 9831, 11469, 13108, 14746, 16384
+};
+
+static dac_cal_t cal[4];
+
+static struct {
+    s16 trim;       // correction at the start of the segment
+    s32 slope;      // change in correction per dac value, 16.16
+} cal_seg[4][DAC_CAL_SEGMENTS];
+
+// the two dacs are daisy chained and each transfer carries the same channel
+// of both; a frame updates outputs 0 and 2 (dac channel a) or 1 and 3 (b)
+#define DAC_FRAME_A ((1 << 0) | (1 << 2))
+#define DAC_FRAME_B ((1 << 1) | (1 << 3))
+#define DAC_CMD_WRITE_A 0x31
+#define DAC_CMD_WRITE_B 0x38
+
+// modulation. lfos are a 32 bit phase accumulator stepped once per dac tick;
+// all divisions happen when rates are set, not on the tick
+#define DAC_MOD_SINE_BITS 8
+#define DAC_MOD_SINE_LEN (1 << DAC_MOD_SINE_BITS)
+#define DAC_MOD_ENV_TOP ((s32)DAC_MOD_FULL << 16)
+
+typedef enum {
+    kEnvIdle,
+    kEnvAttack,
+    kEnvDecay,
+    kEnvSustain,
+    kEnvRelease
+} mod_env_stage;
+
+static struct {
+    u8 source;
+    u8 stage;           // envelope stage
+    u16 rate_ms;
+    s16 depth;
+    s16 out;            // current contribution in dac values
+    u32 phase;
+    u32 inc;            // phase per dac tick, from rate_ms
+    s32 level;          // random walk in [+/-DAC_MOD_FULL], envelope in 16.16
+    s32 attack;         // envelope level per dac tick
+    s32 decay;
+    s32 sustain;
+    s32 release;
+    random_state_t random;
+} mod[4];
+
+// one cycle of sine in [+/-DAC_MOD_FULL], built from fix16_sin on first use
+static s16 mod_sine[DAC_MOD_SINE_LEN + 1];
+static bool mod_sine_ready;
+
+// slew curves, 64 segments from start (0) to target (65535); indexed by
+// dac_slew_shape - 1, linear is computed directly
+static const u16 slew_curves[DAC_SLEW_SHAPE_COUNT - 1][DAC_SLEW_CURVE_LEN + 1] = {
+    // kDacSlewExp: (e^4x - 1) / (e^4 - 1)
+    {
+            0,    79,   163,   252,   347,   449,   556,   671,
+          793,   923,  1062,  1209,  1366,  1533,  1710,  1900,
+         2101,  2315,  2544,  2786,  3045,  3320,  3613,  3925,
+         4257,  4611,  4987,  5387,  5814,  6267,  6750,  7265,
+         7812,  8395,  9015,  9675, 10378, 11126, 11923, 12770,
+        13673, 14634, 15656, 16745, 17904, 19137, 20450, 21848,
+        23336, 24920, 26606, 28401, 30311, 32345, 34510, 36815,
+        39268, 41879, 44659, 47618, 50768, 54121, 57691, 61490,
+        65535,
+    },
+    // kDacSlewLog: (1 - e^-4x) / (1 - e^-4)
+    {
+            0,  4045,  7844, 11414, 14767, 17917, 20876, 23656,
+        26267, 28720, 31025, 33190, 35224, 37134, 38929, 40615,
+        42199, 43687, 45085, 46398, 47631, 48790, 49879, 50901,
+        51862, 52765, 53612, 54409, 55157, 55860, 56520, 57140,
+        57723, 58270, 58785, 59268, 59721, 60148, 60548, 60924,
+        61278, 61610, 61922, 62215, 62490, 62749, 62991, 63220,
+        63434, 63635, 63825, 64002, 64169, 64326, 64473, 64612,
+        64742, 64864, 64979, 65086, 65188, 65283, 65372, 65456,
+        65535,
+    },
+    // kDacSlewSCurve: (1 - cos(pi x)) / 2
+    {
+            0,    39,   158,   355,   630,   982,  1411,  1915,
+         2494,  3146,  3869,  4662,  5522,  6448,  7438,  8488,
+         9597, 10762, 11980, 13248, 14563, 15922, 17321, 18758,
+        20228, 21728, 23256, 24806, 26375, 27960, 29556, 31160,
+        32767, 34375, 35979, 37575, 39160, 40729, 42279, 43807,
+        45307, 46777, 48214, 49613, 50972, 52287, 53555, 54773,
+        55938, 57047, 58097, 59087, 60013, 60873, 61666, 62389,
+        63041, 63620, 64124, 64553, 64905, 65180, 65377, 65496,
+        65535,
+    }
+};
+
+// map slew progress to [0-65535] of the way from start to target
+static inline u32 slew_curve(u8 shape, u32 progress) {
+    const u16 *t;
+    u32 i, frac;
+
+    if (shape == kDacSlewLinear) {
+        return progress >> 8;
+    }
+
+    t = slew_curves[shape - 1];
+    i = progress >> (24 - DAC_SLEW_CURVE_BITS);
+    frac = (progress >> (8 - DAC_SLEW_CURVE_BITS)) & 0xffff;
+    return t[i] + (((s32)(t[i + 1] - t[i]) * (s32)frac) >> 16);
+}
+
+static void mod_sine_init(void) {
+    u16 i;
+    fix16_t a;
+
+    for (i = 0; i <= DAC_MOD_SINE_LEN; i++) {
+        a = ((s32)i * (fix16_pi << 1)) >> DAC_MOD_SINE_BITS;
+        mod_sine[i] = ((s32)fix16_sin(a) * DAC_MOD_FULL) >> 16;
+    }
+    mod_sine_ready = true;
+}
+
+// envelope level change per dac tick to cover span in ms, rounded up like
+// the slew so a whole number of ticks doesn't overrun by one
+static s32 mod_env_rate(s32 span, u16 ms) {
+    if (ms <= DAC_RATE_CV)
+        return span > 0 ? span : 1;
+    return (span + ms - 1) / ms * DAC_RATE_CV;
+}
 
+// advance the modulation source, returns [+/-DAC_MOD_FULL]
+static s32 mod_step(u8 n) {
+    u32 p, frac;
+    s32 v;
+
+    switch (mod[n].source) {
+    case kDacModSine:
+        p = mod[n].phase += mod[n].inc;
+        v = mod_sine[p >> (32 - DAC_MOD_SINE_BITS)];
+        frac = (p >> (16 - DAC_MOD_SINE_BITS)) & 0xffff;
+        return v + (((mod_sine[(p >> (32 - DAC_MOD_SINE_BITS)) + 1] - v) *
+                     (s32)frac) >> 16);
+
+    case kDacModTriangle:
+        p = (mod[n].phase += mod[n].inc) >> 16;
+        if (p < 32768)
+            return (s32)p * 2 - DAC_MOD_FULL;
+        return (s32)(65535 - p) * 2 - DAC_MOD_FULL;
+
+    case kDacModSaw:
+        p = (mod[n].phase += mod[n].inc) >> 16;
+        return (s32)p - 32768;
+
+    case kDacModRandom:
+        // step size follows the rate, reflect off the ends
+        v = (s32)(random_next(&mod[n].random) & 0xffff) - 32768;
+        v = mod[n].level + ((v * (s32)(mod[n].inc >> 15)) >> 15);
+        if (v > DAC_MOD_FULL)
+            v = 2 * DAC_MOD_FULL - v;
+        else if (v < -DAC_MOD_FULL)
+            v = -2 * DAC_MOD_FULL - v;
+        return mod[n].level = v;
+
+    case kDacModEnv:
+        switch (mod[n].stage) {
+        case kEnvAttack:
+            // the top leaves little headroom in an s32, so check before
+            // adding rather than after
+            if (mod[n].attack >= DAC_MOD_ENV_TOP - mod[n].level) {
+                mod[n].level = DAC_MOD_ENV_TOP;
+                mod[n].stage = kEnvDecay;
+            }
+            else
+                mod[n].level += mod[n].attack;
+            break;
+        case kEnvDecay:
+            mod[n].level -= mod[n].decay;
+            if (mod[n].level <= mod[n].sustain) {
+                mod[n].level = mod[n].sustain;
+                mod[n].stage = kEnvSustain;
+            }
+            break;
+        case kEnvRelease:
+            mod[n].level -= mod[n].release;
+            if (mod[n].level <= 0) {
+                mod[n].level = 0;
+                mod[n].stage = kEnvIdle;
+            }
+            break;
+        default:
+            break;
+        }
+        return mod[n].level >> 16;
+
+    default:
+        return 0;
+    }
+}
 
 void init_dacs(void) {
 	// setup daisy chain for two dacs
@@ -40,58 +249,153 @@ void reset_dacs(void) {
 		aout[i].now = 0;
 		aout[i].off = 0;
 		aout[i].target = 0;
-		aout[i].slew = 1;
-		aout[i].step = 1;
-		aout[i].delta = 0;
-		aout[i].a = 0;
+		aout[i].start = 0;
+		aout[i].slew_ms = 0;
+		aout[i].inc = DAC_SLEW_ONE;
+		aout[i].progress = DAC_SLEW_ONE;
+		aout[i].shape = kDacSlewLinear;
+		aout[i].sent = 0xffff;
 
 		is_slewing[i] = false;
+
+		mod[i].source = kDacModOff;
+		mod[i].stage = kEnvIdle;
+		mod[i].out = 0;
+		mod[i].phase = 0;
+		mod[i].level = 0;
+		random_seed(&mod[i].random, i + 1);
 	}
 
 	dac_timer_update();
 }
 
-void dac_set_value_noslew(uint8_t n, uint16_t v) {
-    aout[n].value = v;
+uint16_t dac_cal_apply(uint8_t n, uint16_t v) {
+    u8 i = ((u32)v * DAC_CAL_SEGMENTS) >> 14;
+    s32 t;
+
+    if (i >= DAC_CAL_SEGMENTS)
+        i = DAC_CAL_SEGMENTS - 1;
+
+    t = v + cal_seg[n][i].trim +
+        (((s32)(v - cal_x[i]) * cal_seg[n][i].slope) >> 16);
+    if (t < 0)
+        t = 0;
+    else if (t > DAC_10V)
+        t = DAC_10V;
+    return t;
+}
+
+// value plus offset, clamped and calibrated
+static u16 dac_target(uint8_t n, uint16_t v) {
 	int16_t t = v + aout[n].off;
     if (t < 0)
         t = 0;
     else if (t > 16383)
         t = 16383;
-    aout[n].target = t;
+    return dac_cal_apply(n, t);
+}
 
-    aout[n].step = 1;
-    aout[n].now = aout[n].target;
+void dac_set_value_noslew(uint8_t n, uint16_t v) {
+    aout[n].value = v;
+    aout[n].target = dac_target(n, v);
 
-    aout[n].a = aout[n].now << 16;
+    aout[n].progress = DAC_SLEW_ONE;
+    aout[n].now = aout[n].target;
 }
 
 void dac_set_value(uint8_t n, uint16_t v) {
     aout[n].value = v;
-	int16_t t = v + aout[n].off;
-    if (t < 0)
-        t = 0;
-    else if (t > 16383)
-        t = 16383;
-    aout[n].target = t;
-
-    aout[n].step = aout[n].slew;
-    aout[n].delta = ((aout[n].target - aout[n].now) << 16) / aout[n].step;
+    aout[n].target = dac_target(n, v);
 
-    aout[n].a = aout[n].now << 16;
+    // restart the curve from wherever the output is now
+    aout[n].start = aout[n].now;
+    aout[n].progress = 0;
 }
 
 void dac_set_slew(uint8_t n, uint16_t s) {
     aout[n].slew_ms = s;
-	aout[n].slew = s / DAC_RATE_CV;
-    if (aout[n].slew == 0)
-    	aout[n].slew = 1;
+    // keep the fraction of a dac tick rather than rounding slew to whole
+    // ticks; round up so a whole number of ticks doesn't overrun by one
+    if (s <= DAC_RATE_CV)
+        aout[n].inc = DAC_SLEW_ONE;
+    else
+        aout[n].inc = (((u32)DAC_RATE_CV << 24) + s - 1) / s;
+}
+
+void dac_set_slew_shape(uint8_t n, dac_slew_shape shape) {
+    if (shape < DAC_SLEW_SHAPE_COUNT)
+        aout[n].shape = shape;
 }
 
 void dac_set_off(uint8_t n, int16_t o) {
     aout[n].off = o;
 }
 
+void dac_set_cal(uint8_t n, const dac_cal_t *c) {
+    u8 i;
+
+    cal[n] = *c;
+    for (i = 0; i < DAC_CAL_SEGMENTS; i++) {
+        cal_seg[n][i].trim = c->trim[i];
+        cal_seg[n][i].slope =
+            ((s32)(c->trim[i + 1] - c->trim[i]) << 16) /
+            (cal_x[i + 1] - cal_x[i]);
+    }
+
+    // move a settled output straight onto its corrected value
+    aout[n].target = dac_target(n, aout[n].value);
+    if (aout[n].progress >= DAC_SLEW_ONE)
+        aout[n].now = aout[n].target;
+}
+
+void dac_set_mod_source(uint8_t n, dac_mod_source source) {
+    if (source >= DAC_MOD_SOURCE_COUNT)
+        return;
+    if (source == kDacModSine && !mod_sine_ready)
+        mod_sine_init();
+    if (source != mod[n].source) {
+        mod[n].level = 0;
+        mod[n].stage = kEnvIdle;
+    }
+    mod[n].source = source;
+    if (source == kDacModOff)
+        mod[n].out = 0;
+}
+
+void dac_set_mod_rate(uint8_t n, uint16_t ms) {
+    mod[n].rate_ms = ms;
+    // 2^32 is one cycle
+    if (ms <= DAC_RATE_CV)
+        mod[n].inc = 0x80000000;
+    else
+        mod[n].inc = (0xffffffff / ms) * DAC_RATE_CV;
+}
+
+void dac_set_mod_depth(uint8_t n, int16_t depth) {
+    mod[n].depth = depth;
+}
+
+void dac_set_mod_env(uint8_t n, uint16_t a, uint16_t d, uint16_t s, uint16_t r) {
+    if (s > DAC_MOD_FULL)
+        s = DAC_MOD_FULL;
+    mod[n].sustain = (s32)s << 16;
+    mod[n].attack = mod_env_rate(DAC_MOD_ENV_TOP, a);
+    mod[n].decay = mod_env_rate(DAC_MOD_ENV_TOP - mod[n].sustain, d);
+    mod[n].release = mod_env_rate(DAC_MOD_ENV_TOP, r);
+}
+
+void dac_mod_gate(uint8_t n, bool on) {
+    // retriggering attacks from the current level
+    if (on)
+        mod[n].stage = kEnvAttack;
+    else if (mod[n].stage != kEnvIdle)
+        mod[n].stage = kEnvRelease;
+}
+
+void dac_mod_sync(uint8_t n) {
+    mod[n].phase = 0;
+}
+
 uint16_t dac_get_value(uint8_t n) {
     return aout[n].value;
 }
@@ -100,61 +404,107 @@ uint16_t dac_get_slew(uint8_t n) {
     return aout[n].slew_ms;
 }
 
+dac_slew_shape dac_get_slew_shape(uint8_t n) {
+    return aout[n].shape;
+}
+
 uint16_t dac_get_off(uint8_t n) {
     return aout[n].off;
 }
 
+void dac_get_cal(uint8_t n, dac_cal_t *c) {
+    *c = cal[n];
+}
+
+dac_mod_source dac_get_mod_source(uint8_t n) {
+    return mod[n].source;
+}
+
+uint16_t dac_get_mod_rate(uint8_t n) {
+    return mod[n].rate_ms;
+}
+
+int16_t dac_get_mod_depth(uint8_t n) {
+    return mod[n].depth;
+}
+
+int16_t dac_get_mod(uint8_t n) {
+    return mod[n].out;
+}
+
 void dac_update_now(void) {
 	// update the dacs now
 	dac_timer_update();
 }
 
-void dac_timer_update(void) {
-    u8 i, r = 0;
-    u16 a;
+// send one frame; far is shifted through to the second dac in the chain
+static void dac_write_frame(u8 cmd, u8 far, u8 near) {
+    u16 a = aout[far].sent;
+    u16 b = aout[near].sent;
 
-    for (i = 0; i < 4; i++)
-        if (aout[i].step) {
-            aout[i].step--;
+    u8 irq_flags = irqs_pause();
 
-            is_slewing[i] = false;
+    spi_selectChip(DAC_SPI, DAC_SPI_NPCS);
+    spi_write(DAC_SPI, cmd);
+    spi_write(DAC_SPI, a >> 4);
+    spi_write(DAC_SPI, a << 4);
+    spi_write(DAC_SPI, cmd);
+    spi_write(DAC_SPI, b >> 4);
+    spi_write(DAC_SPI, b << 4);
+    spi_unselectChip(DAC_SPI, DAC_SPI_NPCS);
 
-            if (aout[i].step == 0) { aout[i].now = aout[i].target; }
+    irqs_resume(irq_flags);
+}
+
+void dac_timer_update(void) {
+    u8 i, dirty = 0;
+    u16 code;
+    s32 v;
+
+    for (i = 0; i < 4; i++) {
+        if (aout[i].progress < DAC_SLEW_ONE) {
+            aout[i].progress += aout[i].inc;
+
+            if (aout[i].progress >= DAC_SLEW_ONE) {
+                aout[i].progress = DAC_SLEW_ONE;
+                aout[i].now = aout[i].target;
+                is_slewing[i] = false;
+            }
             else {
-                aout[i].a += aout[i].delta;
-                aout[i].now = aout[i].a >> 16;
+                aout[i].now = aout[i].start +
+                    (((s32)(aout[i].target - aout[i].start) *
+                      (s32)slew_curve(aout[i].shape, aout[i].progress)) >> 16);
                 is_slewing[i] = true;
             }
+        }
+        else {
+            is_slewing[i] = false;
+        }
 
-            r++;
+        v = aout[i].now;
+        if (mod[i].source != kDacModOff) {
+            mod[i].out = (mod_step(i) * mod[i].depth) >> 15;
+            v += mod[i].out;
+            if (v < 0)
+                v = 0;
+            else if (v > DAC_10V)
+                v = DAC_10V;
         }
 
-    if (r) {
-        u8 irq_flags = irqs_pause();
-
-        spi_selectChip(DAC_SPI, DAC_SPI_NPCS);
-        spi_write(SPI, 0x31);
-        a = aout[2].now >> 2;
-        spi_write(SPI, a >> 4);
-        spi_write(SPI, a << 4);
-        spi_write(SPI, 0x31);
-        a = aout[0].now >> 2;
-        spi_write(SPI, a >> 4);
-        spi_write(SPI, a << 4);
-        spi_unselectChip(DAC_SPI, DAC_SPI_NPCS);
-
-        spi_selectChip(DAC_SPI, DAC_SPI_NPCS);
-        spi_write(SPI, 0x38);
-        a = aout[3].now >> 2;
-        spi_write(SPI, a >> 4);
-        spi_write(SPI, a << 4);
-        spi_write(SPI, 0x38);
-        a = aout[1].now >> 2;
-        spi_write(SPI, a >> 4);
-        spi_write(SPI, a << 4);
-        spi_unselectChip(DAC_SPI, DAC_SPI_NPCS);
-
-        irqs_resume(irq_flags);
+        // only outputs whose dac code actually moved need sending; slow slews
+        // spend several ticks on each code
+        code = v >> 2;
+        if (code != aout[i].sent) {
+            aout[i].sent = code;
+            dirty |= 1 << i;
+        }
+    }
+
+    if (dirty & DAC_FRAME_A) {
+        dac_write_frame(DAC_CMD_WRITE_A, 2, 0);
+    }
+    if (dirty & DAC_FRAME_B) {
+        dac_write_frame(DAC_CMD_WRITE_B, 3, 1);
     }
 }
 
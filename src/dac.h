@@ -6,17 +6,66 @@
 #define DAC_RATE_CV 3
 #define DAC_10V 16383
 
+typedef enum {
+    kDacSlewLinear,
+    kDacSlewExp,      // slow start, fast finish
+    kDacSlewLog,      // fast start, slow finish (RC / portamento)
+    kDacSlewSCurve,   // eased at both ends
+
+    DAC_SLEW_SHAPE_COUNT
+} dac_slew_shape;
+
+// per output calibration: the correction in dac values measured at each
+// volt from 0v to 10v, interpolated between volts and applied on top of the
+// offset whenever a value is set. all zeroes is uncalibrated.
+#define DAC_CAL_POINTS 11
+
+typedef struct {
+    int16_t trim[DAC_CAL_POINTS];
+} dac_cal_t;
+
+// modulation summed onto an output every dac tick, after slew. lfos run at
+// the mod rate and swing +/- depth; the envelope swings from 0 to depth.
+#define DAC_MOD_FULL 32767
+
+typedef enum {
+    kDacModOff,
+    kDacModSine,
+    kDacModTriangle,
+    kDacModSaw,
+    kDacModRandom,    // random walk, rate sets how far it wanders
+    kDacModEnv,       // adsr, driven by dac_mod_gate
+
+    DAC_MOD_SOURCE_COUNT
+} dac_mod_source;
+
 void init_dacs(void);
 void reset_dacs(void);
 
 void dac_set_value_noslew(uint8_t n, uint16_t v);
 void dac_set_value(uint8_t n, uint16_t v);
 void dac_set_slew(uint8_t n, uint16_t s);
+void dac_set_slew_shape(uint8_t n, dac_slew_shape shape);
 void dac_set_off(uint8_t n, int16_t o);
+void dac_set_cal(uint8_t n, const dac_cal_t *cal);
+void dac_set_mod_source(uint8_t n, dac_mod_source source);
+void dac_set_mod_rate(uint8_t n, uint16_t ms);
+void dac_set_mod_depth(uint8_t n, int16_t depth);
+// attack, decay and release in ms, sustain in [0-DAC_MOD_FULL]
+void dac_set_mod_env(uint8_t n, uint16_t a, uint16_t d, uint16_t s, uint16_t r);
+void dac_mod_gate(uint8_t n, bool on);
+void dac_mod_sync(uint8_t n);
 
 uint16_t dac_get_value(uint8_t n);
 uint16_t dac_get_slew(uint8_t n);
+dac_slew_shape dac_get_slew_shape(uint8_t n);
 uint16_t dac_get_off(uint8_t n);
+void dac_get_cal(uint8_t n, dac_cal_t *cal);
+uint16_t dac_cal_apply(uint8_t n, uint16_t v);
+dac_mod_source dac_get_mod_source(uint8_t n);
+uint16_t dac_get_mod_rate(uint8_t n);
+int16_t dac_get_mod_depth(uint8_t n);
+int16_t dac_get_mod(uint8_t n);
 
 void dac_update_now(void);
 void dac_timer_update(void);
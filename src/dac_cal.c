@@ -0,0 +1,55 @@
+#include "dac_cal.h"
+
+static json_read_object_state_t dac_cal_object_state;
+static json_read_array_state_t dac_cal_array_state[2];
+
+json_docdef_t dac_cal_docdef = {
+	.read = json_read_object,
+	.write = json_write_object,
+	.state = &dac_cal_object_state,
+	.params = &((json_read_object_params_t) {
+		.docdef_ct = 1,
+		.docdefs = ((json_docdef_t[]) {
+			{
+				.name = "channels",
+				.read = json_read_array,
+				.write = json_write_array,
+				.state = &dac_cal_array_state[0],
+				.params = &((json_read_array_params_t) {
+					.array_len = DAC_CAL_CHANNELS,
+					.item_size = sizeof_field(dac_cal_doc_t, channels[0]),
+					.item_docdef = &((json_docdef_t) {
+						.read = json_read_array,
+						.write = json_write_array,
+						.state = &dac_cal_array_state[1],
+						.params = &((json_read_array_params_t) {
+							.array_len = DAC_CAL_POINTS,
+							.item_size = sizeof_field(dac_cal_doc_t, channels[0].trim[0]),
+							.item_docdef = &((json_docdef_t) {
+								.read = json_read_scalar,
+								.write = json_write_number,
+								.params = &((json_read_scalar_params_t) {
+									.dst_size = sizeof_field(dac_cal_doc_t, channels[0].trim[0]),
+									.dst_offset = offsetof(dac_cal_doc_t, channels[0].trim[0]),
+									.signed_val = true,
+								}),
+							}),
+						}),
+					}),
+				}),
+			},
+		}),
+	}),
+};
+
+void dac_cal_store(dac_cal_doc_t *doc) {
+	for (uint8_t i = 0; i < DAC_CAL_CHANNELS; i++) {
+		dac_get_cal(i, &doc->channels[i]);
+	}
+}
+
+void dac_cal_load(const dac_cal_doc_t *doc) {
+	for (uint8_t i = 0; i < DAC_CAL_CHANNELS; i++) {
+		dac_set_cal(i, &doc->channels[i]);
+	}
+}
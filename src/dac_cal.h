@@ -0,0 +1,27 @@
+#ifndef _DAC_CAL_H_
+#define _DAC_CAL_H_
+
+#include "dac.h"
+#include "json/serdes.h"
+
+// calibration document for all four dac outputs, kept apart from app
+// presets so it survives firmware updates. serialized as
+//
+//   {"channels": [[0, 2, 5, ...], [...], [...], [...]]}
+//
+// one array of DAC_CAL_POINTS trims per output.
+
+#define DAC_CAL_CHANNELS 4
+
+typedef struct {
+    dac_cal_t channels[DAC_CAL_CHANNELS];
+} dac_cal_doc_t;
+
+extern json_docdef_t dac_cal_docdef;
+
+// copy the dacs' calibration into doc, e.g. before json_write
+void dac_cal_store(dac_cal_doc_t *doc);
+// apply doc to the dacs, e.g. after json_read
+void dac_cal_load(const dac_cal_doc_t *doc);
+
+#endif
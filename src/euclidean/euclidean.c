@@ -1,45 +1,95 @@
 #include "euclidean.h"
-#include "data.h"
-
-static const char* table_euclidean[32] = {
-    (const char*)table_euclidean_1,  (const char*)table_euclidean_2,
-    (const char*)table_euclidean_3,  (const char*)table_euclidean_4,
-    (const char*)table_euclidean_5,  (const char*)table_euclidean_6,
-    (const char*)table_euclidean_7,  (const char*)table_euclidean_8,
-    (const char*)table_euclidean_9,  (const char*)table_euclidean_10,
-    (const char*)table_euclidean_11, (const char*)table_euclidean_12,
-    (const char*)table_euclidean_13, (const char*)table_euclidean_14,
-    (const char*)table_euclidean_15, (const char*)table_euclidean_16,
-    (const char*)table_euclidean_17, (const char*)table_euclidean_18,
-    (const char*)table_euclidean_19, (const char*)table_euclidean_20,
-    (const char*)table_euclidean_21, (const char*)table_euclidean_22,
-    (const char*)table_euclidean_23, (const char*)table_euclidean_24,
-    (const char*)table_euclidean_25, (const char*)table_euclidean_26,
-    (const char*)table_euclidean_27, (const char*)table_euclidean_28,
-    (const char*)table_euclidean_29, (const char*)table_euclidean_30,
-    (const char*)table_euclidean_31, (const char*)table_euclidean_32
-};
-
-static char get_byte(const char* a, int n) {
-    return a[n / 8];
+
+// patterns are generated at runtime with the same fold as euclidean.hs, the
+// data.c tables it generates are kept only as a reference for the tests.
+//
+// the pattern under construction is always a run of p copies of subpattern a
+// followed by q copies of subpattern b. each fold pairs min(p, q) a's with
+// b's and the leftovers of whichever run was longer become the new b, until
+// 3 or fewer subpatterns remain or they are all the same.
+
+typedef struct {
+    u32 bits;  // step 0 in bit 0
+    int len;
+} subpattern_t;
+
+static u32 euclidean_build(int fill, int len) {
+    subpattern_t a = { 1, 1 };
+    subpattern_t b = { 0, 1 };
+    subpattern_t r;
+    int p = fill;
+    int q = len - fill;
+    int m, i, pos;
+    u32 mask;
+
+    while (p + q > 3 && p > 0 && q > 0) {
+        m = p < q ? p : q;
+        r = p > q ? a : b;
+        a.bits |= b.bits << a.len;
+        a.len += b.len;
+        b = r;
+        q = p > q ? p - q : q - p;
+        p = m;
+    }
+
+    mask = 0;
+    pos = 0;
+    for (i = 0; i < p; i++) {
+        mask |= a.bits << pos;
+        pos += a.len;
+    }
+    for (i = 0; i < q && pos < 32; i++) {
+        mask |= b.bits << pos;
+        pos += b.len;
+    }
+
+    return mask;
 }
 
-static int get_bit(const char* a, int k) {
-    char byte = get_byte(a, k);
-    int bit_index = 7 - (k % 8);
-    return (byte & (1 << bit_index)) != 0;
+u32 euclidean_mask(int fill, int len, int rotation) {
+    u32 mask, all;
+    int r;
+
+    if (len < 1 || len > EUCLIDEAN_LEN_MAX) return 0;
+    if (fill < 1 || fill > len) return 0;
+
+    mask = euclidean_build(fill, len);
+
+    // rotate within len bits, s.t. bit n is step n - rotation of the pattern
+    r = rotation % len;
+    if (r < 0) r += len;
+    if (r == 0) return mask;
+
+    all = len == 32 ? 0xffffffff : ((u32)1 << len) - 1;
+    return ((mask << r) | (mask >> (len - r))) & all;
 }
 
+// the last pattern euclidean() built, so stepping through one pattern a
+// step at a time only folds it once. the key is cleared while the mask
+// is replaced and read on both sides of the mask, so a query from an
+// interrupt in between can't pair a key with another pattern's mask
+static volatile u16 cache_key;
+static volatile u32 cache_mask;
+
 int euclidean(int fill, int len, int step) {
-    if (len < 1 || len > 32) return 0;
+    u16 key;
+    u32 mask;
+
+    if (len < 1 || len > EUCLIDEAN_LEN_MAX) return 0;
     if (fill < 1 || fill > len) return 0;
 
-    const char* len_table = table_euclidean[len - 1];
-    int entry_size = len / 8;
-    if (len % 8 > 0) entry_size++;
-    const char* table = &len_table[fill * entry_size];
     // adjust step, s.t. 0 <= step < len
     int remainder = step % len;
     int modulo = remainder < 0 ? remainder + len : remainder;
-    return get_bit(table, modulo);
+
+    key = (fill << 6) | len;
+    if (cache_key == key) {
+        mask = cache_mask;
+        if (cache_key == key) return euclidean_mask_step(mask, modulo);
+    }
+    mask = euclidean_build(fill, len);
+    cache_key = 0;
+    cache_mask = mask;
+    cache_key = key;
+    return euclidean_mask_step(mask, modulo);
 }
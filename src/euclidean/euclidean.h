@@ -1,6 +1,19 @@
 #ifndef _EUCLIDEAN_H_
 #define _EUCLIDEAN_H_
 
+#include "types.h"
+
+#define EUCLIDEAN_LEN_MAX 32
+
+// whole pattern for (fill, len), rotated by rotation steps, as a bit mask
+// with step n in bit n. 0 if fill or len are out of range.
+extern u32 euclidean_mask(int fill, int len, int rotation);
+
+// single step query against a mask from euclidean_mask; step in [0, len)
+static inline int euclidean_mask_step(u32 mask, int step) {
+    return (mask >> step) & 1;
+}
+
 extern int euclidean(int fill, int len, int step);
 
 #endif
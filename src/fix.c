@@ -3,199 +3,139 @@
  * aleph
  *
  * additional routines for converting/printing fixed-point datatypes
- 
- FIXME: the integer-conversion routines could use optimization.
- specifically, avoid modulus and refactor to use half as many divides.
 
-here is a good blog post on the topic:
+ integers are converted two digits at a time from a pair table, dividing
+ by a constant 100 (which the compiler turns into a reciprocal multiply)
+ rather than taking a modulus per digit. everything writes straight into
+ the caller's buffer, so these are safe to call from any context.
 
-http://embeddedgurus.com/stack-overflow/2011/02/efficient-c-tip-13-use-the-modulus-operator-with-caution/
- 
  */
 
 #include "print_funcs.h"
 
 #include "fix.h"
 
-//// comon temp variables
-static unsigned int a, u;
-static unsigned long int sign;
-
-// fixme: shouldn't really need these
-static char bufHi[FIX_DIG_HI] = "     ";
-static char bufLo[FIX_DIG_LO] = "     ";
+// max decimal digits in a u32
+#define FIX_DIG_U32 10
+
+// "00" to "99"
+static const char digit_pairs[200] = {
+  '0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8','0','9',
+  '1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7','1','8','1','9',
+  '2','0','2','1','2','2','2','3','2','4','2','5','2','6','2','7','2','8','2','9',
+  '3','0','3','1','3','2','3','3','3','4','3','5','3','6','3','7','3','8','3','9',
+  '4','0','4','1','4','2','4','3','4','4','4','5','4','6','4','7','4','8','4','9',
+  '5','0','5','1','5','2','5','3','5','4','5','5','5','6','5','7','5','8','5','9',
+  '6','0','6','1','6','2','6','3','6','4','6','5','6','6','6','7','6','8','6','9',
+  '7','0','7','1','7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9',
+  '8','0','8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9',
+  '9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8','9','9',
+};
 
 // for fractional part of 16.16
 static const unsigned int places[FIX_DIG_LO] = {
   6553, 655, 65, 7, 1
 };
 
+// write the digits of u so that they end just before end, return the first
+static char* utoa_rev(u32 u, char* end) {
+  u32 q, r;
+
+  while (u >= 100) {
+    q = u / 100;
+    r = (u - q * 100) << 1;
+    u = q;
+    *--end = digit_pairs[r + 1];
+    *--end = digit_pairs[r];
+  }
+  if (u >= 10) {
+    r = u << 1;
+    *--end = digit_pairs[r + 1];
+    *--end = digit_pairs[r];
+  } else {
+    *--end = '0' + u;
+  }
+  return end;
+}
+
 // print 16.16
 void print_fix16(char* buf , fix16_t x) {
-  static char * p;
-  // char sign;
-  int y, i;
-  sign = BIT_SIGN_32(x);
-  p = buf;
-
-  if(sign == 0)  {
-    // whole
-    y = x >> 16;
-    itoa_whole(y, bufHi, FIX_DIG_HI);
-    // fract
-    y = x & 0xffff;
-    itoa_fract(y, bufLo);
-    *p = ' ';
-    p++;
+  int i;
+
+  *buf = ' ';
+  if (BIT_SIGN_32(x) == 0) {
+    itoa_whole(x >> 16, buf + 1, FIX_DIG_HI);
+    itoa_fract(x & 0xffff, buf + 2 + FIX_DIG_HI);
   } else {
-    // whole
-    y = ( ( (x >> 16) ^ 0xffff ) & 0xffff );
-    itoa_whole(y, bufHi, FIX_DIG_HI);
-    // fract
-    y = (x ^ 0xffff) & 0xffff;
-    itoa_fract(y, bufLo);
-    // search for the negative sign
-    *p = ' ';
-    i = FIX_DIG_HI;
-    while(--i>0) {
-      if(bufHi[i] == ' ') {
-	bufHi[i] = '-';
-	break;
-      }
-      if(i == 1) {
-	*p = '-';
+    itoa_whole(((x >> 16) ^ 0xffff) & 0xffff, buf + 1, FIX_DIG_HI);
+    itoa_fract((x ^ 0xffff) & 0xffff, buf + 2 + FIX_DIG_HI);
+    // put the sign just before the digits, or in front if they're full
+    for (i = FIX_DIG_HI - 1; i > 0; i--) {
+      if (buf[1 + i] == ' ') {
+        buf[1 + i] = '-';
+        break;
       }
     }
-    p++;
-  } 
-  // fixme: shouldn't need to copy if pointers are set up correctly
-  i = 0;
-
-  while (i < FIX_DIG_HI) {
-    if(bufHi[i]) {
-      *p = bufHi[i];
-    } else {
-      *p = ' ';
+    if (i == 0) {
+      *buf = '-';
     }
-    i++; p++;
-  } 
-  *p = '.'; p++;
-  i = 0;
-  while (i < FIX_DIG_LO) {
-    *p = bufLo[i] ? bufLo[i] : ' '; 
-    i++; p++;
   }
+  buf[1 + FIX_DIG_HI] = '.';
 }
+
 // format whole part, right justified
 void itoa_whole(int val, char* buf, int len) {
-  static char* p;
-
-  //  print_dbg("\r\n printing integer, val: 0x");
-  //  print_dbg_hex(val);
-
-  p = buf + len - 1; // right justify; start at end
-  if(val == 0) {
-    *p = '0'; p--;
-    while(p >= buf) {
-      *p = ' ';
-      p--;
-    }
-    return;
+  char* p = buf + len;
+  u32 sign = BIT_SIGN_32(val);
+  u32 u = sign ? (u32)BIT_INVERT_32(val) : (u32)val;
+  u32 q, r;
+
+  // least significant digits first, dropping any that don't fit
+  while (u >= 10 && p - buf >= 2) {
+    q = u / 100;
+    r = (u - q * 100) << 1;
+    u = q;
+    *--p = digit_pairs[r + 1];
+    *--p = digit_pairs[r];
   }
-  sign = BIT_SIGN_32(val);
-
-  if ( sign ) {
-    len--;
-    val = BIT_INVERT_32(val);
-    //    print_dbg("\r\n printing negative integer, val after bitinvert: 0x");
-    //    print_dbg_hex(val);
+  if ((u > 0 || p == buf + len) && p > buf) {
+    *--p = '0' + u % 10;
   }
-  u = (unsigned int)val;
-  //// FIXME: pretty slow
-  while(p >= buf) {
-    if (u > 0) {
-      a = u % 10;
-      u /= 10;
-      *p = '0' + a;
-    } else {
-      *p = ' '; 
-    }
-    p--;
-
+  while (p > buf) {
+    *--p = ' ';
   }
-  if(sign) { *buf = '-'; }
+  if (sign && len > 0) { *buf = '-'; }
 }
 
-void itoa_fract(int val, char* buf) {  
-  static char* p;
+// format fractional part of 16.16, fixed length
+void itoa_fract(int val, char* buf) {
+  unsigned int u = (unsigned int)val;
+  unsigned int a;
   int i;
-  unsigned int mul;
-
-  p = buf;
-  u = (unsigned int)val;
-  
-  for(i=0; i<FIX_DIG_LO; i++) {
-    mul = places[i];
-    a = (u / mul);
+
+  for (i = 0; i < FIX_DIG_LO; i++) {
+    a = u / places[i];
     if (a > 9) { a = 9; }
-    u -= (mul * a);
-    *p++ = a + '0';
-  } 
+    u -= places[i] * a;
+    buf[i] = a + '0';
+  }
 }
 
-
-
-/////////
-/////////////
-/// FIXME
-#if 1
-// format whole part, left justified, no length argument (!)
+// format whole part, left justified, return length
 int itoa_whole_lj(int val, char* buf) {
-  static char* p;
-  char tmp;
-  int i;
+  char tmp[FIX_DIG_U32];
+  char* end = tmp + FIX_DIG_U32;
+  char* d;
   int len = 0;
-  
-  if(val == 0) {
-    *buf = '0';
-    return 1;
-  }
 
-  sign = BIT_SIGN_32(val);
-  p = buf;
-
-  if ( sign ) {
-    *p = '-';
-    ++p;
-    ++len;
-    val = BIT_INVERT_32(val) + 1; // FIXME: this will wrap at 0xffffffff
-  }
-
-  u = (unsigned int)val;
-
-  while (u > 0) {
-    a = u % 10;
-    u /= 10;
-    *p = '0' + a;
-    ++p;
-    ++len;
-  }
-  
-  //// FIXME
-  /// ugh, swap digits
-  if(sign) {
-    for (i=1; i<len; i++) {
-      tmp = buf[i];
-      buf[i] = buf[len - i];
-      buf[len - i + 1] = tmp;
-    }
+  if (BIT_SIGN_32(val)) {
+    buf[len++] = '-';
+    d = utoa_rev((u32)BIT_INVERT_32(val), end);
   } else {
-    for (i=0; i<(len >>1); i++) {
-      tmp = *(buf + i);
-      *(buf + i) = *(buf + len - i - 1);
-      *(buf + len - i - 1) = tmp;
-    }
+    d = utoa_rev((u32)val, end);
+  }
+  while (d < end) {
+    buf[len++] = *d++;
   }
   return len;
 }
-#endif
@@ -46,11 +46,13 @@
 #define FIX16_FRACT(x) FIX16_FRACT_TRUNC(x)
 #define FRACT_FIX16(x) ( BIT_SIGN_16(x) ? ((x)>>15) | 0xffff0000 : (x)>>15 )
 
-// print to a buffer
+// these write only into buf and don't null terminate
+
+// print to a buffer, FIX_DIG_TOTAL + 1 chars
 extern void print_fix16(char* buf , fix16_t x);
 // whole-part integer to ascii, right-justified, fixed-length
 extern void itoa_whole(int val, char* buf, int len);
-// whole-part integer to ascii, lef_justfied, return length
+// whole-part integer to ascii, left-justified (up to 11 chars), return length
 extern int itoa_whole_lj(int val, char* buf);
 
 // fractional part to ascii, fixed length
@@ -0,0 +1,569 @@
+#include "json/binary.h"
+
+#include "print_funcs.h"
+
+typedef enum {
+	KIND_UNKNOWN,
+	KIND_OBJECT,
+	KIND_CACHED,
+	KIND_ARRAY,
+	KIND_SCALAR,
+	KIND_ENUM,
+	KIND_BYTES,
+	KIND_MATCH,
+} value_kind_t;
+
+// the docdef's read callback says what it holds
+static value_kind_t docdef_kind(json_docdef_t* docdef) {
+	if (docdef->read == json_read_object) return KIND_OBJECT;
+	if (docdef->read == json_read_object_cached) return KIND_CACHED;
+	if (docdef->read == json_read_array) return KIND_ARRAY;
+	if (docdef->read == json_read_scalar) return KIND_SCALAR;
+	if (docdef->read == json_read_enum) return KIND_ENUM;
+	if (docdef->read == json_read_buffer) return KIND_BYTES;
+	if (docdef->read == json_read_string) return KIND_BYTES;
+	if (docdef->read == json_match_string) return KIND_MATCH;
+	return KIND_UNKNOWN;
+}
+
+uint32_t json_binary_key_id(const char* name) {
+	// FNV-1a, xor-folded
+	uint32_t h = 2166136261u;
+	while (*name) {
+		h = (h ^ (uint8_t)*name++) * 16777619u;
+	}
+	return (h ^ (h >> JSON_BINARY_KEY_BITS)) & ((1u << JSON_BINARY_KEY_BITS) - 1);
+}
+
+static uint32_t zigzag(int32_t v) {
+	return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static int32_t unzigzag(uint32_t v) {
+	return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+static size_t varint_len(uint32_t v) {
+	size_t len = 1;
+	while (v >= 0x80) {
+		v >>= 7;
+		len++;
+	}
+	return len;
+}
+
+static void put_varint(json_puts_cb write, uint32_t v) {
+	char buf[5];
+	size_t len = 0;
+	while (v >= 0x80) {
+		buf[len++] = (v & 0x7f) | 0x80;
+		v >>= 7;
+	}
+	buf[len++] = v;
+	write(buf, len);
+}
+
+bool json_binary_check_keys(json_docdef_t* docdef) {
+	switch (docdef_kind(docdef)) {
+	case KIND_ARRAY:
+		return json_binary_check_keys(((json_read_array_params_t*)docdef->params)->item_docdef);
+	case KIND_OBJECT:
+	case KIND_CACHED: {
+		json_read_object_params_t* params = (json_read_object_params_t*)docdef->params;
+		for (uint8_t i = 0; i < params->docdef_ct; i++) {
+			uint32_t id = json_binary_key_id(params->docdefs[i].name);
+			for (uint8_t j = i + 1; j < params->docdef_ct; j++) {
+				if (json_binary_key_id(params->docdefs[j].name) == id) {
+					print_dbg("\r\n!! binary key id collision: ");
+					print_dbg(params->docdefs[j].name);
+					return false;
+				}
+			}
+			if (!json_binary_check_keys(&params->docdefs[i])) {
+				return false;
+			}
+		}
+		return true;
+	}
+	default:
+		return true;
+	}
+}
+
+
+//// writing
+
+// the scalar as it goes on the wire; false for a size we can't handle
+static bool scalar_wire_value(json_read_scalar_params_t* params,
+			      void* ram, size_t src_offset, uint32_t* v) {
+	void* src = (uint8_t*)ram + src_offset + params->dst_offset;
+	switch (params->dst_size) {
+	case 4:
+		*v = params->signed_val ? zigzag(*(int32_t*)src) : *(uint32_t*)src;
+		return true;
+	case 2:
+		*v = params->signed_val ? zigzag(*(int16_t*)src) : *(uint16_t*)src;
+		return true;
+	case 1:
+		*v = params->signed_val ? zigzag(*(int8_t*)src) : *(uint8_t*)src;
+		return true;
+	default:
+		return false;
+	}
+}
+
+static uint32_t enum_wire_value(json_read_enum_params_t* params,
+				void* ram, size_t src_offset) {
+	int src = *(int*)((uint8_t*)ram + src_offset + params->dst_offset);
+	if (src < 0 || src >= params->option_ct) {
+		src = params->default_val;
+	}
+	return zigzag(src);
+}
+
+static bool written(json_docdef_t* docdef) {
+	return !docdef->skip && docdef_kind(docdef) != KIND_UNKNOWN;
+}
+
+// container sizes in the order write_value reaches them
+static size_t sizes[JSON_BINARY_SIZES_MAX];
+static size_t sizes_ct, sizes_pos;
+
+// encoded size of a value, without its tag and length. containers take
+// the next free slot before their contents, so the slots end up in the
+// order they're written
+static size_t value_size(json_docdef_t* docdef, void* ram, size_t src_offset) {
+	size_t slot = JSON_BINARY_SIZES_MAX;
+
+	switch (docdef_kind(docdef)) {
+	case KIND_OBJECT:
+	case KIND_CACHED: {
+		json_read_object_params_t* params = (json_read_object_params_t*)docdef->params;
+		size_t size = 0;
+		if (sizes_ct < JSON_BINARY_SIZES_MAX) {
+			slot = sizes_ct++;
+		}
+		for (uint8_t i = 0; i < params->docdef_ct; i++) {
+			json_docdef_t* child = &params->docdefs[i];
+			if (!written(child)) {
+				continue;
+			}
+			size_t child_size = value_size(child, ram, src_offset);
+			size += varint_len(json_binary_key_id(child->name))
+				+ varint_len(child_size) + child_size;
+		}
+		if (slot < JSON_BINARY_SIZES_MAX) {
+			sizes[slot] = size;
+		}
+		return size;
+	}
+	case KIND_ARRAY: {
+		json_read_array_params_t* params = (json_read_array_params_t*)docdef->params;
+		size_t size = 0;
+		if (sizes_ct < JSON_BINARY_SIZES_MAX) {
+			slot = sizes_ct++;
+		}
+		for (size_t i = 0; i < params->array_len; i++) {
+			size_t item_size = value_size(params->item_docdef, ram,
+						      src_offset + params->item_size * i);
+			size += varint_len(item_size) + item_size;
+		}
+		if (slot < JSON_BINARY_SIZES_MAX) {
+			sizes[slot] = size;
+		}
+		return size;
+	}
+	case KIND_SCALAR: {
+		uint32_t v = 0;
+		scalar_wire_value(docdef->params, ram, src_offset, &v);
+		return varint_len(v);
+	}
+	case KIND_ENUM:
+		return varint_len(enum_wire_value(docdef->params, ram, src_offset));
+	case KIND_BYTES:
+		return ((json_read_buffer_params_t*)docdef->params)->dst_size;
+	case KIND_MATCH:
+		return strlen(((json_match_string_params_t*)docdef->params)->to_match);
+	default:
+		return 0;
+	}
+}
+
+// a container's size from the measuring pass, once there are no more
+// slots whatever is left is measured again
+static size_t written_size(json_docdef_t* docdef, void* ram, size_t src_offset) {
+	switch (docdef_kind(docdef)) {
+	case KIND_OBJECT:
+	case KIND_CACHED:
+	case KIND_ARRAY:
+		if (sizes_pos < sizes_ct) {
+			return sizes[sizes_pos++];
+		}
+		return value_size(docdef, ram, src_offset);
+	default:
+		return value_size(docdef, ram, src_offset);
+	}
+}
+
+static json_write_result_t write_value(json_puts_cb write,
+				       json_docdef_t* docdef,
+				       void* ram, size_t src_offset) {
+	switch (docdef_kind(docdef)) {
+	case KIND_OBJECT:
+	case KIND_CACHED: {
+		json_read_object_params_t* params = (json_read_object_params_t*)docdef->params;
+		for (uint8_t i = 0; i < params->docdef_ct; i++) {
+			json_docdef_t* child = &params->docdefs[i];
+			if (!written(child)) {
+				continue;
+			}
+			put_varint(write, json_binary_key_id(child->name));
+			put_varint(write, written_size(child, ram, src_offset));
+			if (write_value(write, child, ram, src_offset) != JSON_WRITE_OK) {
+				return JSON_WRITE_ERROR;
+			}
+		}
+		return JSON_WRITE_OK;
+	}
+	case KIND_ARRAY: {
+		json_read_array_params_t* params = (json_read_array_params_t*)docdef->params;
+		for (size_t i = 0; i < params->array_len; i++) {
+			size_t item_offset = src_offset + params->item_size * i;
+			put_varint(write, written_size(params->item_docdef, ram, item_offset));
+			if (write_value(write, params->item_docdef, ram, item_offset) != JSON_WRITE_OK) {
+				return JSON_WRITE_ERROR;
+			}
+		}
+		return JSON_WRITE_OK;
+	}
+	case KIND_SCALAR: {
+		uint32_t v;
+		if (!scalar_wire_value(docdef->params, ram, src_offset, &v)) {
+			return JSON_WRITE_ERROR;
+		}
+		put_varint(write, v);
+		return JSON_WRITE_OK;
+	}
+	case KIND_ENUM:
+		put_varint(write, enum_wire_value(docdef->params, ram, src_offset));
+		return JSON_WRITE_OK;
+	case KIND_BYTES: {
+		json_read_buffer_params_t* params = (json_read_buffer_params_t*)docdef->params;
+		write((char*)ram + src_offset + params->dst_offset, params->dst_size);
+		return JSON_WRITE_OK;
+	}
+	case KIND_MATCH: {
+		json_match_string_params_t* params = (json_match_string_params_t*)docdef->params;
+		write(params->to_match, strlen(params->to_match));
+		return JSON_WRITE_OK;
+	}
+	default:
+		return JSON_WRITE_OK;
+	}
+}
+
+json_write_result_t json_write_binary(json_puts_cb write,
+				      void* ram, json_docdef_t* docdef) {
+	sizes_ct = 0;
+	value_size(docdef, ram, 0);
+
+	write(JSON_BINARY_MAGIC, JSON_BINARY_MAGIC_LEN);
+	sizes_pos = 0;
+	put_varint(write, written_size(docdef, ram, 0));
+	return write_value(write, docdef, ram, 0);
+}
+
+
+//// reading
+
+typedef struct {
+	json_gets_cb read;
+	uint8_t* buf;
+	size_t buf_len;
+	size_t pos;
+	size_t end;
+	// bytes taken from the stream so far, for checking value lengths
+	size_t consumed;
+} binary_reader_t;
+
+static bool fill(binary_reader_t* r) {
+	if (r->pos == r->end) {
+		r->pos = 0;
+		r->end = r->read((char*)r->buf, r->buf_len);
+		if (r->end == 0) {
+			print_dbg("\r\n!! unexpected end of binary preset");
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool get_varint(binary_reader_t* r, uint32_t* v) {
+	uint8_t shift = 0, b;
+	*v = 0;
+	do {
+		if (shift > 28 || !fill(r)) {
+			return false;
+		}
+		b = r->buf[r->pos++];
+		r->consumed++;
+		*v |= (uint32_t)(b & 0x7f) << shift;
+		shift += 7;
+	} while (b & 0x80);
+	return true;
+}
+
+// copy len bytes to dst, or drop them if dst is NULL
+static bool get_bytes(binary_reader_t* r, json_copy_cb copy, char* dst, size_t len) {
+	while (len > 0) {
+		if (!fill(r)) {
+			return false;
+		}
+		size_t n = r->end - r->pos;
+		if (n > len) {
+			n = len;
+		}
+		if (dst != NULL) {
+			copy(dst, (char*)r->buf + r->pos, n);
+			dst += n;
+		}
+		r->pos += n;
+		r->consumed += n;
+		len -= n;
+	}
+	return true;
+}
+
+static bool match_bytes(binary_reader_t* r, const char* s, size_t len) {
+	bool match = true;
+	while (len > 0) {
+		if (!fill(r)) {
+			return false;
+		}
+		if (r->buf[r->pos++] != (uint8_t)*s++) {
+			match = false;
+		}
+		r->consumed++;
+		len--;
+	}
+	return match;
+}
+
+static void copy_memory(char* dst, const char* src, size_t len) {
+	memcpy(dst, src, len);
+}
+
+static json_read_result_t read_value(binary_reader_t* r, json_docdef_t* docdef,
+				     json_copy_cb copy, void* ram, int32_t dst_offset,
+				     size_t len);
+
+static json_read_result_t read_fields(binary_reader_t* r, json_read_object_params_t* params,
+				      json_copy_cb copy, void* ram, int32_t dst_offset,
+				      size_t len) {
+	size_t end = r->consumed + len;
+	uint8_t next = 0;
+	uint32_t id, field_len;
+
+	while (r->consumed < end) {
+		if (!get_varint(r, &id) || !get_varint(r, &field_len)
+		 || r->consumed + field_len > end) {
+			return JSON_READ_MALFORMED;
+		}
+
+		// fields usually arrive in docdef order, so try the one after the
+		// last match before hashing the rest
+		json_docdef_t* match = NULL;
+		for (uint8_t n = 0; n < params->docdef_ct; n++) {
+			uint8_t i = (next + n) % params->docdef_ct;
+			json_docdef_t* child = &params->docdefs[i];
+			if (!child->skip && json_binary_key_id(child->name) == id) {
+				match = child;
+				next = i + 1;
+				break;
+			}
+		}
+
+		size_t field_end = r->consumed + field_len;
+		if (match != NULL) {
+			if (read_value(r, match, copy, ram, dst_offset, field_len) != JSON_READ_OK) {
+				print_dbg("\r\n!! bad binary property value: ");
+				print_dbg(match->name);
+				return JSON_READ_MALFORMED;
+			}
+		}
+		if (r->consumed > field_end
+		 || !get_bytes(r, copy, NULL, field_end - r->consumed)) {
+			return JSON_READ_MALFORMED;
+		}
+	}
+	return JSON_READ_OK;
+}
+
+static json_read_result_t read_value(binary_reader_t* r, json_docdef_t* docdef,
+				     json_copy_cb copy, void* ram, int32_t dst_offset,
+				     size_t len) {
+	switch (docdef_kind(docdef)) {
+	case KIND_OBJECT:
+		return read_fields(r, docdef->params, copy, ram, dst_offset, len);
+	case KIND_CACHED: {
+		// as json_read_object_cached: into a cache, copied out only once
+		// the whole object has been read
+		json_read_object_params_t* params = (json_read_object_params_t*)docdef->params;
+		void* cache = params->alloc(params->dst_size);
+		if (cache == NULL) {
+			print_dbg("\r\n!! allocation failed");
+			return JSON_READ_MALFORMED;
+		}
+		copy_memory(cache, (char*)ram + params->dst_offset + dst_offset, params->dst_size);
+		json_read_result_t result = read_fields(r, params, copy_memory, cache,
+							-params->dst_offset, len);
+		if (result == JSON_READ_OK) {
+			copy((char*)ram + params->dst_offset + dst_offset, cache, params->dst_size);
+		}
+		params->free(cache);
+		return result;
+	}
+	case KIND_ARRAY: {
+		json_read_array_params_t* params = (json_read_array_params_t*)docdef->params;
+		size_t end = r->consumed + len;
+		uint32_t item_len;
+		for (size_t i = 0; r->consumed < end; i++) {
+			if (!get_varint(r, &item_len) || r->consumed + item_len > end) {
+				return JSON_READ_MALFORMED;
+			}
+			// extra items are dropped, as the JSON reader does
+			if (i >= params->array_len) {
+				if (!get_bytes(r, copy, NULL, item_len)) {
+					return JSON_READ_MALFORMED;
+				}
+				continue;
+			}
+			size_t item_end = r->consumed + item_len;
+			if (read_value(r, params->item_docdef, copy, ram,
+				       dst_offset + i * params->item_size, item_len) != JSON_READ_OK
+			 || r->consumed > item_end
+			 || !get_bytes(r, copy, NULL, item_end - r->consumed)) {
+				return JSON_READ_MALFORMED;
+			}
+		}
+		return JSON_READ_OK;
+	}
+	case KIND_SCALAR: {
+		json_read_scalar_params_t* params = (json_read_scalar_params_t*)docdef->params;
+		char* dst = (char*)ram + params->dst_offset + dst_offset;
+		uint32_t v;
+		if (!get_varint(r, &v)) {
+			return JSON_READ_MALFORMED;
+		}
+		if (params->signed_val) {
+			v = unzigzag(v);
+		}
+		switch (params->dst_size) {
+		case sizeof(uint8_t): {
+			uint8_t src = v;
+			copy(dst, (char*)&src, sizeof(uint8_t));
+			return JSON_READ_OK;
+		}
+		case sizeof(uint16_t): {
+			uint16_t src = v;
+			copy(dst, (char*)&src, sizeof(uint16_t));
+			return JSON_READ_OK;
+		}
+		case sizeof(uint32_t):
+			copy(dst, (char*)&v, sizeof(uint32_t));
+			return JSON_READ_OK;
+		default:
+			return JSON_READ_MALFORMED;
+		}
+	}
+	case KIND_ENUM: {
+		json_read_enum_params_t* params = (json_read_enum_params_t*)docdef->params;
+		uint32_t v;
+		if (!get_varint(r, &v)) {
+			return JSON_READ_MALFORMED;
+		}
+		int val = unzigzag(v);
+		if (val < 0 || val >= params->option_ct) {
+			val = params->default_val;
+		}
+		copy((char*)ram + params->dst_offset + dst_offset, (char*)&val, sizeof(int));
+		return JSON_READ_OK;
+	}
+	case KIND_BYTES: {
+		json_read_buffer_params_t* params = (json_read_buffer_params_t*)docdef->params;
+		if (len != params->dst_size) {
+			print_dbg("\r\n!! bad binary buffer len: ");
+			print_dbg_hex(len);
+			return JSON_READ_MALFORMED;
+		}
+		return get_bytes(r, copy, (char*)ram + params->dst_offset + dst_offset, len)
+			? JSON_READ_OK : JSON_READ_MALFORMED;
+	}
+	case KIND_MATCH: {
+		json_match_string_params_t* params = (json_match_string_params_t*)docdef->params;
+		if (params->skip) {
+			return get_bytes(r, copy, NULL, len) ? JSON_READ_OK : JSON_READ_MALFORMED;
+		}
+		if (len != strlen(params->to_match) || !match_bytes(r, params->to_match, len)) {
+			print_dbg("\r\n!! incorrect string match: ");
+			print_dbg(params->to_match);
+			return JSON_READ_MALFORMED;
+		}
+		return JSON_READ_OK;
+	}
+	default:
+		return get_bytes(r, copy, NULL, len) ? JSON_READ_OK : JSON_READ_MALFORMED;
+	}
+}
+
+json_read_result_t json_read_binary(json_gets_cb read, json_copy_cb copy,
+				    void* ram, json_docdef_t* docdef,
+				    uint8_t* buf, size_t buf_len) {
+	binary_reader_t r = {
+		.read = read,
+		.buf = buf,
+		.buf_len = buf_len,
+	};
+	uint32_t len;
+
+	if (!match_bytes(&r, JSON_BINARY_MAGIC, JSON_BINARY_MAGIC_LEN)) {
+		print_dbg("\r\n!! not a binary preset");
+		return JSON_READ_MALFORMED;
+	}
+	if (!get_varint(&r, &len)) {
+		return JSON_READ_MALFORMED;
+	}
+	return read_value(&r, docdef, copy, ram, 0, len);
+}
+
+
+//// conversion
+
+json_read_result_t json_convert_to_binary(json_gets_cb read, json_puts_cb write,
+					  void* ram, json_docdef_t* docdef,
+					  char* textbuf, size_t textbuf_len,
+					  jsmntok_t* tokbuf, size_t tokbuf_len) {
+	json_read_result_t result = json_read(read, copy_memory, ram, docdef,
+					      textbuf, textbuf_len, tokbuf, tokbuf_len);
+	if (result != JSON_READ_OK) {
+		return result;
+	}
+	if (json_write_binary(write, ram, docdef) != JSON_WRITE_OK) {
+		return JSON_READ_MALFORMED;
+	}
+	return JSON_READ_OK;
+}
+
+json_read_result_t json_convert_to_json(json_gets_cb read, json_puts_cb write,
+					void* ram, json_docdef_t* docdef,
+					uint8_t* buf, size_t buf_len) {
+	json_read_result_t result = json_read_binary(read, copy_memory, ram, docdef,
+						     buf, buf_len);
+	if (result != JSON_READ_OK) {
+		return result;
+	}
+	if (json_write(write, ram, docdef) != JSON_WRITE_OK) {
+		return JSON_READ_MALFORMED;
+	}
+	return JSON_READ_OK;
+}
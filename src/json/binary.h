@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "json/serdes.h"
+
+// A compact binary form of the documents json_read/json_write handle,
+// walking the same docdef trees. After a 4 byte header every value is
+// tag-length-value:
+//
+//   object: { key id varint, length varint, value }...
+//   array:  { length varint, value }...
+//   number: varint, zigzagged when signed; bools are 0 or 1
+//   enum:   zigzag varint of the option index
+//   buffer, string: the raw bytes
+//
+// Key ids are a hash of the docdef name, so a reader skips keys it
+// doesn't know and leaves missing ones alone, the same way the JSON
+// reader does. Renaming a key or reordering enum options breaks
+// compatibility, as it would for JSON.
+
+#define JSON_BINARY_MAGIC "DDB1"
+#define JSON_BINARY_MAGIC_LEN 4
+
+// key ids fit in 4 varint bytes
+#define JSON_BINARY_KEY_BITS 28
+
+uint32_t json_binary_key_id(const char* name);
+
+// true if no two keys of any object under docdef share an id. run it
+// over new schemas in a test; a collision means renaming a key.
+bool json_binary_check_keys(json_docdef_t* docdef);
+
+// json_write_binary measures this many containers of a document once,
+// up front; any past that are measured again as they're written
+#ifndef JSON_BINARY_SIZES_MAX
+#define JSON_BINARY_SIZES_MAX 64
+#endif
+
+json_write_result_t json_write_binary(json_puts_cb write,
+				      void* ram, json_docdef_t* docdef);
+
+// buf is scratch for buffering the stream, any size from 1 byte up
+json_read_result_t json_read_binary(json_gets_cb read, json_copy_cb copy,
+				    void* ram, json_docdef_t* docdef,
+				    uint8_t* buf, size_t buf_len);
+
+// convert between the two formats, using ram as the scratch it goes
+// through; ram is left holding the document
+json_read_result_t json_convert_to_binary(json_gets_cb read, json_puts_cb write,
+					  void* ram, json_docdef_t* docdef,
+					  char* textbuf, size_t textbuf_len,
+					  jsmntok_t* tokbuf, size_t tokbuf_len);
+json_read_result_t json_convert_to_json(json_gets_cb read, json_puts_cb write,
+					void* ram, json_docdef_t* docdef,
+					uint8_t* buf, size_t buf_len);
@@ -0,0 +1,272 @@
+#include "json/diff.h"
+
+typedef enum {
+	DIFF_OBJECT,
+	DIFF_ARRAY,
+	DIFF_VALUE,
+	DIFF_MATCH,
+	DIFF_OTHER,
+} diff_kind_t;
+
+static diff_kind_t diff_kind(json_docdef_t* docdef) {
+	if (docdef->read == json_read_object) return DIFF_OBJECT;
+	// cached objects start from ram too, so diff the same way
+	if (docdef->read == json_read_object_cached) return DIFF_OBJECT;
+	if (docdef->read == json_read_array) return DIFF_ARRAY;
+	if (docdef->read == json_read_scalar) return DIFF_VALUE;
+	if (docdef->read == json_read_enum) return DIFF_VALUE;
+	if (docdef->read == json_read_buffer) return DIFF_VALUE;
+	if (docdef->read == json_read_string) return DIFF_VALUE;
+	if (docdef->read == json_match_string) return DIFF_MATCH;
+	return DIFF_OTHER;
+}
+
+// the value itself if it fits, FNV-1a of it if not
+static uint32_t value_slot(void* ram, json_docdef_t* docdef, size_t src_offset) {
+	const uint8_t* src = (const uint8_t*)ram + src_offset;
+	size_t size;
+	uint32_t slot = 0;
+
+	if (docdef->read == json_read_scalar) {
+		json_read_scalar_params_t* params = (json_read_scalar_params_t*)docdef->params;
+		src += params->dst_offset;
+		size = params->dst_size;
+	}
+	else if (docdef->read == json_read_enum) {
+		json_read_enum_params_t* params = (json_read_enum_params_t*)docdef->params;
+		src += params->dst_offset;
+		size = sizeof(int);
+	}
+	else {
+		json_read_buffer_params_t* params = (json_read_buffer_params_t*)docdef->params;
+		src += params->dst_offset;
+		size = params->dst_size;
+	}
+
+	if (size <= sizeof(slot)) {
+		memcpy(&slot, src, size);
+		return slot;
+	}
+	slot = 2166136261u;
+	for (size_t i = 0; i < size; i++) {
+		slot = (slot ^ src[i]) * 16777619u;
+	}
+	return slot;
+}
+
+size_t json_diff_slots(json_docdef_t* docdef) {
+	if (docdef->skip) {
+		return 0;
+	}
+	switch (diff_kind(docdef)) {
+	case DIFF_OBJECT: {
+		json_read_object_params_t* params = (json_read_object_params_t*)docdef->params;
+		size_t ct = 0;
+		for (uint8_t i = 0; i < params->docdef_ct; i++) {
+			ct += json_diff_slots(&params->docdefs[i]);
+		}
+		return ct;
+	}
+	case DIFF_ARRAY: {
+		json_read_array_params_t* params = (json_read_array_params_t*)docdef->params;
+		return params->array_len * json_diff_slots(params->item_docdef);
+	}
+	case DIFF_VALUE:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+// snapshot and changed return through slot_ct how many slots docdef
+// took, so a container counts its children's slots while passing over
+// them instead of asking json_diff_slots at every level. an array's
+// items all take the same count, known after the first
+
+static void snapshot(void* ram, json_docdef_t* docdef, size_t src_offset,
+		     uint32_t* slots, size_t* slot_ct) {
+	size_t ct = 0;
+
+	*slot_ct = 0;
+	if (docdef->skip) {
+		return;
+	}
+	switch (diff_kind(docdef)) {
+	case DIFF_OBJECT: {
+		json_read_object_params_t* params = (json_read_object_params_t*)docdef->params;
+		for (uint8_t i = 0; i < params->docdef_ct; i++) {
+			snapshot(ram, &params->docdefs[i], src_offset, slots + *slot_ct, &ct);
+			*slot_ct += ct;
+		}
+		break;
+	}
+	case DIFF_ARRAY: {
+		json_read_array_params_t* params = (json_read_array_params_t*)docdef->params;
+		for (size_t i = 0; i < params->array_len; i++) {
+			snapshot(ram, params->item_docdef,
+				 src_offset + params->item_size * i,
+				 slots + ct * i, &ct);
+		}
+		*slot_ct = ct * params->array_len;
+		break;
+	}
+	case DIFF_VALUE:
+		*slots = value_slot(ram, docdef, src_offset);
+		*slot_ct = 1;
+		break;
+	default:
+		break;
+	}
+}
+
+void json_diff_snapshot(void* ram, json_docdef_t* docdef, uint32_t* slots) {
+	size_t slot_ct;
+	snapshot(ram, docdef, 0, slots, &slot_ct);
+}
+
+static bool changed(void* ram, json_docdef_t* docdef, size_t src_offset,
+		    const uint32_t* slots, size_t* slot_ct) {
+	size_t ct = 0;
+	bool any = false;
+
+	*slot_ct = 0;
+	if (docdef->skip) {
+		return false;
+	}
+	switch (diff_kind(docdef)) {
+	case DIFF_OBJECT: {
+		json_read_object_params_t* params = (json_read_object_params_t*)docdef->params;
+		for (uint8_t i = 0; i < params->docdef_ct; i++) {
+			any |= changed(ram, &params->docdefs[i], src_offset, slots + *slot_ct, &ct);
+			*slot_ct += ct;
+		}
+		return any;
+	}
+	case DIFF_ARRAY: {
+		json_read_array_params_t* params = (json_read_array_params_t*)docdef->params;
+		for (size_t i = 0; i < params->array_len; i++) {
+			any |= changed(ram, params->item_docdef,
+				       src_offset + params->item_size * i,
+				       slots + ct * i, &ct);
+		}
+		*slot_ct = ct * params->array_len;
+		return any;
+	}
+	case DIFF_VALUE:
+		*slot_ct = 1;
+		return value_slot(ram, docdef, src_offset) != *slots;
+	case DIFF_MATCH:
+		return false;
+	default:
+		// nothing to compare against, so always written
+		return true;
+	}
+}
+
+bool json_diff_changed(void* ram, json_docdef_t* docdef, const uint32_t* slots) {
+	size_t slot_ct;
+	return changed(ram, docdef, 0, slots, &slot_ct);
+}
+
+static json_write_result_t write_changes(json_puts_cb write, void* ram, json_docdef_t* docdef,
+					 size_t src_offset, const uint32_t* slots);
+
+static json_write_result_t write_object_changes(json_puts_cb write, void* ram, json_docdef_t* docdef,
+						size_t src_offset, const uint32_t* slots) {
+	json_read_object_params_t* params = (json_read_object_params_t*)docdef->params;
+	json_write_result_t result;
+	size_t slot_ct;
+	bool first = true;
+
+	write("{", 1);
+	for (uint8_t i = 0; i < params->docdef_ct; i++) {
+		json_docdef_t* property = &params->docdefs[i];
+		bool property_changed = changed(ram, property, src_offset, slots, &slot_ct);
+
+		// constants are kept, so a patch is checked like the base
+		if (!property->skip
+		 && (diff_kind(property) == DIFF_MATCH || property_changed)) {
+			if (!first) {
+				write(", ", 2);
+			}
+			first = false;
+			write("\"", 1);
+			write(property->name, strlen(property->name));
+			write("\": ", 3);
+			result = write_changes(write, ram, property, src_offset, slots);
+			if (result != JSON_WRITE_OK) {
+				return result;
+			}
+		}
+		slots += slot_ct;
+	}
+	write("}", 1);
+	return JSON_WRITE_OK;
+}
+
+static json_write_result_t write_array_changes(json_puts_cb write, void* ram, json_docdef_t* docdef,
+					       size_t src_offset, const uint32_t* slots) {
+	json_read_array_params_t* params = (json_read_array_params_t*)docdef->params;
+	json_docdef_t* item = params->item_docdef;
+	json_write_result_t result;
+	size_t item_slots = 0;
+	size_t len = 0;
+
+	// items are read in order, so stop after the last changed one
+	for (size_t i = 0; i < params->array_len; i++) {
+		if (changed(ram, item, src_offset + params->item_size * i,
+			    slots + item_slots * i, &item_slots)) {
+			len = i + 1;
+		}
+	}
+
+	write("[", 1);
+	for (size_t i = 0; i < len; i++) {
+		size_t item_offset = src_offset + params->item_size * i;
+
+		if (i > 0) {
+			write(", ", 2);
+		}
+		if (changed(ram, item, item_offset, slots + item_slots * i, &item_slots)) {
+			result = write_changes(write, ram, item, item_offset, slots + item_slots * i);
+		}
+		else {
+			switch (diff_kind(item)) {
+			case DIFF_OBJECT:
+				write("{}", 2);
+				result = JSON_WRITE_OK;
+				break;
+			case DIFF_ARRAY:
+				write("[]", 2);
+				result = JSON_WRITE_OK;
+				break;
+			default:
+				result = item->write(write, ram, item, item_offset);
+				break;
+			}
+		}
+		if (result != JSON_WRITE_OK) {
+			return result;
+		}
+	}
+	write("]", 1);
+	return JSON_WRITE_OK;
+}
+
+static json_write_result_t write_changes(json_puts_cb write, void* ram, json_docdef_t* docdef,
+					 size_t src_offset, const uint32_t* slots) {
+	switch (diff_kind(docdef)) {
+	case DIFF_OBJECT:
+		return write_object_changes(write, ram, docdef, src_offset, slots);
+	case DIFF_ARRAY:
+		return write_array_changes(write, ram, docdef, src_offset, slots);
+	default:
+		return docdef->write(write, ram, docdef, src_offset);
+	}
+}
+
+json_write_result_t json_write_diff(json_puts_cb write,
+				    void* ram, json_docdef_t* docdef,
+				    const uint32_t* slots) {
+	return write_changes(write, ram, docdef, 0, slots);
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "json/serdes.h"
+
+// Incremental saves: remember what ram held when a preset was last
+// written in full, then write only what has changed since as a patch.
+//
+// The snapshot is one uint32_t slot per scalar, enum, buffer or string
+// under the docdef, holding the value itself when it fits in 4 bytes and
+// a hash of it otherwise, so nothing in the app has to mark its changes.
+//
+// The patch is a JSON document of the same shape holding only the
+// changed values. Missing keys are left alone on reading, so applying it
+// is just json_read of the patch over ram already holding the base:
+//
+//   json_read(base) ... json_diff_snapshot(ram, docdef, slots)
+//   on save:    json_write_diff(patch, ram, docdef, slots)
+//   on load:    json_read(base), then json_read(patch)
+//
+// Each patch is against the base, so a later one replaces an earlier
+// one. Rewrite the base and snapshot again when patches grow large.
+//
+// Array items before a changed one are written as {} for objects and []
+// for arrays, and in full otherwise. Cached objects start from what ram
+// holds when read, so they are diffed key by key like plain objects.
+
+// the snapshot slots docdef needs
+size_t json_diff_slots(json_docdef_t* docdef);
+
+void json_diff_snapshot(void* ram, json_docdef_t* docdef, uint32_t* slots);
+
+// true if anything under docdef differs from the snapshot
+bool json_diff_changed(void* ram, json_docdef_t* docdef, const uint32_t* slots);
+
+json_write_result_t json_write_diff(json_puts_cb write,
+				    void* ram, json_docdef_t* docdef,
+				    const uint32_t* slots);
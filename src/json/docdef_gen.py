@@ -0,0 +1,433 @@
+#!/usr/bin/env python3
+
+"""Generate json_docdef_t tables from a schema description.
+
+usage: docdef_gen.py SCHEMA [OUT]
+
+Writes OUT.h and OUT.c, by default the schema path with its extension
+replaced by _docdef. Check the generated files in next to the schema,
+as with euclidean/data.c.
+
+A schema names the generated symbols, the struct the document maps to
+and the headers declaring it, then lists the keys of the root object:
+
+    schema kria kria_data_t
+    include "kria.h"
+    version 2
+
+    # KEY KIND [@FIELD] [ARGS]
+    curr_preset  uint
+    glyph        buffer
+    mode         enum  @kria_mode  NORMAL MUTE PROB  default=NORMAL
+    tracks       array @t
+      -          cached
+        octave   int   @oct
+        steps    array @p
+          -      bool
+
+FIELD is the struct member relative to the enclosing object, by default
+the key. An array's item is the one line under it with the key "-" and
+maps to element [0]. Kinds:
+
+    uint, int, bool     json_read_scalar
+    enum OPTION...      json_read_enum, default=OPTION or the first
+    buffer              hex encoded bytes
+    string              raw characters, must fill the field
+    object              nested keys
+    cached              nested keys, read into an arena copy first
+    array               one item line
+    match TEXT [skip]   a constant string, with skip any string reads
+
+The output needs no runtime setup: params, key indexes and enum option
+lists are const, so they stay in flash, and only the docdefs themselves
+and one parser state per nesting level take SRAM. Duplicate keys and
+binary key id collisions fail here; a field whose size doesn't suit its
+reader fails to compile. SCHEMA_HASH changes whenever the document
+format does: keys, kinds, enum options or match strings. ARENA_SIZE is
+the json_arena_t buffer reading needs for the deepest nesting of cached
+objects, 0 without any.
+"""
+
+import os
+import re
+import shlex
+import sys
+
+KINDS = ('uint', 'int', 'bool', 'enum', 'buffer', 'string',
+         'object', 'cached', 'array', 'match')
+CONTAINERS = ('object', 'cached', 'array')
+
+# json_binary_key_id in binary.c
+KEY_BITS = 28
+
+
+def fnv1a(data, h=2166136261):
+    for b in data:
+        h = ((h ^ b) * 16777619) & 0xffffffff
+    return h
+
+
+def binary_key_id(name):
+    h = fnv1a(name.encode())
+    return (h ^ (h >> KEY_BITS)) & ((1 << KEY_BITS) - 1)
+
+
+class SchemaError(Exception):
+    pass
+
+
+class Node:
+    def __init__(self, key, kind, field, args, line):
+        self.key = key
+        self.kind = kind
+        self.field = field
+        self.args = args
+        self.line = line
+        self.children = []
+
+
+class Schema:
+    def __init__(self):
+        self.prefix = None
+        self.type = None
+        self.includes = []
+        self.version = 0
+        self.root = Node(None, 'object', None, [], 0)
+
+
+def fail(line, msg):
+    raise SchemaError('line %d: %s' % (line, msg))
+
+
+def parse(text):
+    schema = Schema()
+    # (indent, node) for each open container
+    stack = [(-1, schema.root)]
+
+    for n, raw in enumerate(text.splitlines(), 1):
+        try:
+            words = shlex.split(raw, comments=True)
+        except ValueError as e:
+            fail(n, str(e))
+        if not words:
+            continue
+        line = raw.expandtabs(8)
+        indent = len(line) - len(line.lstrip())
+
+        if indent == 0 and words[0] in ('schema', 'include', 'version'):
+            if words[0] == 'schema':
+                if len(words) != 3:
+                    fail(n, 'expected: schema PREFIX TYPE')
+                schema.prefix, schema.type = words[1], words[2]
+            elif words[0] == 'include':
+                schema.includes += words[1:]
+            else:
+                schema.version = int(words[1], 0)
+            continue
+
+        if len(words) < 2:
+            fail(n, 'expected: KEY KIND [@FIELD] [ARGS]')
+        key, kind, rest = words[0], words[1], words[2:]
+        if kind not in KINDS:
+            fail(n, 'unknown kind %r' % kind)
+        field = None
+        if rest and rest[0].startswith('@'):
+            field = rest[0][1:]
+            rest = rest[1:]
+
+        while indent <= stack[-1][0]:
+            stack.pop()
+        parent = stack[-1][1]
+        if parent.kind not in CONTAINERS:
+            fail(n, '%s %s has no keys' % (parent.kind, parent.key))
+        if (key == '-') != (parent.kind == 'array'):
+            fail(n, 'array items, and only array items, use the key "-"')
+        if parent.kind == 'array' and parent.children:
+            fail(n, 'array %s has more than one item' % parent.key)
+
+        node = Node(key, kind, field, rest, n)
+        parent.children.append(node)
+        if kind in CONTAINERS:
+            stack.append((indent, node))
+
+    if schema.prefix is None:
+        raise SchemaError('missing "schema PREFIX TYPE" line')
+    check(schema.root)
+    return schema
+
+
+def check(node):
+    if node.kind == 'array' and len(node.children) != 1:
+        fail(node.line, 'array %s needs one item' % node.key)
+    if node.kind in ('object', 'cached'):
+        keys = [c.key for c in node.children]
+        if len(keys) > 255:
+            fail(node.line, 'more than 255 keys')
+        ids = {}
+        for c in node.children:
+            if keys.count(c.key) > 1:
+                fail(c.line, 'duplicate key %s' % c.key)
+            other = ids.setdefault(binary_key_id(c.key), c.key)
+            if other != c.key:
+                fail(c.line, 'binary key id of %s collides with %s' % (c.key, other))
+    if node.kind == 'enum':
+        options = [a for a in node.args if not a.startswith('default=')]
+        if not options or len(options) > 255:
+            fail(node.line, 'enum needs 1 to 255 options')
+    if node.kind == 'match' and (len(node.args) not in (1, 2) or node.args[1:] not in ([], ['skip'])):
+        fail(node.line, 'expected: match TEXT [skip]')
+    for c in node.children:
+        check(c)
+
+
+def schema_hash(schema):
+    h = fnv1a(b'')
+
+    def walk(node, depth):
+        nonlocal h
+        line = '%d %s %s %s\n' % (depth, node.key, node.kind, ' '.join(node.args))
+        h = fnv1a(line.encode(), h)
+        for c in node.children:
+            walk(c, depth + 1)
+
+    walk(schema.root, 0)
+    return h
+
+
+def arena_max(exprs):
+    exprs = [e for e in exprs if e is not None]
+    if not exprs:
+        return None
+    expr = exprs[0]
+    for e in exprs[1:]:
+        expr = 'JSON_ARENA_MAX(%s, %s)' % (expr, e)
+    return expr
+
+
+def c_string(s):
+    return '"' + s.replace('\\', '\\\\').replace('"', '\\"') + '"'
+
+
+class Generator:
+    def __init__(self, schema):
+        self.s = schema
+        self.defs = []
+        self.symbols = set()
+        self.object_depth = 0
+        self.array_depth = 0
+        self.buffers = False
+
+    def symbol(self, keys):
+        base = re.sub(r'\W', '_', '_'.join([self.s.prefix] + keys))
+        sym, n = base, 2
+        while sym in self.symbols:
+            sym, n = '%s_%d' % (base, n), n + 1
+        self.symbols.add(sym)
+        return sym
+
+    def field(self, path):
+        return '%s, %s' % (self.s.type, path)
+
+    def docdef(self, node, path, keys, objects, arrays):
+        """Lines for the designated initializer of node's docdef."""
+        sym = self.symbol(keys)
+        kind = node.kind
+        lines = []
+        node.arena = None
+        if node.key is not None and node.key != '-':
+            lines.append('.name = %s,' % c_string(node.key))
+
+        if kind in ('uint', 'int', 'bool'):
+            self.defs.append(
+                'DOCDEF_CHECK(%s_size, sizeof_field(%s) == 1 || sizeof_field(%s) == 2 || sizeof_field(%s) == 4);'
+                % (sym, self.field(path), self.field(path), self.field(path)))
+            self.defs.append(
+                'static const json_read_scalar_params_t %s_params = {\n'
+                '\t.dst_size = sizeof_field(%s),\n'
+                '\t.dst_offset = offsetof(%s),\n'
+                '\t.signed_val = %s,\n'
+                '};' % (sym, self.field(path), self.field(path),
+                        'true' if kind == 'int' else 'false'))
+            lines += ['.read = json_read_scalar,',
+                      '.write = %s,' % ('json_write_bool' if kind == 'bool' else 'json_write_number')]
+
+        elif kind == 'enum':
+            options = [a for a in node.args if not a.startswith('default=')]
+            default = 0
+            for a in node.args:
+                if a.startswith('default='):
+                    name = a[len('default='):]
+                    if name not in options:
+                        fail(node.line, 'default %s is not an option' % name)
+                    default = options.index(name)
+            self.defs.append(
+                'DOCDEF_CHECK(%s_size, sizeof_field(%s) == sizeof(int));' % (sym, self.field(path)))
+            self.defs.append(
+                'static const char* const %s_options[] = {\n%s\n};'
+                % (sym, '\n'.join('\t%s,' % c_string(o) for o in options)))
+            self.defs.append(
+                'static const json_read_enum_params_t %s_params = {\n'
+                '\t.option_ct = %d,\n'
+                '\t.options = (const char**)%s_options,\n'
+                '\t.dst_offset = offsetof(%s),\n'
+                '\t.default_val = %d,\n'
+                '};' % (sym, len(options), sym, self.field(path), default))
+            lines += ['.read = json_read_enum,', '.write = json_write_enum,']
+
+        elif kind in ('buffer', 'string'):
+            self.buffers = True
+            self.defs.append(
+                'static const json_read_buffer_params_t %s_params = {\n'
+                '\t.dst_size = sizeof_field(%s),\n'
+                '\t.dst_offset = offsetof(%s),\n'
+                '};' % (sym, self.field(path), self.field(path)))
+            lines += ['.read = json_read_%s,' % kind,
+                      '.write = json_write_%s,' % kind,
+                      '.state = &%s_buffer_state,' % self.s.prefix]
+
+        elif kind == 'match':
+            text = node.args[0]
+            skip = len(node.args) == 2
+            self.defs.append(
+                'static const json_match_string_params_t %s_params = {\n'
+                '\t.to_match = %s,\n'
+                '\t.skip = %s,\n'
+                '};' % (sym, c_string(text), 'true' if skip else 'false'))
+            lines += ['.read = json_match_string,', '.write = json_write_constant_string,']
+
+        elif kind == 'array':
+            item = node.children[0]
+            item_path = path + '[0]'
+            self.array_depth = max(self.array_depth, arrays + 1)
+            item_lines = self.docdef(item, item_path, keys + ['item'], objects, arrays + 1)
+            node.arena = item.arena
+            self.defs.append(
+                'static json_docdef_t %s_item = {\n%s\n};'
+                % (sym, '\n'.join('\t' + l for l in item_lines)))
+            self.defs.append(
+                'static const json_read_array_params_t %s_params = {\n'
+                '\t.array_len = sizeof_field(%s) / sizeof_field(%s),\n'
+                '\t.item_size = sizeof_field(%s),\n'
+                '\t.item_docdef = &%s_item,\n'
+                '};' % (sym, self.field(path), self.field(item_path),
+                        self.field(item_path), sym))
+            lines += ['.read = json_read_array,',
+                      '.write = json_write_array,',
+                      '.state = &%s_array_state[%d],' % (self.s.prefix, arrays)]
+
+        else:
+            # object or cached
+            self.object_depth = max(self.object_depth, objects + 1)
+            children = []
+            for c in node.children:
+                child_path = c.field if c.field is not None else c.key
+                if path:
+                    child_path = path + '.' + child_path
+                children.append(self.docdef(c, child_path, keys + [c.key], objects + 1, arrays))
+            node.arena = arena_max(c.arena for c in node.children)
+            order = sorted(range(len(node.children)), key=lambda i: node.children[i].key.encode())
+            self.defs.append(
+                'static json_docdef_t %s_docdefs[] = {\n%s\n};'
+                % (sym, '\n'.join('\t{\n%s\n\t},' % '\n'.join('\t\t' + l for l in c) for c in children)))
+            self.defs.append(
+                'static const uint8_t %s_key_index[] = { %s };'
+                % (sym, ', '.join(str(i) for i in order)))
+            params = [
+                '\t.docdefs = %s_docdefs,' % sym,
+                '\t.docdef_ct = %d,' % len(children),
+                '\t.key_index = %s_key_index,' % sym,
+            ]
+            read = 'json_read_object'
+            if kind == 'cached':
+                if not path:
+                    fail(node.line, 'a cached object needs a field')
+                read = 'json_read_object_cached'
+                own = 'JSON_ARENA_ALIGN(sizeof_field(%s))' % self.field(path)
+                node.arena = own if node.arena is None else '%s + %s' % (own, node.arena)
+                params += [
+                    '\t.dst_size = sizeof_field(%s),' % self.field(path),
+                    '\t.dst_offset = offsetof(%s),' % self.field(path),
+                    '\t.alloc = json_arena_alloc,',
+                    '\t.free = json_arena_free,',
+                ]
+            self.defs.append(
+                'static const json_read_object_params_t %s_params = {\n%s\n};'
+                % (sym, '\n'.join(params)))
+            lines += ['.read = %s,' % read,
+                      '.write = json_write_object,',
+                      '.state = &%s_object_state[%d],' % (self.s.prefix, objects)]
+
+        lines.append('.params = (void*)&%s_params,' % sym)
+        return lines
+
+    def generate(self, out_name):
+        s = self.s
+        root = self.docdef(s.root, '', ['root'], 0, 0)
+        guard = re.sub(r'\W', '_', os.path.basename(out_name)).upper() + '_H'
+        upper = s.prefix.upper()
+        source = os.path.basename(self.source)
+
+        h = ['// generated by docdef_gen.py from %s, do not edit' % source,
+             '',
+             '#ifndef %s' % guard,
+             '#define %s' % guard,
+             '',
+             '#include "json/serdes.h"']
+        h += ['#include %s' % c_string(i) for i in s.includes]
+        h += ['',
+              '#define %s_SCHEMA_VERSION %d' % (upper, s.version),
+              '#define %s_SCHEMA_HASH 0x%08xu' % (upper, schema_hash(s)),
+              '#define %s_ARENA_SIZE (%s)' % (upper, s.root.arena or '0'),
+              '',
+              'extern json_docdef_t %s_docdef;' % s.prefix,
+              '',
+              '#endif',
+              '']
+
+        c = ['// generated by docdef_gen.py from %s, do not edit' % source,
+             '',
+             '#include "%s.h"' % os.path.basename(out_name),
+             '',
+             '// fails to compile if a field doesn\'t suit its reader',
+             '#define DOCDEF_CHECK(name, cond) typedef char name[(cond) ? 1 : -1]',
+             '',
+             '// objects and arrays at the same depth are never read at once',
+             'static json_read_object_state_t %s_object_state[%d];' % (s.prefix, self.object_depth)]
+        if self.array_depth:
+            c.append('static json_read_array_state_t %s_array_state[%d];' % (s.prefix, self.array_depth))
+        if self.buffers:
+            c.append('static json_read_buffer_state_t %s_buffer_state;' % s.prefix)
+        c.append('')
+        for d in self.defs:
+            c += [d, '']
+        c += ['json_docdef_t %s_docdef = {' % s.prefix]
+        c += ['\t' + l for l in root]
+        c += ['};', '']
+        return '\n'.join(h), '\n'.join(c)
+
+
+def main(argv):
+    if len(argv) not in (2, 3):
+        sys.stderr.write(__doc__)
+        return 2
+    path = argv[1]
+    out = argv[2] if len(argv) == 3 else os.path.splitext(path)[0] + '_docdef'
+    with open(path) as f:
+        text = f.read()
+    try:
+        schema = parse(text)
+        gen = Generator(schema)
+        gen.source = path
+        h, c = gen.generate(out)
+    except SchemaError as e:
+        sys.stderr.write('%s: %s\n' % (path, e))
+        return 1
+    with open(out + '.h', 'w') as f:
+        f.write(h)
+    with open(out + '.c', 'w') as f:
+        f.write(c)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
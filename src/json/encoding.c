@@ -7,127 +7,204 @@
 #include "print_funcs.h"
 #endif
 
-char* encode_decimal_unsigned(uint32_t val) {
-	static char decimal_encoding_buf[12] = { 0 };
-	uint8_t i;
+// "00" to "99", for encoding two digits per division
+static const char decimal_pairs[200] =
+	"0001020304050607080910111213141516171819"
+	"2021222324252627282930313233343536373839"
+	"4041424344454647484950515253545556575859"
+	"6061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
 
-#if JSON_DEBUG
-	print_dbg("\r\nencode unsigned ");
-	print_dbg_hex(val);
-#endif
-	for (i = 0; i < 12; i++) {
-	  decimal_encoding_buf[i] = 0;
+static const uint32_t decimal_powers[10] = {
+	1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000,
+};
+
+// "00" to "FF", for encoding a byte per lookup
+static const char hex_pairs[512] =
+	"000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F"
+	"202122232425262728292A2B2C2D2E2F303132333435363738393A3B3C3D3E3F"
+	"404142434445464748494A4B4C4D4E4F505152535455565758595A5B5C5D5E5F"
+	"606162636465666768696A6B6C6D6E6F707172737475767778797A7B7C7D7E7F"
+	"808182838485868788898A8B8C8D8E8F909192939495969798999A9B9C9D9E9F"
+	"A0A1A2A3A4A5A6A7A8A9AAABACADAEAFB0B1B2B3B4B5B6B7B8B9BABBBCBDBEBF"
+	"C0C1C2C3C4C5C6C7C8C9CACBCCCDCECFD0D1D2D3D4D5D6D7D8D9DADBDCDDDEDF"
+	"E0E1E2E3E4E5E6E7E8E9EAEBECEDEEEFF0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF";
+
+// value of each hex digit, 0xff for anything else
+static const uint8_t hex_values[256] = {
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+};
+
+size_t encode_decimal_unsigned_to(char* dst, uint32_t val) {
+	size_t len = 1;
+	char* p;
+
+	while (len < 10 && val >= decimal_powers[len]) {
+		len++;
 	}
-	i = 10;
-	if (val == 0) {
-		decimal_encoding_buf[i--] = '0';
+	p = dst + len;
+	*p = 0;
+	while (val >= 100) {
+		const char* pair = &decimal_pairs[(val % 100) * 2];
+		val /= 100;
+		*--p = pair[1];
+		*--p = pair[0];
+	}
+	if (val >= 10) {
+		*--p = decimal_pairs[val * 2 + 1];
+		*--p = decimal_pairs[val * 2];
 	}
 	else {
-		for (; val && i; --i, val /= 10) {
-			decimal_encoding_buf[i] = (val % 10) + '0';
-		}
+		*--p = '0' + val;
 	}
+
 #if JSON_DEBUG
-	print_dbg("-> ");
-	print_dbg(&decimal_encoding_buf[i + 1]);
+	print_dbg("\r\nencode unsigned -> ");
+	print_dbg(dst);
 #endif
-	return &decimal_encoding_buf[i + 1];
+	return len;
 }
 
-char* encode_decimal_signed(int32_t val) {
-	char* ret;
+size_t encode_decimal_signed_to(char* dst, int32_t val) {
 	if (val < 0) {
-		ret = encode_decimal_unsigned(-val);
-		*--ret = '-';
-	} else {
-		ret = encode_decimal_unsigned(val);
+		*dst = '-';
+		return 1 + encode_decimal_unsigned_to(dst + 1, 0u - (uint32_t)val);
 	}
-	return ret;
+	return encode_decimal_unsigned_to(dst, val);
 }
 
-int32_t decode_decimal(const char* s, int len) {
-	int32_t ret = 0;
+char* encode_decimal_unsigned(uint32_t val) {
+	static char decimal_encoding_buf[JSON_DECIMAL_LEN];
+	encode_decimal_unsigned_to(decimal_encoding_buf, val);
+	return decimal_encoding_buf;
+}
+
+char* encode_decimal_signed(int32_t val) {
+	static char decimal_encoding_buf[JSON_DECIMAL_LEN];
+	encode_decimal_signed_to(decimal_encoding_buf, val);
+	return decimal_encoding_buf;
+}
+
+int decode_decimal_checked(int32_t* dst, const char* s, size_t len) {
+	uint32_t val = 0;
+	bool negative;
+	size_t i;
 
 #if JSON_DEBUG
 	print_dbg("\r\ndecode scalar: ");
-	for(int i = 0; i < len; i++) {
+	for (i = 0; i < len; i++) {
 		print_dbg_char(s[i]);
 	}
 #endif
 
 	// also handle bool
-	if (s[0] == 't') {
-		return 1;
+	if (len == 4 && strncmp(s, "true", 4) == 0) {
+		*dst = 1;
+		return 0;
 	}
-	if (s[0] == 'f') {
+	if (len == 5 && strncmp(s, "false", 5) == 0) {
+		*dst = 0;
 		return 0;
 	}
-	bool negative = s[0] == '-';
-	for (int i = negative ? 1 : 0; i < len; i++) {
-		ret = ret * 10 + (s[i] - '0');
+
+	negative = len > 0 && s[0] == '-';
+	i = negative ? 1 : 0;
+	if (i == len) {
+		return -1;
 	}
-        if (negative) {
-		ret = -ret;
+	for (; i < len; i++) {
+		uint8_t digit = s[i] - '0';
+		if (digit > 9) {
+			return -1;
+		}
+		if (val > (UINT32_MAX - digit) / 10) {
+			return -1;
+		}
+		val = val * 10 + digit;
 	}
+	if (negative) {
+		if (val > 2147483648u) {
+			return -1;
+		}
+		val = 0u - val;
+	}
+	*dst = (int32_t)val;
+	return 0;
+}
 
-#if JSON_DEBUG
-	print_dbg(" -> ");
-	print_dbg_hex(ret);
-#endif
-
+int32_t decode_decimal(const char* s, int len) {
+	int32_t ret = 0;
+	decode_decimal_checked(&ret, s, len);
 	return ret;
 }
 
 int decode_nybble(uint8_t* dst, char hex) {
-	if (hex < '0') {
-		return -1;
-	}
-	if (hex <= '9') {
-		*dst = hex - '0';
-		return 0;
-	}
-	if (hex < 'A' || hex > 'f') {
-		return -1;
-	}
-	if (hex >= 'a') {
-		hex -= ('a' - 'A');
-	}
-	if (hex > 'F') {
+	uint8_t val = hex_values[(uint8_t)hex];
+	if (val > 0xF) {
 		return -1;
 	}
-        *dst = hex - 'A' + 0xA;
+	*dst = val;
 	return 0;
 }
 
 int decode_hexbuf(json_copy_cb copy, char* dst, const char* src, size_t len) {
-	uint8_t upper, lower;
-	char byte;
+	char bytes[32];
+	size_t n = 0;
+
+	if (len % 2 != 0) {
+		return -1;
+	}
 	for (size_t i = 0; i < len; i += 2) {
-		if (decode_nybble(&upper, src[i]) < 0) {
+		uint8_t upper = hex_values[(uint8_t)src[i]];
+		uint8_t lower = hex_values[(uint8_t)src[i + 1]];
+		if ((upper | lower) > 0xF) {
 			return -1;
 		}
-		if (decode_nybble(&lower, src[i + 1]) < 0) {
-			return -1;
+		bytes[n++] = (upper << 4) | lower;
+		if (n == sizeof(bytes)) {
+			copy(dst, bytes, n);
+			dst += n;
+			n = 0;
 		}
-		byte = (upper << 4) | lower;
-		copy(dst + i / 2, &byte, 1);
+	}
+	if (n > 0) {
+		copy(dst, bytes, n);
 	}
 	return 0;
 }
 
 char encode_nybble(uint8_t value) {
-	if (value > 0x9) {
-		return value - 0xA + 'A';
-	}
-	return value + '0';
+	return hex_pairs[value * 2 + 1];
 }
 
 void encode_hexbuf(json_puts_cb write, const uint8_t* src, size_t len) {
-	char nybble;
+	char hex[64];
+	size_t n = 0;
+
 	for (size_t i = 0; i < len; i++) {
-		nybble = encode_nybble((src[i] & 0xF0) >> 4);
-		write(&nybble, 1);
-		nybble = encode_nybble(src[i] & 0x0F);
-		write(&nybble, 1);
+		hex[n++] = hex_pairs[src[i] * 2];
+		hex[n++] = hex_pairs[src[i] * 2 + 1];
+		if (n == sizeof(hex)) {
+			write(hex, n);
+			n = 0;
+		}
+	}
+	if (n > 0) {
+		write(hex, n);
 	}
 }
@@ -3,9 +3,24 @@
 
 #include "json/serdes.h"
 
+// fits "-2147483648" and a NUL
+#define JSON_DECIMAL_LEN 12
+
+// write val NUL terminated into dst, which holds JSON_DECIMAL_LEN;
+// returns the length without the NUL
+size_t encode_decimal_unsigned_to(char* dst, uint32_t val);
+size_t encode_decimal_signed_to(char* dst, int32_t val);
+// the same into a static buffer, overwritten on every call
 char* encode_decimal_unsigned(uint32_t val);
 char* encode_decimal_signed(int32_t val);
+
+// anything from -2147483648 to 4294967295, or true/false as 1/0.
+// returns -1 without touching dst for anything else, including
+// fractions, exponents and values out of that range
+int decode_decimal_checked(int32_t* dst, const char* s, size_t len);
+// the same, returning 0 for what decode_decimal_checked rejects
 int32_t decode_decimal(const char* s, int len);
+
 int decode_hexbuf(json_copy_cb copy, char* dst, const char* src, size_t len);
 int decode_nybble(uint8_t* dst, char hex);
 char encode_nybble(uint8_t val);
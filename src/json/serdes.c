@@ -12,7 +12,6 @@ json_read_result_t json_read_object(
 	jsmntok_t* tok,
 	json_copy_cb copy, void* ram, json_docdef_t* docdef,
 	const char* text, size_t text_len, int32_t dst_offset) {
-	json_read_object_params_t* params = (json_read_object_params_t*)docdef->params;
 	json_read_object_state_t* state = (json_read_object_state_t*)docdef->state;
 
 	if (docdef->fresh) {
@@ -53,18 +52,15 @@ json_read_result_t json_read_object(
 			return JSON_READ_MALFORMED;
 		}
 		if (tok->end > 0) {
-			for (uint8_t i = 0; i < params->docdef_ct; i++) {
-				if (strncmp(params->docdefs[i].name, text + tok->start, tok->end - tok->start) == 0) {
-					if (params->docdefs[i].skip) {
-						continue;
-					}
-					state->active_docdef = &params->docdefs[i];
-					state->active_docdef->fresh = true;
-					state->object_state = JSON_OBJECT_PARSE_PROPERTY;
-					return JSON_READ_INCOMPLETE;
-				}
+			state->active_docdef = json_docdef_find_key_len(
+				docdef, text + tok->start, tok->end - tok->start);
+			if (state->active_docdef != NULL) {
+				state->active_docdef->fresh = true;
+				state->object_state = JSON_OBJECT_PARSE_PROPERTY;
+				return JSON_READ_INCOMPLETE;
 			}
 			state->object_state = JSON_OBJECT_SKIP_SECTION;
+			json_read_skip(JSON_SKIP_VALUE, state->depth);
 		}
 		return JSON_READ_INCOMPLETE;
 	case JSON_OBJECT_PARSE_PROPERTY: {
@@ -117,6 +113,10 @@ json_read_result_t json_read_object_cached(
 			print_dbg_hex(state->object_state);
 			return JSON_READ_MALFORMED;
 		}
+		// keys the document leaves out keep their values
+		memcpy(state->cache,
+		       (char*)ram + params->dst_offset + dst_offset,
+		       params->dst_size);
 	}
 
 
@@ -166,18 +166,15 @@ json_read_result_t json_read_object_cached(
 			return JSON_READ_MALFORMED;
 		}
 		if (tok->end > 0) {
-			for (uint8_t i = 0; i < params->docdef_ct; i++) {
-				if (strncmp(params->docdefs[i].name, text + tok->start, tok->end - tok->start) == 0) {
-					if (params->docdefs[i].skip) {
-						continue;
-					}
-					state->active_docdef = &params->docdefs[i];
-					state->active_docdef->fresh = true;
-					state->object_state = JSON_OBJECT_PARSE_PROPERTY;
-					return JSON_READ_INCOMPLETE;
-				}
+			state->active_docdef = json_docdef_find_key_len(
+				docdef, text + tok->start, tok->end - tok->start);
+			if (state->active_docdef != NULL) {
+				state->active_docdef->fresh = true;
+				state->object_state = JSON_OBJECT_PARSE_PROPERTY;
+				return JSON_READ_INCOMPLETE;
 			}
 			state->object_state = JSON_OBJECT_SKIP_SECTION;
+			json_read_skip(JSON_SKIP_VALUE, state->depth);
 		}
 		return JSON_READ_INCOMPLETE;
 	case JSON_OBJECT_PARSE_PROPERTY: {
@@ -257,6 +254,24 @@ json_write_result_t json_write_object(
 	return JSON_WRITE_OK;
 }
 
+// whether a decoded number fits the destination. decode_decimal_checked
+// only keeps it to 32 bits, so "-1" and "4294967295" both come back as
+// -1 and the sign of the text tells them apart
+static bool scalar_fits(int32_t val, bool negative, uint8_t dst_size, bool signed_val) {
+	uint32_t bits = dst_size * 8;
+
+	if (negative) {
+		if (!signed_val) {
+			return val == 0;
+		}
+		return dst_size >= sizeof(uint32_t) || val >= -((int32_t)1 << (bits - 1));
+	}
+	if (dst_size >= sizeof(uint32_t)) {
+		return !signed_val || val >= 0;
+	}
+	return (uint32_t)val < ((uint32_t)1 << (signed_val ? bits - 1 : bits));
+}
+
 json_read_result_t json_read_scalar(
 	jsmntok_t* tok,
 	json_copy_cb copy, void* ram, json_docdef_t* docdef,
@@ -271,7 +286,17 @@ json_read_result_t json_read_scalar(
 		return JSON_READ_INCOMPLETE;
 	}
 	void* dst = (char*)ram + params->dst_offset + dst_offset;
-	int val = decode_decimal(text + tok->start, tok->end - tok->start);
+	int32_t val;
+	if (decode_decimal_checked(&val, text + tok->start, tok->end - tok->start) < 0) {
+		print_dbg("\r\n!! bad number for scalar: ");
+		print_dbg(docdef->name);
+		return JSON_READ_MALFORMED;
+	}
+	if (!scalar_fits(val, text[tok->start] == '-', params->dst_size, params->signed_val)) {
+		print_dbg("\r\n!! number out of range for scalar: ");
+		print_dbg(docdef->name);
+		return JSON_READ_MALFORMED;
+	}
 
 #if JSON_DEBUG
 	print_dbg("\r\n> read scalar: ");
@@ -312,7 +337,8 @@ json_write_result_t json_write_number(
 	size_t src_offset) {
 	json_read_scalar_params_t* params = (json_read_scalar_params_t*)docdef->params;
 	void* src = (uint8_t*)ram + src_offset + params->dst_offset;
-	char* dec;
+	char dec[JSON_DECIMAL_LEN];
+	size_t len;
 
 #if JSON_DEBUG
 	print_dbg("\r\nwrite scalar, size ");
@@ -325,13 +351,13 @@ json_write_result_t json_write_number(
 #endif
 		switch (params->dst_size) {
 		case 4:
-			dec = encode_decimal_signed(*(int32_t*)src);
+			len = encode_decimal_signed_to(dec, *(int32_t*)src);
 			break;
 		case 2:
-			dec = encode_decimal_signed(*(int16_t*)src);
+			len = encode_decimal_signed_to(dec, *(int16_t*)src);
 			break;
 		case 1:
-			dec = encode_decimal_signed(*(int8_t*)src);
+			len = encode_decimal_signed_to(dec, *(int8_t*)src);
 			break;
 		default:
 			return JSON_WRITE_ERROR;
@@ -342,13 +368,13 @@ json_write_result_t json_write_number(
 #endif
 		switch (params->dst_size) {
 		case 4:
-			dec = encode_decimal_unsigned(*(uint32_t*)src);
+			len = encode_decimal_unsigned_to(dec, *(uint32_t*)src);
 			break;
 		case 2:
-			dec = encode_decimal_unsigned(*(uint16_t*)src);
+			len = encode_decimal_unsigned_to(dec, *(uint16_t*)src);
 			break;
 		case 1:
-			dec = encode_decimal_unsigned(*(uint8_t*)src);
+			len = encode_decimal_unsigned_to(dec, *(uint8_t*)src);
 			break;
 		default:
 			return JSON_WRITE_ERROR;
@@ -356,9 +382,9 @@ json_write_result_t json_write_number(
 	}
 #if JSON_DEBUG
 	print_dbg("\r\nencoded decimal has len ");
-	print_dbg_hex(strlen(dec));
+	print_dbg_hex(len);
 #endif
-	write(dec, strlen(dec));
+	write(dec, len);
 	return JSON_WRITE_OK;
 }
 
@@ -441,8 +467,14 @@ json_read_result_t json_read_enum(
 			copy(dst, (char*)&params->default_val, sizeof(int));
 		}
 		else {
-			int decimal = decode_decimal(text + tok->start, tok->end - tok->start);
-			copy(dst, (char*)&decimal, sizeof(int));
+			int32_t decimal;
+			if (decode_decimal_checked(&decimal, text + tok->start, tok->end - tok->start) < 0) {
+				print_dbg("\r\n!! bad number for enum: ");
+				print_dbg(docdef->name);
+				return JSON_READ_MALFORMED;
+			}
+			int val = decimal;
+			copy(dst, (char*)&val, sizeof(int));
 		}
 		return JSON_READ_OK;
 	}
@@ -510,7 +542,9 @@ json_read_result_t json_read_array(
 		params->item_docdef->fresh = true;
 		return JSON_READ_INCOMPLETE;
 	case JSON_ARRAY_MATCH_ITEMS:
-		if (state->array_ct > params->array_len) {
+		if (state->array_ct >= params->array_len) {
+			// more items than the destination holds
+			json_read_skip(JSON_SKIP_REST, state->depth);
 			return JSON_READ_INCOMPLETE;
 		}
 
@@ -594,18 +628,23 @@ json_read_result_t json_read_buffer(
 	size_t start = tok->start > 0 ? tok->start : 0;
 	size_t input_len = (tok->end >= 0 ? tok->end : text_len) - start;
 	if (input_len % 2 != 0) {
+		if (tok->end >= 0) {
+			print_dbg("\r\n!! odd buffer len");
+			return JSON_READ_MALFORMED;
+		}
 		// need to start the token over so that we decode whole bytes
 		return JSON_READ_INCOMPLETE;
 	}
-	if (tok->end > 0) {
-		if (state->buf_pos + (input_len / 2) != params->dst_size) {
-			print_dbg("\r\n!! bad buffer len: ");
-			print_dbg_hex(state->buf_pos + (input_len / 2));
-			print_dbg("(expected ");
-			print_dbg_hex(params->dst_size);
-			print_dbg(")");
-			return JSON_READ_MALFORMED;
-		}
+	// a piece can't be checked against the total length yet, but must
+	// not run past it
+	if (state->buf_pos + (input_len / 2) > params->dst_size
+	 || (tok->end >= 0 && state->buf_pos + (input_len / 2) != params->dst_size)) {
+		print_dbg("\r\n!! bad buffer len: ");
+		print_dbg_hex(state->buf_pos + (input_len / 2));
+		print_dbg("(expected ");
+		print_dbg_hex(params->dst_size);
+		print_dbg(")");
+		return JSON_READ_MALFORMED;
 	}
 	char* dst = (char*)ram + params->dst_offset + dst_offset;
 
@@ -686,15 +725,14 @@ json_read_result_t json_read_string(
 	}
 	size_t start = tok->start > 0 ? tok->start : 0;
 	size_t len = (tok->end >= 0 ? tok->end : text_len) - start;
-	if (tok->end >= 0) {
-		if (state->buf_pos + len != params->dst_size) {
-			print_dbg("\r\n!! bad string len: ");
-			print_dbg_hex(state->buf_pos + len);
-			print_dbg("(expected ");
-			print_dbg_hex(params->dst_size);
-			print_dbg(")");
-			return JSON_READ_MALFORMED;
-		}
+	if (state->buf_pos + len > params->dst_size
+	 || (tok->end >= 0 && state->buf_pos + len != params->dst_size)) {
+		print_dbg("\r\n!! bad string len: ");
+		print_dbg_hex(state->buf_pos + len);
+		print_dbg("(expected ");
+		print_dbg_hex(params->dst_size);
+		print_dbg(")");
+		return JSON_READ_MALFORMED;
 	}
 	char* dst = (char*)ram + params->dst_offset + dst_offset;
 	copy(dst + state->buf_pos, text + start, len);
@@ -706,181 +744,638 @@ json_read_result_t json_read_string(
 	return JSON_READ_KEEP_GOING;
 }
 
+
+//// arena allocation
+
+static json_arena_t* active_arena;
+
+void json_arena_init(json_arena_t* arena, void* buf, size_t len) {
+	size_t pad = JSON_ARENA_ALIGN((uintptr_t)buf) - (uintptr_t)buf;
+
+	if (pad > len) {
+		pad = len;
+	}
+	arena->buf = (uint8_t*)buf + pad;
+	arena->len = len - pad;
+	arena->used = 0;
+	arena->peak = 0;
+	active_arena = arena;
+}
+
+void* json_arena_alloc(size_t size) {
+	json_arena_t* arena = active_arena;
+	void* ret;
+
+	size = JSON_ARENA_ALIGN(size);
+	if (arena == NULL || size > arena->len - arena->used) {
+		print_dbg("\r\n!! arena full");
+		return NULL;
+	}
+	ret = arena->buf + arena->used;
+	arena->used += size;
+	if (arena->used > arena->peak) {
+		arena->peak = arena->used;
+	}
+	return ret;
+}
+
+void json_arena_free(void* ptr) {
+	json_arena_t* arena = active_arena;
+
+	// only the newest allocation is released early, and with it
+	// anything allocated after it
+	if (arena != NULL
+	 && (uint8_t*)ptr >= arena->buf
+	 && (uint8_t*)ptr < arena->buf + arena->used) {
+		arena->used = (uint8_t*)ptr - arena->buf;
+	}
+}
+
+size_t json_arena_size(json_docdef_t* docdef) {
+	size_t size = 0;
+
+	if (docdef->read == json_read_array) {
+		return json_arena_size(((json_read_array_params_t*)docdef->params)->item_docdef);
+	}
+	if (docdef->read != json_read_object && docdef->read != json_read_object_cached) {
+		return 0;
+	}
+
+	json_read_object_params_t* params = (json_read_object_params_t*)docdef->params;
+	for (uint8_t i = 0; i < params->docdef_ct; i++) {
+		size_t child = json_arena_size(&params->docdefs[i]);
+		size = JSON_ARENA_MAX(size, child);
+	}
+	if (docdef->read == json_read_object_cached) {
+		size += JSON_ARENA_ALIGN(params->dst_size);
+	}
+	return size;
+}
+
+
 json_read_state_t deserialize_state;
 
+static bool ends_primitive(char c) {
+	switch (c) {
+	// non-strict, like jsmn: a primitive can end at ':'
+	case '\t': case '\r': case '\n': case ' ':
+	case ',': case ']': case '}': case ':':
+		return true;
+	default:
+		return false;
+	}
+}
+
+static bool is_hex_digit(char c) {
+	return (c >= '0' && c <= '9')
+	    || (c >= 'A' && c <= 'F')
+	    || (c >= 'a' && c <= 'f');
+}
+
+void json_read_skip(json_read_skip_t mode, unsigned int depth) {
+	deserialize_state.skip = mode;
+	deserialize_state.skip_depth = depth;
+	deserialize_state.skip_in_string = false;
+}
+
+// pass over text until the skip ends, counting brackets but not checking
+// that they match
+static void skip_text(const char* textbuf) {
+	json_read_state_t* s = &deserialize_state;
+	char c;
+
+	for (; s->head < s->tail; s->head++) {
+		c = textbuf[s->head];
+		if (s->skip_in_string) {
+			if (s->escape) {
+				s->escape = 0;
+			}
+			else if (c == '\\') {
+				s->escape = 1;
+			}
+			else if (c == '\"') {
+				s->skip_in_string = false;
+			}
+			continue;
+		}
+		switch (c) {
+		case '\"':
+			s->skip_in_string = true;
+			break;
+		case '{': case '[':
+			s->depth++;
+			break;
+		case '}': case ']':
+			if (s->depth == s->skip_depth) {
+				s->skip = JSON_SKIP_NONE;
+				return;
+			}
+			s->depth--;
+			break;
+		case ',':
+			if (s->skip == JSON_SKIP_VALUE && s->depth == s->skip_depth) {
+				s->skip = JSON_SKIP_NONE;
+				return;
+			}
+			break;
+		}
+	}
+}
+
+static json_read_result_t read_finished(json_read_result_t result) {
+	if (active_arena != NULL) {
+		active_arena->used = deserialize_state.arena_mark;
+	}
+	if (result == JSON_READ_OK) {
+		print_dbg("\r\n> OK! total bytes read from disk: ");
+	}
+	else {
+		print_dbg("\r\n> FAILED! total bytes read from disk: ");
+	}
+	print_dbg_hex(deserialize_state.total_bytes_read);
+	print_dbg("\r\n> total tokens processed: ");
+	print_dbg_hex(deserialize_state.total_tokens_read);
+	return result;
+}
+
+// hand one token to the root docdef. text_len is where a string piece
+// ends when the token is still open (end < 0).
+static json_read_result_t emit_token(
+	jsmntype_t type, int start, int end,
+	json_copy_cb copy, void* ram, json_docdef_t* docdef,
+	const char* textbuf, size_t text_len) {
+	json_read_result_t result;
+	jsmntok_t tok = {
+		.type = type,
+		.start = start,
+		.end = end,
+		.depth = deserialize_state.depth,
+	};
+
+	deserialize_state.total_tokens_read++;
+	result = docdef->read(&tok, copy, ram, docdef, textbuf, text_len, 0);
+	if (result == JSON_READ_MALFORMED) {
+		print_dbg("\r\nfailed on token type ");
+		print_dbg_hex(type);
+		print_dbg(" that spans ");
+		print_dbg_hex(start);
+		print_dbg(" - ");
+		print_dbg_hex(end);
+		print_dbg(": ");
+		for (size_t i = start; i < (end >= 0 ? end : text_len); i++) {
+			print_dbg_char(textbuf[i]);
+		}
+	}
+	return result;
+}
+
+// the whole buffer has been tokenized, start filling it from the front
+// again. the only text kept is a string or primitive the end of the
+// buffer split, and of a string only what the callback couldn't take.
+static json_read_result_t wrap_textbuf(
+	json_copy_cb copy, void* ram, json_docdef_t* docdef,
+	char* textbuf, size_t textbuf_len) {
+	json_read_state_t* s = &deserialize_state;
+	json_read_result_t result;
+	size_t keep, piece;
+
+	s->head = s->tail = 0;
+	if (s->tok_start < 0) {
+		return JSON_READ_INCOMPLETE;
+	}
+
+	keep = textbuf_len - s->tok_start;
+	if (s->tok_type == JSMN_STRING) {
+		// long values go to the callback a piece at a time. keeping the
+		// piece even means a hex buffer always decodes whole bytes.
+		piece = keep & ~(size_t)1;
+		if (piece > 0) {
+			result = emit_token(JSMN_STRING, s->tok_start, -1,
+					    copy, ram, docdef,
+					    textbuf, s->tok_start + piece);
+			switch (result) {
+			case JSON_READ_KEEP_GOING:
+				s->tok_start += piece;
+				keep -= piece;
+				break;
+			case JSON_READ_INCOMPLETE:
+				break;
+			default:
+				return result;
+			}
+		}
+	}
+	if (keep >= textbuf_len) {
+		print_dbg("\r\n!! token longer than text buffer");
+		return JSON_READ_MALFORMED;
+	}
+
+	if (keep > 0) {
+		memmove(textbuf, textbuf + s->tok_start, keep);
+	}
+	s->tok_start = 0;
+	s->head = s->tail = keep;
+	return JSON_READ_INCOMPLETE;
+}
+
 json_read_result_t json_read(
 	json_gets_cb read, json_copy_cb copy, void* ram,
 	json_docdef_t* docdef,
 	char* textbuf, size_t textbuf_len,
 	jsmntok_t* tokbuf, size_t tokbuf_len)
 {
-	enum jsmnerr jsmn_err;
-	json_read_result_t result = JSON_READ_KEEP_GOING;
-	int keep_ct = 0;
-	jsmntok_t* last_tok;
-	size_t bytes_read = 0;
-	uint32_t total_tokens_read = 0;
-	uint32_t total_bytes_read = 0;
+	json_read_state_t* s = &deserialize_state;
+	json_read_result_t result;
+	size_t bytes_read;
+	char c;
 
 	docdef->fresh = true;
-	memset(textbuf, 0, textbuf_len);
-	deserialize_state.text_ct = textbuf_len;
-	deserialize_state.curr_tok = tokbuf_len;
-	jsmn_init(&deserialize_state.jsmn);
-
-	for (uint8_t i = 0; i < tokbuf_len; i++) {
-		tokbuf[i].start = tokbuf[i].end = 0;
-	}
-
-	while (deserialize_state.text_ct >= 0) {
-		if (deserialize_state.jsmn.pos > textbuf_len) {
-			print_dbg("\r\n!! tokenizer out of bounds");
-			return JSON_READ_MALFORMED;
-		}
-
-		// when a batch of tokens has been processed
-		if (deserialize_state.curr_tok >= deserialize_state.jsmn.toknext) {
-			keep_ct = 0;
-			if (deserialize_state.jsmn.toknext > 0) {
-				last_tok = &tokbuf[deserialize_state.jsmn.toknext - 1];
-				if (result == JSON_READ_KEEP_GOING || last_tok->start == 0) {
-					// if in the middle of a string or buffer value, don't backtrack
-					keep_ct = 0;
-				} else if (last_tok->end < 0) {
-					// if the last token was incomplete, copy the text already read and
-					// try to parse it again
-					keep_ct = deserialize_state.text_ct - last_tok->start;
-				} else {
-					// if the last token was complete, copy everything after it
-					keep_ct = deserialize_state.text_ct - last_tok->end;
-				}
-				if (keep_ct > 0) {
-					memmove(textbuf,
-						textbuf + deserialize_state.text_ct - keep_ct,
-						keep_ct);
+	s->head = s->tail = 0;
+	s->tok_start = -1;
+	s->escape = 0;
+	s->depth = 0;
+	s->arrays = 0;
+	s->skip = JSON_SKIP_NONE;
+	s->skip_in_string = false;
+	s->arena_mark = active_arena != NULL ? active_arena->used : 0;
+	s->total_bytes_read = 0;
+	s->total_tokens_read = 0;
+
+	for (;;) {
+		if (s->head == s->tail) {
+			if (s->tail == textbuf_len) {
+				result = wrap_textbuf(copy, ram, docdef, textbuf, textbuf_len);
+				if (result != JSON_READ_INCOMPLETE) {
+					return read_finished(JSON_READ_MALFORMED);
 				}
-
-				// rewind the parser state so it stays within the fixed buffers.
-				// if we've already partially consumed a string or primitive,
-				// we need to account for that as well.
-				if (deserialize_state.jsmn.string_open) {
-					deserialize_state.jsmn.pos -= deserialize_state.text_ct;
-				}
-				else if (deserialize_state.jsmn.number_open) {
-					deserialize_state.jsmn.pos = 0;
-				}
-				else {
-					deserialize_state.jsmn.pos -= deserialize_state.text_ct - keep_ct;
-				}
-				deserialize_state.jsmn.toknext = 0;
 			}
-
-			// read from stream and tokenize
+			bytes_read = read(textbuf + s->tail, textbuf_len - s->tail);
 #if JSON_DEBUG
 			print_dbg("\r\n> reading, keep ");
-			print_dbg_hex(keep_ct);
-			print_dbg(", request ");
-			print_dbg_hex(textbuf_len - keep_ct);
-#endif
-			bytes_read = read(textbuf + keep_ct, textbuf_len - keep_ct);
-			total_bytes_read += bytes_read;
-#if JSON_DEBUG
+			print_dbg_hex(s->tail);
 			print_dbg(", got ");
 			print_dbg_hex(bytes_read);
 #endif
-			if (bytes_read < 0) {
-#if JSON_DEBUG
-				print_dbg("\r\n!! read error");
-#endif
-				return JSON_READ_MALFORMED;
+			if (bytes_read == 0) {
+				// a primitive can end the stream, nothing else can
+				if (s->tok_start >= 0 && s->tok_type == JSMN_PRIMITIVE) {
+					result = emit_token(JSMN_PRIMITIVE, s->tok_start, s->tail,
+							    copy, ram, docdef, textbuf, s->tail);
+					if (result == JSON_READ_OK) {
+						return read_finished(JSON_READ_OK);
+					}
+				}
+				print_dbg("\r\n!! unexpected EOF");
+				return read_finished(JSON_READ_MALFORMED);
 			}
-			deserialize_state.text_ct = keep_ct + bytes_read;
+			s->tail += bytes_read;
+			s->total_bytes_read += bytes_read;
+		}
 
-			jsmn_err = jsmn_parse(&deserialize_state.jsmn,
-					      textbuf, deserialize_state.text_ct,
-					      tokbuf, tokbuf_len);
-			if (bytes_read == 0) {
-				if (jsmn_err == JSMN_ERROR_PART || (int)jsmn_err == 0) {
-#if JSON_DEBUG
-					print_dbg("\r\n!! unexpected EOF");
-#endif
-					return JSON_READ_MALFORMED;
+		if (s->skip != JSON_SKIP_NONE) {
+			if (s->tok_start >= 0) {
+				// the token in progress is part of what's skipped
+				s->skip_in_string = s->tok_type == JSMN_STRING;
+				s->tok_start = -1;
+			}
+			skip_text(textbuf);
+			continue;
+		}
+
+		c = textbuf[s->head];
+
+		if (s->tok_start >= 0 && s->tok_type == JSMN_STRING) {
+			if (s->escape == JSON_ESCAPE_START) {
+				switch (c) {
+				case '\"': case '/': case '\\': case 'b':
+				case 'f': case 'r': case 'n': case 't':
+					s->escape = 0;
+					break;
+				case 'u':
+					s->escape = 4;
+					break;
+				default:
+					print_dbg("\r\n!! bad escape in string");
+					return read_finished(JSON_READ_MALFORMED);
+				}
+			}
+			else if (s->escape > 0) {
+				if (!is_hex_digit(c)) {
+					print_dbg("\r\n!! bad \\u escape in string");
+					return read_finished(JSON_READ_MALFORMED);
 				}
+				s->escape--;
 			}
-			if ((int)jsmn_err == 0) {
-				deserialize_state.jsmn.pos = 0;
+			else if (c == '\\') {
+				s->escape = JSON_ESCAPE_START;
+			}
+			else if (c == '\"') {
+				result = emit_token(JSMN_STRING, s->tok_start, s->head,
+						    copy, ram, docdef, textbuf, s->tail);
+				s->tok_start = -1;
+				if (result == JSON_READ_OK || result == JSON_READ_MALFORMED) {
+					return read_finished(result);
+				}
+			}
+			s->head++;
+			continue;
+		}
+
+		if (s->tok_start >= 0) {
+			if (!ends_primitive(c)) {
+				if (c < 32 || c >= 127) {
+					print_dbg("\r\n!! bad character in primitive");
+					return read_finished(JSON_READ_MALFORMED);
+				}
+				s->head++;
 				continue;
 			}
-			if ((int)jsmn_err < 0
-			 && jsmn_err != JSMN_ERROR_NOMEM
-			 && jsmn_err != JSMN_ERROR_PART) {
-#if JSON_DEBUG
-				print_dbg("\r\n!! tokenizer error");
-#endif
-				return JSON_READ_MALFORMED;
+			result = emit_token(JSMN_PRIMITIVE, s->tok_start, s->head,
+					    copy, ram, docdef, textbuf, s->tail);
+			s->tok_start = -1;
+			if (result == JSON_READ_OK || result == JSON_READ_MALFORMED) {
+				return read_finished(result);
+			}
+			if (s->skip != JSON_SKIP_NONE) {
+				// the skip decides what the terminator means
+				continue;
 			}
-			deserialize_state.curr_tok = 0;
 		}
 
-		jsmntok_t* tok = &tokbuf[deserialize_state.curr_tok];
-		result = docdef->read(
-			tok,
-			copy, ram, docdef,
-			textbuf, textbuf_len, 0);
-		deserialize_state.curr_tok++;
-		total_tokens_read++;
-		switch (result) {
-		case JSON_READ_KEEP_GOING:
-			continue;
-		case JSON_READ_INCOMPLETE:
-			continue;
-		case JSON_READ_OK:
-			print_dbg("\r\n> OK! total bytes read from disk: ");
-			print_dbg_hex(total_bytes_read);
-			print_dbg("\r\n> total tokens processed: ");
-			print_dbg_hex(total_tokens_read);
-			return JSON_READ_OK;
+		switch (c) {
+		case '{': case '[':
+			if (s->depth >= JSON_READ_MAX_DEPTH) {
+				print_dbg("\r\n!! nesting too deep");
+				return read_finished(JSON_READ_MALFORMED);
+			}
+			if (c == '[') {
+				s->arrays |= (uint32_t)1 << s->depth;
+			}
+			else {
+				s->arrays &= ~((uint32_t)1 << s->depth);
+			}
+			result = emit_token(c == '{' ? JSMN_OBJECT : JSMN_ARRAY, s->head, -1,
+					    copy, ram, docdef, textbuf, s->tail);
+			s->depth++;
+			break;
+		case '}': case ']':
+			if (s->depth == 0
+			 || ((s->arrays >> (s->depth - 1)) & 1) != (c == ']')) {
+				print_dbg("\r\n!! unmatched ");
+				print_dbg_char(c);
+				return read_finished(JSON_READ_MALFORMED);
+			}
+			s->depth--;
+			result = emit_token(c == '}' ? JSMN_OBJECT : JSMN_ARRAY, s->head, s->head + 1,
+					    copy, ram, docdef, textbuf, s->tail);
+			break;
+		case '\"':
+			s->tok_start = s->head + 1;
+			s->tok_type = JSMN_STRING;
+			s->escape = 0;
+			result = JSON_READ_INCOMPLETE;
+			break;
+		case '\t': case '\r': case '\n': case ' ':
+		case ':': case ',':
+			result = JSON_READ_INCOMPLETE;
+			break;
 		default:
-			print_dbg("\r\n> FAILED! total bytes read from disk: ");
-			print_dbg_hex(total_bytes_read);
-			print_dbg("\r\n> total tokens processed: ");
-			print_dbg_hex(total_tokens_read);
-
+			s->tok_start = s->head;
+			s->tok_type = JSMN_PRIMITIVE;
+			result = JSON_READ_INCOMPLETE;
+			break;
+		}
+		if (result == JSON_READ_OK || result == JSON_READ_MALFORMED) {
+			return read_finished(result);
+		}
+		s->head++;
+	}
+}
 
-			print_dbg("\r\nfailed on token type ");
-			print_dbg_hex(tok->type);
-			print_dbg(" that spans ");
-			print_dbg_hex(tok->start);
-			print_dbg(" - ");
-			print_dbg_hex(tok->end);
+//// selective reads
+
+typedef enum {
+	JSON_PATH_OPEN,   // expecting the container the next segment is in
+	JSON_PATH_KEYS,   // looking for the segment's key
+	JSON_PATH_ITEMS,  // counting items up to the segment's index
+	JSON_PATH_VALUE,  // reading the value at the path
+	JSON_PATH_INDEX,  // noting the offsets of the container's items
+} json_path_phase_t;
+
+typedef struct {
+	json_path_phase_t phase;
+	const char* seg;
+	size_t seg_len;
+	uint32_t index;
+	uint32_t item_ct;
+	unsigned int depth;    // depth of the container's items
+	bool keys;
+	json_docdef_t* target;
+	int32_t dst_offset;
+	uint32_t* offsets;
+	size_t offsets_len;
+	size_t offsets_ct;
+} json_path_state_t;
+
+static json_path_state_t path_state;
+
+static bool parse_index(const char* s, size_t len, uint32_t* index) {
+	*index = 0;
+	if (len == 0) {
+		return false;
+	}
+	for (size_t i = 0; i < len; i++) {
+		if (s[i] < '0' || s[i] > '9') {
+			return false;
+		}
+		*index = *index * 10 + (s[i] - '0');
+	}
+	return true;
+}
 
-			print_dbg("\r\n> contents of read buffer:\r\n\r\n");
+static void next_segment(json_path_state_t* p) {
+	const char* s = p->seg + p->seg_len;
+	while (*s == '/') {
+		s++;
+	}
+	p->seg = s;
+	p->seg_len = strcspn(s, "/");
+}
 
-			size_t i;
-			for (i = 0; i < textbuf_len; i++) {
-				print_dbg_char(textbuf[i]);
-			}
-			print_dbg("\r\n");
+// where text at textbuf position pos is in the stream
+static uint32_t stream_offset(int pos) {
+	return deserialize_state.total_bytes_read - (deserialize_state.tail - pos);
+}
 
-			i = 0;
-			if (tok->start > 0) {
-				for (i = 0; i < tok->start; i++) {
-					print_dbg_char(' ');
+static json_read_result_t read_path_step(
+	jsmntok_t* tok,
+	json_copy_cb copy, void* ram, json_docdef_t* docdef,
+	const char* text, size_t text_len, int32_t dst_offset) {
+	json_path_state_t* p = (json_path_state_t*)docdef->state;
+	// open brackets have no end; strings without one are still being read
+	bool partial = tok->type == JSMN_STRING && tok->end < 0;
+	bool open = (tok->type == JSMN_OBJECT || tok->type == JSMN_ARRAY) && tok->end < 0;
+
+	switch (p->phase) {
+	case JSON_PATH_OPEN:
+		if (p->seg_len == 0) {
+			if (p->offsets != NULL) {
+				if (!open) {
+					print_dbg("\r\n!! path to index isn't a container");
+					return JSON_READ_MALFORMED;
 				}
-				print_dbg_char('^');
-				i++;
+				p->keys = tok->type == JSMN_OBJECT;
+				p->depth = tok->depth + 1;
+				p->phase = JSON_PATH_INDEX;
+				return JSON_READ_INCOMPLETE;
 			}
-			for (; i < (tok->end > 0 ? (tok->end - 1) : textbuf_len); i++) {
-				print_dbg_char('-');
+			p->target->fresh = true;
+			p->phase = JSON_PATH_VALUE;
+			return p->target->read(tok, copy, ram, p->target, text, text_len, p->dst_offset);
+		}
+		if (!open) {
+			print_dbg("\r\n!! path leads into a value");
+			return JSON_READ_MALFORMED;
+		}
+		if (tok->type == JSMN_ARRAY) {
+			if (!parse_index(p->seg, p->seg_len, &p->index)) {
+				print_dbg("\r\n!! path has a key where an index goes");
+				return JSON_READ_MALFORMED;
 			}
-			if (tok->end >= 0) {
-				print_dbg_char('^');
+			p->item_ct = 0;
+			p->phase = JSON_PATH_ITEMS;
+		}
+		else {
+			p->phase = JSON_PATH_KEYS;
+		}
+		p->depth = tok->depth + 1;
+		return JSON_READ_INCOMPLETE;
+	case JSON_PATH_KEYS:
+		if (tok->depth < p->depth) {
+			print_dbg("\r\n!! path not found");
+			return JSON_READ_MALFORMED;
+		}
+		if (tok->type != JSMN_STRING) {
+			print_dbg("\r\n!! bad token type for object name match: ");
+			print_dbg_hex(tok->type);
+			return JSON_READ_MALFORMED;
+		}
+		if (partial) {
+			return JSON_READ_INCOMPLETE;
+		}
+		if (tok->end - tok->start == p->seg_len
+		 && strncmp(text + tok->start, p->seg, p->seg_len) == 0) {
+			next_segment(p);
+			p->phase = JSON_PATH_OPEN;
+			return JSON_READ_INCOMPLETE;
+		}
+		json_read_skip(JSON_SKIP_VALUE, p->depth);
+		return JSON_READ_INCOMPLETE;
+	case JSON_PATH_ITEMS:
+		if (tok->depth < p->depth) {
+			print_dbg("\r\n!! path not found");
+			return JSON_READ_MALFORMED;
+		}
+		if (partial) {
+			return JSON_READ_INCOMPLETE;
+		}
+		if (p->item_ct < p->index) {
+			p->item_ct++;
+			json_read_skip(JSON_SKIP_VALUE, p->depth);
+			return JSON_READ_INCOMPLETE;
+		}
+		// this token starts the item
+		next_segment(p);
+		p->phase = JSON_PATH_OPEN;
+		return read_path_step(tok, copy, ram, docdef, text, text_len, dst_offset);
+	case JSON_PATH_VALUE:
+		return p->target->read(tok, copy, ram, p->target, text, text_len, p->dst_offset);
+	case JSON_PATH_INDEX:
+		if (tok->depth < p->depth || p->offsets_ct == p->offsets_len) {
+			return JSON_READ_OK;
+		}
+		if (partial) {
+			return JSON_READ_INCOMPLETE;
+		}
+		if (p->keys) {
+			if (tok->type != JSMN_STRING) {
+				print_dbg("\r\n!! bad token type for object name match: ");
+				print_dbg_hex(tok->type);
+				return JSON_READ_MALFORMED;
 			}
-			print_dbg("\r\n\r\n");
+			// just past the name; reading from there skips the ':'
+			p->offsets[p->offsets_ct++] = stream_offset(tok->end + 1);
+		}
+		else {
+			p->offsets[p->offsets_ct++] = stream_offset(tok->start);
+		}
+		json_read_skip(JSON_SKIP_VALUE, p->depth);
+		return JSON_READ_INCOMPLETE;
+	default:
+		return JSON_READ_MALFORMED;
+	}
+}
+
+static json_read_result_t read_path(
+	json_gets_cb read, json_copy_cb copy,
+	void* ram, json_docdef_t* docdef,
+	const char* path, bool at_value,
+	uint32_t* offsets, size_t offsets_len,
+	char* textbuf, size_t textbuf_len) {
+	json_docdef_t path_docdef = {
+		.read = read_path_step,
+		.state = &path_state,
+	};
+	json_read_result_t result;
+
+	memset(&path_state, 0, sizeof(path_state));
+	path_state.phase = JSON_PATH_OPEN;
+	path_state.seg = path;
+	next_segment(&path_state);
+	if (at_value) {
+		path_state.seg_len = 0;
+	}
+	path_state.offsets = offsets;
+	path_state.offsets_len = offsets_len;
+	if (docdef != NULL) {
+		path_state.target = json_docdef_find_path(docdef, path, &path_state.dst_offset);
+		if (path_state.target == NULL) {
+			print_dbg("\r\n!! no docdef for path: ");
+			print_dbg(path);
 			return JSON_READ_MALFORMED;
 		}
 	}
-	return JSON_READ_MALFORMED;
+
+	result = json_read(read, copy, ram, &path_docdef, textbuf, textbuf_len, NULL, 0);
+	return result;
+}
+
+json_read_result_t json_read_path(
+	json_gets_cb read, json_copy_cb copy,
+	void* ram, json_docdef_t* docdef,
+	const char* path,
+	char* textbuf, size_t textbuf_len) {
+	return read_path(read, copy, ram, docdef, path, false, NULL, 0, textbuf, textbuf_len);
+}
+
+json_read_result_t json_read_path_at(
+	json_gets_cb read, json_copy_cb copy,
+	void* ram, json_docdef_t* docdef,
+	const char* path,
+	char* textbuf, size_t textbuf_len) {
+	return read_path(read, copy, ram, docdef, path, true, NULL, 0, textbuf, textbuf_len);
+}
+
+json_read_result_t json_index_path(
+	json_gets_cb read, const char* path,
+	uint32_t* offsets, size_t offsets_len,
+	size_t* offsets_ct,
+	char* textbuf, size_t textbuf_len) {
+	json_read_result_t result = read_path(
+		read, NULL, NULL, NULL, path, false,
+		offsets, offsets_len, textbuf, textbuf_len);
+	*offsets_ct = path_state.offsets_ct;
+	return result;
 }
 
 json_write_result_t json_write(
@@ -890,12 +1385,208 @@ json_write_result_t json_write(
 	return ret;
 }
 
+static json_puts_buffer_t* active_puts_buffer;
+
+bool json_puts_buffer_init(json_puts_buffer_t* b, json_puts_cb write,
+			   char* buf, size_t buf_len) {
+	if (buf_len == 0) {
+		print_dbg("\r\n!! zero length write buffer");
+		return false;
+	}
+	b->write = write;
+	b->buf = buf;
+	b->buf_len = buf_len;
+	b->pos = 0;
+	active_puts_buffer = b;
+	return true;
+}
+
+void json_puts_buffered(const char* src, size_t len) {
+	json_puts_buffer_t* b = active_puts_buffer;
+	size_t n;
+
+	while (len > 0) {
+		// whole blocks go straight through when nothing is pending,
+		// which keeps every write block aligned
+		if (b->pos == 0 && len >= b->buf_len) {
+			n = len - len % b->buf_len;
+			b->write(src, n);
+			src += n;
+			len -= n;
+			continue;
+		}
+		n = b->buf_len - b->pos;
+		if (n > len) {
+			n = len;
+		}
+		memcpy(b->buf + b->pos, src, n);
+		b->pos += n;
+		src += n;
+		len -= n;
+		if (b->pos == b->buf_len) {
+			b->write(b->buf, b->buf_len);
+			b->pos = 0;
+		}
+	}
+}
+
+void json_puts_buffer_flush(json_puts_buffer_t* b) {
+	if (b->pos > 0) {
+		b->write(b->buf, b->pos);
+		b->pos = 0;
+	}
+}
+
+json_write_result_t json_write_buffered(json_puts_cb write,
+					char* buf, size_t buf_len,
+					void* ram, json_docdef_t* docdef) {
+	json_puts_buffer_t* prev = active_puts_buffer;
+	json_puts_buffer_t b;
+	json_write_result_t ret;
+
+	if (!json_puts_buffer_init(&b, write, buf, buf_len)) {
+		return JSON_WRITE_ERROR;
+	}
+	ret = json_write(json_puts_buffered, ram, docdef);
+	json_puts_buffer_flush(&b);
+	active_puts_buffer = prev;
+	return ret;
+}
+
+// strcmp against a name that isn't NUL terminated, and may hold a NUL
+static int key_cmp(const char* key, const char* name, size_t len) {
+	size_t i;
+	for (i = 0; i < len && key[i] != 0; i++) {
+		if (key[i] != name[i]) {
+			return (uint8_t)key[i] - (uint8_t)name[i];
+		}
+	}
+	if (i < len) {
+		return -1;
+	}
+	return key[i] != 0;
+}
+
+static json_docdef_t* find_key(const json_read_object_params_t* params,
+			       const char* name, size_t len, bool with_skipped) {
+	json_docdef_t* d;
+
+	if (params->key_index == NULL) {
+		for (int i = 0; i < params->docdef_ct; i++) {
+			d = &params->docdefs[i];
+			if (key_cmp(d->name, name, len) == 0 && (with_skipped || !d->skip)) {
+				return d;
+			}
+		}
+		return NULL;
+	}
+
+	// lower bound, then walk the run of equal names in declaration order
+	int lo = 0, hi = params->docdef_ct;
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+		if (key_cmp(params->docdefs[params->key_index[mid]].name, name, len) < 0) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	for (; lo < params->docdef_ct; lo++) {
+		d = &params->docdefs[params->key_index[lo]];
+		if (key_cmp(d->name, name, len) != 0) {
+			break;
+		}
+		if (with_skipped || !d->skip) {
+			return d;
+		}
+	}
+	return NULL;
+}
+
 json_docdef_t* json_docdef_find_key(json_docdef_t* object_docdef, const char* name) {
 	const json_read_object_params_t* params = (json_read_object_params_t*)object_docdef->params;
-	for (int i = 0; i < params->docdef_ct; i++) {
-		if (strcmp(params->docdefs[i].name, name) == 0) {
-			return &params->docdefs[i];
+	return find_key(params, name, strlen(name), true);
+}
+
+json_docdef_t* json_docdef_find_key_len(json_docdef_t* object_docdef, const char* name, size_t len) {
+	const json_read_object_params_t* params = (json_read_object_params_t*)object_docdef->params;
+	return find_key(params, name, len, false);
+}
+
+json_docdef_t* json_docdef_find_path(json_docdef_t* docdef, const char* path, int32_t* dst_offset) {
+	json_read_array_params_t* array_params;
+	uint32_t index;
+	size_t len;
+
+	*dst_offset = 0;
+	for (;;) {
+		while (*path == '/') {
+			path++;
+		}
+		if (*path == 0) {
+			return docdef;
+		}
+		len = strcspn(path, "/");
+		if (docdef->read == json_read_array) {
+			array_params = (json_read_array_params_t*)docdef->params;
+			if (!parse_index(path, len, &index) || index >= array_params->array_len) {
+				return NULL;
+			}
+			*dst_offset += index * array_params->item_size;
+			docdef = array_params->item_docdef;
+		}
+		else if (docdef->read == json_read_object || docdef->read == json_read_object_cached) {
+			docdef = json_docdef_find_key_len(docdef, path, len);
+			if (docdef == NULL) {
+				return NULL;
+			}
+		}
+		else {
+			return NULL;
 		}
+		path += len;
 	}
-	return NULL;
+}
+
+static size_t index_keys(json_docdef_t* docdef, uint8_t** pool, size_t* pool_len) {
+	size_t used = 0;
+
+	if (docdef->read == json_read_array) {
+		json_read_array_params_t* params = (json_read_array_params_t*)docdef->params;
+		return index_keys(params->item_docdef, pool, pool_len);
+	}
+	if (docdef->read != json_read_object && docdef->read != json_read_object_cached) {
+		return 0;
+	}
+
+	json_read_object_params_t* params = (json_read_object_params_t*)docdef->params;
+	// shared item docdefs only need indexing once
+	if (params->key_index == NULL) {
+		used = params->docdef_ct;
+		if (*pool != NULL && used <= *pool_len) {
+			uint8_t* order = *pool;
+			// insertion sort; stable, so duplicate names keep their order
+			for (uint8_t i = 0; i < params->docdef_ct; i++) {
+				uint8_t j = i;
+				while (j > 0 && strcmp(params->docdefs[order[j - 1]].name,
+						       params->docdefs[i].name) > 0) {
+					order[j] = order[j - 1];
+					j--;
+				}
+				order[j] = i;
+			}
+			params->key_index = order;
+			*pool += used;
+			*pool_len -= used;
+		}
+	}
+
+	for (uint8_t i = 0; i < params->docdef_ct; i++) {
+		used += index_keys(&params->docdefs[i], pool, pool_len);
+	}
+	return used;
+}
+
+size_t json_docdef_index(json_docdef_t* docdef, uint8_t* pool, size_t pool_len) {
+	return index_keys(docdef, &pool, &pool_len);
 }
@@ -38,6 +38,11 @@
 
 void nop_free(void* ptr);
 
+// or, for any number of cached objects nested at once:
+//    .alloc = json_arena_alloc,
+//    .free = json_arena_free,
+// with an arena of json_arena_size(&docdef) set up before reading
+
 
 //// error codes
 typedef enum {
@@ -70,6 +75,9 @@ struct json_docdef_t;
 //   copy - will be called to load data from the json stream into the
 //          destination address
 //   ram - pointer to the destination struct
+//   textbuf - any size that fits the longest key or number; string
+//          values longer than it are read in pieces
+//   tokbuf - no longer used, tokens go straight to the docdef
 json_read_result_t json_read(json_gets_cb read,
 			     json_copy_cb copy,
 			     void* ram, struct json_docdef_t* docdef,
@@ -134,6 +142,10 @@ typedef struct {
         size_t dst_size;
         json_alloc_cb alloc;
         json_free_cb free;
+	// optional: docdef positions in name order, for binary search on
+	// property names. filled in by json_docdef_index() or generated by
+	// docdef_gen.py; NULL scans
+	const uint8_t* key_index;
 } json_read_object_params_t;
 
 typedef enum {
@@ -259,12 +271,130 @@ json_write_result_t json_write_constant_string(
 
 // top-level parser state
 // will be initialized during json_read call
+//
+// json_read tokenizes each byte of textbuf once, handing tokens to the
+// docdef callbacks as it finds them. when the buffer is full it wraps
+// around to the front, keeping only a string or primitive that was split
+// by the end of the buffer.
+#define JSON_READ_MAX_DEPTH 32
+#define JSON_ESCAPE_START 0xff
+
+typedef enum {
+	JSON_SKIP_NONE,
+	JSON_SKIP_VALUE, // up to the ',' or closing bracket after the next value
+	JSON_SKIP_REST,  // up to the bracket closing the container
+} json_read_skip_t;
+
 typedef struct {
-	jsmn_parser jsmn;
-	size_t text_ct;
-	unsigned int curr_tok;
+	size_t head;         // next byte to tokenize
+	size_t tail;         // end of the text read so far
+	int tok_start;       // start of the string or primitive in progress, or -1
+	jsmntype_t tok_type;
+	uint8_t escape;      // escape sequence bytes left to check
+	unsigned int depth;
+	uint32_t arrays;     // bit per nesting level, set for arrays
+	json_read_skip_t skip;
+	unsigned int skip_depth;
+	bool skip_in_string;
+	size_t arena_mark;   // arena use when the read started
+	uint32_t total_bytes_read;
+	uint32_t total_tokens_read;
 } json_read_state_t;
 
+// for read callbacks: have json_read pass over text without tokenizing
+// it, only counting brackets until the container whose items are at
+// depth ends, or with JSON_SKIP_VALUE until its next item does. used for
+// unknown keys and array items past the end of the destination.
+void json_read_skip(json_read_skip_t mode, unsigned int depth);
+
+
+// selective reads, for e.g. one preset slot out of a file of many.
+// paths are keys and array indexes separated by '/', as in "slots/3".
+// text before the value is skipped without being tokenized, and reading
+// stops as soon as the value has been read.
+json_read_result_t json_read_path(json_gets_cb read, json_copy_cb copy,
+				  void* ram, struct json_docdef_t* docdef,
+				  const char* path,
+				  char* textbuf, size_t textbuf_len);
+
+// the same, with the stream already at the value's offset from a sidecar
+// index built by json_index_path
+json_read_result_t json_read_path_at(json_gets_cb read, json_copy_cb copy,
+				     void* ram, struct json_docdef_t* docdef,
+				     const char* path,
+				     char* textbuf, size_t textbuf_len);
+
+// build a sidecar index for the container at path: the stream offset of
+// each of its first offsets_len items, or for an object of each key's
+// value in document order. *offsets_ct is set to how many were found.
+json_read_result_t json_index_path(json_gets_cb read, const char* path,
+				   uint32_t* offsets, size_t offsets_len,
+				   size_t* offsets_ct,
+				   char* textbuf, size_t textbuf_len);
+
+
+// buffered output: collects the small writes the serializer makes and
+// hands the underlying writer whole blocks, so e.g. a 512 byte buffer
+// writes a file a sector at a time. json_puts_cb takes no context, so
+// json_puts_buffered feeds whichever buffer was initialized last.
+typedef struct {
+	json_puts_cb write;
+	char* buf;
+	size_t buf_len;
+	size_t pos;
+} json_puts_buffer_t;
+
+// false, leaving the active buffer as it was, if buf_len is 0
+bool json_puts_buffer_init(json_puts_buffer_t* b, json_puts_cb write,
+			   char* buf, size_t buf_len);
+void json_puts_buffered(const char* src, size_t len);
+// write out whatever is left; call once after the last write
+void json_puts_buffer_flush(json_puts_buffer_t* b);
+
+// json_write through a buffer, flushed before returning. a buffer the
+// caller had active is active again afterwards
+json_write_result_t json_write_buffered(json_puts_cb write,
+					char* buf, size_t buf_len,
+					void* ram, struct json_docdef_t* docdef);
+
+
+// arena allocation for cached objects: a bump allocator over a buffer
+// the app sets aside once, so cached objects can nest and share types
+// without heap or a static cache each. json_alloc_cb takes no context,
+// so json_arena_alloc uses whichever arena was initialized last.
+//
+// frees release the newest allocation, which is the order the readers
+// make them in; a read session returns the arena to where it started
+// when it finishes, so whatever a malformed document left allocated is
+// rolled back with it.
+#define JSON_ARENA_ALIGN(size) (((size) + 3) & ~(size_t)3)
+#define JSON_ARENA_MAX(a, b) ((a) > (b) ? (a) : (b))
+
+typedef struct {
+	uint8_t* buf;
+	size_t len;
+	size_t used;
+	size_t peak;         // most used at once, for sizing
+} json_arena_t;
+
+void json_arena_init(json_arena_t* arena, void* buf, size_t len);
+void* json_arena_alloc(size_t size);
+void json_arena_free(void* ptr);
+// the most the cached objects under docdef hold at once; the arena
+// needs this plus up to 3 bytes if buf isn't word aligned
+size_t json_arena_size(struct json_docdef_t* docdef);
+
 
 // helpers for visiting docdefs
 json_docdef_t* json_docdef_find_key(json_docdef_t* object_docdef, const char* name);
+// name need not be NUL terminated; skipped docdefs are passed over
+json_docdef_t* json_docdef_find_key_len(json_docdef_t* object_docdef, const char* name, size_t len);
+// the docdef reading the value at path, and the dst_offset it reads
+// with; NULL if the path leaves the docdef tree
+json_docdef_t* json_docdef_find_path(json_docdef_t* docdef, const char* path, int32_t* dst_offset);
+
+// sort the keys of every object under docdef into pool, once at startup,
+// so reading matches property names by binary search instead of
+// comparing against every docdef. returns the bytes a full index needs;
+// pass pool = NULL to size it. objects that don't fit keep scanning.
+size_t json_docdef_index(json_docdef_t* docdef, uint8_t* pool, size_t pool_len);
@@ -18,6 +18,7 @@ extern "C"
 # endif
 #endif
 
+#include <stddef.h>
 #include <stdint.h>
 
 typedef int32_t fix16_t;
@@ -161,6 +162,66 @@ extern fix16_t fix16_sqrt(fix16_t inValue) FIXMATH_FUNC_ATTRS;
 */
 extern fix16_t fix16_exp(fix16_t inValue) FIXMATH_FUNC_ATTRS;
 
+
+
+/* Batch kernels: the same results as calling the scalar function on each
+ * element, without a call per element. dst may alias a source array.
+ * Define FIXMATH_BATCH_VECTOR to use GCC vector extensions (host builds).
+ */
+
+/*! dst[i] = fix16_mul(a[i], b[i])
+*/
+extern void fix16_mul_n(fix16_t *dst, const fix16_t *a, const fix16_t *b, size_t n);
+
+/*! dst[i] = fix16_mul(a[i], k)
+*/
+extern void fix16_scale_n(fix16_t *dst, const fix16_t *a, fix16_t k, size_t n);
+
+/*! dst[i] = fix16_lerp16(a[i], b[i], inFract)
+*/
+extern void fix16_lerp_n(fix16_t *dst, const fix16_t *a, const fix16_t *b, uint16_t inFract, size_t n);
+
+/*! dst[i] = fix16_sin(a[i])
+*/
+extern void fix16_sin_n(fix16_t *dst, const fix16_t *a, size_t n);
+
+#ifndef FIXMATH_NO_OVERFLOW
+/*! dst[i] = fix16_sadd(a[i], b[i])
+*/
+extern void fix16_sadd_n(fix16_t *dst, const fix16_t *a, const fix16_t *b, size_t n);
+#endif
+
+
+
+/* Fast interpolated transcendentals. FIXMATH_FAST_BITS (8, 12 or 16) sets
+ * the accuracy at compile time: sin, cos and log2 are within 2^-bits
+ * absolute, pow2 and exp within 2^-bits relative, give or take an lsb.
+ * The tables cost 200 bytes at 8 bits, 780 at 12 and 3 KB at 16.
+ */
+#ifndef FIXMATH_FAST_BITS
+#define FIXMATH_FAST_BITS 12
+#endif
+
+/*! Returns the sine of the given angle in radians.
+*/
+extern fix16_t fix16_sin_fast(fix16_t inAngle) FIXMATH_FUNC_ATTRS;
+
+/*! Returns the cosine of the given angle in radians.
+*/
+extern fix16_t fix16_cos_fast(fix16_t inAngle) FIXMATH_FUNC_ATTRS;
+
+/*! Returns 2^x, saturating to fix16_max.
+*/
+extern fix16_t fix16_pow2_fast(fix16_t inValue) FIXMATH_FUNC_ATTRS;
+
+/*! Returns log2(x), or fix16_min for x <= 0.
+*/
+extern fix16_t fix16_log2_fast(fix16_t inValue) FIXMATH_FUNC_ATTRS;
+
+/*! Returns e^x, saturating to fix16_max.
+*/
+extern fix16_t fix16_exp_fast(fix16_t inValue) FIXMATH_FUNC_ATTRS;
+
 #ifdef __cplusplus
 }
 #include "fix16.hpp"
@@ -0,0 +1,158 @@
+#include "fix16.h"
+#include "int64.h"
+
+/* Batch versions of the scalar kernels. Each produces exactly what the
+ * scalar function would for every element; the win is dropping the call,
+ * and for sin the cache lookup, per element.
+ */
+
+#if !defined(FIXMATH_NO_64BIT) && !defined(FIXMATH_OPTIMIZE_8BIT)
+/* Inline copy of the 64-bit fix16_mul. */
+static inline fix16_t fix16_mul_inline(fix16_t inArg0, fix16_t inArg1)
+{
+  int64_t product = (int64_t)inArg0 * inArg1;
+
+  #ifndef FIXMATH_NO_OVERFLOW
+  uint32_t upper = (product >> 47);
+  #endif
+
+  if (product < 0)
+  {
+    #ifndef FIXMATH_NO_OVERFLOW
+    if (~upper)
+        return fix16_overflow;
+    #endif
+
+    #ifndef FIXMATH_NO_ROUNDING
+    product--;
+    #endif
+  }
+  else
+  {
+    #ifndef FIXMATH_NO_OVERFLOW
+    if (upper)
+        return fix16_overflow;
+    #endif
+  }
+
+  #ifdef FIXMATH_NO_ROUNDING
+  return product >> 16;
+  #else
+  fix16_t result = product >> 16;
+  result += (product & 0x8000) >> 15;
+  return result;
+  #endif
+}
+#else
+#define fix16_mul_inline fix16_mul
+#endif
+
+#if defined(FIXMATH_BATCH_VECTOR) && defined(__GNUC__)
+typedef int32_t fix16_v4_t __attribute__((vector_size(16)));
+
+static inline fix16_v4_t fix16_v4_load(const fix16_t *p)
+{
+  fix16_v4_t v;
+  __builtin_memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline void fix16_v4_store(fix16_t *p, fix16_v4_t v)
+{
+  __builtin_memcpy(p, &v, sizeof(v));
+}
+#endif
+
+void fix16_mul_n(fix16_t *dst, const fix16_t *a, const fix16_t *b, size_t n)
+{
+  size_t i;
+  for (i = 0; i < n; i++)
+    dst[i] = fix16_mul_inline(a[i], b[i]);
+}
+
+void fix16_scale_n(fix16_t *dst, const fix16_t *a, fix16_t k, size_t n)
+{
+  size_t i;
+  for (i = 0; i < n; i++)
+    dst[i] = fix16_mul_inline(a[i], k);
+}
+
+void fix16_lerp_n(fix16_t *dst, const fix16_t *a, const fix16_t *b, uint16_t inFract, size_t n)
+{
+  size_t i;
+#ifndef FIXMATH_NO_64BIT
+  int64_t f0 = (1 << 16) - inFract, f1 = inFract;
+  for (i = 0; i < n; i++)
+    dst[i] = (fix16_t)((a[i] * f0 + b[i] * f1) >> 16);
+#else
+  for (i = 0; i < n; i++)
+    dst[i] = fix16_lerp16(a[i], b[i], inFract);
+#endif
+}
+
+void fix16_sin_n(fix16_t *dst, const fix16_t *a, size_t n)
+{
+  size_t i;
+#if defined(FIXMATH_SIN_LUT) || defined(FIXMATH_FAST_SIN)
+  for (i = 0; i < n; i++)
+    dst[i] = fix16_sin(a[i]);
+#else
+  /* same reduction and series as fix16_sin, minus its cache */
+  fix16_t x, x2, out;
+  for (i = 0; i < n; i++)
+  {
+    x = a[i] % (fix16_pi << 1);
+    if (x > fix16_pi)
+      x -= (fix16_pi << 1);
+    else if (x < -fix16_pi)
+      x += (fix16_pi << 1);
+
+    x2 = fix16_mul_inline(x, x);
+    out = x;
+    x = fix16_mul_inline(x, x2);
+    out -= (x / 6);
+    x = fix16_mul_inline(x, x2);
+    out += (x / 120);
+    x = fix16_mul_inline(x, x2);
+    out -= (x / 5040);
+    x = fix16_mul_inline(x, x2);
+    out += (x / 362880);
+    x = fix16_mul_inline(x, x2);
+    out -= (x / 39916800);
+    dst[i] = out;
+  }
+#endif
+}
+
+#ifndef FIXMATH_NO_OVERFLOW
+void fix16_sadd_n(fix16_t *dst, const fix16_t *a, const fix16_t *b, size_t n)
+{
+  size_t i = 0;
+
+#if defined(FIXMATH_BATCH_VECTOR) && defined(__GNUC__)
+  /* overflow only when a and b share a sign the sum doesn't; saturate
+   * toward a's sign */
+  for (; i + 4 <= n; i += 4)
+  {
+    fix16_v4_t va = fix16_v4_load(a + i);
+    fix16_v4_t vb = fix16_v4_load(b + i);
+    fix16_v4_t sum = (fix16_v4_t)((uint32_t __attribute__((vector_size(16))))va +
+                                  (uint32_t __attribute__((vector_size(16))))vb);
+    fix16_v4_t over = (~(va ^ vb) & (va ^ sum)) >> 31;
+    fix16_v4_t sat = (va >> 31) ^ fix16_max;
+    fix16_v4_store(dst + i, (sum & ~over) | (sat & over));
+  }
+#endif
+
+  for (; i < n; i++)
+  {
+    uint32_t _a = a[i], _b = b[i];
+    uint32_t sum = _a + _b;
+
+    if (!((_a ^ _b) & 0x80000000) && ((_a ^ sum) & 0x80000000))
+      dst[i] = (a[i] > 0) ? fix16_max : fix16_min;
+    else
+      dst[i] = sum;
+  }
+}
+#endif
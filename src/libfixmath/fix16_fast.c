@@ -0,0 +1,107 @@
+#include "fix16.h"
+#include "fix16_fast_lut.h"
+
+/* Table driven transcendentals. Each function looks up a segment of a
+ * 2.30 table and interpolates linearly inside it; FIXMATH_FAST_BITS picks
+ * the table size, and with it the accuracy. Nothing here divides or loops.
+ */
+
+#define LUT_SHIFT (32 - FIX16_FAST_LUT_BITS)
+
+/* Interpolate a table at a 32-bit position: the top bits pick the segment,
+ * the next 16 the distance into it. Returns 2.30. */
+static inline uint32_t lut_interp(const uint32_t *lut, uint32_t pos)
+{
+  uint32_t i = pos >> LUT_SHIFT;
+  uint32_t t = (pos >> (LUT_SHIFT - 16)) & 0xffff;
+  int32_t d = (int32_t)(lut[i + 1] - lut[i]);
+
+  return lut[i] + (int32_t)(((int64_t)d * t) >> 16);
+}
+
+/* 2.30 to 16.16, rounded */
+static inline fix16_t lut_round(uint32_t v)
+{
+  return (fix16_t)((v + (1 << 13)) >> 14);
+}
+
+/* sin of a phase where 2^32 is a full turn */
+static fix16_t fix16_sin_phase(uint32_t phase)
+{
+  uint32_t q = phase << 2;
+  uint32_t v;
+
+  /* the second and fourth quadrants run the table backwards */
+  if (phase & 0x40000000)
+    q = -q;
+
+  if (q == 0)
+    v = (phase & 0x40000000) ? (1 << 30) : 0;
+  else
+    v = lut_interp(_fix16_fast_sin_lut, q);
+
+  return (phase & 0x80000000) ? -lut_round(v) : lut_round(v);
+}
+
+/* radians to phase: 2^32 / (2 * pi) in 16.16 */
+#define PHASE_PER_RADIAN 683565276
+
+fix16_t fix16_sin_fast(fix16_t inAngle)
+{
+  return fix16_sin_phase((uint32_t)(((int64_t)inAngle * PHASE_PER_RADIAN) >> 16));
+}
+
+fix16_t fix16_cos_fast(fix16_t inAngle)
+{
+  return fix16_sin_phase((uint32_t)(((int64_t)inAngle * PHASE_PER_RADIAN) >> 16) + 0x40000000);
+}
+
+fix16_t fix16_pow2_fast(fix16_t inValue)
+{
+  int32_t n = inValue >> 16;
+  uint32_t v;
+  int32_t shift;
+
+  /* 2^15 doesn't fit, 2^-17 rounds to zero */
+  if (n >= 15)
+    return fix16_max;
+  if (n < -17)
+    return 0;
+
+  v = lut_interp(_fix16_fast_pow2_lut, (uint32_t)inValue << 16);
+
+  shift = 14 - n;
+  if (shift <= 0)
+    return (fix16_t)(v << -shift);
+  return (fix16_t)((v + (1 << (shift - 1))) >> shift);
+}
+
+fix16_t fix16_log2_fast(fix16_t inValue)
+{
+  int32_t p;
+  uint32_t v;
+
+  if (inValue <= 0)
+    return fix16_min;
+
+  /* inValue = 2^p * 1.m, with m left aligned in 32 bits */
+  p = 31 - __builtin_clz(inValue);
+  v = p ? lut_interp(_fix16_fast_log2_lut, (uint32_t)inValue << (32 - p)) : 0;
+
+  return (p - 16) * fix16_one + lut_round(v);
+}
+
+/* log2(e) in 2.30 */
+#define LOG2_E 1549082005
+
+fix16_t fix16_exp_fast(fix16_t inValue)
+{
+  /* ln(2^15) and ln(2^-17): past these pow2 saturates anyway, and the
+   * product below could overflow */
+  if (inValue >= 681391)
+    return fix16_max;
+  if (inValue <= -772243)
+    return 0;
+
+  return fix16_pow2_fast((fix16_t)(((int64_t)inValue * LOG2_E) >> 30));
+}
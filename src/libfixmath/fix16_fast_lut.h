@@ -0,0 +1,226 @@
+#ifndef __fix16_fast_lut_h__
+#define __fix16_fast_lut_h__
+
+/* Tables for fix16_fast.c, all 2.30 fixed point with one extra entry for
+ * interpolating the last segment. Generated with:
+ *
+ *   for bits, n in ((8, 16), (12, 64), (16, 256)):
+ *       sin  = [round(math.sin(i * math.pi / 2 / n) * 2**30) for i in range(n + 1)]
+ *       pow2 = [round(2 ** (i / n) * 2**30) for i in range(n + 1)]
+ *       log2 = [round(math.log2(1 + i / n) * 2**30) for i in range(n + 1)]
+ */
+#if FIXMATH_FAST_BITS == 8
+
+#define FIX16_FAST_LUT_BITS 4
+
+static const uint32_t _fix16_fast_sin_lut[17] = {
+	0x00000000, 0x0645E9AF, 0x0C7C5C1E, 0x1294062F, 0x187DE2A7, 0x1E2B5D38,
+	0x238E7673, 0x2899E64A, 0x2D413CCD, 0x317900D6, 0x3536CC52, 0x387165E3,
+	0x3B20D79E, 0x3D3E82AE, 0x3EC52FA0, 0x3FB11B48, 0x40000000,
+};
+
+static const uint32_t _fix16_fast_pow2_lut[17] = {
+	0x40000000, 0x42D561B4, 0x45CAE0F2, 0x48E1E9BA, 0x4C1BF829, 0x4F7A9930,
+	0x52FF6B55, 0x56AC1F75, 0x5A82799A, 0x5E8451D0, 0x62B39509, 0x6712460B,
+	0x6BA27E65, 0x70666F76, 0x75606374, 0x7A92BE8B, 0x80000000,
+};
+
+static const uint32_t _fix16_fast_log2_lut[17] = {
+	0x00000000, 0x0598FDBF, 0x0AE00D1D, 0x0FDE0B5D, 0x149A784C, 0x191BBA89,
+	0x1D6753E0, 0x21820A02, 0x2570068E, 0x2934F098, 0x2CD4011D, 0x305013AB,
+	0x33ABB3FB, 0x36E9291F, 0x3A0A7EDA, 0x3D118D67, 0x40000000,
+};
+
+#elif FIXMATH_FAST_BITS == 12
+
+#define FIX16_FAST_LUT_BITS 6
+
+static const uint32_t _fix16_fast_sin_lut[65] = {
+	0x00000000, 0x0192155F, 0x0323ECBE, 0x04B54825, 0x0645E9AF, 0x07D59396,
+	0x09640837, 0x0AF10A22, 0x0C7C5C1E, 0x0E05C135, 0x0F8CFCBE, 0x1111D263,
+	0x1294062F, 0x14135C94, 0x158F9A76, 0x17088531, 0x187DE2A7, 0x19EF7944,
+	0x1B5D100A, 0x1CC66E99, 0x1E2B5D38, 0x1F8BA4DC, 0x20E70F32, 0x223D66A8,
+	0x238E7673, 0x24DA0A9A, 0x261FEFFA, 0x275FF452, 0x2899E64A, 0x29CD9578,
+	0x2AFAD269, 0x2C216EAA, 0x2D413CCD, 0x2E5A1070, 0x2F6BBE45, 0x30761C18,
+	0x317900D6, 0x32744493, 0x3367C090, 0x34534F41, 0x3536CC52, 0x361214B0,
+	0x36E5068A, 0x37AF8159, 0x387165E3, 0x392A9642, 0x39DAF5E8, 0x3A8269A3,
+	0x3B20D79E, 0x3BB6276E, 0x3C42420A, 0x3CC511D9, 0x3D3E82AE, 0x3DAE81CF,
+	0x3E14FDF7, 0x3E71E759, 0x3EC52FA0, 0x3F0EC9F5, 0x3F4EAAFE, 0x3F84C8E2,
+	0x3FB11B48, 0x3FD39B5A, 0x3FEC43C7, 0x3FFB10C1, 0x40000000,
+};
+
+static const uint32_t _fix16_fast_pow2_lut[65] = {
+	0x40000000, 0x40B268FA, 0x4166C34C, 0x421D1462, 0x42D561B4, 0x438FB0CB,
+	0x444C0740, 0x450A6ABB, 0x45CAE0F2, 0x468D6FAE, 0x47521CC6, 0x4818EE22,
+	0x48E1E9BA, 0x49AD1598, 0x4A7A77D4, 0x4B4A169C, 0x4C1BF829, 0x4CF022CA,
+	0x4DC69CDD, 0x4E9F6CD4, 0x4F7A9930, 0x50582888, 0x51382182, 0x521A8AD7,
+	0x52FF6B55, 0x53E6C9DA, 0x54D0AD5A, 0x55BD1CDB, 0x56AC1F75, 0x579DBC57,
+	0x5891FAC1, 0x5988E209, 0x5A82799A, 0x5B7EC8F2, 0x5C7DD7A4, 0x5D7FAD59,
+	0x5E8451D0, 0x5F8BCCDB, 0x60962665, 0x61A3666D, 0x62B39509, 0x63C6BA64,
+	0x64DCDEC3, 0x65F60A7F, 0x6712460B, 0x683199ED, 0x69540EC9, 0x6A79AD56,
+	0x6BA27E65, 0x6CCE8AE1, 0x6DFDDBCC, 0x6F307A41, 0x70666F76, 0x719FC4B9,
+	0x72DC8374, 0x741CB528, 0x75606374, 0x76A7980F, 0x77F25CCE, 0x7940BB9E,
+	0x7A92BE8B, 0x7BE86FBA, 0x7D41D96E, 0x7E9F0606, 0x80000000,
+};
+
+static const uint32_t _fix16_fast_log2_lut[65] = {
+	0x00000000, 0x016E7968, 0x02D75A6F, 0x043ACE28, 0x0598FDBF, 0x06F21090,
+	0x08462C46, 0x099574F1, 0x0AE00D1D, 0x0C2615E8, 0x0D67AF17, 0x0EA4F726,
+	0x0FDE0B5D, 0x111307DB, 0x124407AB, 0x137124CF, 0x149A784C, 0x15C01A3A,
+	0x16E221CE, 0x1800A563, 0x191BBA89, 0x1A33760A, 0x1B47EBF7, 0x1C592FAD,
+	0x1D6753E0, 0x1E726AA2, 0x1F7A8569, 0x207FB517, 0x21820A02, 0x228193F5,
+	0x237E623D, 0x247883A8, 0x2570068E, 0x2664F8D5, 0x275767F5, 0x284760FD,
+	0x2934F098, 0x2A20230E, 0x2B09044D, 0x2BEF9FE8, 0x2CD4011D, 0x2DB632D5,
+	0x2E963FAD, 0x2F7431F2, 0x305013AB, 0x3129EE96, 0x3201CC2C, 0x32D7B5A5,
+	0x33ABB3FB, 0x347DCFE7, 0x354E11EB, 0x361C824D, 0x36E9291F, 0x37B40E3A,
+	0x387D3946, 0x3944B1B9, 0x3A0A7EDA, 0x3ACEA7C0, 0x3B913356, 0x3C52285C,
+	0x3D118D67, 0x3DCF68E3, 0x3E8BC118, 0x3F469C23, 0x40000000,
+};
+
+#elif FIXMATH_FAST_BITS == 16
+
+#define FIX16_FAST_LUT_BITS 8
+
+static const uint32_t _fix16_fast_sin_lut[257] = {
+	0x00000000, 0x006487C4, 0x00C90E90, 0x012D936C, 0x0192155F, 0x01F69373,
+	0x025B0CAF, 0x02BF801A, 0x0323ECBE, 0x038851A2, 0x03ECADCF, 0x0451004D,
+	0x04B54825, 0x0519845E, 0x057DB403, 0x05E1D61B, 0x0645E9AF, 0x06A9EDC9,
+	0x070DE172, 0x0771C3B3, 0x07D59396, 0x08395024, 0x089CF867, 0x09008B6A,
+	0x09640837, 0x09C76DD8, 0x0A2ABB59, 0x0A8DEFC3, 0x0AF10A22, 0x0B540982,
+	0x0BB6ECEF, 0x0C19B374, 0x0C7C5C1E, 0x0CDEE5F9, 0x0D415013, 0x0DA39978,
+	0x0E05C135, 0x0E67C65A, 0x0EC9A7F3, 0x0F2B650F, 0x0F8CFCBE, 0x0FEE6E0D,
+	0x104FB80E, 0x10B0D9D0, 0x1111D263, 0x1172A0D7, 0x11D3443F, 0x1233BBAC,
+	0x1294062F, 0x12F422DB, 0x135410C3, 0x13B3CEFA, 0x14135C94, 0x1472B8A5,
+	0x14D1E242, 0x1530D881, 0x158F9A76, 0x15EE2738, 0x164C7DDD, 0x16AA9D7E,
+	0x17088531, 0x1766340F, 0x17C3A931, 0x1820E3B0, 0x187DE2A7, 0x18DAA52F,
+	0x19372A64, 0x19937161, 0x19EF7944, 0x1A4B4128, 0x1AA6C82B, 0x1B020D6C,
+	0x1B5D100A, 0x1BB7CF23, 0x1C1249D8, 0x1C6C7F4A, 0x1CC66E99, 0x1D2016E9,
+	0x1D79775C, 0x1DD28F15, 0x1E2B5D38, 0x1E83E0EB, 0x1EDC1953, 0x1F340596,
+	0x1F8BA4DC, 0x1FE2F64C, 0x2039F90F, 0x2090AC4D, 0x20E70F32, 0x213D20E8,
+	0x2192E09B, 0x21E84D76, 0x223D66A8, 0x22922B5E, 0x22E69AC8, 0x233AB414,
+	0x238E7673, 0x23E1E117, 0x2434F332, 0x2487ABF7, 0x24DA0A9A, 0x252C0E4F,
+	0x257DB64C, 0x25CF01C8, 0x261FEFFA, 0x2670801A, 0x26C0B162, 0x2710830C,
+	0x275FF452, 0x27AF0472, 0x27FDB2A7, 0x284BFE2F, 0x2899E64A, 0x28E76A37,
+	0x29348937, 0x2981428C, 0x29CD9578, 0x2A19813F, 0x2A650525, 0x2AB02071,
+	0x2AFAD269, 0x2B451A55, 0x2B8EF77D, 0x2BD8692B, 0x2C216EAA, 0x2C6A0746,
+	0x2CB2324C, 0x2CF9EF09, 0x2D413CCD, 0x2D881AE8, 0x2DCE88AA, 0x2E148566,
+	0x2E5A1070, 0x2E9F291B, 0x2EE3CEBE, 0x2F2800AF, 0x2F6BBE45, 0x2FAF06DA,
+	0x2FF1D9C7, 0x30343667, 0x30761C18, 0x30B78A36, 0x30F8801F, 0x3138FD35,
+	0x317900D6, 0x31B88A66, 0x31F79948, 0x32362CE0, 0x32744493, 0x32B1DFC9,
+	0x32EEFDEA, 0x332B9E5E, 0x3367C090, 0x33A363EC, 0x33DE87DE, 0x34192BD5,
+	0x34534F41, 0x348CF190, 0x34C61236, 0x34FEB0A5, 0x3536CC52, 0x356E64B2,
+	0x35A5793C, 0x35DC0968, 0x361214B0, 0x36479A8E, 0x367C9A7E, 0x36B113FD,
+	0x36E5068A, 0x371871A5, 0x374B54CE, 0x377DAF89, 0x37AF8159, 0x37E0C9C3,
+	0x3811884D, 0x3841BC7F, 0x387165E3, 0x38A08402, 0x38CF1669, 0x38FD1CA4,
+	0x392A9642, 0x395782D3, 0x3983E1E8, 0x39AFB313, 0x39DAF5E8, 0x3A05A9FD,
+	0x3A2FCEE8, 0x3A596442, 0x3A8269A3, 0x3AAADEA6, 0x3AD2C2E8, 0x3AFA1605,
+	0x3B20D79E, 0x3B470753, 0x3B6CA4C4, 0x3B91AF97, 0x3BB6276E, 0x3BDA0BF0,
+	0x3BFD5CC4, 0x3C201994, 0x3C42420A, 0x3C63D5D1, 0x3C84D496, 0x3CA53E09,
+	0x3CC511D9, 0x3CE44FB7, 0x3D02F757, 0x3D21086C, 0x3D3E82AE, 0x3D5B65D2,
+	0x3D77B192, 0x3D9365A8, 0x3DAE81CF, 0x3DC905C5, 0x3DE2F148, 0x3DFC4418,
+	0x3E14FDF7, 0x3E2D1EA8, 0x3E44A5EF, 0x3E5B9392, 0x3E71E759, 0x3E87A10C,
+	0x3E9CC076, 0x3EB14563, 0x3EC52FA0, 0x3ED87EFC, 0x3EEB3347, 0x3EFD4C54,
+	0x3F0EC9F5, 0x3F1FABFF, 0x3F2FF24A, 0x3F3F9CAB, 0x3F4EAAFE, 0x3F5D1D1D,
+	0x3F6AF2E3, 0x3F782C30, 0x3F84C8E2, 0x3F90C8DA, 0x3F9C2BFB, 0x3FA6F228,
+	0x3FB11B48, 0x3FBAA740, 0x3FC395F9, 0x3FCBE75E, 0x3FD39B5A, 0x3FDAB1D9,
+	0x3FE12ACB, 0x3FE7061F, 0x3FEC43C7, 0x3FF0E3B6, 0x3FF4E5E0, 0x3FF84A3C,
+	0x3FFB10C1, 0x3FFD3969, 0x3FFEC42D, 0x3FFFB10B, 0x40000000,
+};
+
+static const uint32_t _fix16_fast_pow2_lut[257] = {
+	0x40000000, 0x402C6BE9, 0x4058F6A8, 0x4085A051, 0x40B268FA, 0x40DF50B8,
+	0x410C57A2, 0x41397DCC, 0x4166C34C, 0x41942839, 0x41C1ACA7, 0x41EF50AE,
+	0x421D1462, 0x424AF7DA, 0x4278FB2B, 0x42A71E6C, 0x42D561B4, 0x4303C518,
+	0x433248AE, 0x4360EC8D, 0x438FB0CB, 0x43BE957F, 0x43ED9AC0, 0x441CC0A3,
+	0x444C0740, 0x447B6EAD, 0x44AAF702, 0x44DAA054, 0x450A6ABB, 0x453A564D,
+	0x456A6323, 0x459A9152, 0x45CAE0F2, 0x45FB521A, 0x462BE4E2, 0x465C9961,
+	0x468D6FAE, 0x46BE67E0, 0x46EF8210, 0x4720BE55, 0x47521CC6, 0x47839D7B,
+	0x47B5408C, 0x47E70611, 0x4818EE22, 0x484AF8D6, 0x487D2646, 0x48AF768A,
+	0x48E1E9BA, 0x49147FEE, 0x4947393F, 0x497A15C4, 0x49AD1598, 0x49E038D0,
+	0x4A137F88, 0x4A46E9D6, 0x4A7A77D4, 0x4AAE299B, 0x4AE1FF43, 0x4B15F8E6,
+	0x4B4A169C, 0x4B7E587E, 0x4BB2BEA5, 0x4BE7492B, 0x4C1BF829, 0x4C50CBB8,
+	0x4C85C3F1, 0x4CBAE0EF, 0x4CF022CA, 0x4D25899C, 0x4D5B157E, 0x4D90C68B,
+	0x4DC69CDD, 0x4DFC988C, 0x4E32B9B4, 0x4E69006E, 0x4E9F6CD4, 0x4ED5FF00,
+	0x4F0CB70C, 0x4F439514, 0x4F7A9930, 0x4FB1C37C, 0x4FE91413, 0x50208B0E,
+	0x50582888, 0x508FEC9C, 0x50C7D765, 0x50FFE8FE, 0x51382182, 0x5170810B,
+	0x51A907B4, 0x51E1B59A, 0x521A8AD7, 0x52538786, 0x528CABC3, 0x52C5F7AA,
+	0x52FF6B55, 0x533906E0, 0x5372CA68, 0x53ACB607, 0x53E6C9DA, 0x542105FD,
+	0x545B6A8B, 0x5495F7A1, 0x54D0AD5A, 0x550B8BD4, 0x55469329, 0x5581C378,
+	0x55BD1CDB, 0x55F89F70, 0x56344B52, 0x567020A0, 0x56AC1F75, 0x56E847EF,
+	0x57249A29, 0x57611642, 0x579DBC57, 0x57DA8C83, 0x581786E6, 0x5854AB9B,
+	0x5891FAC1, 0x58CF7474, 0x590D18D3, 0x594AE7FB, 0x5988E209, 0x59C7071C,
+	0x5A055751, 0x5A43D2C6, 0x5A82799A, 0x5AC14BEA, 0x5B0049D4, 0x5B3F7377,
+	0x5B7EC8F2, 0x5BBE4A61, 0x5BFDF7E5, 0x5C3DD19C, 0x5C7DD7A4, 0x5CBE0A1C,
+	0x5CFE6923, 0x5D3EF4D7, 0x5D7FAD59, 0x5DC092C7, 0x5E01A53F, 0x5E42E4E3,
+	0x5E8451D0, 0x5EC5EC26, 0x5F07B405, 0x5F49A98C, 0x5F8BCCDB, 0x5FCE1E12,
+	0x60109D51, 0x60534AB7, 0x60962665, 0x60D9307B, 0x611C6919, 0x615FD05E,
+	0x61A3666D, 0x61E72B65, 0x622B1F66, 0x626F4292, 0x62B39509, 0x62F816EB,
+	0x633CC85B, 0x6381A978, 0x63C6BA64, 0x640BFB41, 0x64516C2E, 0x64970D4F,
+	0x64DCDEC3, 0x6522E0AD, 0x6569132F, 0x65AF766A, 0x65F60A7F, 0x663CCF92,
+	0x6683C5C3, 0x66CAED35, 0x6712460B, 0x6759D065, 0x67A18C68, 0x67E97A34,
+	0x683199ED, 0x6879EBB6, 0x68C26FB1, 0x690B2601, 0x69540EC9, 0x699D2A2C,
+	0x69E6784D, 0x6A2FF94F, 0x6A79AD56, 0x6AC39485, 0x6B0DAEFF, 0x6B57FCE9,
+	0x6BA27E65, 0x6BED3399, 0x6C381CA6, 0x6C8339B2, 0x6CCE8AE1, 0x6D1A1057,
+	0x6D65CA38, 0x6DB1B8A8, 0x6DFDDBCC, 0x6E4A33C9, 0x6E96C0C3, 0x6EE382DE,
+	0x6F307A41, 0x6F7DA710, 0x6FCB096F, 0x7018A185, 0x70666F76, 0x70B47368,
+	0x7102AD80, 0x71511DE4, 0x719FC4B9, 0x71EEA226, 0x723DB650, 0x728D015D,
+	0x72DC8374, 0x732C3CBA, 0x737C2D55, 0x73CC556D, 0x741CB528, 0x746D4CAC,
+	0x74BE1C20, 0x750F23AB, 0x75606374, 0x75B1DBA2, 0x76038C5B, 0x765575C8,
+	0x76A7980F, 0x76F9F359, 0x774C87CC, 0x779F5590, 0x77F25CCE, 0x78459DAC,
+	0x78991854, 0x78ECCCEC, 0x7940BB9E, 0x7994E492, 0x79E947EF, 0x7A3DE5DF,
+	0x7A92BE8B, 0x7AE7D21A, 0x7B3D20B6, 0x7B92AA88, 0x7BE86FBA, 0x7C3E7073,
+	0x7C94ACDE, 0x7CEB2523, 0x7D41D96E, 0x7D98C9E6, 0x7DEFF6B6, 0x7E476009,
+	0x7E9F0606, 0x7EF6E8DA, 0x7F4F08AE, 0x7FA765AD, 0x80000000,
+};
+
+static const uint32_t _fix16_fast_log2_lut[257] = {
+	0x00000000, 0x005C2712, 0x00B7F286, 0x01136311, 0x016E7968, 0x01C9363C,
+	0x02239A3B, 0x027DA613, 0x02D75A6F, 0x0330B7F8, 0x0389BF57, 0x03E27130,
+	0x043ACE28, 0x0492D6E0, 0x04EA8BF7, 0x0541EE0E, 0x0598FDBF, 0x05EFBBA6,
+	0x0646285C, 0x069C4478, 0x06F21090, 0x07478D39, 0x079CBB04, 0x07F19A84,
+	0x08462C46, 0x089A70DA, 0x08EE68CC, 0x094214A6, 0x099574F1, 0x09E88A37,
+	0x0A3B54FD, 0x0A8DD5C8, 0x0AE00D1D, 0x0B31FB7D, 0x0B83A16A, 0x0BD4FF64,
+	0x0C2615E8, 0x0C76E574, 0x0CC76E84, 0x0D17B192, 0x0D67AF17, 0x0DB7678C,
+	0x0E06DB67, 0x0E560B1E, 0x0EA4F726, 0x0EF39FF2, 0x0F4205F4, 0x0F90299D,
+	0x0FDE0B5D, 0x102BABA2, 0x10790ADC, 0x10C62975, 0x111307DB, 0x115FA677,
+	0x11AC05B3, 0x11F825F7, 0x124407AB, 0x128FAB36, 0x12DB10FC, 0x13263963,
+	0x137124CF, 0x13BBD3A1, 0x1406463B, 0x14507CFF, 0x149A784C, 0x14E43881,
+	0x152DBDFC, 0x1577091B, 0x15C01A3A, 0x1608F1B4, 0x16518FE4, 0x1699F525,
+	0x16E221CE, 0x172A1638, 0x1771D2BA, 0x17B957AC, 0x1800A563, 0x1847BC34,
+	0x188E9C73, 0x18D54674, 0x191BBA89, 0x1961F905, 0x19A80239, 0x19EDD676,
+	0x1A33760A, 0x1A78E147, 0x1ABE1879, 0x1B031BF0, 0x1B47EBF7, 0x1B8C88DC,
+	0x1BD0F2EA, 0x1C152A6C, 0x1C592FAD, 0x1C9D02F7, 0x1CE0A492, 0x1D2414C8,
+	0x1D6753E0, 0x1DAA6222, 0x1DED3FD4, 0x1E2FED3D, 0x1E726AA2, 0x1EB4B848,
+	0x1EF6D673, 0x1F38C568, 0x1F7A8569, 0x1FBC16B9, 0x1FFD799B, 0x203EAE4F,
+	0x207FB517, 0x20C08E34, 0x210139E5, 0x2141B86A, 0x21820A02, 0x21C22EEB,
+	0x22022763, 0x2241F3A7, 0x228193F5, 0x22C10889, 0x2300519F, 0x233F6F72,
+	0x237E623D, 0x23BD2A3B, 0x23FBC7A6, 0x243A3AB7, 0x247883A8, 0x24B6A2B1,
+	0x24F4980B, 0x253263ED, 0x2570068E, 0x25AD8027, 0x25EAD0EC, 0x2627F914,
+	0x2664F8D5, 0x26A1D065, 0x26DE7FF7, 0x271B07C0, 0x275767F5, 0x2793A0C9,
+	0x27CFB26F, 0x280B9D1A, 0x284760FD, 0x2882FE4A, 0x28BE7531, 0x28F9C5E6,
+	0x2934F098, 0x296FF578, 0x29AAD4B6, 0x29E58E83, 0x2A20230E, 0x2A5A9286,
+	0x2A94DD19, 0x2ACF02F7, 0x2B09044D, 0x2B42E149, 0x2B7C9A19, 0x2BB62EEA,
+	0x2BEF9FE8, 0x2C28ED40, 0x2C62171F, 0x2C9B1DAF, 0x2CD4011D, 0x2D0CC193,
+	0x2D455F3D, 0x2D7DDA45, 0x2DB632D5, 0x2DEE6918, 0x2E267D36, 0x2E5E6F5A,
+	0x2E963FAD, 0x2ECDEE56, 0x2F057B80, 0x2F3CE751, 0x2F7431F2, 0x2FAB5B8B,
+	0x2FE26443, 0x30194C41, 0x305013AB, 0x3086BAAA, 0x30BD4161, 0x30F3A7F9,
+	0x3129EE96, 0x3160155E, 0x31961C77, 0x31CC0404, 0x3201CC2C, 0x32377512,
+	0x326CFEDB, 0x32A269AB, 0x32D7B5A5, 0x330CE2EE, 0x3341F1A7, 0x3376E1F5,
+	0x33ABB3FB, 0x33E067DA, 0x3414FDB5, 0x344975AE, 0x347DCFE7, 0x34B20C82,
+	0x34E62BA0, 0x351A2D63, 0x354E11EB, 0x3581D959, 0x35B583CE, 0x35E9116A,
+	0x361C824D, 0x364FD698, 0x36830E69, 0x36B629E1, 0x36E9291F, 0x371C0C41,
+	0x374ED367, 0x37817EB0, 0x37B40E3A, 0x37E68223, 0x3818DA89, 0x384B178B,
+	0x387D3946, 0x38AF3FD7, 0x38E12B5D, 0x3912FBF4, 0x3944B1B9, 0x39764CCA,
+	0x39A7CD42, 0x39D9333E, 0x3A0A7EDA, 0x3A3BB033, 0x3A6CC765, 0x3A9DC48B,
+	0x3ACEA7C0, 0x3AFF7121, 0x3B3020C8, 0x3B60B6D1, 0x3B913356, 0x3BC19673,
+	0x3BF1E041, 0x3C2210DB, 0x3C52285C, 0x3C8226DD, 0x3CB20C79, 0x3CE1D949,
+	0x3D118D67, 0x3D4128EC, 0x3D70ABF2, 0x3DA01691, 0x3DCF68E3, 0x3DFEA301,
+	0x3E2DC504, 0x3E5CCF03, 0x3E8BC118, 0x3EBA9B5A, 0x3EE95DE2, 0x3F1808C8,
+	0x3F469C23, 0x3F75180C, 0x3FA37C99, 0x3FD1C9E3, 0x40000000,
+};
+
+#else
+#error "FIXMATH_FAST_BITS must be 8, 12 or 16"
+#endif
+
+#endif
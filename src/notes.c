@@ -8,10 +8,20 @@
 // private
 //
 
-static pool_element_t *pool_tail(note_pool_t *p) {
-  pool_element_t *element = p->head;
-  while (element) element = element->next;
-  return element;
+static inline bool map_test(note_pool_t *p, u8 num) {
+  return (p->held[num >> 5] >> (num & 31)) & 1;
+}
+
+static inline void map_set(note_pool_t *p, u8 num) {
+  p->held[num >> 5] |= (u32)1 << (num & 31);
+}
+
+static inline void map_clear(note_pool_t *p, u8 num) {
+  p->held[num >> 5] &= ~((u32)1 << (num & 31));
+}
+
+static inline pool_element_t *pool_tail(note_pool_t *p) {
+  return p->tail;
 }
 
 static inline pool_element_t *pool_head(note_pool_t *p) {
@@ -19,10 +29,34 @@ static inline pool_element_t *pool_head(note_pool_t *p) {
 }
 
 static inline void pool_push(note_pool_t *p, pool_element_t *head) {
+  head->prev = NULL;
   head->next = p->head;
+  if (p->head) {
+    p->head->prev = head;
+  }
+  else {
+    p->tail = head;
+  }
   p->head = head;
 }
 
+static inline void pool_unlink(note_pool_t *p, pool_element_t *element) {
+  if (element->prev) {
+    element->prev->next = element->next;
+  }
+  else {
+    p->head = element->next;
+  }
+  if (element->next) {
+    element->next->prev = element->prev;
+  }
+  else {
+    p->tail = element->prev;
+  }
+  element->prev = NULL;
+  element->next = NULL;
+}
+
 inline static u8 pool_remaining(note_pool_t *p) {
   return NOTE_POOL_SIZE - p->count;
 }
@@ -32,55 +66,31 @@ inline static u8 pool_count(note_pool_t *p) {
 }
 
 static pool_element_t *pool_take(note_pool_t *p) {
-  pool_element_t *allocated = NULL;
+  pool_element_t *allocated;
   
-  if (pool_remaining(p) == 0) {
+  if (p->free_count == 0) {
     // fail fast if full
     return NULL;
   }
-  if (p->last_free) {
-    // quick
-    allocated = p->last_free;
-    p->last_free = NULL;
-  }
-  else {
-    // search
-    for (u8 i = 0; i < NOTE_POOL_SIZE; i++) {
-      if (p->elements[i].is_free) {
-        allocated = &(p->elements[i]);
-        break;
-      }
-    }
-  }
-  if (allocated) {
-    // record
-    allocated->is_free = 0;
-    allocated->next = NULL;
-    p->count++;
-    pool_push(p, allocated); // chain and set as head
-  }
+
+  allocated = &(p->elements[p->free[--p->free_count]]);
+  allocated->is_free = 0;
+  p->count++;
+  pool_push(p, allocated); // chain and set as head
   
   return allocated;
 }
 
 static void pool_return(note_pool_t *p, pool_element_t *element) {
-  pool_element_t *before;
-
   if (element) {
-    if (element->next) {
-      // middle of chain, pop out of chain
-      before = pool_head(p);
-      while (before && before->next != element)
-        before = before->next;
-      before->next = element->next;
-    }
+    pool_unlink(p, element);
+    map_clear(p, element->note.num);
 
     element->is_free = 1;
-    element->next = NULL;
     element->note.num = 0;
     element->note.vel = 0;
 
-    p->last_free = element;
+    p->free[p->free_count++] = element - p->elements;
     p->count--;
   }
 }
@@ -92,13 +102,21 @@ static void pool_init(note_pool_t *p) {
     e->note.num = 0;
     e->note.vel = 0;
     e->is_free = 1;
+    e->prev = NULL;
     e->next = NULL;
 		e++;
+    // hand out low indices first
+    p->free[i] = NOTE_POOL_SIZE - 1 - i;
+  }
+
+  for (u8 i = 0; i < NOTE_POOL_MAP_WORDS; i++) {
+    p->held[i] = 0;
   }
 
 	p->count = 0;
+  p->free_count = NOTE_POOL_SIZE;
   p->head = NULL;
-  p->last_free = NULL;
+  p->tail = NULL;
 }
 
 //
@@ -110,6 +128,8 @@ void notes_init(note_pool_t *pool) {
 
 void notes_hold(note_pool_t *pool, u8 num, u8 vel) {
   pool_element_t *head;
+
+  if (num >= NOTE_POOL_NOTES) return;
   
   // release note if already held
   notes_release(pool, num);
@@ -122,43 +142,45 @@ void notes_hold(note_pool_t *pool, u8 num, u8 vel) {
   head = pool_take(pool); // shouldn't be NULL given the above
   head->note.num = num;
   head->note.vel = vel;
+
+  map_set(pool, num);
+  pool->slot[num] = head - pool->elements;
 }
 
 void notes_release(note_pool_t *pool, u8 num) {
-  // FIXME: uses pool internals :|
-  pool_element_t *element = pool_head(pool);
-  pool_element_t *before = NULL;
-  
-  // find matching note
-  while (element && element->note.num != num) {
-    before = element;
-    element = element->next;
-  }
-  
-  if (element) {
-    // found a match
-    if (before) {
-      // in the middle
-      before->next = element->next;
-    }
-    else {
-      // element is head
-      pool->head = element->next; // FIXME: we are breaking the pool abstraction here
-      element->next = NULL; // FIXME: to prevent pool_return from messing up head?? nope
-    }
-    pool_return(pool, element);
+  if (notes_is_held(pool, num)) {
+    pool_return(pool, &(pool->elements[pool->slot[num]]));
   }
 }
 
+bool notes_is_held(note_pool_t *pool, u8 num) {
+  return num < NOTE_POOL_NOTES && map_test(pool, num);
+}
+
 const held_note_t *notes_get(note_pool_t *pool, note_priority p) {
   pool_element_t *element = pool_head(pool);
+  s8 i;
+
   if (element) {
     // at least one held note...
     switch (p) {
     case kNotePriorityLast:
       return &(element->note);
+    case kNotePriorityHigh:
+      for (i = NOTE_POOL_MAP_WORDS - 1; i >= 0; i--) {
+        if (pool->held[i]) {
+          return &(pool->elements[pool->slot[(i << 5) + 31 - __builtin_clz(pool->held[i])]].note);
+        }
+      }
+      return NULL;
+    case kNotePriorityLow:
+      for (i = 0; i < NOTE_POOL_MAP_WORDS; i++) {
+        if (pool->held[i]) {
+          return &(pool->elements[pool->slot[(i << 5) + __builtin_ctz(pool->held[i])]].note);
+        }
+      }
+      return NULL;
     default:
-      // FIME: others not implemented
       return NULL;
     }
   }
@@ -8,13 +8,19 @@
 
 // maintains a fixed size pool of held notes
 //
-// the pool is structured as a linked list ordered from most recent to least
-// recent notes.
+// the pool is structured as a doubly linked list ordered from most recent to
+// least recent notes. free elements are kept on a stack of element indices
+// and held note numbers are tracked in a 128 bit presence map (with a note to
+// element index table alongside it) so that hold, release and lookup do not
+// need to walk the list.
 
 #ifndef NOTE_POOL_SIZE
 #define NOTE_POOL_SIZE 16
 #endif
 
+#define NOTE_POOL_NOTES 128
+#define NOTE_POOL_MAP_WORDS (NOTE_POOL_NOTES / 32)
+
 typedef enum {
   kNotePriorityHigh,
   kNotePriorityLow,
@@ -29,6 +35,7 @@ typedef struct {
 struct pool_element {
   held_note_t note;
   u8 is_free;
+  struct pool_element* prev;
   struct pool_element* next;
 };
 typedef struct pool_element pool_element_t;
@@ -37,13 +44,22 @@ typedef struct {
 	pool_element_t  elements[NOTE_POOL_SIZE];
 	u8              count;
 	pool_element_t* head;
-	pool_element_t* last_free;
+	pool_element_t* tail;
+
+	// stack of free element indices, free[0..free_count) are available
+	u8              free[NOTE_POOL_SIZE];
+	u8              free_count;
+
+	// bit n set when note n is held; slot[n] is only valid when set
+	u32             held[NOTE_POOL_MAP_WORDS];
+	u8              slot[NOTE_POOL_NOTES];
 } note_pool_t;
 
 
 void notes_init(note_pool_t *pool);
 void notes_hold(note_pool_t *pool, u8 num, u8 vel);
 void notes_release(note_pool_t *pool, u8 num);
+bool notes_is_held(note_pool_t *pool, u8 num);
 const held_note_t *notes_get(note_pool_t *pool, note_priority p);
 u8 notes_count(note_pool_t *pool);
 
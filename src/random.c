@@ -1,18 +1,126 @@
 #include "random.h"
 
+/*
+ * xoshiro128** (Blackman and Vigna): 128 bits of state, period 2^128 - 1,
+ * and only 32-bit shifts, rotates and one multiply per draw.
+ */
+
+static inline u32 rotl32(u32 x, u8 k) {
+    return (x << k) | (x >> (32 - k));
+}
+
+// splitmix32, to spread a small seed over the whole state
+static u32 splitmix32(u32 *x) {
+    u32 z = (*x += 0x9e3779b9);
+    z = (z ^ (z >> 16)) * 0x85ebca6b;
+    z = (z ^ (z >> 13)) * 0xc2b2ae35;
+    return z ^ (z >> 16);
+}
+
 void random_seed(random_state_t *r, u32 seed) {
-    r->z = 12345;
-    r->w = seed;
-}	
+    u8 i;
+    for (i = 0; i < 4; i++) {
+        r->s[i] = splitmix32(&seed);
+    }
+    // the splitmix32 mix is a bijection and its four inputs differ, so at
+    // most one word is zero and the state is never all zero
+}
+
+void random_seed_stream(random_state_t *r, u32 seed, u8 stream) {
+    random_seed(r, seed);
+    while (stream--) {
+        random_jump(r);
+    }
+}
+
+u32 random_next(random_state_t *r) {
+    return random_next32(r) >> 1;
+}
+
+u32 random_next32(random_state_t *r) {
+    u32 *s = r->s;
+    u32 result = rotl32(s[1] * 5, 7) * 9;
+    u32 t = s[1] << 9;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl32(s[3], 11);
+
+    return result;
+}
+
+void random_jump(random_state_t *r) {
+    static const u32 jump[4] = { 0x8764000b, 0xf542d2d3, 0x6fa035c3, 0x77f2db5b };
+    u32 s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    u8 i, b;
+
+    for (i = 0; i < 4; i++) {
+        for (b = 0; b < 32; b++) {
+            if (jump[i] & (1UL << b)) {
+                s0 ^= r->s[0];
+                s1 ^= r->s[1];
+                s2 ^= r->s[2];
+                s3 ^= r->s[3];
+            }
+            random_next32(r);
+        }
+    }
+
+    r->s[0] = s0;
+    r->s[1] = s1;
+    r->s[2] = s2;
+    r->s[3] = s3;
+}
 
 /*
- * MWC generator concatenates two 16-bit multiply-
- * with-carry generators, x(n)=36969x(n-1)+carry,
- * y(n)=18000y(n-1)+carry mod 2^16, has period about 2^60
+ * Lemire's multiply and shift: the high word of x * n is uniform in
+ * [0, n) once the few low words that would bias it are rejected. The
+ * rejection needs a modulo, but only on the rare draws that land in the
+ * first n values of the low word.
  */
-u32 random_next(random_state_t *r) {
-    r->z = 36969 * (r->z & 65535) + (r->z >> 16);
-    r->w = 18000 * (r->w & 65535) + (r->w >> 16);
-    return ((r->z << 16) + r->w) & 0x7FFFFFFF;
+u32 random_range(random_state_t *r, u32 n) {
+    u64 m = (u64)random_next32(r) * n;
+    u32 low = (u32)m;
+
+    if (low < n) {
+        u32 threshold = -n % n;
+        while (low < threshold) {
+            m = (u64)random_next32(r) * n;
+            low = (u32)m;
+        }
+    }
+    return m >> 32;
+}
+
+s32 random_between(random_state_t *r, s32 lo, s32 hi) {
+    u32 span = (u32)hi - (u32)lo + 1;
+    // the full 32-bit range wraps span to 0
+    if (span == 0) {
+        return (s32)random_next32(r);
+    }
+    return (s32)((u32)lo + random_range(r, span));
 }
 
+void random_fill(random_state_t *r, u32 *dst, size_t n) {
+    // work on a local copy so the state stays in registers
+    u32 s0 = r->s[0], s1 = r->s[1], s2 = r->s[2], s3 = r->s[3], t;
+
+    while (n--) {
+        *dst++ = rotl32(s1 * 5, 7) * 9;
+        t = s1 << 9;
+        s2 ^= s0;
+        s3 ^= s1;
+        s1 ^= s2;
+        s0 ^= s3;
+        s2 ^= t;
+        s3 = rotl32(s3, 11);
+    }
+
+    r->s[0] = s0;
+    r->s[1] = s1;
+    r->s[2] = s2;
+    r->s[3] = s3;
+}
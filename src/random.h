@@ -1,13 +1,16 @@
 #ifndef _RANDOM_H_
 #define _RANDOM_H_
 
+#include <stddef.h>
+
 #include "types.h"
 
 //------------------------------
 //----- types
 
+// xoshiro128** state; never all zero once seeded
 typedef struct {
-	u32 z, w;
+	u32 s[4];
 } random_state_t;
 
 //------------------------------
@@ -15,6 +18,21 @@ typedef struct {
 
 // (re)seed generator, restarting sequence
 extern void random_seed(random_state_t *r, u32 seed);
+// seed and then jump stream times; streams from one seed never overlap
+// for 2^64 draws, so per track randomness stays independent and repeatable
+extern void random_seed_stream(random_state_t *r, u32 seed, u8 stream);
+// advance 2^64 draws
+extern void random_jump(random_state_t *r);
+
+// 31 random bits, as the MWC generator this replaced gave; fits an s32
 extern u32 random_next(random_state_t *r);
+// 32 random bits
+extern u32 random_next32(random_state_t *r);
+// unbiased value in [0, n), 0 if n is 0
+extern u32 random_range(random_state_t *r, u32 n);
+// unbiased value in [lo, hi]
+extern s32 random_between(random_state_t *r, s32 lo, s32 hi);
+// fill dst with n values from random_next32
+extern void random_fill(random_state_t *r, u32 *dst, size_t n);
 
 #endif // header guard
@@ -0,0 +1,119 @@
+#include "scale.h"
+#include "dac.h"
+
+static json_read_object_state_t scale_object_state;
+static json_read_array_state_t scale_array_state;
+
+json_docdef_t scale_docdef = {
+	.read = json_read_object,
+	.write = json_write_object,
+	.state = &scale_object_state,
+	.params = &((json_read_object_params_t) {
+		.docdef_ct = 3,
+		.docdefs = ((json_docdef_t[]) {
+			{
+				.name = "mask",
+				.read = json_read_scalar,
+				.write = json_write_number,
+				.params = &((json_read_scalar_params_t) {
+					.dst_size = sizeof_field(scale_t, mask),
+					.dst_offset = offsetof(scale_t, mask),
+					.signed_val = false,
+				}),
+			},
+			{
+				.name = "root",
+				.read = json_read_scalar,
+				.write = json_write_number,
+				.params = &((json_read_scalar_params_t) {
+					.dst_size = sizeof_field(scale_t, root),
+					.dst_offset = offsetof(scale_t, root),
+					.signed_val = false,
+				}),
+			},
+			{
+				.name = "tune",
+				.read = json_read_array,
+				.write = json_write_array,
+				.state = &scale_array_state,
+				.params = &((json_read_array_params_t) {
+					.array_len = SCALE_PITCH_CLASSES,
+					.item_size = sizeof_field(scale_t, tune[0]),
+					.item_docdef = &((json_docdef_t) {
+						.read = json_read_scalar,
+						.write = json_write_number,
+						.params = &((json_read_scalar_params_t) {
+							.dst_size = sizeof_field(scale_t, tune[0]),
+							.dst_offset = offsetof(scale_t, tune[0]),
+							.signed_val = true,
+						}),
+					}),
+				}),
+			},
+		}),
+	}),
+};
+
+void scale_from_mode(scale_t* s, u8 mode, u8 root) {
+	u8 degree = 0;
+
+	s->mask = 1;
+	s->root = root % SCALE_PITCH_CLASSES;
+	for (u8 i = 0; i < SCALE_MODES - 1; i++) {
+		degree += SCALE_INT[mode % SCALE_MODES][i];
+		s->mask |= 1 << degree;
+	}
+	for (u8 i = 0; i < SCALE_PITCH_CLASSES; i++) {
+		s->tune[i] = 0;
+	}
+}
+
+static bool scale_has(const scale_t* s, s16 n) {
+	u8 i = (n + SCALE_PITCH_CLASSES * 11 - s->root) % SCALE_PITCH_CLASSES;
+	return (s->mask >> i) & 1;
+}
+
+void scale_compile(scale_quantizer_t* q, const scale_t* s) {
+	u8 i;
+	s16 d;
+	s32 p;
+
+	for (i = 0; i < SCALE_NOTES; i++) {
+		q->note[i] = i;
+		if ((s->mask & 0xfff) == 0) {
+			continue;
+		}
+		// search outwards, below first so that ties round down
+		for (d = 0; d < SCALE_PITCH_CLASSES; d++) {
+			if (i - d >= 0 && scale_has(s, i - d)) {
+				q->note[i] = i - d;
+				break;
+			}
+			if (i + d < SCALE_NOTES && scale_has(s, i + d)) {
+				q->note[i] = i + d;
+				break;
+			}
+		}
+	}
+
+	// 16384 dac values to 12000 cents, in 16.16. nothing is gained tuning
+	// further than the whole range, and limiting it keeps the product in
+	// an s32
+	for (i = 0; i < SCALE_NOTES; i++) {
+		p = s->tune[(i + SCALE_PITCH_CLASSES * 11 - s->root) % SCALE_PITCH_CLASSES];
+		if (p < -SCALE_TUNE_MAX) {
+			p = -SCALE_TUNE_MAX;
+		}
+		else if (p > SCALE_TUNE_MAX) {
+			p = SCALE_TUNE_MAX;
+		}
+		p = ET[i] + ((p * (s32)89478) >> 16);
+		if (p < 0) {
+			p = 0;
+		}
+		else if (p > DAC_10V) {
+			p = DAC_10V;
+		}
+		q->pitch[i] = p;
+	}
+}
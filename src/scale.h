@@ -0,0 +1,58 @@
+#ifndef _SCALE_H_
+#define _SCALE_H_
+
+#include "types.h"
+#include "music.h"
+#include "json/serdes.h"
+
+// scale quantizer
+//
+// a scale is a 12 bit pitch class mask relative to its root, with an
+// optional tuning offset in cents for each degree. compiling it produces a
+// note to note table and a note to dac value table, so quantizing a note or
+// a dac value is a lookup (plus one multiply to find the nearest semitone
+// of a dac value).
+
+#define SCALE_NOTES ET_SIZE
+#define SCALE_PITCH_CLASSES 12
+#define SCALE_MODES 7
+
+// tuning offsets beyond the dac range are limited to it
+#define SCALE_TUNE_MAX 12000
+
+typedef struct {
+	u16 mask;                        // bit i: root + i semitones is in the scale
+	u8 root;                         // pitch class, 0 = c
+	s16 tune[SCALE_PITCH_CLASSES];   // cents, indexed like mask [+/-SCALE_TUNE_MAX]
+} scale_t;
+
+typedef struct {
+	u8 note[SCALE_NOTES];    // nearest note in the scale, ties round down
+	u16 pitch[SCALE_NOTES];  // dac value for each note, ET plus tuning
+} scale_quantizer_t;
+
+// a diatonic mode from SCALE_INT
+void scale_from_mode(scale_t* s, u8 mode, u8 root);
+void scale_compile(scale_quantizer_t* q, const scale_t* s);
+
+static inline u8 scale_quantize_note(const scale_quantizer_t* q, u8 n) {
+	return q->note[n & (SCALE_NOTES - 1)];
+}
+
+static inline u16 scale_note_dac(const scale_quantizer_t* q, u8 n) {
+	return q->pitch[q->note[n & (SCALE_NOTES - 1)]];
+}
+
+// quantize a 1v/oct dac value to the nearest note in the scale
+static inline u16 scale_quantize_dac(const scale_quantizer_t* q, u16 v) {
+	u32 n = ((u32)v * 120 + 8192) >> 14;
+	if (n >= SCALE_NOTES) {
+		n = SCALE_NOTES - 1;
+	}
+	return q->pitch[q->note[n]];
+}
+
+// {"mask": 2741, "root": 0, "tune": [0, 0, ...]}
+extern json_docdef_t scale_docdef;
+
+#endif
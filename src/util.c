@@ -1,10 +1,12 @@
 #include "types.h"
 #include "util.h"
+#include "random.h"
+
+// random_seed(&rnd_state, 1234567), done at compile time
+static random_state_t rnd_state = {{ 0x06ef1ad9, 0x0c1d995f, 0xc23d04e1, 0xc9d8e2b6 }};
 
 u32 rnd(void) {
-  x1 = x1 * c1 + a1;
-  x2 = x2 * c2 + a2;
-  return (x1>>16) | (x2>>16);
+  return random_next32(&rnd_state) >> 16;
 }
 
 
@@ -3,13 +3,8 @@
 
 #include "types.h"
 
-static const u32 a1 = 0x19660d;
-static const u32 c1 = 0x3c6ef35f;
-static volatile u32 x1 = 1234567;  // seed
-static const u32 a2 = 0x19660d;
-static const u32 c2 = 0x3c6ef35f;
-static volatile u32 x2 = 7654321;  // seed
-
+// 16 bits from a shared generator, as before; use a random_state_t of
+// your own for anything that needs to be repeatable or wider
 extern u32 rnd(void);
 extern u16 rotl(u16 value, u16 shift);
 char* itoa(int value, char* result, int base);
@@ -0,0 +1,62 @@
+// the arp engine: four lanes pulsed player by player and through
+// arp_engine_pulse, over a chord of eight notes.
+//
+//   make bench
+
+#include <stdio.h>
+#include <time.h>
+
+#include "util.c"
+#include "notes.c"
+#include "random.c"
+#include "euclidean/euclidean.c"
+#include "arp.c"
+
+#define BENCH_TICKS 1000000
+#define BENCH_LANES 4
+
+u8 irqs_pause(void) { return 0; }
+void irqs_resume(u8 irq_flags) {}
+u32 time_now(void) { return 123909; }
+
+static void null_note_on(u8 ch, u8 num, u8 vel) {}
+static void null_note_off(u8 ch, u8 num, u8 vel) {}
+
+int main(void) {
+	midi_behavior_t b = { .note_on = null_note_on, .note_off = null_note_off };
+	arp_engine_t e;
+	arp_seq_t *s;
+	clock_t start;
+	double per_player, per_engine;
+	u32 t;
+	u8 lane;
+
+	arp_engine_init(&e, BENCH_LANES, eStyleUpDown, 16);
+	for (lane = 0; lane < BENCH_LANES; lane++) {
+		arp_player_set_fill(arp_engine_player(&e, lane), 3 + lane);
+	}
+	for (u8 n = 0; n < 8; n++) {
+		arp_engine_note_add(&e, 40 + n * 3, 100);
+	}
+	s = arp_seq_buf_front(&e.seq);
+
+	start = clock();
+	for (t = 0; t < BENCH_TICKS; t++) {
+		for (lane = 0; lane < BENCH_LANES; lane++) {
+			arp_player_pulse(&e.players[lane], s, &b, t & 1);
+		}
+	}
+	per_player = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	start = clock();
+	for (t = 0; t < BENCH_TICKS; t++) {
+		arp_engine_pulse(&e, t & 1);
+		arp_engine_dispatch(&e, &b);
+	}
+	per_engine = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	printf("%d lanes, ns/tick\n\n", BENCH_LANES);
+	printf("arp_player_pulse x%d %9.1f\n", BENCH_LANES, per_player * 1e9 / BENCH_TICKS);
+	printf("arp_engine_pulse    %9.1f\n", per_engine * 1e9 / BENCH_TICKS);
+	return 0;
+}
@@ -0,0 +1,121 @@
+// key lookup: one wide object, keys named like app state fields, read
+// with a linear scan of its docdefs and through json_docdef_index.
+//
+//   make bench
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define __PRINT_FUNCS_H__
+#define print_dbg(s)
+#define print_dbg_char(c)
+#define print_dbg_hex(x)
+#define print_dbg_ulong(n)
+
+#include "../unit/json/json_test_common.c"
+
+#define WIDE_KEYS 200
+#define BENCH_PASSES 200
+
+static uint8_t wide_dest[WIDE_KEYS];
+static char wide_names[WIDE_KEYS][16];
+static json_read_scalar_params_t wide_scalar_params[WIDE_KEYS];
+static json_docdef_t wide_docdefs[WIDE_KEYS];
+static json_read_object_state_t wide_state;
+static json_read_object_params_t wide_params = {
+	.docdefs = wide_docdefs,
+	.docdef_ct = WIDE_KEYS,
+};
+static json_docdef_t wide_docdef = {
+	.read = json_read_object,
+	.write = json_write_object,
+	.state = &wide_state,
+	.params = &wide_params,
+};
+
+static char wide_text[WIDE_KEYS * 24];
+static size_t wide_text_len, wide_text_pos;
+static char wide_buf[256];
+static jsmntok_t wide_tokens[32];
+
+static size_t read_wide(char* dst, size_t len) {
+	size_t n = wide_text_len - wide_text_pos;
+	if (n > len) n = len;
+	memcpy(dst, wide_text + wide_text_pos, n);
+	wide_text_pos += n;
+	return n;
+}
+
+static void build_wide(void) {
+	char* p = wide_text;
+
+	for (int i = 0; i < WIDE_KEYS; i++) {
+		// shared prefixes, as in "track_0_step_len"
+		sprintf(wide_names[i], "track_%d_p%d", i % 8, i / 8);
+		wide_scalar_params[i] = (json_read_scalar_params_t) {
+			.dst_offset = i,
+			.dst_size = 1,
+		};
+		wide_docdefs[i] = (json_docdef_t) {
+			.name = wide_names[i],
+			.read = json_read_scalar,
+			.write = json_write_number,
+			.params = &wide_scalar_params[i],
+		};
+	}
+
+	// keys in reverse, so file order is no help to the scan
+	*p++ = '{';
+	for (int i = WIDE_KEYS - 1; i >= 0; i--) {
+		p += sprintf(p, "\"%s\": %d%s", wide_names[i], i & 0xff, i ? ", " : "");
+	}
+	*p++ = '}';
+	wide_text_len = p - wide_text;
+}
+
+static double bench(const char* label) {
+	json_read_result_t result;
+	clock_t start;
+
+	memset(wide_dest, 0, sizeof(wide_dest));
+	start = clock();
+	for (int pass = 0; pass < BENCH_PASSES; pass++) {
+		wide_text_pos = 0;
+		result = json_read(read_wide, copy, wide_dest, &wide_docdef,
+				   wide_buf, sizeof(wide_buf),
+				   wide_tokens, sizeof(wide_tokens) / sizeof(wide_tokens[0]));
+		if (result != JSON_READ_OK) {
+			printf("\n%s: read failed with %d\n", label, result);
+			exit(1);
+		}
+	}
+	for (int i = 0; i < WIDE_KEYS; i++) {
+		if (wide_dest[i] != (i & 0xff)) {
+			printf("\n%s: %s read back %d\n", label, wide_names[i], wide_dest[i]);
+			exit(1);
+		}
+	}
+	return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+int main(void) {
+	static uint8_t pool[WIDE_KEYS];
+	double scan_s, index_s;
+
+	build_wide();
+	scan_s = bench("scan");
+	if (json_docdef_index(&wide_docdef, pool, sizeof(pool)) != WIDE_KEYS) {
+		printf("index didn't take all %d keys\n", WIDE_KEYS);
+		exit(1);
+	}
+	index_s = bench("index");
+
+	printf("%d keys, %d byte object\n\n", WIDE_KEYS, (int)wide_text_len);
+	printf("%-6s %9s\n", "lookup", "us/read");
+	printf("%-6s %9.1f\n", "scan", scan_s * 1e6 / BENCH_PASSES);
+	printf("%-6s %9.1f\n", "index", index_s * 1e6 / BENCH_PASSES);
+	return 0;
+}
@@ -0,0 +1,120 @@
+// number and hex encoding, against the div/mod and nybble-at-a-time
+// versions they replaced.
+//
+//   make bench
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define __PRINT_FUNCS_H__
+#define print_dbg(s)
+#define print_dbg_char(c)
+#define print_dbg_hex(x)
+#define print_dbg_ulong(n)
+
+#include "../unit/json/json_test_common.c"
+
+#define BENCH_PASSES 200000
+#define BENCH_HEX_PASSES (BENCH_PASSES / 100)
+
+static size_t encode_decimal_divmod(char* dst, uint32_t val) {
+	char buf[10];
+	size_t i = sizeof(buf), len;
+	do {
+		buf[--i] = val % 10 + '0';
+		val /= 10;
+	} while (val);
+	len = sizeof(buf) - i;
+	memcpy(dst, buf + i, len);
+	dst[len] = 0;
+	return len;
+}
+
+static void hex_write_nybbles(json_puts_cb write, const uint8_t* src, size_t len) {
+	char c;
+	for (size_t i = 0; i < len; i++) {
+		c = "0123456789ABCDEF"[src[i] >> 4];
+		write(&c, 1);
+		c = "0123456789ABCDEF"[src[i] & 0xF];
+		write(&c, 1);
+	}
+}
+
+static char hex_out_buf[1024];
+static size_t hex_out_len;
+
+static void hex_write(const char* src, size_t len) {
+	memcpy(hex_out_buf + hex_out_len, src, len);
+	hex_out_len += len;
+}
+
+static volatile size_t bench_sink;
+
+int main(void) {
+	char dec[JSON_DECIMAL_LEN];
+	uint8_t bytes[256];
+	char decoded[256];
+	clock_t start;
+	double divmod_s, pairs_s, checked_s, nybbles_s, table_s, decode_s;
+	int32_t val;
+
+	start = clock();
+	for (uint32_t i = 0; i < BENCH_PASSES; i++) {
+		bench_sink += encode_decimal_divmod(dec, i * 21517u);
+	}
+	divmod_s = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	start = clock();
+	for (uint32_t i = 0; i < BENCH_PASSES; i++) {
+		bench_sink += encode_decimal_unsigned_to(dec, i * 21517u);
+	}
+	pairs_s = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	start = clock();
+	for (uint32_t i = 0; i < BENCH_PASSES; i++) {
+		size_t len = encode_decimal_unsigned_to(dec, i * 21517u);
+		decode_decimal_checked(&val, dec, len);
+		bench_sink += val;
+	}
+	checked_s = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	for (int i = 0; i < 256; i++) {
+		bytes[i] = i * 7;
+	}
+	start = clock();
+	for (int pass = 0; pass < BENCH_HEX_PASSES; pass++) {
+		hex_out_len = 0;
+		hex_write_nybbles(hex_write, bytes, sizeof(bytes));
+	}
+	nybbles_s = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	start = clock();
+	for (int pass = 0; pass < BENCH_HEX_PASSES; pass++) {
+		hex_out_len = 0;
+		encode_hexbuf(hex_write, bytes, sizeof(bytes));
+	}
+	table_s = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	start = clock();
+	for (int pass = 0; pass < BENCH_HEX_PASSES; pass++) {
+		decode_hexbuf(copy, decoded, hex_out_buf, hex_out_len);
+	}
+	decode_s = (double)(clock() - start) / CLOCKS_PER_SEC;
+	if (memcmp(bytes, decoded, sizeof(bytes))) {
+		printf("hex didn't decode to what was encoded\n");
+		exit(1);
+	}
+
+	printf("%-24s %9s\n", "decimal", "ns");
+	printf("%-24s %9.1f\n", "encode, div/mod", divmod_s * 1e9 / BENCH_PASSES);
+	printf("%-24s %9.1f\n", "encode, pairs", pairs_s * 1e9 / BENCH_PASSES);
+	printf("%-24s %9.1f\n", "encode + checked decode", checked_s * 1e9 / BENCH_PASSES);
+	printf("\n%-24s %9s\n", "hex", "MB/s");
+	printf("%-24s %9.1f\n", "encode, nybbles", sizeof(bytes) * BENCH_HEX_PASSES / nybbles_s / 1e6);
+	printf("%-24s %9.1f\n", "encode, table", sizeof(bytes) * BENCH_HEX_PASSES / table_s / 1e6);
+	printf("%-24s %9.1f\n", "decode", sizeof(bytes) * BENCH_HEX_PASSES / decode_s / 1e6);
+	return 0;
+}
@@ -0,0 +1,63 @@
+// euclidean rhythms, one step at a time: the old table lookup against
+// euclidean(), and against building a mask once and testing its bits.
+//
+//   make bench
+
+#include <stdio.h>
+#include <time.h>
+
+#include "euclidean/euclidean.c"
+
+#include "../unit/euclidean_table.c"
+
+#define BENCH_PASSES 2000
+
+// (fill, len, step) queries and (fill, len) patterns in a pass
+#define BENCH_QUERIES 11440.0
+#define BENCH_PATTERNS 528.0
+
+int main(void) {
+    clock_t start;
+    double table_s, euclidean_s, build_s, mask_s;
+    volatile int sink = 0;
+    int pass, len, fill, step;
+    u32 masks[33];
+
+    start = clock();
+    for (pass = 0; pass < BENCH_PASSES; pass++)
+        for (len = 1; len <= 32; len++)
+            for (fill = 1; fill <= len; fill++)
+                for (step = 0; step < len; step++)
+                    sink += table_lookup(fill, len, step);
+    table_s = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (pass = 0; pass < BENCH_PASSES; pass++)
+        for (len = 1; len <= 32; len++)
+            for (fill = 1; fill <= len; fill++)
+                for (step = 0; step < len; step++)
+                    sink += euclidean(fill, len, step);
+    euclidean_s = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (pass = 0; pass < BENCH_PASSES; pass++)
+        for (len = 1; len <= 32; len++)
+            for (fill = 1; fill <= len; fill++)
+                masks[fill] = euclidean_mask(fill, len, pass);
+    build_s = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (pass = 0; pass < BENCH_PASSES; pass++)
+        for (len = 1; len <= 32; len++)
+            for (fill = 1; fill <= len; fill++)
+                for (step = 0; step < len; step++)
+                    sink += euclidean_mask_step(masks[fill], step);
+    mask_s = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    printf("%-20s %9s\n", "", "ns");
+    printf("%-20s %9.2f\n", "table, per step", table_s * 1e9 / BENCH_PASSES / BENCH_QUERIES);
+    printf("%-20s %9.2f\n", "euclidean, per step", euclidean_s * 1e9 / BENCH_PASSES / BENCH_QUERIES);
+    printf("%-20s %9.2f\n", "mask, per step", mask_s * 1e9 / BENCH_PASSES / BENCH_QUERIES);
+    printf("%-20s %9.2f\n", "mask build", build_s * 1e9 / BENCH_PASSES / BENCH_PATTERNS);
+    return 0;
+}
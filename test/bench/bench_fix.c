@@ -0,0 +1,56 @@
+// number formatting: itoa_whole and print_fix16 against the per-digit
+// div/mod routines they replaced.
+//
+//   make bench
+
+#include <stdio.h>
+#include <time.h>
+
+#include "fix.c"
+
+#include "../unit/fix_reference.c"
+
+#define BENCH_VALUES 2000000
+
+int main(void) {
+	clock_t start;
+	double old_s, new_s, old_fix_s, new_fix_s;
+	char buf[16];
+	volatile char sink = 0;
+	s32 v;
+
+	start = clock();
+	for (v = 0; v < BENCH_VALUES; v++) {
+		old_itoa_whole(v * 7 - BENCH_VALUES, buf, 8);
+		sink += buf[7];
+	}
+	old_s = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	start = clock();
+	for (v = 0; v < BENCH_VALUES; v++) {
+		itoa_whole(v * 7 - BENCH_VALUES, buf, 8);
+		sink += buf[7];
+	}
+	new_s = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	start = clock();
+	for (v = 0; v < BENCH_VALUES; v++) {
+		old_print_fix16(buf, (fix16_t)((u32)v * 2099));
+		sink += buf[11];
+	}
+	old_fix_s = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	start = clock();
+	for (v = 0; v < BENCH_VALUES; v++) {
+		print_fix16(buf, (fix16_t)((u32)v * 2099));
+		sink += buf[11];
+	}
+	new_fix_s = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	printf("%-12s %9s %9s\n", "ns", "div/mod", "now");
+	printf("%-12s %9.1f %9.1f\n", "itoa_whole",
+	       old_s * 1e9 / BENCH_VALUES, new_s * 1e9 / BENCH_VALUES);
+	printf("%-12s %9.1f %9.1f\n", "print_fix16",
+	       old_fix_s * 1e9 / BENCH_VALUES, new_fix_s * 1e9 / BENCH_VALUES);
+	return 0;
+}
@@ -0,0 +1,94 @@
+// the fix16 batch kernels against calling the scalar function for each
+// element, over arrays of a mix of small and full range values.
+//
+//   make bench
+
+#include <stdio.h>
+#include <time.h>
+
+#include "types.h"
+
+#define FIXMATH_BATCH_VECTOR
+
+#include "libfixmath/fix16_batch.c"
+#include "libfixmath/fix16.c"
+#include "libfixmath/fix16_sqrt.c"
+#include "libfixmath/fix16_trig.c"
+
+// odd, so the vector paths leave a remainder
+#define N 1027
+#define BENCH_PASSES 2000
+
+static fix16_t a[N], b[N], out[N];
+
+static u32 rand_state = 1;
+static fix16_t rand_fix16(void) {
+	rand_state ^= rand_state << 13;
+	rand_state ^= rand_state >> 17;
+	rand_state ^= rand_state << 5;
+	return (fix16_t)rand_state;
+}
+
+static void fill(fix16_t* x, u8 shift) {
+	for (u16 i = 0; i < N; i++) {
+		x[i] = rand_fix16() >> (i % 4 == 0 ? 0 : shift);
+	}
+}
+
+static void report(const char* name, double scalar_s, double batch_s) {
+	double per = 1e9 / ((double)BENCH_PASSES * N);
+	printf("%-6s %9.2f %9.2f\n", name, scalar_s * per, batch_s * per);
+}
+
+int main(void) {
+	clock_t start;
+	double scalar_s, batch_s;
+	u16 pass, i;
+
+	fill(a, 8);
+	fill(b, 8);
+	printf("%-6s %9s %9s\n", "ns", "scalar", "batch");
+
+	start = clock();
+	for (pass = 0; pass < BENCH_PASSES; pass++)
+		for (i = 0; i < N; i++) out[i] = fix16_mul(a[i], b[i]);
+	scalar_s = (double)(clock() - start) / CLOCKS_PER_SEC;
+	start = clock();
+	for (pass = 0; pass < BENCH_PASSES; pass++) fix16_mul_n(out, a, b, N);
+	batch_s = (double)(clock() - start) / CLOCKS_PER_SEC;
+	report("mul", scalar_s, batch_s);
+
+	start = clock();
+	for (pass = 0; pass < BENCH_PASSES; pass++)
+		for (i = 0; i < N; i++) out[i] = fix16_lerp16(a[i], b[i], pass);
+	scalar_s = (double)(clock() - start) / CLOCKS_PER_SEC;
+	start = clock();
+	for (pass = 0; pass < BENCH_PASSES; pass++) fix16_lerp_n(out, a, b, pass, N);
+	batch_s = (double)(clock() - start) / CLOCKS_PER_SEC;
+	report("lerp", scalar_s, batch_s);
+
+	// a moving phase, so the scalar sin's cache mostly misses as it would
+	// for an lfo bank
+	start = clock();
+	for (pass = 0; pass < BENCH_PASSES; pass++)
+		for (i = 0; i < N; i++) out[i] = fix16_sin(a[i] + pass * 37);
+	scalar_s = (double)(clock() - start) / CLOCKS_PER_SEC;
+	start = clock();
+	for (pass = 0; pass < BENCH_PASSES; pass++) {
+		for (i = 0; i < N; i++) b[i] = a[i] + pass * 37;
+		fix16_sin_n(out, b, N);
+	}
+	batch_s = (double)(clock() - start) / CLOCKS_PER_SEC;
+	report("sin", scalar_s, batch_s);
+
+	fill(b, 8);
+	start = clock();
+	for (pass = 0; pass < BENCH_PASSES; pass++)
+		for (i = 0; i < N; i++) out[i] = fix16_sadd(a[i], b[i]);
+	scalar_s = (double)(clock() - start) / CLOCKS_PER_SEC;
+	start = clock();
+	for (pass = 0; pass < BENCH_PASSES; pass++) fix16_sadd_n(out, a, b, N);
+	batch_s = (double)(clock() - start) / CLOCKS_PER_SEC;
+	report("sadd", scalar_s, batch_s);
+	return 0;
+}
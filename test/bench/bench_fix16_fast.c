@@ -0,0 +1,62 @@
+// the table driven fix16 functions at the default FIXMATH_FAST_BITS,
+// against the fix16 functions they stand in for and libm.
+//
+//   make bench
+
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "types.h"
+
+#include "libfixmath/fix16_fast.c"
+#include "libfixmath/fix16.c"
+#include "libfixmath/fix16_exp.c"
+#include "libfixmath/fix16_sqrt.c"
+#include "libfixmath/fix16_trig.c"
+
+#define BENCH_N 1000000
+
+static volatile fix16_t bench_sink;
+static volatile double bench_sink_d;
+
+static double bench_fix(fix16_t (*f)(fix16_t), s32 start, s32 step) {
+	clock_t t = clock();
+	fix16_t acc = 0;
+	s32 x = start;
+	for (u32 i = 0; i < BENCH_N; i++, x += step) acc += f(x);
+	bench_sink = acc;
+	return (double)(clock() - t) / CLOCKS_PER_SEC * 1e9 / BENCH_N;
+}
+
+static double bench_libm(double (*f)(double), s32 start, s32 step) {
+	clock_t t = clock();
+	double acc = 0;
+	s32 x = start;
+	for (u32 i = 0; i < BENCH_N; i++, x += step) acc += f(x / 65536.0);
+	bench_sink_d = acc;
+	return (double)(clock() - t) / CLOCKS_PER_SEC * 1e9 / BENCH_N;
+}
+
+int main(void) {
+	printf("%d bits, ns\n\n", FIXMATH_FAST_BITS);
+	printf("%-5s %9s %9s %9s\n", "", "fast", "fix16", "libm");
+
+	// odd steps walk the whole range so the fix16_sin/fix16_exp caches
+	// mostly miss, as they would for a bank of moving lfos
+	printf("%-5s %9.2f %9.2f %9.2f\n", "sin",
+	       bench_fix(fix16_sin_fast, -fix16_pi, 413),
+	       bench_fix(fix16_sin, -fix16_pi, 413),
+	       bench_libm(sin, -fix16_pi, 413));
+	printf("%-5s %9.2f %9.2f %9.2f\n", "exp",
+	       bench_fix(fix16_exp_fast, -8 * fix16_one, 131),
+	       bench_fix(fix16_exp, -8 * fix16_one, 131),
+	       bench_libm(exp, -8 * fix16_one, 131));
+	printf("%-5s %9.2f %9s %9.2f\n", "pow2",
+	       bench_fix(fix16_pow2_fast, -8 * fix16_one, 131), "",
+	       bench_libm(exp2, -8 * fix16_one, 131));
+	printf("%-5s %9.2f %9s %9.2f\n", "log2",
+	       bench_fix(fix16_log2_fast, 1, 2147), "",
+	       bench_libm(log2, 1, 2147));
+	return 0;
+}
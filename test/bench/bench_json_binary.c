@@ -0,0 +1,123 @@
+// the binary format against JSON: the test schema written to a writer
+// that drops it and read back from memory, both ways.
+//
+//   make bench
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define __PRINT_FUNCS_H__
+#define print_dbg(s)
+#define print_dbg_char(c)
+#define print_dbg_hex(x)
+#define print_dbg_ulong(n)
+
+#include "../unit/json/json_test_common.c"
+#include "../unit/json/json_test_schema.c"
+#include "json/binary.c"
+
+#define BENCH_PASSES 5000
+
+static char bench_text[8192];
+static size_t bench_text_len, bench_text_pos;
+
+static void bench_write(const char* src, size_t len) {
+	if (bench_text_len + len > sizeof(bench_text)) {
+		printf("document doesn't fit in %zu bytes\n", sizeof(bench_text));
+		exit(1);
+	}
+	memcpy(bench_text + bench_text_len, src, len);
+	bench_text_len += len;
+}
+
+static size_t bench_read(char* dst, size_t len) {
+	size_t n = bench_text_len - bench_text_pos;
+	if (n > len) n = len;
+	memcpy(dst, bench_text + bench_text_pos, n);
+	bench_text_pos += n;
+	return n;
+}
+
+static void nop_write(const char* src, size_t len) {
+}
+
+static json_test_dest_t sample;
+
+static void fill_sample(void) {
+	memset(&sample, 0, sizeof(sample));
+	sample.ubyte = 200;
+	sample.sbyte = -100;
+	sample.ushort = 60000;
+	sample.sshort = -30000;
+	sample.ulong = 4000000000u;
+	sample.slong = -2147483647 - 1;
+	sample.boolean = true;
+	sample.test_enum = TEST_ENUM_TWO;
+	for (int i = 0; i < sizeof(sample.buffer); i++) sample.buffer[i] = i * 17;
+	sample.nested.ubyte = 11;
+	sample.nested_cached.ubyte = 22;
+	for (int i = 0; i < 4; i++) sample.nested_array[i].ubyte = 30 + i;
+	memcpy(sample.longstring, LONG_STRING, sizeof(sample.longstring));
+	for (int i = 0; i < sizeof(sample.longbuffer); i++) sample.longbuffer[i] = 255 - i;
+}
+
+static void bench(const char* label, bool binary) {
+	static char textbuf[256];
+	static jsmntok_t tokens[32];
+	static uint8_t buf[256];
+	json_read_result_t result = JSON_READ_OK;
+	clock_t start;
+	double write_s, read_s;
+
+	bench_text_len = 0;
+	if (binary) {
+		json_write_binary(bench_write, &sample, &json_test_docdef);
+	}
+	else {
+		json_write(bench_write, &sample, &json_test_docdef);
+	}
+
+	start = clock();
+	for (int pass = 0; pass < BENCH_PASSES; pass++) {
+		if (binary) {
+			json_write_binary(nop_write, &sample, &json_test_docdef);
+		}
+		else {
+			json_write(nop_write, &sample, &json_test_docdef);
+		}
+	}
+	write_s = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	start = clock();
+	for (int pass = 0; pass < BENCH_PASSES && result == JSON_READ_OK; pass++) {
+		bench_text_pos = 0;
+		if (binary) {
+			result = json_read_binary(bench_read, copy, &json_test_dest, &json_test_docdef,
+						  buf, sizeof(buf));
+		}
+		else {
+			result = json_read(bench_read, copy, &json_test_dest, &json_test_docdef,
+					   textbuf, sizeof(textbuf),
+					   tokens, sizeof(tokens) / sizeof(tokens[0]));
+		}
+	}
+	read_s = (double)(clock() - start) / CLOCKS_PER_SEC;
+	if (result != JSON_READ_OK || memcmp(&sample, &json_test_dest, sizeof(sample))) {
+		printf("\n%s: didn't read back what was written\n", label);
+		exit(1);
+	}
+
+	printf("%-6s %9zu %9.2f %9.2f\n", label, bench_text_len,
+	       write_s * 1e6 / BENCH_PASSES, read_s * 1e6 / BENCH_PASSES);
+}
+
+int main(void) {
+	fill_sample();
+	printf("%-6s %9s %9s %9s\n", "format", "bytes", "write us", "read us");
+	bench("json", false);
+	bench("binary", true);
+	return 0;
+}
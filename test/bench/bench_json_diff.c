@@ -0,0 +1,95 @@
+// incremental saves: the test schema with one value changed, written
+// in full with json_write and as a patch with json_write_diff.
+//
+//   make bench
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define __PRINT_FUNCS_H__
+#define print_dbg(s)
+#define print_dbg_char(c)
+#define print_dbg_hex(x)
+#define print_dbg_ulong(n)
+
+#include "../unit/json/json_test_common.c"
+#include "../unit/json/json_test_schema.c"
+#include "json/diff.c"
+
+#define BENCH_PASSES 20000
+
+static char bench_text[8192];
+static size_t bench_text_len;
+
+static uint32_t bench_slots[32];
+
+static void bench_write(const char* src, size_t len) {
+	if (bench_text_len + len > sizeof(bench_text)) {
+		printf("document doesn't fit in %zu bytes\n", sizeof(bench_text));
+		exit(1);
+	}
+	memcpy(bench_text + bench_text_len, src, len);
+	bench_text_len += len;
+}
+
+static void fill_dest(json_test_dest_t* dest) {
+	memset(dest, 0, sizeof(*dest));
+	dest->ubyte = 200;
+	dest->sbyte = -100;
+	dest->ushort = 60000;
+	dest->sshort = -30000;
+	dest->ulong = 123456789;
+	dest->slong = -2147483647 - 1;
+	dest->boolean = true;
+	dest->test_enum = TEST_ENUM_TWO;
+	for (int i = 0; i < sizeof(dest->buffer); i++) dest->buffer[i] = i * 17;
+	dest->nested.ubyte = 11;
+	dest->nested_cached.ubyte = 22;
+	for (int i = 0; i < 4; i++) dest->nested_array[i].ubyte = 30 + i;
+	memcpy(dest->longstring, LONG_STRING, sizeof(dest->longstring));
+	for (int i = 0; i < sizeof(dest->longbuffer); i++) dest->longbuffer[i] = 255 - i;
+}
+
+static void bench(const char* label, bool diff) {
+	json_write_result_t result;
+	clock_t start;
+	double s;
+
+	start = clock();
+	for (int pass = 0; pass < BENCH_PASSES; pass++) {
+		bench_text_len = 0;
+		if (diff) {
+			result = json_write_diff(bench_write, &json_test_dest, &json_test_docdef, bench_slots);
+		}
+		else {
+			result = json_write(bench_write, &json_test_dest, &json_test_docdef);
+		}
+		if (result != JSON_WRITE_OK) {
+			printf("\n%s: write failed with %d\n", label, result);
+			exit(1);
+		}
+	}
+	s = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	printf("%-6s %9.2f %9zu\n", label, s * 1e6 / BENCH_PASSES, bench_text_len);
+}
+
+int main(void) {
+	if (json_diff_slots(&json_test_docdef) > sizeof(bench_slots) / sizeof(bench_slots[0])) {
+		printf("the test schema needs more than %zu snapshot slots\n",
+		       sizeof(bench_slots) / sizeof(bench_slots[0]));
+		exit(1);
+	}
+	fill_dest(&json_test_dest);
+	json_diff_snapshot(&json_test_dest, &json_test_docdef, bench_slots);
+	json_test_dest.nested_array[1].ubyte = 0;
+
+	printf("saving the test schema with one array item changed\n\n");
+	printf("%-6s %9s %9s\n", "save", "us", "bytes");
+	bench("full", false);
+	bench("patch", true);
+	return 0;
+}
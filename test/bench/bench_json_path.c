@@ -0,0 +1,112 @@
+// selective preset loading: one slot of a bank read by reading the
+// whole document, by json_read_path from the start, and by seeking to
+// an offset json_index_path recorded.
+//
+//   make bench
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define __PRINT_FUNCS_H__
+#define print_dbg(s)
+#define print_dbg_char(c)
+#define print_dbg_hex(x)
+#define print_dbg_ulong(n)
+
+#include "../unit/json/json_test_common.c"
+#include "../unit/json/json_test_bank.c"
+
+#define BENCH_PASSES 2000
+
+static char bench_mem[32768];
+static size_t bench_mem_len, bench_mem_pos;
+
+static char bench_textbuf[64];
+
+static size_t bench_read(char* dst, size_t len) {
+	size_t n = bench_mem_len - bench_mem_pos;
+	if (n > len) n = len;
+	memcpy(dst, bench_mem + bench_mem_pos, n);
+	bench_mem_pos += n;
+	return n;
+}
+
+static void bench_write(const char* src, size_t len) {
+	if (bench_mem_len + len > sizeof(bench_mem)) {
+		printf("bank doesn't fit in %zu bytes\n", sizeof(bench_mem));
+		exit(1);
+	}
+	memcpy(bench_mem + bench_mem_len, src, len);
+	bench_mem_len += len;
+}
+
+static void write_bank(void) {
+	bank.version = 3;
+	for (int i = 0; i < SLOT_CT; i++) {
+		bank.slots[i].level = i + 1;
+		bank.slots[i].len = 1000 + i;
+		for (int j = 0; j < sizeof(bank.slots[i].steps); j++) {
+			bank.slots[i].steps[j] = i * 7 + j;
+		}
+	}
+	json_write(bench_write, &bank, &bank_docdef);
+}
+
+// the whole bank when path is NULL, otherwise the value at path, read
+// from offset start
+static void bench(const char* label, size_t start, const char* path) {
+	json_read_result_t result;
+	clock_t t;
+	double s;
+
+	t = clock();
+	for (int pass = 0; pass < BENCH_PASSES; pass++) {
+		bench_mem_pos = start;
+		if (path == NULL) {
+			result = json_read(bench_read, copy, &bank_in, &bank_docdef,
+					   bench_textbuf, sizeof(bench_textbuf), NULL, 0);
+		} else if (start == 0) {
+			result = json_read_path(bench_read, copy, &bank_in, &bank_docdef, path,
+						bench_textbuf, sizeof(bench_textbuf));
+		} else {
+			result = json_read_path_at(bench_read, copy, &bank_in, &bank_docdef, path,
+						   bench_textbuf, sizeof(bench_textbuf));
+		}
+		if (result != JSON_READ_OK) {
+			printf("\n%s: read failed with %d\n", label, result);
+			exit(1);
+		}
+	}
+	s = (double)(clock() - t) / CLOCKS_PER_SEC;
+
+	printf("%-6s %9.1f %9zu\n", label, s * 1e6 / BENCH_PASSES, bench_mem_pos - start);
+}
+
+int main(void) {
+	uint32_t offsets[SLOT_CT];
+	size_t ct;
+	char path[16];
+
+	write_bank();
+	sprintf(path, "slots/%d", SLOT_CT - 1);
+	bench_mem_pos = 0;
+	if (json_index_path(bench_read, "slots", offsets, SLOT_CT, &ct,
+			    bench_textbuf, sizeof(bench_textbuf)) != JSON_READ_OK || ct != SLOT_CT) {
+		printf("couldn't index the bank's slots\n");
+		exit(1);
+	}
+
+	printf("%zu byte bank of %d slots, reading the last one\n\n", bench_mem_len, SLOT_CT);
+	printf("%-6s %9s %9s\n", "read", "us", "bytes");
+	bench("whole", 0, NULL);
+	bench("path", 0, path);
+	bench("seek", offsets[SLOT_CT - 1], path);
+	if (memcmp(&bank.slots[SLOT_CT - 1], &bank_in.slots[SLOT_CT - 1], sizeof(slot_t)) != 0) {
+		printf("\nthe slot read back differs\n");
+		exit(1);
+	}
+	return 0;
+}
@@ -0,0 +1,152 @@
+// json_read throughput against the test schema, for a range of text
+// buffer sizes: what a smaller buffer costs in wrapping and refills.
+//
+// the inputs are the whole schema as json_write writes it, and a set
+// of generated documents with whitespace, reordered and unknown keys.
+//
+//   make bench
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define __PRINT_FUNCS_H__
+#define print_dbg(s)
+#define print_dbg_char(c)
+#define print_dbg_hex(x)
+#define print_dbg_ulong(n)
+
+#include "../unit/json/json_test_common.c"
+#include "../unit/json/json_test_schema.c"
+#include "../fuzz/json_doc_gen.c"
+
+#define BENCH_DOCS 64
+#define BENCH_DOC_LEN 4096
+#define BENCH_BYTES (8 * 1024 * 1024)
+
+static char bench_docs[BENCH_DOCS][BENCH_DOC_LEN];
+static size_t bench_doc_lens[BENCH_DOCS];
+static size_t bench_doc_ct;
+
+static char bench_textbuf[1024];
+
+static const char* bench_doc;
+static size_t bench_doc_len, bench_doc_pos;
+static uint32_t bench_refills;
+
+static size_t bench_read(char* dst, size_t len) {
+	size_t n = bench_doc_len - bench_doc_pos;
+	if (n > len) n = len;
+	memcpy(dst, bench_doc + bench_doc_pos, n);
+	bench_doc_pos += n;
+	bench_refills++;
+	return n;
+}
+
+static void bench_write(const char* src, size_t len) {
+	char* doc = bench_docs[bench_doc_ct];
+	size_t* doc_len = &bench_doc_lens[bench_doc_ct];
+	if (*doc_len + len > BENCH_DOC_LEN) {
+		len = BENCH_DOC_LEN - *doc_len;
+	}
+	memcpy(doc + *doc_len, src, len);
+	*doc_len += len;
+}
+
+static void fill_dest(json_test_dest_t* dest) {
+	uint8_t* p = (uint8_t*)dest;
+	for (size_t i = 0; i < sizeof(*dest); i++) {
+		p[i] = json_gen_rand();
+	}
+	// stay inside what the readers accept
+	dest->boolean = json_gen_rand() % 2;
+	dest->test_enum = json_gen_rand() % 3;
+	for (size_t i = 0; i < sizeof(dest->longstring); i++) {
+		dest->longstring[i] = 'a' + json_gen_rand() % 26;
+	}
+}
+
+static void make_docs(void) {
+	json_test_dest_t dest;
+
+	json_gen_seed(1);
+	fill_dest(&dest);
+	json_write(bench_write, &dest, &json_test_docdef);
+	bench_doc_ct++;
+	while (bench_doc_ct < BENCH_DOCS) {
+		bench_doc_lens[bench_doc_ct] = json_gen_document(
+			bench_docs[bench_doc_ct], BENCH_DOC_LEN, &json_test_docdef, true);
+		bench_doc_ct++;
+	}
+}
+
+static void bench(const char* label, size_t first, size_t last, size_t textbuf_len) {
+	size_t doc_bytes = 0;
+	uint32_t reads = 0, tokens = 0;
+	clock_t start;
+	double s;
+
+	for (size_t i = first; i < last; i++) {
+		doc_bytes += bench_doc_lens[i];
+	}
+	bench_refills = 0;
+	start = clock();
+	for (size_t total = 0; total < BENCH_BYTES; total += doc_bytes) {
+		for (size_t i = first; i < last; i++) {
+			bench_doc = bench_docs[i];
+			bench_doc_len = bench_doc_lens[i];
+			bench_doc_pos = 0;
+			if (json_read(bench_read, copy, &json_test_dest, &json_test_docdef,
+				      bench_textbuf, textbuf_len, NULL, 0) != JSON_READ_OK) {
+				printf("\n%s: document %zu didn't read with a %zu byte buffer\n",
+				       label, i, textbuf_len);
+				exit(1);
+			}
+			tokens += deserialize_state.total_tokens_read;
+			reads++;
+		}
+	}
+	s = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	printf("%-9s %5zu %9.1f %11.2f %9.1f %9.1f\n",
+	       label, textbuf_len,
+	       (double)doc_bytes * reads / (last - first) / s / 1e6,
+	       tokens / s / 1e6,
+	       (double)bench_refills / reads,
+	       s * 1e6 / reads);
+}
+
+int main(void) {
+	static const size_t textbuf_lens[] = {
+		16, 24, 32, 48, 64, 128, 256, 512, 1024,
+	};
+	const size_t textbuf_ct = sizeof(textbuf_lens) / sizeof(textbuf_lens[0]);
+	static uint32_t arena_buf[16];
+	json_arena_t arena;
+	json_read_object_params_t* params =
+		find_docdef(&json_test_docdef, "nested_cached")->params;
+	size_t generated_bytes = 0;
+
+	// as the firmware would, to keep malloc out of the numbers
+	params->alloc = json_arena_alloc;
+	params->free = json_arena_free;
+	json_arena_init(&arena, arena_buf, sizeof(arena_buf));
+
+	make_docs();
+	for (size_t i = 1; i < bench_doc_ct; i++) {
+		generated_bytes += bench_doc_lens[i];
+	}
+	printf("written document of %zu bytes, %zu generated of %zu on average\n\n",
+	       bench_doc_lens[0], bench_doc_ct - 1, generated_bytes / (bench_doc_ct - 1));
+	printf("%-9s %5s %9s %11s %9s %9s\n",
+	       "document", "buf", "MB/s", "Mtokens/s", "reads", "us/doc");
+	for (size_t i = 0; i < textbuf_ct; i++) {
+		bench("written", 0, 1, textbuf_lens[i]);
+	}
+	for (size_t i = 0; i < textbuf_ct; i++) {
+		bench("generated", 1, bench_doc_ct, textbuf_lens[i]);
+	}
+	return 0;
+}
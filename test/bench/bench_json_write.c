@@ -0,0 +1,83 @@
+// buffered writes: the test schema written straight to a slow writer
+// and through json_write_buffered. each call to the writer costs about
+// what a FAT write call would in setup, modeled as fixed busy work.
+//
+//   make bench
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define __PRINT_FUNCS_H__
+#define print_dbg(s)
+#define print_dbg_char(c)
+#define print_dbg_hex(x)
+#define print_dbg_ulong(n)
+
+#include "../unit/json/json_test_common.c"
+#include "../unit/json/json_test_schema.c"
+
+#define BENCH_PASSES 2000
+#define CALL_COST 200
+
+static volatile uint32_t call_cost_sink;
+static uint32_t bench_calls;
+static size_t bench_bytes;
+
+static void slow_write(const char* src, size_t len) {
+	for (int i = 0; i < CALL_COST; i++) call_cost_sink += i;
+	bench_calls++;
+	bench_bytes += len;
+}
+
+static void fill_dest(void) {
+	memset(&json_test_dest, 0, sizeof(json_test_dest));
+	json_test_dest.ulong = 123456789;
+	json_test_dest.sshort = -42;
+	json_test_dest.test_enum = TEST_ENUM_ONE;
+	for (int i = 0; i < sizeof(json_test_dest.buffer); i++) json_test_dest.buffer[i] = i;
+	memcpy(json_test_dest.longstring, LONG_STRING, sizeof(json_test_dest.longstring));
+}
+
+// buf_len 0 writes unbuffered
+static void bench(const char* label, size_t buf_len) {
+	static char buf[4096];
+	json_write_result_t result;
+	clock_t start;
+	double s;
+
+	bench_calls = 0;
+	bench_bytes = 0;
+	start = clock();
+	for (int pass = 0; pass < BENCH_PASSES; pass++) {
+		if (buf_len == 0) {
+			result = json_write(slow_write, &json_test_dest, &json_test_docdef);
+		}
+		else {
+			result = json_write_buffered(slow_write, buf, buf_len,
+						     &json_test_dest, &json_test_docdef);
+		}
+		if (result != JSON_WRITE_OK) {
+			printf("\n%s: write failed with %d\n", label, result);
+			exit(1);
+		}
+	}
+	s = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	printf("%-10s %5zu %9u %9.1f\n", label, buf_len,
+	       bench_calls / BENCH_PASSES, bench_bytes / s / 1e6);
+}
+
+int main(void) {
+	static const size_t buf_lens[] = { 64, 512, 4096 };
+
+	fill_dest();
+	printf("%-10s %5s %9s %9s\n", "write", "buf", "calls/doc", "MB/s");
+	bench("unbuffered", 0);
+	for (size_t i = 0; i < sizeof(buf_lens) / sizeof(buf_lens[0]); i++) {
+		bench("buffered", buf_lens[i]);
+	}
+	return 0;
+}
@@ -0,0 +1,31 @@
+// the note pool: holds and releases against a full pool, so every hold
+// evicts and every release finds its note somewhere in the middle.
+//
+//   make bench
+
+#include <stdio.h>
+#include <time.h>
+
+#include "notes.c"
+
+#define BENCH_ITERATIONS 1000000
+
+int main(void) {
+	note_pool_t p;
+	clock_t start;
+	double elapsed;
+	u32 i;
+
+	notes_init(&p);
+
+	start = clock();
+	for (i = 0; i < BENCH_ITERATIONS; i++) {
+		notes_hold(&p, (i * 7) & 0x7f, 1);
+		notes_release(&p, (i * 13) & 0x7f);
+	}
+	elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+	printf("pool size %d\n\n", NOTE_POOL_SIZE);
+	printf("hold/release %9.1f ns/event\n", elapsed * 1e9 / (2.0 * BENCH_ITERATIONS));
+	return 0;
+}
@@ -0,0 +1,57 @@
+// random: xoshiro128** against the multiply-with-carry generator it
+// replaced, per value and for ranges.
+//
+//   make bench
+
+#include <stdio.h>
+#include <time.h>
+
+#include "random.c"
+
+#define BENCH_N (1 << 22)
+
+static u32 bench_buf[1024];
+
+// the old generator, for comparison
+typedef struct { u32 z, w; } mwc_state_t;
+
+static u32 mwc_next(mwc_state_t *r) {
+	r->z = 36969 * (r->z & 65535) + (r->z >> 16);
+	r->w = 18000 * (r->w & 65535) + (r->w >> 16);
+	return ((r->z << 16) + r->w) & 0x7FFFFFFF;
+}
+
+int main(void) {
+	random_state_t r;
+	mwc_state_t m = { 12345, 12345 };
+	volatile u32 sink = 0;
+	u32 i, acc = 0;
+	clock_t start;
+	double ns = 1e9 / BENCH_N;
+
+	random_seed(&r, 12345);
+
+	start = clock();
+	for (i = 0; i < BENCH_N; i++) acc += mwc_next(&m);
+	printf("mwc next:         %.2f ns\n", (double)(clock() - start) / CLOCKS_PER_SEC * ns);
+
+	start = clock();
+	for (i = 0; i < BENCH_N; i++) acc += random_next32(&r);
+	printf("random_next32:    %.2f ns\n", (double)(clock() - start) / CLOCKS_PER_SEC * ns);
+
+	start = clock();
+	for (i = 0; i < BENCH_N; i += 1024) random_fill(&r, bench_buf, 1024);
+	printf("random_fill:      %.2f ns\n", (double)(clock() - start) / CLOCKS_PER_SEC * ns);
+
+	start = clock();
+	for (i = 0; i < BENCH_N; i++) acc += mwc_next(&m) % 12;
+	printf("mwc %% 12:         %.2f ns\n", (double)(clock() - start) / CLOCKS_PER_SEC * ns);
+
+	start = clock();
+	for (i = 0; i < BENCH_N; i++) acc += random_range(&r, 12);
+	printf("random_range(12): %.2f ns\n", (double)(clock() - start) / CLOCKS_PER_SEC * ns);
+
+	sink = acc + bench_buf[7];
+	(void)sink;
+	return 0;
+}
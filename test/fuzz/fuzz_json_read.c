@@ -0,0 +1,207 @@
+// fuzz harness for json_read against the test schema.
+//
+// an input is one byte choosing the text buffer length, one choosing
+// how much each read callback hands over, then the document. each
+// input is read twice, with those sizes and with a buffer that holds
+// the whole document, and checked for:
+//
+//   - nothing written outside the text buffer or destination
+//   - only JSON_READ_OK or JSON_READ_MALFORMED coming back
+//   - the arena left as it was
+//   - a read that succeeds with the small buffer giving the same result
+//     with the big one
+//
+// built three ways:
+//   make fuzz            standalone, one input from a file or stdin, as
+//                        AFL runs it; -corpus DIR N writes N seeds
+//   make fuzz-libfuzzer  clang -fsanitize=fuzzer, with ASan and UBSan
+//   included from unit/json/test_fuzz_read.c with FUZZ_NO_MAIN
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// the readers' diagnostics would dominate the run time
+#define __PRINT_FUNCS_H__
+#define print_dbg(s)
+#define print_dbg_char(c)
+#define print_dbg_hex(x)
+#define print_dbg_ulong(n)
+
+#include "../unit/json/json_test_common.c"
+#include "../unit/json/json_test_schema.c"
+#include "json_doc_gen.c"
+
+// "nested_cached" is the longest key of the test schema
+#define FUZZ_MIN_TEXTBUF 14
+#define FUZZ_MAX_TEXTBUF (FUZZ_MIN_TEXTBUF + 255)
+#define FUZZ_FULL_TEXTBUF 8192
+#define FUZZ_HEADER_LEN 2
+#define FUZZ_CANARY_LEN 16
+#define FUZZ_CANARY 0xa5
+
+typedef struct {
+	uint8_t pre[FUZZ_CANARY_LEN];
+	json_test_dest_t dest;
+	uint8_t post[FUZZ_CANARY_LEN];
+} fuzz_ram_t;
+
+static struct {
+	uint8_t pre[FUZZ_CANARY_LEN];
+	char text[FUZZ_FULL_TEXTBUF];
+	uint8_t post[FUZZ_CANARY_LEN];
+} fuzz_textbuf;
+
+static fuzz_ram_t fuzz_ram[2];
+
+static uint32_t fuzz_arena_buf[64];
+static json_arena_t fuzz_arena;
+
+static const uint8_t* fuzz_doc;
+static size_t fuzz_doc_len, fuzz_doc_pos, fuzz_chunk;
+
+static size_t fuzz_read(char* dst, size_t len) {
+	size_t n = fuzz_doc_len - fuzz_doc_pos;
+	if (n > len) n = len;
+	if (n > fuzz_chunk) n = fuzz_chunk;
+	memcpy(dst, fuzz_doc + fuzz_doc_pos, n);
+	fuzz_doc_pos += n;
+	return n;
+}
+
+static bool fuzz_canary_ok(const uint8_t* canary) {
+	for (int i = 0; i < FUZZ_CANARY_LEN; i++) {
+		if (canary[i] != FUZZ_CANARY) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static void fuzz_init(void) {
+	static bool done;
+	if (!done) {
+		// cached objects come out of an arena, so a malformed read that
+		// leaves one allocated shows up
+		json_read_object_params_t* params =
+			find_docdef(&json_test_docdef, "nested_cached")->params;
+		params->alloc = json_arena_alloc;
+		params->free = json_arena_free;
+		json_arena_init(&fuzz_arena, fuzz_arena_buf, sizeof(fuzz_arena_buf));
+		done = true;
+	}
+}
+
+static json_read_result_t fuzz_read_with(fuzz_ram_t* ram, size_t textbuf_len, size_t chunk) {
+	memset(fuzz_textbuf.pre, FUZZ_CANARY, FUZZ_CANARY_LEN);
+	memset(fuzz_textbuf.post, FUZZ_CANARY, FUZZ_CANARY_LEN);
+	memset(fuzz_textbuf.text + textbuf_len, FUZZ_CANARY, sizeof(fuzz_textbuf.text) - textbuf_len);
+	memset(ram, FUZZ_CANARY, sizeof(*ram));
+	fuzz_doc_pos = 0;
+	fuzz_chunk = chunk;
+	return json_read(fuzz_read, copy, &ram->dest, &json_test_docdef,
+			 fuzz_textbuf.text, textbuf_len, NULL, 0);
+}
+
+// 0 if the input passed, otherwise the line of the check that failed
+int fuzz_json_read_one(const uint8_t* data, size_t size) {
+	size_t textbuf_len, chunk;
+	json_read_result_t small, full;
+
+	if (size < FUZZ_HEADER_LEN) {
+		return 0;
+	}
+	fuzz_init();
+	textbuf_len = FUZZ_MIN_TEXTBUF + data[0];
+	chunk = 1 + data[1];
+	fuzz_doc = data + FUZZ_HEADER_LEN;
+	fuzz_doc_len = size - FUZZ_HEADER_LEN;
+
+#define FUZZ_CHECK(cond) do { if (!(cond)) return __LINE__; } while (0)
+
+	small = fuzz_read_with(&fuzz_ram[0], textbuf_len, chunk);
+	FUZZ_CHECK(small == JSON_READ_OK || small == JSON_READ_MALFORMED);
+	FUZZ_CHECK(fuzz_canary_ok(fuzz_textbuf.pre));
+	FUZZ_CHECK(fuzz_canary_ok(fuzz_textbuf.post));
+	FUZZ_CHECK(fuzz_canary_ok((uint8_t*)fuzz_textbuf.text + textbuf_len));
+	FUZZ_CHECK(fuzz_canary_ok(fuzz_ram[0].pre));
+	FUZZ_CHECK(fuzz_canary_ok(fuzz_ram[0].post));
+	FUZZ_CHECK(fuzz_arena.used == 0);
+	FUZZ_CHECK(deserialize_state.total_bytes_read <= fuzz_doc_len);
+
+	full = fuzz_read_with(&fuzz_ram[1], sizeof(fuzz_textbuf.text), fuzz_doc_len + 1);
+	FUZZ_CHECK(full == JSON_READ_OK || full == JSON_READ_MALFORMED);
+	FUZZ_CHECK(fuzz_canary_ok(fuzz_ram[1].pre));
+	FUZZ_CHECK(fuzz_canary_ok(fuzz_ram[1].post));
+	FUZZ_CHECK(fuzz_arena.used == 0);
+	if (small == JSON_READ_OK && fuzz_doc_len < sizeof(fuzz_textbuf.text)) {
+		FUZZ_CHECK(full == JSON_READ_OK);
+		FUZZ_CHECK(memcmp(&fuzz_ram[0], &fuzz_ram[1], sizeof(fuzz_ram_t)) == 0);
+	}
+
+#undef FUZZ_CHECK
+	return 0;
+}
+
+// write a generated input: the two size bytes, then a document
+size_t fuzz_json_read_input(uint8_t* dst, size_t len, bool valid) {
+	dst[0] = json_gen_rand();
+	dst[1] = json_gen_rand();
+	return FUZZ_HEADER_LEN + json_gen_document((char*)dst + FUZZ_HEADER_LEN,
+						   len - FUZZ_HEADER_LEN,
+						   &json_test_docdef, valid);
+}
+
+#ifdef LIBFUZZER
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+	if (fuzz_json_read_one(data, size) != 0) {
+		abort();
+	}
+	return 0;
+}
+
+#elif !defined(FUZZ_NO_MAIN)
+
+static uint8_t fuzz_input[FUZZ_FULL_TEXTBUF];
+
+int main(int argc, char** argv) {
+	FILE* fp = stdin;
+	size_t len;
+	int line;
+
+	if (argc == 4 && strcmp(argv[1], "-corpus") == 0) {
+		char path[1024];
+		int n = atoi(argv[3]);
+		json_gen_seed(n);
+		for (int i = 0; i < n; i++) {
+			len = fuzz_json_read_input(fuzz_input, sizeof(fuzz_input), i % 2 == 0);
+			snprintf(path, sizeof(path), "%s/seed_%04d", argv[2], i);
+			fp = fopen(path, "wb");
+			if (fp == NULL) {
+				perror(path);
+				return 1;
+			}
+			fwrite(fuzz_input, 1, len, fp);
+			fclose(fp);
+		}
+		return 0;
+	}
+	if (argc == 2) {
+		fp = fopen(argv[1], "rb");
+		if (fp == NULL) {
+			perror(argv[1]);
+			return 1;
+		}
+	}
+	len = fread(fuzz_input, 1, sizeof(fuzz_input), fp);
+	line = fuzz_json_read_one(fuzz_input, len);
+	if (line != 0) {
+		fprintf(stderr, "check at line %d failed\n", line);
+		abort();
+	}
+	return 0;
+}
+
+#endif
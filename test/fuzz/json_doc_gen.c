@@ -0,0 +1,320 @@
+// random documents for any docdef tree: known keys in any order with
+// values of the right kind, unknown keys holding anything, odd
+// whitespace, and optionally some damage on top.
+//
+// needs json/serdes.c
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+static uint32_t gen_rand_state = 1;
+
+void json_gen_seed(uint32_t seed) {
+	gen_rand_state = seed ? seed : 1;
+}
+
+// xorshift32
+uint32_t json_gen_rand(void) {
+	uint32_t x = gen_rand_state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	return gen_rand_state = x;
+}
+
+static bool gen_chance(uint32_t one_in) {
+	return json_gen_rand() % one_in == 0;
+}
+
+typedef struct {
+	char* buf;
+	size_t len;
+	size_t pos;
+	bool valid;   // only what every reader accepts
+} gen_out_t;
+
+static void gen_put(gen_out_t* o, const char* s, size_t len) {
+	if (len > o->len - o->pos) {
+		len = o->len - o->pos;
+	}
+	memcpy(o->buf + o->pos, s, len);
+	o->pos += len;
+}
+
+static void gen_puts(gen_out_t* o, const char* s) {
+	gen_put(o, s, strlen(s));
+}
+
+static void gen_space(gen_out_t* o) {
+	static const char space[] = " \t\r\n";
+	if (gen_chance(3)) {
+		for (uint32_t n = 1 + json_gen_rand() % 3; n > 0; n--) {
+			gen_put(o, &space[json_gen_rand() % 4], 1);
+		}
+	}
+}
+
+static void gen_decimal(gen_out_t* o, int64_t val) {
+	char dec[24];
+	size_t len = 0;
+	uint64_t u = val < 0 ? -(uint64_t)val : (uint64_t)val;
+
+	do {
+		dec[sizeof(dec) - ++len] = '0' + u % 10;
+		u /= 10;
+	} while (u);
+	if (val < 0) {
+		dec[sizeof(dec) - ++len] = '-';
+	}
+	gen_put(o, dec + sizeof(dec) - len, len);
+}
+
+static void gen_name(gen_out_t* o) {
+	// short enough for any text buffer that fits the schema's keys
+	static const char chars[] = "abcdefghijklmnopqrstuvwxyz_0123456789";
+	char name[12];
+	size_t len = 1 + json_gen_rand() % sizeof(name);
+
+	for (size_t i = 0; i < len; i++) {
+		name[i] = chars[json_gen_rand() % (sizeof(chars) - 1)];
+	}
+	gen_puts(o, "\"");
+	gen_put(o, name, len);
+	gen_puts(o, "\"");
+}
+
+// a value no docdef asked for, so anything goes
+static void gen_unknown(gen_out_t* o, int depth) {
+	static const char* const strings[] = {
+		"\"\"", "\"text\"", "\"\\\"quoted\\\"\"", "\"\\\\\"", "\"\\u00e9\\n\"",
+		"\"{[\"", "\"]}\"",
+	};
+	static const char* const primitives[] = {
+		"true", "false", "null", "0", "-1", "1.5e3", "4294967296",
+	};
+
+	switch (json_gen_rand() % (depth < 3 ? 4 : 2)) {
+	case 0:
+		gen_puts(o, strings[json_gen_rand() % (sizeof(strings) / sizeof(strings[0]))]);
+		break;
+	case 1:
+		gen_puts(o, primitives[json_gen_rand() % (sizeof(primitives) / sizeof(primitives[0]))]);
+		break;
+	case 2:
+		gen_puts(o, "[");
+		for (uint32_t i = 0, n = json_gen_rand() % 4; i < n; i++) {
+			if (i > 0) gen_puts(o, ",");
+			gen_space(o);
+			gen_unknown(o, depth + 1);
+		}
+		gen_puts(o, "]");
+		break;
+	default:
+		gen_puts(o, "{");
+		for (uint32_t i = 0, n = json_gen_rand() % 4; i < n; i++) {
+			if (i > 0) gen_puts(o, ",");
+			gen_space(o);
+			gen_name(o);
+			gen_puts(o, ":");
+			gen_space(o);
+			gen_unknown(o, depth + 1);
+		}
+		gen_puts(o, "}");
+		break;
+	}
+}
+
+static void gen_hex(gen_out_t* o, size_t bytes) {
+	static const char upper[] = "0123456789ABCDEF";
+	static const char lower[] = "0123456789abcdef";
+	const char* digits = gen_chance(2) ? upper : lower;
+
+	for (size_t i = 0; i < bytes * 2; i++) {
+		gen_put(o, &digits[json_gen_rand() % 16], 1);
+	}
+}
+
+static void gen_value(gen_out_t* o, json_docdef_t* docdef, int depth);
+
+static void gen_object(gen_out_t* o, json_docdef_t* docdef, int depth) {
+	json_read_object_params_t* params = (json_read_object_params_t*)docdef->params;
+	uint8_t order[256];
+	bool first = true;
+
+	for (uint8_t i = 0; i < params->docdef_ct; i++) {
+		order[i] = i;
+	}
+	for (uint8_t i = params->docdef_ct; i > 1; i--) {
+		uint8_t j = json_gen_rand() % i;
+		uint8_t t = order[i - 1];
+		order[i - 1] = order[j];
+		order[j] = t;
+	}
+
+	gen_puts(o, "{");
+	for (uint8_t i = 0; i < params->docdef_ct; i++) {
+		json_docdef_t* property = &params->docdefs[order[i]];
+		bool unknown = gen_chance(8);
+		if (!unknown && (property->skip || gen_chance(4))) {
+			continue;
+		}
+		if (!first) gen_puts(o, ",");
+		first = false;
+		gen_space(o);
+		if (unknown) {
+			gen_name(o);
+		}
+		else {
+			gen_puts(o, "\"");
+			gen_puts(o, property->name);
+			gen_puts(o, "\"");
+		}
+		gen_space(o);
+		gen_puts(o, ":");
+		gen_space(o);
+		if (unknown) {
+			gen_unknown(o, depth + 1);
+		}
+		else {
+			gen_value(o, property, depth + 1);
+		}
+		gen_space(o);
+	}
+	gen_puts(o, "}");
+}
+
+static void gen_value(gen_out_t* o, json_docdef_t* docdef, int depth) {
+	if (docdef->read == json_read_object || docdef->read == json_read_object_cached) {
+		gen_object(o, docdef, depth);
+	}
+	else if (docdef->read == json_read_array) {
+		json_read_array_params_t* params = (json_read_array_params_t*)docdef->params;
+		// extra items are allowed and dropped
+		uint32_t n = json_gen_rand() % (params->array_len + 3);
+		gen_puts(o, "[");
+		for (uint32_t i = 0; i < n; i++) {
+			if (i > 0) gen_puts(o, ",");
+			gen_space(o);
+			gen_value(o, params->item_docdef, depth + 1);
+		}
+		gen_puts(o, "]");
+	}
+	else if (docdef->read == json_read_scalar && docdef->write == json_write_bool) {
+		gen_puts(o, gen_chance(2) ? "true" : "false");
+	}
+	else if (docdef->read == json_read_scalar) {
+		json_read_scalar_params_t* params = (json_read_scalar_params_t*)docdef->params;
+		int bits = params->dst_size * 8;
+		int64_t range = (int64_t)1 << bits;
+		int64_t val = ((uint64_t)json_gen_rand() << 32 | json_gen_rand()) % range;
+		if (params->signed_val) {
+			val -= range / 2;
+		}
+		if (!o->valid && gen_chance(16)) {
+			// past 32 bits
+			val = (int64_t)1 << 32 | json_gen_rand();
+		}
+		gen_decimal(o, val);
+	}
+	else if (docdef->read == json_read_enum) {
+		json_read_enum_params_t* params = (json_read_enum_params_t*)docdef->params;
+		switch (json_gen_rand() % 8) {
+		case 0:
+			gen_puts(o, "null");
+			break;
+		case 1:
+			gen_puts(o, "\"bogus\"");
+			break;
+		case 2:
+			gen_decimal(o, json_gen_rand() % params->option_ct);
+			break;
+		default:
+			gen_puts(o, "\"");
+			gen_puts(o, params->options[json_gen_rand() % params->option_ct]);
+			gen_puts(o, "\"");
+			break;
+		}
+	}
+	else if (docdef->read == json_read_buffer) {
+		json_read_buffer_params_t* params = (json_read_buffer_params_t*)docdef->params;
+		size_t bytes = params->dst_size;
+		if (!o->valid && gen_chance(16)) {
+			bytes = json_gen_rand() % (bytes + 2);
+		}
+		gen_puts(o, "\"");
+		gen_hex(o, bytes);
+		gen_puts(o, "\"");
+	}
+	else if (docdef->read == json_read_string) {
+		json_read_buffer_params_t* params = (json_read_buffer_params_t*)docdef->params;
+		static const char chars[] = "abcdefghijklmnopqrstuvwxyz ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+		gen_puts(o, "\"");
+		for (size_t i = 0; i < params->dst_size; i++) {
+			gen_put(o, &chars[json_gen_rand() % (sizeof(chars) - 1)], 1);
+		}
+		gen_puts(o, "\"");
+	}
+	else if (docdef->read == json_match_string) {
+		json_match_string_params_t* params = (json_match_string_params_t*)docdef->params;
+		gen_puts(o, "\"");
+		gen_puts(o, params->to_match);
+		gen_puts(o, "\"");
+	}
+	else {
+		gen_unknown(o, depth);
+	}
+}
+
+// overwrite, drop, repeat or cut off a few pieces of the document
+static void gen_damage(gen_out_t* o) {
+	static const char syntax[] = "{}[]\",:\\ \x01" "0-e.tn";
+
+	for (uint32_t n = 1 + json_gen_rand() % 4; n > 0 && o->pos > 0; n--) {
+		size_t at = json_gen_rand() % o->pos;
+		size_t span = 1 + json_gen_rand() % 16;
+		if (span > o->pos - at) {
+			span = o->pos - at;
+		}
+
+		switch (json_gen_rand() % 5) {
+		case 0:
+			o->buf[at] = syntax[json_gen_rand() % (sizeof(syntax) - 1)];
+			break;
+		case 1:
+			o->buf[at] = json_gen_rand();
+			break;
+		case 2:
+			memmove(o->buf + at, o->buf + at + span, o->pos - at - span);
+			o->pos -= span;
+			break;
+		case 3:
+			if (o->pos + span <= o->len) {
+				memmove(o->buf + at + span, o->buf + at, o->pos - at);
+				o->pos += span;
+			}
+			break;
+		default:
+			o->pos = at;
+			break;
+		}
+	}
+}
+
+// returns the document's length, at most len. with valid set the
+// document reads without error; otherwise a third are damaged.
+size_t json_gen_document(char* dst, size_t len, json_docdef_t* docdef, bool valid) {
+	gen_out_t o = {
+		.buf = dst,
+		.len = len,
+		.valid = valid,
+	};
+
+	gen_space(&o);
+	gen_value(&o, docdef, 0);
+	gen_space(&o);
+	if (!valid && gen_chance(3)) {
+		gen_damage(&o);
+	}
+	return o.pos;
+}
@@ -5,9 +5,11 @@
 #ifndef __COMPILER_H__
 #define __COMPILER_H__
 
+#ifndef __bool_true_false_are_defined
 typedef char bool;
 
 #define true 1
 #define false 0
+#endif
 
 #endif
@@ -0,0 +1,8 @@
+#ifndef __DELAY_H__
+#define __DELAY_H__
+
+// dummy; nothing to wait for on the host
+#define delay_us(us)
+#define delay_ms(ms)
+
+#endif // __DELAY_H__
@@ -0,0 +1,6 @@
+#ifndef __INTERRUPT_H__
+#define __INTERRUPT_H__
+
+// dummy; stand-in for the asf interrupt header
+
+#endif // __INTERRUPT_H__
@@ -0,0 +1,27 @@
+#ifndef __SPI_H__
+#define __SPI_H__
+
+//
+// stand-in for the asf spi driver; tests provide the functions (and the
+// AVR32_SPI instance) to record what would have been sent.
+//
+
+#include <stdint.h>
+
+typedef struct {
+	int unused;
+} avr32_spi_t;
+
+typedef enum {
+	SPI_OK = 0,
+	SPI_ERROR = -1
+} spi_status_t;
+
+extern volatile avr32_spi_t AVR32_SPI;
+
+spi_status_t spi_selectChip(volatile avr32_spi_t *spi, uint8_t chip);
+spi_status_t spi_unselectChip(volatile avr32_spi_t *spi, uint8_t chip);
+spi_status_t spi_write(volatile avr32_spi_t *spi, uint16_t data);
+spi_status_t spi_read(volatile avr32_spi_t *spi, uint16_t *data);
+
+#endif
@@ -0,0 +1,149 @@
+// Shared by the test_fix16_fast*.c files, each of which sets
+// FIXMATH_FAST_BITS before including this.
+
+#include <math.h>
+#include <stdio.h>
+
+#include "unity.h"
+
+#include "types.h"
+
+// this
+#include "libfixmath/fix16_fast.c"
+
+#include "libfixmath/fix16.c"
+#include "libfixmath/fix16_exp.c"
+#include "libfixmath/fix16_sqrt.c"
+#include "libfixmath/fix16_trig.c"
+
+// the bound in lsbs, never tighter than one
+#define ABS_LSB ((65536 >> FIXMATH_FAST_BITS) ? (65536 >> FIXMATH_FAST_BITS) : 1)
+#define REL_BOUND (1.0 / (1 << FIXMATH_FAST_BITS))
+
+static double to_d(fix16_t x) {
+	return x / 65536.0;
+}
+
+static double abs_lsb(fix16_t got, double want) {
+	return fabs(to_d(got) - want) * 65536.0;
+}
+
+// relative error, after forgiving the last lsb of rounding
+static double rel_err(fix16_t got, double want) {
+	double e = fabs(to_d(got) - want) - 1.0 / 65536.0;
+	return e > 0 ? e / want : 0;
+}
+
+void test_sin_cos_error(void) {
+	double worst = 0, e;
+	s32 x;
+
+	for (x = -8 * 65536; x <= 8 * 65536; x += 3) {
+		e = abs_lsb(fix16_sin_fast(x), sin(to_d(x)));
+		if (e > worst) worst = e;
+		e = abs_lsb(fix16_cos_fast(x), cos(to_d(x)));
+		if (e > worst) worst = e;
+	}
+	printf("%d bit sin/cos: worst %.2f lsb, bound %d\n", FIXMATH_FAST_BITS, worst, ABS_LSB);
+	TEST_ASSERT_TRUE(worst <= ABS_LSB);
+
+	// far out, the only error is the 16.16 angle itself
+	TEST_ASSERT_TRUE(abs_lsb(fix16_sin_fast(fix16_max), sin(to_d(fix16_max))) <= ABS_LSB);
+	TEST_ASSERT_TRUE(abs_lsb(fix16_cos_fast(fix16_min), cos(to_d(fix16_min))) <= ABS_LSB);
+
+	TEST_ASSERT_EQUAL_INT32(0, fix16_sin_fast(0));
+	TEST_ASSERT_EQUAL_INT32(fix16_one, fix16_cos_fast(0));
+}
+
+void test_pow2_error(void) {
+	double worst = 0, e;
+	s32 x;
+
+	for (x = -17 * 65536; x < 15 * 65536; x += 5) {
+		e = rel_err(fix16_pow2_fast(x), exp2(to_d(x)));
+		if (e > worst) worst = e;
+	}
+	printf("%d bit pow2: worst %.2e relative, bound %.2e\n", FIXMATH_FAST_BITS, worst, REL_BOUND);
+	TEST_ASSERT_TRUE(worst <= REL_BOUND);
+
+	// integers are exact
+	for (x = -16; x < 15; x++) {
+		TEST_ASSERT_EQUAL_INT32((fix16_t)(exp2(x) * 65536.0 + 0.5), fix16_pow2_fast(x * fix16_one));
+	}
+
+	TEST_ASSERT_EQUAL_INT32(fix16_max, fix16_pow2_fast(15 * fix16_one));
+	TEST_ASSERT_EQUAL_INT32(fix16_max, fix16_pow2_fast(fix16_max));
+	TEST_ASSERT_EQUAL_INT32(0, fix16_pow2_fast(-18 * fix16_one));
+	TEST_ASSERT_EQUAL_INT32(0, fix16_pow2_fast(fix16_min));
+}
+
+void test_pow2_monotonic(void) {
+	// one volt per octave in 16.16: a rising cv must never step down
+	fix16_t prev = fix16_pow2_fast(-5 * fix16_one), y;
+	s32 x;
+
+	for (x = -5 * fix16_one + 1; x < 5 * fix16_one; x++) {
+		y = fix16_pow2_fast(x);
+		TEST_ASSERT_TRUE(y >= prev);
+		prev = y;
+	}
+}
+
+void test_log2_error(void) {
+	double worst = 0, e;
+	s32 x;
+
+	for (x = 1; x > 0 && x <= fix16_max; x += (x >> 12) + 1) {
+		e = abs_lsb(fix16_log2_fast(x), log2(to_d(x)));
+		if (e > worst) worst = e;
+	}
+	printf("%d bit log2: worst %.2f lsb, bound %d\n", FIXMATH_FAST_BITS, worst, ABS_LSB);
+	TEST_ASSERT_TRUE(worst <= ABS_LSB);
+
+	for (x = -16; x < 15; x++) {
+		TEST_ASSERT_EQUAL_INT32(x * fix16_one, fix16_log2_fast((fix16_t)exp2(x + 16)));
+	}
+
+	TEST_ASSERT_EQUAL_INT32(fix16_min, fix16_log2_fast(0));
+	TEST_ASSERT_EQUAL_INT32(fix16_min, fix16_log2_fast(-fix16_one));
+}
+
+void test_log2_pow2_round_trip(void) {
+	s32 x;
+
+	// from 1 up, so rounding pow2's output costs log2 under 1.5 lsb
+	for (x = 0; x < 14 * fix16_one; x += 97) {
+		TEST_ASSERT_INT32_WITHIN(2 * ABS_LSB + 1, x, fix16_log2_fast(fix16_pow2_fast(x)));
+	}
+}
+
+void test_exp_error(void) {
+	double worst = 0, e;
+	s32 x;
+
+	for (x = -772243; x < 681391; x += 5) {
+		e = rel_err(fix16_exp_fast(x), exp(to_d(x)));
+		if (e > worst) worst = e;
+	}
+	printf("%d bit exp: worst %.2e relative, bound %.2e\n", FIXMATH_FAST_BITS, worst, REL_BOUND);
+	TEST_ASSERT_TRUE(worst <= REL_BOUND);
+
+	TEST_ASSERT_EQUAL_INT32(fix16_one, fix16_exp_fast(0));
+	TEST_ASSERT_EQUAL_INT32(fix16_max, fix16_exp_fast(11 * fix16_one));
+	TEST_ASSERT_EQUAL_INT32(fix16_max, fix16_exp_fast(fix16_max));
+	TEST_ASSERT_EQUAL_INT32(0, fix16_exp_fast(-12 * fix16_one));
+	TEST_ASSERT_EQUAL_INT32(0, fix16_exp_fast(fix16_min));
+}
+
+int main(void) {
+	UNITY_BEGIN();
+
+	RUN_TEST(test_sin_cos_error);
+	RUN_TEST(test_pow2_error);
+	RUN_TEST(test_pow2_monotonic);
+	RUN_TEST(test_log2_error);
+	RUN_TEST(test_log2_pow2_round_trip);
+	RUN_TEST(test_exp_error);
+
+	return UNITY_END();
+}
@@ -0,0 +1,89 @@
+#include "json/serdes.h"
+
+// a bank of preset slots, as an app would keep them
+#define SLOT_CT 32
+
+typedef struct {
+	uint8_t level;
+	uint16_t len;
+	uint8_t steps[64];
+} slot_t;
+
+typedef struct {
+	uint8_t version;
+	slot_t slots[SLOT_CT];
+} bank_t;
+
+bank_t bank, bank_in;
+
+json_read_object_state_t bank_object_state[2];
+json_read_array_state_t bank_array_state;
+json_read_buffer_state_t bank_buffer_state;
+
+json_docdef_t bank_docdef = {
+	.read = json_read_object,
+	.write = json_write_object,
+	.state = &bank_object_state[0],
+	.params = &((json_read_object_params_t) {
+		.docdef_ct = 2,
+		.docdefs = ((json_docdef_t[]) {
+			{
+				.name = "version",
+				.read = json_read_scalar,
+				.write = json_write_number,
+				.params = &((json_read_scalar_params_t) {
+					.dst_size = sizeof_field(bank_t, version),
+					.dst_offset = offsetof(bank_t, version),
+				}),
+			},
+			{
+				.name = "slots",
+				.read = json_read_array,
+				.write = json_write_array,
+				.state = &bank_array_state,
+				.params = &((json_read_array_params_t) {
+					.array_len = SLOT_CT,
+					.item_size = sizeof_field(bank_t, slots[0]),
+					.item_docdef = &((json_docdef_t) {
+						.read = json_read_object,
+						.write = json_write_object,
+						.state = &bank_object_state[1],
+						.params = &((json_read_object_params_t) {
+							.docdef_ct = 3,
+							.docdefs = ((json_docdef_t[]) {
+								{
+									.name = "level",
+									.read = json_read_scalar,
+									.write = json_write_number,
+									.params = &((json_read_scalar_params_t) {
+										.dst_size = sizeof_field(bank_t, slots[0].level),
+										.dst_offset = offsetof(bank_t, slots[0].level),
+									}),
+								},
+								{
+									.name = "len",
+									.read = json_read_scalar,
+									.write = json_write_number,
+									.params = &((json_read_scalar_params_t) {
+										.dst_size = sizeof_field(bank_t, slots[0].len),
+										.dst_offset = offsetof(bank_t, slots[0].len),
+									}),
+								},
+								{
+									.name = "steps",
+									.read = json_read_buffer,
+									.write = json_write_buffer,
+									.state = &bank_buffer_state,
+									.params = &((json_read_buffer_params_t) {
+										.dst_size = sizeof_field(bank_t, slots[0].steps),
+										.dst_offset = offsetof(bank_t, slots[0].steps),
+									}),
+								},
+							}),
+						}),
+					}),
+				}),
+			},
+		}),
+	}),
+};
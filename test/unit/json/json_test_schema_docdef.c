@@ -0,0 +1,297 @@
+// generated by docdef_gen.py from json_test_schema.docdef, do not edit
+
+#include "json_test_schema_docdef.h"
+
+// fails to compile if a field doesn't suit its reader
+#define DOCDEF_CHECK(name, cond) typedef char name[(cond) ? 1 : -1]
+
+// objects and arrays at the same depth are never read at once
+static json_read_object_state_t json_test_gen_object_state[2];
+static json_read_array_state_t json_test_gen_array_state[1];
+static json_read_buffer_state_t json_test_gen_buffer_state;
+
+DOCDEF_CHECK(json_test_gen_root_ubyte_size, sizeof_field(json_test_dest_t, ubyte) == 1 || sizeof_field(json_test_dest_t, ubyte) == 2 || sizeof_field(json_test_dest_t, ubyte) == 4);
+
+static const json_read_scalar_params_t json_test_gen_root_ubyte_params = {
+	.dst_size = sizeof_field(json_test_dest_t, ubyte),
+	.dst_offset = offsetof(json_test_dest_t, ubyte),
+	.signed_val = false,
+};
+
+DOCDEF_CHECK(json_test_gen_root_sbyte_size, sizeof_field(json_test_dest_t, sbyte) == 1 || sizeof_field(json_test_dest_t, sbyte) == 2 || sizeof_field(json_test_dest_t, sbyte) == 4);
+
+static const json_read_scalar_params_t json_test_gen_root_sbyte_params = {
+	.dst_size = sizeof_field(json_test_dest_t, sbyte),
+	.dst_offset = offsetof(json_test_dest_t, sbyte),
+	.signed_val = true,
+};
+
+DOCDEF_CHECK(json_test_gen_root_ushort_size, sizeof_field(json_test_dest_t, ushort) == 1 || sizeof_field(json_test_dest_t, ushort) == 2 || sizeof_field(json_test_dest_t, ushort) == 4);
+
+static const json_read_scalar_params_t json_test_gen_root_ushort_params = {
+	.dst_size = sizeof_field(json_test_dest_t, ushort),
+	.dst_offset = offsetof(json_test_dest_t, ushort),
+	.signed_val = false,
+};
+
+DOCDEF_CHECK(json_test_gen_root_sshort_size, sizeof_field(json_test_dest_t, sshort) == 1 || sizeof_field(json_test_dest_t, sshort) == 2 || sizeof_field(json_test_dest_t, sshort) == 4);
+
+static const json_read_scalar_params_t json_test_gen_root_sshort_params = {
+	.dst_size = sizeof_field(json_test_dest_t, sshort),
+	.dst_offset = offsetof(json_test_dest_t, sshort),
+	.signed_val = true,
+};
+
+DOCDEF_CHECK(json_test_gen_root_ulong_size, sizeof_field(json_test_dest_t, ulong) == 1 || sizeof_field(json_test_dest_t, ulong) == 2 || sizeof_field(json_test_dest_t, ulong) == 4);
+
+static const json_read_scalar_params_t json_test_gen_root_ulong_params = {
+	.dst_size = sizeof_field(json_test_dest_t, ulong),
+	.dst_offset = offsetof(json_test_dest_t, ulong),
+	.signed_val = false,
+};
+
+DOCDEF_CHECK(json_test_gen_root_slong_size, sizeof_field(json_test_dest_t, slong) == 1 || sizeof_field(json_test_dest_t, slong) == 2 || sizeof_field(json_test_dest_t, slong) == 4);
+
+static const json_read_scalar_params_t json_test_gen_root_slong_params = {
+	.dst_size = sizeof_field(json_test_dest_t, slong),
+	.dst_offset = offsetof(json_test_dest_t, slong),
+	.signed_val = true,
+};
+
+DOCDEF_CHECK(json_test_gen_root_boolean_size, sizeof_field(json_test_dest_t, boolean) == 1 || sizeof_field(json_test_dest_t, boolean) == 2 || sizeof_field(json_test_dest_t, boolean) == 4);
+
+static const json_read_scalar_params_t json_test_gen_root_boolean_params = {
+	.dst_size = sizeof_field(json_test_dest_t, boolean),
+	.dst_offset = offsetof(json_test_dest_t, boolean),
+	.signed_val = false,
+};
+
+DOCDEF_CHECK(json_test_gen_root_test_enum_size, sizeof_field(json_test_dest_t, test_enum) == sizeof(int));
+
+static const char* const json_test_gen_root_test_enum_options[] = {
+	"ZERO",
+	"ONE",
+	"TWO",
+};
+
+static const json_read_enum_params_t json_test_gen_root_test_enum_params = {
+	.option_ct = 3,
+	.options = (const char**)json_test_gen_root_test_enum_options,
+	.dst_offset = offsetof(json_test_dest_t, test_enum),
+	.default_val = 0,
+};
+
+static const json_read_buffer_params_t json_test_gen_root_buffer_params = {
+	.dst_size = sizeof_field(json_test_dest_t, buffer),
+	.dst_offset = offsetof(json_test_dest_t, buffer),
+};
+
+DOCDEF_CHECK(json_test_gen_root_nested_ubyte_size, sizeof_field(json_test_dest_t, nested.ubyte) == 1 || sizeof_field(json_test_dest_t, nested.ubyte) == 2 || sizeof_field(json_test_dest_t, nested.ubyte) == 4);
+
+static const json_read_scalar_params_t json_test_gen_root_nested_ubyte_params = {
+	.dst_size = sizeof_field(json_test_dest_t, nested.ubyte),
+	.dst_offset = offsetof(json_test_dest_t, nested.ubyte),
+	.signed_val = false,
+};
+
+static json_docdef_t json_test_gen_root_nested_docdefs[] = {
+	{
+		.name = "ubyte",
+		.read = json_read_scalar,
+		.write = json_write_number,
+		.params = (void*)&json_test_gen_root_nested_ubyte_params,
+	},
+};
+
+static const uint8_t json_test_gen_root_nested_key_index[] = { 0 };
+
+static const json_read_object_params_t json_test_gen_root_nested_params = {
+	.docdefs = json_test_gen_root_nested_docdefs,
+	.docdef_ct = 1,
+	.key_index = json_test_gen_root_nested_key_index,
+};
+
+DOCDEF_CHECK(json_test_gen_root_nested_array_item_ubyte_size, sizeof_field(json_test_dest_t, nested_array[0].ubyte) == 1 || sizeof_field(json_test_dest_t, nested_array[0].ubyte) == 2 || sizeof_field(json_test_dest_t, nested_array[0].ubyte) == 4);
+
+static const json_read_scalar_params_t json_test_gen_root_nested_array_item_ubyte_params = {
+	.dst_size = sizeof_field(json_test_dest_t, nested_array[0].ubyte),
+	.dst_offset = offsetof(json_test_dest_t, nested_array[0].ubyte),
+	.signed_val = false,
+};
+
+static json_docdef_t json_test_gen_root_nested_array_item_docdefs[] = {
+	{
+		.name = "ubyte",
+		.read = json_read_scalar,
+		.write = json_write_number,
+		.params = (void*)&json_test_gen_root_nested_array_item_ubyte_params,
+	},
+};
+
+static const uint8_t json_test_gen_root_nested_array_item_key_index[] = { 0 };
+
+static const json_read_object_params_t json_test_gen_root_nested_array_item_params = {
+	.docdefs = json_test_gen_root_nested_array_item_docdefs,
+	.docdef_ct = 1,
+	.key_index = json_test_gen_root_nested_array_item_key_index,
+};
+
+static json_docdef_t json_test_gen_root_nested_array_item = {
+	.read = json_read_object,
+	.write = json_write_object,
+	.state = &json_test_gen_object_state[1],
+	.params = (void*)&json_test_gen_root_nested_array_item_params,
+};
+
+static const json_read_array_params_t json_test_gen_root_nested_array_params = {
+	.array_len = sizeof_field(json_test_dest_t, nested_array) / sizeof_field(json_test_dest_t, nested_array[0]),
+	.item_size = sizeof_field(json_test_dest_t, nested_array[0]),
+	.item_docdef = &json_test_gen_root_nested_array_item,
+};
+
+DOCDEF_CHECK(json_test_gen_root_nested_cached_ubyte_size, sizeof_field(json_test_dest_t, nested_cached.ubyte) == 1 || sizeof_field(json_test_dest_t, nested_cached.ubyte) == 2 || sizeof_field(json_test_dest_t, nested_cached.ubyte) == 4);
+
+static const json_read_scalar_params_t json_test_gen_root_nested_cached_ubyte_params = {
+	.dst_size = sizeof_field(json_test_dest_t, nested_cached.ubyte),
+	.dst_offset = offsetof(json_test_dest_t, nested_cached.ubyte),
+	.signed_val = false,
+};
+
+static json_docdef_t json_test_gen_root_nested_cached_docdefs[] = {
+	{
+		.name = "ubyte",
+		.read = json_read_scalar,
+		.write = json_write_number,
+		.params = (void*)&json_test_gen_root_nested_cached_ubyte_params,
+	},
+};
+
+static const uint8_t json_test_gen_root_nested_cached_key_index[] = { 0 };
+
+static const json_read_object_params_t json_test_gen_root_nested_cached_params = {
+	.docdefs = json_test_gen_root_nested_cached_docdefs,
+	.docdef_ct = 1,
+	.key_index = json_test_gen_root_nested_cached_key_index,
+	.dst_size = sizeof_field(json_test_dest_t, nested_cached),
+	.dst_offset = offsetof(json_test_dest_t, nested_cached),
+	.alloc = json_arena_alloc,
+	.free = json_arena_free,
+};
+
+static const json_read_buffer_params_t json_test_gen_root_longstring_params = {
+	.dst_size = sizeof_field(json_test_dest_t, longstring),
+	.dst_offset = offsetof(json_test_dest_t, longstring),
+};
+
+static const json_read_buffer_params_t json_test_gen_root_longbuffer_params = {
+	.dst_size = sizeof_field(json_test_dest_t, longbuffer),
+	.dst_offset = offsetof(json_test_dest_t, longbuffer),
+};
+
+static json_docdef_t json_test_gen_root_docdefs[] = {
+	{
+		.name = "ubyte",
+		.read = json_read_scalar,
+		.write = json_write_number,
+		.params = (void*)&json_test_gen_root_ubyte_params,
+	},
+	{
+		.name = "sbyte",
+		.read = json_read_scalar,
+		.write = json_write_number,
+		.params = (void*)&json_test_gen_root_sbyte_params,
+	},
+	{
+		.name = "ushort",
+		.read = json_read_scalar,
+		.write = json_write_number,
+		.params = (void*)&json_test_gen_root_ushort_params,
+	},
+	{
+		.name = "sshort",
+		.read = json_read_scalar,
+		.write = json_write_number,
+		.params = (void*)&json_test_gen_root_sshort_params,
+	},
+	{
+		.name = "ulong",
+		.read = json_read_scalar,
+		.write = json_write_number,
+		.params = (void*)&json_test_gen_root_ulong_params,
+	},
+	{
+		.name = "slong",
+		.read = json_read_scalar,
+		.write = json_write_number,
+		.params = (void*)&json_test_gen_root_slong_params,
+	},
+	{
+		.name = "boolean",
+		.read = json_read_scalar,
+		.write = json_write_bool,
+		.params = (void*)&json_test_gen_root_boolean_params,
+	},
+	{
+		.name = "test_enum",
+		.read = json_read_enum,
+		.write = json_write_enum,
+		.params = (void*)&json_test_gen_root_test_enum_params,
+	},
+	{
+		.name = "buffer",
+		.read = json_read_buffer,
+		.write = json_write_buffer,
+		.state = &json_test_gen_buffer_state,
+		.params = (void*)&json_test_gen_root_buffer_params,
+	},
+	{
+		.name = "nested",
+		.read = json_read_object,
+		.write = json_write_object,
+		.state = &json_test_gen_object_state[1],
+		.params = (void*)&json_test_gen_root_nested_params,
+	},
+	{
+		.name = "nested_array",
+		.read = json_read_array,
+		.write = json_write_array,
+		.state = &json_test_gen_array_state[0],
+		.params = (void*)&json_test_gen_root_nested_array_params,
+	},
+	{
+		.name = "nested_cached",
+		.read = json_read_object_cached,
+		.write = json_write_object,
+		.state = &json_test_gen_object_state[1],
+		.params = (void*)&json_test_gen_root_nested_cached_params,
+	},
+	{
+		.name = "longstring",
+		.read = json_read_string,
+		.write = json_write_string,
+		.state = &json_test_gen_buffer_state,
+		.params = (void*)&json_test_gen_root_longstring_params,
+	},
+	{
+		.name = "longbuffer",
+		.read = json_read_buffer,
+		.write = json_write_buffer,
+		.state = &json_test_gen_buffer_state,
+		.params = (void*)&json_test_gen_root_longbuffer_params,
+	},
+};
+
+static const uint8_t json_test_gen_root_key_index[] = { 6, 8, 13, 12, 9, 10, 11, 1, 5, 3, 7, 0, 4, 2 };
+
+static const json_read_object_params_t json_test_gen_root_params = {
+	.docdefs = json_test_gen_root_docdefs,
+	.docdef_ct = 14,
+	.key_index = json_test_gen_root_key_index,
+};
+
+json_docdef_t json_test_gen_docdef = {
+	.read = json_read_object,
+	.write = json_write_object,
+	.state = &json_test_gen_object_state[0],
+	.params = (void*)&json_test_gen_root_params,
+};
@@ -0,0 +1,15 @@
+// generated by docdef_gen.py from json_test_schema.docdef, do not edit
+
+#ifndef JSON_TEST_SCHEMA_DOCDEF_H
+#define JSON_TEST_SCHEMA_DOCDEF_H
+
+#include "json/serdes.h"
+#include "json_test_schema.h"
+
+#define JSON_TEST_GEN_SCHEMA_VERSION 1
+#define JSON_TEST_GEN_SCHEMA_HASH 0x75023dd4u
+#define JSON_TEST_GEN_ARENA_SIZE (JSON_ARENA_ALIGN(sizeof_field(json_test_dest_t, nested_cached)))
+
+extern json_docdef_t json_test_gen_docdef;
+
+#endif
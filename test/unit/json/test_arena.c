@@ -0,0 +1,281 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "unity.h"
+
+#include "json_test_common.c"
+#include "json/binary.c"
+
+// cached objects nested in cached objects, an array of them, and two
+// of the same type side by side: more than a static cache per type
+// could serve
+typedef struct {
+	uint8_t a;
+	uint16_t b;
+} pair_t;
+
+typedef struct {
+	pair_t inner;
+	uint8_t c;
+} outer_t;
+
+typedef struct {
+	outer_t items[3];
+	pair_t x;
+	pair_t y;
+} doc_t;
+
+doc_t doc;
+
+json_read_object_state_t doc_object_state[3];
+json_read_array_state_t doc_array_state;
+
+#define PAIR_DOCDEFS(field)							\
+	((json_docdef_t[]) {							\
+		{								\
+			.name = "a",						\
+			.read = json_read_scalar,				\
+			.write = json_write_number,				\
+			.params = &((json_read_scalar_params_t) {		\
+				.dst_size = sizeof_field(doc_t, field.a),	\
+				.dst_offset = offsetof(doc_t, field.a),		\
+			}),							\
+		},								\
+		{								\
+			.name = "b",						\
+			.read = json_read_scalar,				\
+			.write = json_write_number,				\
+			.params = &((json_read_scalar_params_t) {		\
+				.dst_size = sizeof_field(doc_t, field.b),	\
+				.dst_offset = offsetof(doc_t, field.b),		\
+			}),							\
+		},								\
+	})
+
+#define PAIR_DOCDEF(key, field, depth)						\
+	{									\
+		.name = key,							\
+		.read = json_read_object_cached,				\
+		.write = json_write_object,					\
+		.state = &doc_object_state[depth],				\
+		.params = &((json_read_object_params_t) {			\
+			.docdef_ct = 2,						\
+			.docdefs = PAIR_DOCDEFS(field),				\
+			.dst_size = sizeof_field(doc_t, field),			\
+			.dst_offset = offsetof(doc_t, field),			\
+			.alloc = json_arena_alloc,				\
+			.free = json_arena_free,				\
+		}),								\
+	}
+
+json_docdef_t doc_docdef = {
+	.read = json_read_object,
+	.write = json_write_object,
+	.state = &doc_object_state[0],
+	.params = &((json_read_object_params_t) {
+		.docdef_ct = 3,
+		.docdefs = ((json_docdef_t[]) {
+			{
+				.name = "items",
+				.read = json_read_array,
+				.write = json_write_array,
+				.state = &doc_array_state,
+				.params = &((json_read_array_params_t) {
+					.array_len = 3,
+					.item_size = sizeof(outer_t),
+					.item_docdef = &((json_docdef_t) {
+						.read = json_read_object_cached,
+						.write = json_write_object,
+						.state = &doc_object_state[1],
+						.params = &((json_read_object_params_t) {
+							.docdef_ct = 2,
+							.docdefs = ((json_docdef_t[]) {
+								PAIR_DOCDEF("inner", items[0].inner, 2),
+								{
+									.name = "c",
+									.read = json_read_scalar,
+									.write = json_write_number,
+									.params = &((json_read_scalar_params_t) {
+										.dst_size = sizeof_field(doc_t, items[0].c),
+										.dst_offset = offsetof(doc_t, items[0].c),
+									}),
+								},
+							}),
+							.dst_size = sizeof(outer_t),
+							.dst_offset = offsetof(doc_t, items[0]),
+							.alloc = json_arena_alloc,
+							.free = json_arena_free,
+						}),
+					}),
+				}),
+			},
+			PAIR_DOCDEF("x", x, 1),
+			PAIR_DOCDEF("y", y, 1),
+		}),
+	}),
+};
+
+#define ARENA_SIZE (JSON_ARENA_ALIGN(sizeof(outer_t)) + JSON_ARENA_ALIGN(sizeof(pair_t)))
+
+uint32_t arena_buf[ARENA_SIZE / 4 + 1];
+json_arena_t arena;
+
+// in-memory stream
+char mem[1024];
+size_t mem_len, mem_pos;
+
+void mem_write(const char* src, size_t len) {
+	TEST_ASSERT_TRUE(mem_len + len <= sizeof(mem));
+	memcpy(mem + mem_len, src, len);
+	mem_len += len;
+}
+
+void mem_set(const char* s) {
+	mem_len = 0;
+	mem_write(s, strlen(s));
+}
+
+size_t mem_read(char* dst, size_t len) {
+	size_t n = mem_len - mem_pos;
+	if (n > len) n = len;
+	memcpy(dst, mem + mem_pos, n);
+	mem_pos += n;
+	return n;
+}
+
+json_read_result_t read_doc(size_t arena_len) {
+	json_arena_init(&arena, arena_buf, arena_len);
+	mem_pos = 0;
+	return json_read(mem_read, copy, &doc, &doc_docdef,
+			 json_test_buf, sizeof(json_test_buf), NULL, 0);
+}
+
+doc_t sample, zero;
+
+void fill_sample(void) {
+	memset(&sample, 0, sizeof(sample));
+	for (int i = 0; i < 3; i++) {
+		sample.items[i].inner.a = 10 + i;
+		sample.items[i].inner.b = 1000 + i;
+		sample.items[i].c = 20 + i;
+	}
+	sample.x.a = 1;
+	sample.x.b = 2;
+	sample.y.a = 3;
+	sample.y.b = 4;
+}
+
+void test_arena_size(void) {
+	TEST_ASSERT_EQUAL_INT(ARENA_SIZE, json_arena_size(&doc_docdef));
+
+	// whatever the buffer's alignment, allocations are word aligned
+	for (int offset = 0; offset < 4; offset++) {
+		json_arena_init(&arena, (uint8_t*)arena_buf + offset, ARENA_SIZE);
+		void* p = json_arena_alloc(1);
+		TEST_ASSERT_NOT_NULL(p);
+		TEST_ASSERT_EQUAL_INT(0, (uintptr_t)p % 4);
+		TEST_ASSERT_EQUAL_INT(0, (uintptr_t)json_arena_alloc(1) % 4);
+	}
+}
+
+void test_alloc_and_free(void) {
+	json_arena_init(&arena, arena_buf, 16);
+
+	uint8_t* a = json_arena_alloc(3);
+	uint8_t* b = json_arena_alloc(8);
+	TEST_ASSERT_EQUAL_PTR(a + 4, b);
+	TEST_ASSERT_NULL(json_arena_alloc(8));
+	TEST_ASSERT_EQUAL_PTR(b + 8, json_arena_alloc(4));
+	TEST_ASSERT_EQUAL_INT(16, arena.used);
+
+	// freeing an older allocation releases the newer ones with it
+	json_arena_free(b);
+	TEST_ASSERT_EQUAL_INT(4, arena.used);
+	TEST_ASSERT_EQUAL_PTR(b, json_arena_alloc(8));
+	json_arena_free(a);
+	TEST_ASSERT_EQUAL_INT(0, arena.used);
+	TEST_ASSERT_EQUAL_INT(16, arena.peak);
+
+	// something the arena didn't hand out is left alone
+	json_arena_alloc(4);
+	json_arena_free(&sample);
+	TEST_ASSERT_EQUAL_INT(4, arena.used);
+}
+
+void test_nested_round_trip(void) {
+	fill_sample();
+	mem_len = 0;
+	TEST_ASSERT_EQUAL_INT(JSON_WRITE_OK, json_write(mem_write, &sample, &doc_docdef));
+
+	memset(&doc, 0, sizeof(doc));
+	TEST_ASSERT_EQUAL_INT(JSON_READ_OK, read_doc(ARENA_SIZE));
+	TEST_ASSERT_EQUAL_MEMORY(&sample, &doc, sizeof(doc));
+	TEST_ASSERT_EQUAL_INT(ARENA_SIZE, arena.peak);
+	TEST_ASSERT_EQUAL_INT(0, arena.used);
+
+	// and through the binary reader, which frees in the same order
+	mem_len = 0;
+	TEST_ASSERT_EQUAL_INT(JSON_WRITE_OK, json_write_binary(mem_write, &sample, &doc_docdef));
+	memset(&doc, 0, sizeof(doc));
+	json_arena_init(&arena, arena_buf, ARENA_SIZE);
+	mem_pos = 0;
+	TEST_ASSERT_EQUAL_INT(JSON_READ_OK, json_read_binary(
+		mem_read, copy, &doc, &doc_docdef, (uint8_t*)json_test_buf, sizeof(json_test_buf)));
+	TEST_ASSERT_EQUAL_MEMORY(&sample, &doc, sizeof(doc));
+	TEST_ASSERT_EQUAL_INT(0, arena.used);
+}
+
+void test_arena_too_small(void) {
+	fill_sample();
+	mem_len = 0;
+	json_write(mem_write, &sample, &doc_docdef);
+
+	// the inner object doesn't fit, so its item is never copied out
+	memset(&doc, 0, sizeof(doc));
+	TEST_ASSERT_EQUAL_INT(JSON_READ_MALFORMED, read_doc(ARENA_SIZE - 4));
+	TEST_ASSERT_EQUAL_MEMORY(&zero, &doc, sizeof(doc));
+	TEST_ASSERT_EQUAL_INT(0, arena.used);
+}
+
+void test_malformed_rolls_back(void) {
+	// the second item breaks off inside its inner object
+	mem_set("{\"items\": [{\"inner\": {\"a\": 1, \"b\": 2}, \"c\": 3}, "
+		"{\"c\": 5, \"inner\": {\"a\": 4 ]}]}");
+
+	memset(&doc, 0, sizeof(doc));
+	TEST_ASSERT_EQUAL_INT(JSON_READ_MALFORMED, read_doc(ARENA_SIZE));
+	TEST_ASSERT_EQUAL_UINT8(1, doc.items[0].inner.a);
+	TEST_ASSERT_EQUAL_UINT16(2, doc.items[0].inner.b);
+	TEST_ASSERT_EQUAL_UINT8(3, doc.items[0].c);
+	TEST_ASSERT_EQUAL_MEMORY(&zero.items[1], &doc.items[1], sizeof(outer_t));
+	TEST_ASSERT_EQUAL_INT(0, arena.used);
+
+	// the arena is ready for the next read
+	mem_set("{\"x\": {\"a\": 9, \"b\": 9}}");
+	TEST_ASSERT_EQUAL_INT(JSON_READ_OK, read_doc(ARENA_SIZE));
+	TEST_ASSERT_EQUAL_UINT8(9, doc.x.a);
+}
+
+void test_missing_keys_keep_values(void) {
+	fill_sample();
+	doc = sample;
+	mem_set("{\"items\": [{\"c\": 7}, {\"inner\": {\"b\": 8}}], \"y\": {}}");
+	TEST_ASSERT_EQUAL_INT(JSON_READ_OK, read_doc(ARENA_SIZE));
+
+	sample.items[0].c = 7;
+	sample.items[1].inner.b = 8;
+	TEST_ASSERT_EQUAL_MEMORY(&sample, &doc, sizeof(doc));
+}
+
+int main(void) {
+	UNITY_BEGIN();
+
+	RUN_TEST(test_arena_size);
+	RUN_TEST(test_alloc_and_free);
+	RUN_TEST(test_nested_round_trip);
+	RUN_TEST(test_arena_too_small);
+	RUN_TEST(test_malformed_rolls_back);
+	RUN_TEST(test_missing_keys_keep_values);
+
+	return UNITY_END();
+}
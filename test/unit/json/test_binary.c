@@ -0,0 +1,256 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "unity.h"
+
+#include "json_test_common.c"
+#include "json_test_schema.c"
+
+// few enough size slots that the test schema runs out of them, so
+// containers get both measured up front and measured as they're written
+#define JSON_BINARY_SIZES_MAX 4
+
+// this
+#include "json/binary.c"
+
+// in-memory streams
+uint8_t mem[8192];
+size_t mem_len, mem_pos, mem_chunk;
+uint32_t mem_writes;
+
+void mem_reset(void) {
+	mem_len = mem_pos = 0;
+	mem_writes = 0;
+	mem_chunk = sizeof(mem);
+}
+
+void mem_write(const char* src, size_t len) {
+	TEST_ASSERT_TRUE(mem_len + len <= sizeof(mem));
+	memcpy(mem + mem_len, src, len);
+	mem_len += len;
+	mem_writes++;
+}
+
+size_t mem_read(char* dst, size_t len) {
+	size_t n = mem_len - mem_pos;
+	if (n > len) n = len;
+	if (n > mem_chunk) n = mem_chunk;
+	memcpy(dst, mem + mem_pos, n);
+	mem_pos += n;
+	return n;
+}
+
+uint8_t bin_buf[32];
+
+json_test_dest_t sample;
+
+void fill_sample(void) {
+	memset(&sample, 0, sizeof(sample));
+	sample.ubyte = 200;
+	sample.sbyte = -100;
+	sample.ushort = 60000;
+	sample.sshort = -30000;
+	sample.ulong = 4000000000u;
+	sample.slong = -2147483647 - 1;
+	sample.boolean = true;
+	sample.test_enum = TEST_ENUM_TWO;
+	for (int i = 0; i < sizeof(sample.buffer); i++) sample.buffer[i] = i * 17;
+	sample.nested.ubyte = 11;
+	sample.nested_cached.ubyte = 22;
+	for (int i = 0; i < 4; i++) sample.nested_array[i].ubyte = 30 + i;
+	memcpy(sample.longstring, LONG_STRING, sizeof(sample.longstring));
+	for (int i = 0; i < sizeof(sample.longbuffer); i++) sample.longbuffer[i] = 255 - i;
+}
+
+void test_keys_are_distinct(void) {
+	TEST_ASSERT_TRUE(json_binary_check_keys(&json_test_docdef));
+	TEST_ASSERT_TRUE(json_binary_key_id("ubyte") < (1u << JSON_BINARY_KEY_BITS));
+	TEST_ASSERT_TRUE(json_binary_key_id("ubyte") != json_binary_key_id("sbyte"));
+}
+
+void test_varints(void) {
+	uint32_t values[] = { 0, 1, 127, 128, 16383, 16384, 0x0fffffff, 0xffffffff };
+	uint32_t v;
+
+	for (int i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+		mem_reset();
+		put_varint(mem_write, values[i]);
+		TEST_ASSERT_EQUAL_INT(varint_len(values[i]), mem_len);
+
+		binary_reader_t r = { .read = mem_read, .buf = bin_buf, .buf_len = 1 };
+		TEST_ASSERT_TRUE(get_varint(&r, &v));
+		TEST_ASSERT_EQUAL_UINT32(values[i], v);
+	}
+
+	for (int32_t s = -70000; s < 70000; s += 7) {
+		TEST_ASSERT_EQUAL_INT32(s, unzigzag(zigzag(s)));
+	}
+	TEST_ASSERT_EQUAL_INT32(INT32_MIN, unzigzag(zigzag(INT32_MIN)));
+	TEST_ASSERT_EQUAL_INT32(INT32_MAX, unzigzag(zigzag(INT32_MAX)));
+	TEST_ASSERT_EQUAL_UINT32(1, zigzag(-1));
+
+	// a sixth byte is never valid
+	mem_reset();
+	mem_write("\xff\xff\xff\xff\xff\x01", 6);
+	binary_reader_t r = { .read = mem_read, .buf = bin_buf, .buf_len = sizeof(bin_buf) };
+	TEST_ASSERT_FALSE(get_varint(&r, &v));
+}
+
+void test_round_trip(void) {
+	size_t chunks[] = { 1, 3, 7, sizeof(mem) };
+
+	fill_sample();
+	mem_reset();
+	TEST_ASSERT_EQUAL_INT(JSON_WRITE_OK, json_write_binary(mem_write, &sample, &json_test_docdef));
+	TEST_ASSERT_EQUAL_MEMORY(JSON_BINARY_MAGIC, mem, JSON_BINARY_MAGIC_LEN);
+
+	// any read size and scratch size gives the same result
+	for (int c = 0; c < sizeof(chunks) / sizeof(chunks[0]); c++) {
+		for (size_t buf_len = 1; buf_len <= sizeof(bin_buf); buf_len *= 2) {
+			mem_pos = 0;
+			mem_chunk = chunks[c];
+			memset(&json_test_dest, 0, sizeof(json_test_dest));
+			TEST_ASSERT_EQUAL_INT(JSON_READ_OK, json_read_binary(
+				mem_read, copy, &json_test_dest, &json_test_docdef, bin_buf, buf_len));
+			TEST_ASSERT_EQUAL_MEMORY(&sample, &json_test_dest, sizeof(sample));
+		}
+	}
+}
+
+void test_skips_unknown_and_keeps_missing(void) {
+	json_docdef_t* sshort = find_docdef(&json_test_docdef, "sshort");
+	json_docdef_t* nested = find_docdef(&json_test_docdef, "nested");
+
+	// a writer that doesn't know about sshort
+	fill_sample();
+	sshort->skip = true;
+	mem_reset();
+	json_write_binary(mem_write, &sample, &json_test_docdef);
+	sshort->skip = false;
+
+	// a reader that doesn't know about nested, reading into a struct
+	// that has a value for sshort already
+	nested->skip = true;
+	memset(&json_test_dest, 0, sizeof(json_test_dest));
+	json_test_dest.sshort = 1234;
+	TEST_ASSERT_EQUAL_INT(JSON_READ_OK, json_read_binary(
+		mem_read, copy, &json_test_dest, &json_test_docdef, bin_buf, sizeof(bin_buf)));
+	nested->skip = false;
+
+	TEST_ASSERT_EQUAL_INT16(1234, json_test_dest.sshort);
+	TEST_ASSERT_EQUAL_UINT8(0, json_test_dest.nested.ubyte);
+	TEST_ASSERT_EQUAL_UINT32(sample.ulong, json_test_dest.ulong);
+	TEST_ASSERT_EQUAL_UINT8(sample.nested_cached.ubyte, json_test_dest.nested_cached.ubyte);
+	TEST_ASSERT_EQUAL_MEMORY(sample.longbuffer, json_test_dest.longbuffer, sizeof(sample.longbuffer));
+}
+
+void test_truncates_array(void) {
+	json_docdef_t* array = find_docdef(&json_test_docdef, "nested_array");
+	json_read_array_params_t* params = array->params;
+
+	fill_sample();
+	mem_reset();
+	json_write_binary(mem_write, &sample, &json_test_docdef);
+
+	// a reader with a shorter array drops the rest
+	params->array_len = 2;
+	memset(&json_test_dest, 0, sizeof(json_test_dest));
+	TEST_ASSERT_EQUAL_INT(JSON_READ_OK, json_read_binary(
+		mem_read, copy, &json_test_dest, &json_test_docdef, bin_buf, sizeof(bin_buf)));
+	params->array_len = 4;
+
+	TEST_ASSERT_EQUAL_UINT8(30, json_test_dest.nested_array[0].ubyte);
+	TEST_ASSERT_EQUAL_UINT8(31, json_test_dest.nested_array[1].ubyte);
+	TEST_ASSERT_EQUAL_UINT8(0, json_test_dest.nested_array[2].ubyte);
+	TEST_ASSERT_EQUAL_UINT8(sample.longstring[0], json_test_dest.longstring[0]);
+}
+
+void test_rejects_malformed(void) {
+	fill_sample();
+	mem_reset();
+	json_write_binary(mem_write, &sample, &json_test_docdef);
+	size_t full = mem_len;
+
+	// every truncation fails cleanly
+	for (mem_len = 0; mem_len < full; mem_len++) {
+		mem_pos = 0;
+		TEST_ASSERT_EQUAL_INT(JSON_READ_MALFORMED, json_read_binary(
+			mem_read, copy, &json_test_dest, &json_test_docdef, bin_buf, sizeof(bin_buf)));
+	}
+
+	// a JSON document isn't a binary one
+	mem_reset();
+	mem_write("{\"ubyte\": 1}", 12);
+	TEST_ASSERT_EQUAL_INT(JSON_READ_MALFORMED, json_read_binary(
+		mem_read, copy, &json_test_dest, &json_test_docdef, bin_buf, sizeof(bin_buf)));
+
+	// nor is a field that claims more than its object holds
+	mem_reset();
+	mem_write(JSON_BINARY_MAGIC "\x02\x01\x05", JSON_BINARY_MAGIC_LEN + 3);
+	TEST_ASSERT_EQUAL_INT(JSON_READ_MALFORMED, json_read_binary(
+		mem_read, copy, &json_test_dest, &json_test_docdef, bin_buf, sizeof(bin_buf)));
+}
+
+//
+// conversion, through the JSON text the valid json tests use
+//
+char json_text[4096];
+size_t json_text_len;
+
+void json_text_write(const char* src, size_t len) {
+	memcpy(json_text + json_text_len, src, len);
+	json_text_len += len;
+}
+
+size_t json_text_read(char* dst, size_t len) {
+	size_t n = json_text_len - mem_pos;
+	if (n > len) n = len;
+	memcpy(dst, json_text + mem_pos, n);
+	mem_pos += n;
+	return n;
+}
+
+void test_convert_both_ways(void) {
+	char original[sizeof(json_text)];
+	size_t original_len;
+	json_test_dest_t scratch;
+
+	fill_sample();
+	json_text_len = 0;
+	json_write(json_text_write, &sample, &json_test_docdef);
+	memcpy(original, json_text, json_text_len);
+	original_len = json_text_len;
+
+	// json -> binary
+	mem_reset();
+	mem_pos = 0;
+	TEST_ASSERT_EQUAL_INT(JSON_READ_OK, json_convert_to_binary(
+		json_text_read, mem_write, &scratch, &json_test_docdef,
+		json_test_buf, sizeof(json_test_buf),
+		json_test_tokens, sizeof(json_test_tokens) / sizeof(json_test_tokens[0])));
+	printf("json %d bytes, binary %d bytes\n", (int)original_len, (int)mem_len);
+	TEST_ASSERT_TRUE(mem_len < original_len);
+
+	// binary -> json gives back the same text
+	memset(&scratch, 0, sizeof(scratch));
+	json_text_len = 0;
+	mem_pos = 0;
+	TEST_ASSERT_EQUAL_INT(JSON_READ_OK, json_convert_to_json(
+		mem_read, json_text_write, &scratch, &json_test_docdef, bin_buf, sizeof(bin_buf)));
+	TEST_ASSERT_EQUAL_INT(original_len, json_text_len);
+	TEST_ASSERT_EQUAL_MEMORY(original, json_text, original_len);
+}
+
+int main(void) {
+	UNITY_BEGIN();
+
+	RUN_TEST(test_keys_are_distinct);
+	RUN_TEST(test_varints);
+	RUN_TEST(test_round_trip);
+	RUN_TEST(test_skips_unknown_and_keeps_missing);
+	RUN_TEST(test_truncates_array);
+	RUN_TEST(test_rejects_malformed);
+	RUN_TEST(test_convert_both_ways);
+
+	return UNITY_END();
+}
@@ -0,0 +1,300 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "unity.h"
+
+#include "json_test_common.c"
+#include "json_test_schema.c"
+
+// this
+#include "json/diff.c"
+
+// in-memory streams: the base preset and a patch
+typedef struct {
+	char text[8192];
+	size_t len, pos;
+} mem_file_t;
+
+mem_file_t base, patch;
+mem_file_t* mem_file;
+
+uint32_t slots[32];
+
+void mem_write(const char* src, size_t len) {
+	TEST_ASSERT_TRUE(mem_file->len + len <= sizeof(mem_file->text));
+	memcpy(mem_file->text + mem_file->len, src, len);
+	mem_file->len += len;
+}
+
+size_t mem_read(char* dst, size_t len) {
+	size_t n = mem_file->len - mem_file->pos;
+	if (n > len) n = len;
+	memcpy(dst, mem_file->text + mem_file->pos, n);
+	mem_file->pos += n;
+	return n;
+}
+
+void write_file(mem_file_t* f, bool diff) {
+	mem_file = f;
+	f->len = 0;
+	if (diff) {
+		TEST_ASSERT_EQUAL_INT(JSON_WRITE_OK, json_write_diff(mem_write, &json_test_dest, &json_test_docdef, slots));
+	}
+	else {
+		TEST_ASSERT_EQUAL_INT(JSON_WRITE_OK, json_write(mem_write, &json_test_dest, &json_test_docdef));
+	}
+	f->text[f->len] = 0;
+}
+
+void read_file(mem_file_t* f) {
+	mem_file = f;
+	f->pos = 0;
+	TEST_ASSERT_EQUAL_INT(JSON_READ_OK, json_read(
+		mem_read, copy, &json_test_dest, &json_test_docdef,
+		json_test_buf, sizeof(json_test_buf), NULL, 0));
+}
+
+json_test_dest_t sample;
+
+void fill_sample(void) {
+	memset(&sample, 0, sizeof(sample));
+	sample.ubyte = 200;
+	sample.sbyte = -100;
+	sample.ushort = 60000;
+	sample.sshort = -30000;
+	sample.ulong = 123456789;
+	sample.slong = -2147483647 - 1;
+	sample.boolean = true;
+	sample.test_enum = TEST_ENUM_TWO;
+	for (int i = 0; i < sizeof(sample.buffer); i++) sample.buffer[i] = i * 17;
+	sample.nested.ubyte = 11;
+	sample.nested_cached.ubyte = 22;
+	for (int i = 0; i < 4; i++) sample.nested_array[i].ubyte = 30 + i;
+	memcpy(sample.longstring, LONG_STRING, sizeof(sample.longstring));
+	for (int i = 0; i < sizeof(sample.longbuffer); i++) sample.longbuffer[i] = 255 - i;
+}
+
+// save the sample as the base and snapshot it
+void save_base(void) {
+	fill_sample();
+	json_test_dest = sample;
+	write_file(&base, false);
+	json_diff_snapshot(&json_test_dest, &json_test_docdef, slots);
+}
+
+// base then patch, into a cleared struct
+void load_patched(void) {
+	memset(&json_test_dest, 0, sizeof(json_test_dest));
+	read_file(&base);
+	read_file(&patch);
+}
+
+void test_slot_count(void) {
+	// 7 numbers, an enum, a buffer, 2 nested objects of one, 4 array
+	// items of one, a string and a buffer
+	TEST_ASSERT_EQUAL_INT(17, json_diff_slots(&json_test_docdef));
+	TEST_ASSERT_TRUE(json_diff_slots(&json_test_docdef) <= sizeof(slots) / sizeof(slots[0]));
+}
+
+void test_unchanged_is_empty(void) {
+	save_base();
+	TEST_ASSERT_FALSE(json_diff_changed(&json_test_dest, &json_test_docdef, slots));
+	write_file(&patch, true);
+	TEST_ASSERT_EQUAL_STRING("{}", patch.text);
+}
+
+void test_patch_holds_changes(void) {
+	save_base();
+	json_test_dest.sshort = 5;
+	json_test_dest.nested_array[2].ubyte = 9;
+	TEST_ASSERT_TRUE(json_diff_changed(&json_test_dest, &json_test_docdef, slots));
+	write_file(&patch, true);
+	TEST_ASSERT_EQUAL_STRING("{\"sshort\": 5, \"nested_array\": [{}, {}, {\"ubyte\": 9}]}", patch.text);
+
+	// one byte of a long value is enough
+	save_base();
+	json_test_dest.longstring[100] = 'x';
+	write_file(&patch, true);
+	TEST_ASSERT_EQUAL_INT(strlen("{\"longstring\": \"\"}") + sizeof(sample.longstring), patch.len);
+
+	// cached objects are diffed like plain ones
+	save_base();
+	json_test_dest.nested_cached.ubyte = 1;
+	write_file(&patch, true);
+	TEST_ASSERT_EQUAL_STRING("{\"nested_cached\": {\"ubyte\": 1}}", patch.text);
+}
+
+void test_base_and_patch_load(void) {
+	json_test_dest_t changed;
+
+	// each field on its own, then all of them
+	for (int field = 0; field <= 14; field++) {
+		save_base();
+		if (field == 0 || field == 14) json_test_dest.ubyte++;
+		if (field == 1 || field == 14) json_test_dest.sbyte = 100;
+		if (field == 2 || field == 14) json_test_dest.ushort = 1;
+		if (field == 3 || field == 14) json_test_dest.sshort = -1;
+		if (field == 4 || field == 14) json_test_dest.ulong = 0;
+		if (field == 5 || field == 14) json_test_dest.slong = 2147483647;
+		if (field == 6 || field == 14) json_test_dest.boolean = false;
+		if (field == 7 || field == 14) json_test_dest.test_enum = TEST_ENUM_ZERO;
+		if (field == 8 || field == 14) json_test_dest.buffer[15] = 0;
+		if (field == 9 || field == 14) json_test_dest.nested.ubyte = 0;
+		if (field == 10 || field == 14) json_test_dest.nested_cached.ubyte = 0;
+		if (field == 11 || field == 14) json_test_dest.nested_array[3].ubyte = 0;
+		if (field == 12 || field == 14) json_test_dest.longstring[0] = '-';
+		if (field == 13 || field == 14) json_test_dest.longbuffer[63] = 0;
+		changed = json_test_dest;
+
+		write_file(&patch, true);
+		TEST_ASSERT_TRUE(patch.len < base.len);
+		load_patched();
+		TEST_ASSERT_EQUAL_MEMORY(&changed, &json_test_dest, sizeof(changed));
+	}
+}
+
+void test_later_patch_replaces_earlier(void) {
+	json_test_dest_t changed;
+
+	save_base();
+	json_test_dest.ubyte = 1;
+	write_file(&patch, true);
+
+	// against the base, so a second patch carries the first change too
+	json_test_dest.nested_array[0].ubyte = 2;
+	changed = json_test_dest;
+	write_file(&patch, true);
+	load_patched();
+	TEST_ASSERT_EQUAL_MEMORY(&changed, &json_test_dest, sizeof(changed));
+
+	// a value changed back is left out
+	json_test_dest.ubyte = sample.ubyte;
+	write_file(&patch, true);
+	TEST_ASSERT_EQUAL_STRING("{\"nested_array\": [{\"ubyte\": 2}]}", patch.text);
+}
+
+// a cached object of two values, in an array
+typedef struct {
+	uint8_t a;
+	uint8_t b;
+} pair_t;
+
+pair_t pairs[2], pairs_in[2];
+uint32_t pair_slots[4];
+
+json_read_object_state_t pair_object_state;
+json_read_array_state_t pair_array_state;
+
+json_docdef_t pair_docdef = {
+	.read = json_read_array,
+	.write = json_write_array,
+	.state = &pair_array_state,
+	.params = &((json_read_array_params_t) {
+		.array_len = 2,
+		.item_size = sizeof(pair_t),
+		.item_docdef = &((json_docdef_t) {
+			.read = json_read_object_cached,
+			.write = json_write_object,
+			.state = &pair_object_state,
+			.params = &((json_read_object_params_t) {
+				.docdef_ct = 2,
+				.docdefs = ((json_docdef_t[]) {
+					{
+						.name = "a",
+						.read = json_read_scalar,
+						.write = json_write_number,
+						.params = &((json_read_scalar_params_t) {
+							.dst_size = sizeof_field(pair_t, a),
+							.dst_offset = offsetof(pair_t, a),
+						}),
+					},
+					{
+						.name = "b",
+						.read = json_read_scalar,
+						.write = json_write_number,
+						.params = &((json_read_scalar_params_t) {
+							.dst_size = sizeof_field(pair_t, b),
+							.dst_offset = offsetof(pair_t, b),
+						}),
+					},
+				}),
+				.dst_size = sizeof(pair_t),
+				.alloc = malloc,
+				.free = free,
+			}),
+		}),
+	}),
+};
+
+void read_pairs(mem_file_t* f) {
+	mem_file = f;
+	f->pos = 0;
+	TEST_ASSERT_EQUAL_INT(JSON_READ_OK, json_read(
+		mem_read, copy, pairs_in, &pair_docdef,
+		json_test_buf, sizeof(json_test_buf), NULL, 0));
+}
+
+void test_cached_object_by_key(void) {
+	pairs[0] = (pair_t) { 1, 2 };
+	pairs[1] = (pair_t) { 3, 4 };
+	TEST_ASSERT_EQUAL_INT(4, json_diff_slots(&pair_docdef));
+	mem_file = &base;
+	base.len = 0;
+	TEST_ASSERT_EQUAL_INT(JSON_WRITE_OK, json_write(mem_write, pairs, &pair_docdef));
+	json_diff_snapshot(pairs, &pair_docdef, pair_slots);
+
+	pairs[1].b = 9;
+	mem_file = &patch;
+	patch.len = 0;
+	TEST_ASSERT_EQUAL_INT(JSON_WRITE_OK, json_write_diff(mem_write, pairs, &pair_docdef, pair_slots));
+	patch.text[patch.len] = 0;
+	TEST_ASSERT_EQUAL_STRING("[{}, {\"b\": 9}]", patch.text);
+
+	// keys the patch leaves out keep what the base read
+	memset(pairs_in, 0, sizeof(pairs_in));
+	read_pairs(&base);
+	read_pairs(&patch);
+	TEST_ASSERT_EQUAL_MEMORY(pairs, pairs_in, sizeof(pairs));
+}
+
+json_write_result_t write_fails(json_puts_cb write, void* ram,
+				json_docdef_t* docdef, size_t src_offset) {
+	return JSON_WRITE_ERROR;
+}
+
+void test_write_error_returned(void) {
+	json_read_array_params_t* array = find_docdef(&json_test_docdef, "nested_array")->params;
+	json_docdef_t* item_ubyte = find_docdef(array->item_docdef, "ubyte");
+	json_docdef_t* ubyte = find_docdef(&json_test_docdef, "ubyte");
+	json_write_subtree_cb number_write = ubyte->write;
+
+	// from a value inside an array item, and one at the top
+	save_base();
+	item_ubyte->write = write_fails;
+	json_test_dest.nested_array[1].ubyte = 0;
+	mem_file = &patch;
+	patch.len = 0;
+	TEST_ASSERT_EQUAL_INT(JSON_WRITE_ERROR, json_write_diff(mem_write, &json_test_dest, &json_test_docdef, slots));
+	item_ubyte->write = number_write;
+
+	save_base();
+	ubyte->write = write_fails;
+	json_test_dest.ubyte = 0;
+	patch.len = 0;
+	TEST_ASSERT_EQUAL_INT(JSON_WRITE_ERROR, json_write_diff(mem_write, &json_test_dest, &json_test_docdef, slots));
+	ubyte->write = number_write;
+}
+
+int main(void) {
+	UNITY_BEGIN();
+
+	RUN_TEST(test_slot_count);
+	RUN_TEST(test_unchanged_is_empty);
+	RUN_TEST(test_patch_holds_changes);
+	RUN_TEST(test_base_and_patch_load);
+	RUN_TEST(test_later_patch_replaces_earlier);
+	RUN_TEST(test_cached_object_by_key);
+	RUN_TEST(test_write_error_returned);
+
+	return UNITY_END();
+}
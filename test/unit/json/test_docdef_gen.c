@@ -0,0 +1,119 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "unity.h"
+
+#include "json_test_common.c"
+#include "json_test_schema.c"
+#include "json/binary.c"
+
+// generated from json_test_schema.docdef, the same document as
+// json_test_schema.c
+#include "json_test_schema_docdef.c"
+
+char out[2][8192];
+size_t out_len[2];
+int out_sel;
+
+void out_write(const char* src, size_t len) {
+	memcpy(out[out_sel] + out_len[out_sel], src, len);
+	out_len[out_sel] += len;
+}
+
+json_test_dest_t sample;
+
+void fill_sample(void) {
+	memset(&sample, 0, sizeof(sample));
+	sample.ubyte = 200;
+	sample.sbyte = -100;
+	sample.ushort = 60000;
+	sample.sshort = -30000;
+	sample.ulong = 123456789;
+	sample.slong = -2147483647 - 1;
+	sample.boolean = true;
+	sample.test_enum = TEST_ENUM_TWO;
+	for (int i = 0; i < sizeof(sample.buffer); i++) sample.buffer[i] = i * 17;
+	sample.nested.ubyte = 11;
+	sample.nested_cached.ubyte = 22;
+	for (int i = 0; i < 4; i++) sample.nested_array[i].ubyte = 30 + i;
+	memcpy(sample.longstring, LONG_STRING, sizeof(sample.longstring));
+	for (int i = 0; i < sizeof(sample.longbuffer); i++) sample.longbuffer[i] = 255 - i;
+}
+
+size_t out_pos;
+
+size_t out_read(char* dst, size_t len) {
+	size_t n = out_len[0] - out_pos;
+	if (n > len) n = len;
+	memcpy(dst, out[0] + out_pos, n);
+	out_pos += n;
+	return n;
+}
+
+void test_writes_same_document(void) {
+	fill_sample();
+	for (out_sel = 0; out_sel < 2; out_sel++) {
+		out_len[out_sel] = 0;
+		TEST_ASSERT_EQUAL_INT(JSON_WRITE_OK, json_write(
+			out_write, &sample,
+			out_sel ? &json_test_gen_docdef : &json_test_docdef));
+	}
+	TEST_ASSERT_EQUAL_INT(out_len[0], out_len[1]);
+	TEST_ASSERT_EQUAL_MEMORY(out[0], out[1], out_len[0]);
+}
+
+uint32_t arena_buf[JSON_TEST_GEN_ARENA_SIZE / 4];
+json_arena_t arena;
+
+void test_reads_same_document(void) {
+	json_arena_init(&arena, arena_buf, sizeof(arena_buf));
+	fill_sample();
+	out_sel = 0;
+	out_len[0] = 0;
+	json_write(out_write, &sample, &json_test_docdef);
+
+	out_pos = 0;
+	memset(&json_test_dest, 0, sizeof(json_test_dest));
+	TEST_ASSERT_EQUAL_INT(JSON_READ_OK, json_read(
+		out_read, copy, &json_test_dest, &json_test_gen_docdef,
+		json_test_buf, sizeof(json_test_buf), NULL, 0));
+	TEST_ASSERT_EQUAL_MEMORY(&sample, &json_test_dest, sizeof(sample));
+	TEST_ASSERT_EQUAL_INT(sizeof(arena_buf), arena.peak);
+	TEST_ASSERT_EQUAL_INT(0, arena.used);
+}
+
+void test_key_index_is_generated(void) {
+	json_read_object_params_t* params = json_test_gen_docdef.params;
+	uint8_t pool[32];
+
+	TEST_ASSERT_NOT_NULL(params->key_index);
+	for (uint8_t i = 1; i < params->docdef_ct; i++) {
+		TEST_ASSERT_TRUE(strcmp(
+			params->docdefs[params->key_index[i - 1]].name,
+			params->docdefs[params->key_index[i]].name) < 0);
+	}
+
+	// nothing is left for runtime indexing to do
+	TEST_ASSERT_EQUAL_INT(0, json_docdef_index(&json_test_gen_docdef, pool, sizeof(pool)));
+	TEST_ASSERT_EQUAL_PTR(
+		find_docdef(&json_test_gen_docdef, "longbuffer"),
+		json_docdef_find_key(&json_test_gen_docdef, "longbuffer"));
+}
+
+void test_binary_keys_version_and_arena(void) {
+	TEST_ASSERT_TRUE(json_binary_check_keys(&json_test_gen_docdef));
+	TEST_ASSERT_EQUAL_INT(1, JSON_TEST_GEN_SCHEMA_VERSION);
+	TEST_ASSERT_TRUE(JSON_TEST_GEN_SCHEMA_HASH != 0);
+	TEST_ASSERT_EQUAL_INT(json_arena_size(&json_test_gen_docdef), JSON_TEST_GEN_ARENA_SIZE);
+}
+
+int main(void) {
+	UNITY_BEGIN();
+
+	RUN_TEST(test_writes_same_document);
+	RUN_TEST(test_reads_same_document);
+	RUN_TEST(test_key_index_is_generated);
+	RUN_TEST(test_binary_keys_version_and_arena);
+
+	return UNITY_END();
+}
@@ -0,0 +1,174 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "unity.h"
+
+#include "json_test_common.c"
+#include "json_test_schema.c"
+
+static void clear_index(json_docdef_t* docdef) {
+	json_read_object_params_t* params;
+
+	if (docdef->read == json_read_array) {
+		clear_index(((json_read_array_params_t*)docdef->params)->item_docdef);
+		return;
+	}
+	if (docdef->read != json_read_object && docdef->read != json_read_object_cached) {
+		return;
+	}
+	params = docdef->params;
+	params->key_index = NULL;
+	for (uint8_t i = 0; i < params->docdef_ct; i++) {
+		clear_index(&params->docdefs[i]);
+	}
+}
+
+static json_read_result_t read_string(const char* s) {
+	FILE* fp = write_temp_file("in.tmp", s, strlen(s));
+	set_fp(fp);
+	memset(&json_test_dest, 0, sizeof(json_test_dest_t));
+
+	json_read_result_t result = json_read(
+		read_fp, copy,
+		&json_test_dest, &json_test_docdef,
+		json_test_buf, sizeof(json_test_buf),
+		json_test_tokens, sizeof(json_test_tokens) / sizeof(json_test_tokens[0]));
+	fclose(fp);
+	return result;
+}
+
+void test_index_sorts_every_object(void) {
+	uint8_t pool[32];
+	json_read_object_params_t* params = json_test_docdef.params;
+
+	clear_index(&json_test_docdef);
+
+	// 14 top level keys, plus one each for nested, nested_cached and the
+	// array's item object
+	TEST_ASSERT_EQUAL_INT(17, json_docdef_index(&json_test_docdef, NULL, 0));
+	TEST_ASSERT_EQUAL_INT(17, json_docdef_index(&json_test_docdef, pool, sizeof(pool)));
+
+	TEST_ASSERT_EQUAL_PTR(pool, params->key_index);
+	for (uint8_t i = 1; i < params->docdef_ct; i++) {
+		TEST_ASSERT_TRUE(strcmp(
+			params->docdefs[params->key_index[i - 1]].name,
+			params->docdefs[params->key_index[i]].name) < 0);
+	}
+	TEST_ASSERT_NOT_NULL(((json_read_object_params_t*)find_docdef(&json_test_docdef, "nested")->params)->key_index);
+	TEST_ASSERT_NOT_NULL(((json_read_object_params_t*)find_docdef(&json_test_docdef, "nested_cached")->params)->key_index);
+
+	// already indexed objects are left alone
+	TEST_ASSERT_EQUAL_INT(0, json_docdef_index(&json_test_docdef, pool, sizeof(pool)));
+}
+
+void test_index_finds_same_keys_as_scan(void) {
+	uint8_t pool[32];
+	json_read_object_params_t* params = json_test_docdef.params;
+	json_docdef_t* scanned[14];
+	uint8_t i;
+
+	clear_index(&json_test_docdef);
+	for (i = 0; i < params->docdef_ct; i++) {
+		scanned[i] = json_docdef_find_key(&json_test_docdef, params->docdefs[i].name);
+		TEST_ASSERT_EQUAL_PTR(&params->docdefs[i], scanned[i]);
+	}
+
+	json_docdef_index(&json_test_docdef, pool, sizeof(pool));
+	for (i = 0; i < params->docdef_ct; i++) {
+		TEST_ASSERT_EQUAL_PTR(scanned[i], json_docdef_find_key(&json_test_docdef, params->docdefs[i].name));
+	}
+	TEST_ASSERT_NULL(json_docdef_find_key(&json_test_docdef, "aaa"));
+	TEST_ASSERT_NULL(json_docdef_find_key(&json_test_docdef, "zzz"));
+}
+
+void test_match_is_exact(void) {
+	uint8_t pool[32];
+
+	for (int indexed = 0; indexed < 2; indexed++) {
+		clear_index(&json_test_docdef);
+		if (indexed) {
+			json_docdef_index(&json_test_docdef, pool, sizeof(pool));
+		}
+
+		// a property name that is a prefix of a key isn't that key
+		TEST_ASSERT_NULL(json_docdef_find_key_len(&json_test_docdef, "ubyte", 4));
+		TEST_ASSERT_NULL(json_docdef_find_key_len(&json_test_docdef, "nested_arr", 10));
+		TEST_ASSERT_NULL(json_docdef_find_key_len(&json_test_docdef, "ubytes", 6));
+		// nor is a document name holding a NUL after the key
+		TEST_ASSERT_NULL(json_docdef_find_key_len(&json_test_docdef, "ubyte\0xx", 8));
+		TEST_ASSERT_EQUAL_PTR(
+			find_docdef(&json_test_docdef, "nested"),
+			json_docdef_find_key_len(&json_test_docdef, "nested_array", 6));
+		TEST_ASSERT_EQUAL_PTR(
+			find_docdef(&json_test_docdef, "nested_array"),
+			json_docdef_find_key_len(&json_test_docdef, "nested_array", 12));
+	}
+}
+
+void test_skipped_keys(void) {
+	uint8_t pool[32];
+	json_docdef_t* sbyte = find_docdef(&json_test_docdef, "sbyte");
+
+	clear_index(&json_test_docdef);
+	json_docdef_index(&json_test_docdef, pool, sizeof(pool));
+
+	sbyte->skip = true;
+	TEST_ASSERT_NULL(json_docdef_find_key_len(&json_test_docdef, "sbyte", 5));
+	TEST_ASSERT_EQUAL_PTR(sbyte, json_docdef_find_key(&json_test_docdef, "sbyte"));
+
+	TEST_ASSERT_EQUAL_INT(JSON_READ_OK, read_string("{\"sbyte\": -5, \"ubyte\": 5}"));
+	TEST_ASSERT_EQUAL_INT8(0, json_test_dest.sbyte);
+	TEST_ASSERT_EQUAL_UINT8(5, json_test_dest.ubyte);
+	sbyte->skip = false;
+}
+
+void test_short_pool_falls_back(void) {
+	uint8_t pool[3];
+	json_read_object_params_t* params = json_test_docdef.params;
+
+	clear_index(&json_test_docdef);
+
+	// the root doesn't fit, the three one-key objects do
+	TEST_ASSERT_EQUAL_INT(17, json_docdef_index(&json_test_docdef, pool, sizeof(pool)));
+	TEST_ASSERT_NULL(params->key_index);
+	TEST_ASSERT_NOT_NULL(((json_read_object_params_t*)find_docdef(&json_test_docdef, "nested")->params)->key_index);
+
+	TEST_ASSERT_EQUAL_INT(JSON_READ_OK, read_string(
+		"{\"nested_array\": [{\"ubyte\": 1}, {\"ubyte\": 2}], "
+		"\"nested\": {\"ubyte\": 3}, \"sshort\": -4}"));
+	TEST_ASSERT_EQUAL_UINT8(1, json_test_dest.nested_array[0].ubyte);
+	TEST_ASSERT_EQUAL_UINT8(2, json_test_dest.nested_array[1].ubyte);
+	TEST_ASSERT_EQUAL_UINT8(3, json_test_dest.nested.ubyte);
+	TEST_ASSERT_EQUAL_INT16(-4, json_test_dest.sshort);
+}
+
+void test_indexed_read(void) {
+	uint8_t pool[32];
+
+	clear_index(&json_test_docdef);
+	json_docdef_index(&json_test_docdef, pool, sizeof(pool));
+
+	TEST_ASSERT_EQUAL_INT(JSON_READ_OK, read_string(
+		"{\"sshort\": -2, \"ulong\": 7, \"unknown\": {\"ubyte\": 9}, "
+		"\"nested_cached\": {\"ubyte\": 8}, \"test_enum\": \"ONE\", "
+		"\"boolean\": true, \"ubyte\": 6}"));
+	TEST_ASSERT_EQUAL_INT16(-2, json_test_dest.sshort);
+	TEST_ASSERT_EQUAL_UINT32(7, json_test_dest.ulong);
+	TEST_ASSERT_EQUAL_UINT8(8, json_test_dest.nested_cached.ubyte);
+	TEST_ASSERT_EQUAL_INT(TEST_ENUM_ONE, json_test_dest.test_enum);
+	TEST_ASSERT_EQUAL_INT(true, json_test_dest.boolean);
+	TEST_ASSERT_EQUAL_UINT8(6, json_test_dest.ubyte);
+}
+
+int main(void) {
+	UNITY_BEGIN();
+
+	RUN_TEST(test_index_sorts_every_object);
+	RUN_TEST(test_index_finds_same_keys_as_scan);
+	RUN_TEST(test_match_is_exact);
+	RUN_TEST(test_skipped_keys);
+	RUN_TEST(test_short_pool_falls_back);
+	RUN_TEST(test_indexed_read);
+
+	return UNITY_END();
+}
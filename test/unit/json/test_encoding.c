@@ -1,3 +1,4 @@
+#include <stdio.h>
 #include <string.h>
 
 #include "unity.h"
@@ -66,12 +67,162 @@ void test_decode_hexbuf(void) {
 	}
 }
 
+void test_decimal_exhaustive(void) {
+	char expected[JSON_DECIMAL_LEN + 8];
+	char dec[JSON_DECIMAL_LEN];
+	int32_t val;
+
+	// every 16 bit value, both ways
+	for (int32_t i = -32768; i <= 65535; i++) {
+		size_t len = sprintf(expected, "%d", (int)i);
+		if (i < 0) {
+			TEST_ASSERT_EQUAL_INT(len, encode_decimal_signed_to(dec, i));
+		}
+		else {
+			TEST_ASSERT_EQUAL_INT(len, encode_decimal_unsigned_to(dec, i));
+		}
+		TEST_ASSERT_EQUAL_STRING(expected, dec);
+		TEST_ASSERT_EQUAL_INT(0, decode_decimal_checked(&val, expected, len));
+		TEST_ASSERT_EQUAL_INT32(i, val);
+	}
+
+	// a prime stride through the rest of 32 bits, and each length edge
+	for (uint64_t u = 0; u <= UINT32_MAX; u += 65521) {
+		size_t len = sprintf(expected, "%lu", (unsigned long)u);
+		TEST_ASSERT_EQUAL_INT(len, encode_decimal_unsigned_to(dec, u));
+		TEST_ASSERT_EQUAL_STRING(expected, dec);
+		TEST_ASSERT_EQUAL_INT(0, decode_decimal_checked(&val, expected, len));
+		TEST_ASSERT_EQUAL_UINT32(u, (uint32_t)val);
+
+		int32_t v = (int32_t)(uint32_t)u;
+		len = sprintf(expected, "%ld", (long)v);
+		TEST_ASSERT_EQUAL_INT(len, encode_decimal_signed_to(dec, v));
+		TEST_ASSERT_EQUAL_STRING(expected, dec);
+	}
+	for (uint64_t p = 1; p <= UINT32_MAX; p *= 10) {
+		uint32_t edges[] = { p - 1, p, p + 1 };
+		for (int e = 0; e < 3; e++) {
+			size_t len = sprintf(expected, "%lu", (unsigned long)edges[e]);
+			TEST_ASSERT_EQUAL_INT(len, encode_decimal_unsigned_to(dec, edges[e]));
+			TEST_ASSERT_EQUAL_STRING(expected, dec);
+		}
+	}
+}
+
+static const char* bad_decimals[] = {
+	"4294967296",
+	"9999999999",
+	"42949672950",
+	"-2147483649",
+	"-4294967295",
+	"",
+	"-",
+	"1.5",
+	"1e3",
+	"+1",
+	" 1",
+	"1-",
+	"0x10",
+	"tru",
+	"trueish",
+	"null",
+};
+
+void test_decimal_rejects(void) {
+	int32_t val = 1234;
+
+	for (int i = 0; i < sizeof(bad_decimals) / sizeof(bad_decimals[0]); i++) {
+		TEST_ASSERT_EQUAL_INT(-1, decode_decimal_checked(
+			&val, bad_decimals[i], strlen(bad_decimals[i])));
+		TEST_ASSERT_EQUAL_INT32(1234, val);
+		TEST_ASSERT_EQUAL_INT32(0, decode_decimal(bad_decimals[i], strlen(bad_decimals[i])));
+	}
+
+	TEST_ASSERT_EQUAL_INT(0, decode_decimal_checked(&val, "true", 4));
+	TEST_ASSERT_EQUAL_INT32(1, val);
+	TEST_ASSERT_EQUAL_INT(0, decode_decimal_checked(&val, "false", 5));
+	TEST_ASSERT_EQUAL_INT32(0, val);
+	TEST_ASSERT_EQUAL_INT(0, decode_decimal_checked(&val, "-0", 2));
+	TEST_ASSERT_EQUAL_INT32(0, val);
+	TEST_ASSERT_EQUAL_INT(0, decode_decimal_checked(&val, "00000000004294967295", 20));
+	TEST_ASSERT_EQUAL_UINT32(4294967295u, (uint32_t)val);
+
+	// only len characters are looked at
+	TEST_ASSERT_EQUAL_INT(0, decode_decimal_checked(&val, "12,", 2));
+	TEST_ASSERT_EQUAL_INT32(12, val);
+}
+
+// collects hex output across writes
+char hex_out_buf[1024];
+size_t hex_out_len;
+uint32_t hex_out_writes;
+
+void hex_write(const char* src, size_t len) {
+	memcpy(hex_out_buf + hex_out_len, src, len);
+	hex_out_len += len;
+	hex_out_writes++;
+}
+
+void test_hex_exhaustive(void) {
+	uint8_t bytes[256];
+	char decoded[256];
+	char expected[3];
+	uint8_t nybble;
+
+	for (int i = 0; i < 256; i++) {
+		bytes[i] = i;
+	}
+	hex_out_len = 0;
+	hex_out_writes = 0;
+	encode_hexbuf(hex_write, bytes, sizeof(bytes));
+	TEST_ASSERT_EQUAL_INT(512, hex_out_len);
+	TEST_ASSERT_EQUAL_INT(512 / 64, hex_out_writes);
+	for (int i = 0; i < 256; i++) {
+		sprintf(expected, "%02X", i);
+		TEST_ASSERT_EQUAL_MEMORY(expected, hex_out_buf + i * 2, 2);
+	}
+
+	TEST_ASSERT_EQUAL_INT(0, decode_hexbuf(copy, decoded, hex_out_buf, hex_out_len));
+	TEST_ASSERT_EQUAL_MEMORY(bytes, decoded, sizeof(bytes));
+
+	// lower case reads the same
+	for (size_t i = 0; i < hex_out_len; i++) {
+		if (hex_out_buf[i] >= 'A') hex_out_buf[i] += 'a' - 'A';
+	}
+	memset(decoded, 0, sizeof(decoded));
+	TEST_ASSERT_EQUAL_INT(0, decode_hexbuf(copy, decoded, hex_out_buf, hex_out_len));
+	TEST_ASSERT_EQUAL_MEMORY(bytes, decoded, sizeof(bytes));
+
+	// every character, in either position
+	for (int c = 0; c < 256; c++) {
+		bool valid = (c >= '0' && c <= '9') || (c >= 'A' && c <= 'F') || (c >= 'a' && c <= 'f');
+		char pair[2];
+
+		TEST_ASSERT_EQUAL_INT(valid ? 0 : -1, decode_nybble(&nybble, c));
+		pair[0] = c;
+		pair[1] = '0';
+		TEST_ASSERT_EQUAL_INT(valid ? 0 : -1, decode_hexbuf(copy, decoded, pair, 2));
+		pair[0] = '0';
+		pair[1] = c;
+		TEST_ASSERT_EQUAL_INT(valid ? 0 : -1, decode_hexbuf(copy, decoded, pair, 2));
+	}
+	for (uint8_t v = 0; v < 16; v++) {
+		TEST_ASSERT_EQUAL_INT(0, decode_nybble(&nybble, encode_nybble(v)));
+		TEST_ASSERT_EQUAL_UINT8(v, nybble);
+	}
+
+	TEST_ASSERT_EQUAL_INT(-1, decode_hexbuf(copy, decoded, "ABC", 3));
+}
+
 int main(void) {
 	UNITY_BEGIN();
 
 	RUN_TEST(test_decimal_signed_round_trip);
 	RUN_TEST(test_decimal_unsigned_round_trip);
 	RUN_TEST(test_decode_hexbuf);
+	RUN_TEST(test_decimal_exhaustive);
+	RUN_TEST(test_decimal_rejects);
+	RUN_TEST(test_hex_exhaustive);
 
 	return UNITY_END();
 }
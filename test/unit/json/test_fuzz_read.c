@@ -0,0 +1,108 @@
+#include "unity.h"
+
+// the fuzz harness, run over generated inputs so every build covers it
+#define FUZZ_NO_MAIN
+#include "../../fuzz/fuzz_json_read.c"
+
+#define FUZZ_RUNS 3000
+
+uint8_t input[FUZZ_FULL_TEXTBUF];
+
+void print_input(const uint8_t* data, size_t len) {
+	printf("\ntextbuf %d, chunk %d:\n", FUZZ_MIN_TEXTBUF + data[0], 1 + data[1]);
+	fwrite(data + FUZZ_HEADER_LEN, 1, len - FUZZ_HEADER_LEN, stdout);
+	printf("\n");
+}
+
+void test_valid_documents_read(void) {
+	json_gen_seed(1);
+	for (int i = 0; i < FUZZ_RUNS; i++) {
+		size_t len = fuzz_json_read_input(input, sizeof(input), true);
+		int line = fuzz_json_read_one(input, len);
+		json_read_result_t result = fuzz_read_with(
+			&fuzz_ram[0], FUZZ_MIN_TEXTBUF + input[0], 1 + input[1]);
+		if (line != 0 || result != JSON_READ_OK) {
+			print_input(input, len);
+		}
+		TEST_ASSERT_EQUAL_INT(0, line);
+		TEST_ASSERT_EQUAL_INT(JSON_READ_OK, result);
+	}
+}
+
+void test_damaged_documents(void) {
+	int ok_ct = 0;
+
+	json_gen_seed(2);
+	for (int i = 0; i < FUZZ_RUNS; i++) {
+		size_t len = fuzz_json_read_input(input, sizeof(input), false);
+		int line = fuzz_json_read_one(input, len);
+		if (line != 0) {
+			print_input(input, len);
+		}
+		TEST_ASSERT_EQUAL_INT(0, line);
+		ok_ct += fuzz_read_with(&fuzz_ram[0], FUZZ_MIN_TEXTBUF + input[0], 1 + input[1]) == JSON_READ_OK;
+	}
+
+	// enough get through to exercise the readers, not only the tokenizer
+	TEST_ASSERT_TRUE(ok_ct > FUZZ_RUNS / 4);
+	TEST_ASSERT_TRUE(ok_ct < FUZZ_RUNS);
+}
+
+void test_random_bytes(void) {
+	json_gen_seed(3);
+	for (int i = 0; i < FUZZ_RUNS; i++) {
+		size_t len = json_gen_rand() % 64;
+		for (size_t j = 0; j < len; j++) {
+			input[j] = json_gen_rand();
+		}
+		TEST_ASSERT_EQUAL_INT(0, fuzz_json_read_one(input, len));
+	}
+}
+
+// inputs the harness has caught out before
+#define FOUND(textbuf, chunk, doc, result) { textbuf, chunk, doc, sizeof(doc) - 1, result }
+
+void test_found_inputs(void) {
+	static const struct {
+		uint8_t textbuf;
+		uint8_t chunk;
+		const char* doc;
+		size_t len;
+		json_read_result_t result;
+	} found[] = {
+		// a hex buffer too long for its field, handed over in pieces
+		FOUND(50, 2, "{\"longbuffer\":\""
+		      "0123456789ABCDEF0123456789ABCDEF0123456789ABCDEF0123456789ABCDEF"
+		      "0123456789ABCDEF0123456789ABCDEF0123456789ABCDEF0123456789ABCDEF"
+		      "0123456789ABCDEF0123456789ABCDEF0123456789ABCDEF0123456789ABCDEF"
+		      "0123456789ABCDEF0123456789ABCDEF0123456789ABCDEF0123456789ABCDEF"
+		      "0123456789ABCDEF0123456789ABCDEF0123456789ABCDEF0123456789ABCDEF\"}",
+		      JSON_READ_MALFORMED),
+		// an odd number of hex digits
+		FOUND(27, 173, "{\"buffer\":\"447280D7F0FDF0F1B40A71FC627055E\"}",
+		      JSON_READ_MALFORMED),
+		// a key with a NUL in it, longer than the known key before the NUL.
+		// reading past that key only shows in a sanitizer build
+		FOUND(0, 255, "{\"ubyte\0xx\":1}", JSON_READ_OK),
+	};
+
+	for (size_t i = 0; i < sizeof(found) / sizeof(found[0]); i++) {
+		input[0] = found[i].textbuf;
+		input[1] = found[i].chunk;
+		memcpy(input + FUZZ_HEADER_LEN, found[i].doc, found[i].len);
+		TEST_ASSERT_EQUAL_INT(0, fuzz_json_read_one(input, FUZZ_HEADER_LEN + found[i].len));
+		TEST_ASSERT_EQUAL_INT(found[i].result, fuzz_read_with(
+			&fuzz_ram[0], FUZZ_MIN_TEXTBUF + input[0], 1 + input[1]));
+	}
+}
+
+int main(void) {
+	UNITY_BEGIN();
+
+	RUN_TEST(test_valid_documents_read);
+	RUN_TEST(test_damaged_documents);
+	RUN_TEST(test_random_bytes);
+	RUN_TEST(test_found_inputs);
+
+	return UNITY_END();
+}
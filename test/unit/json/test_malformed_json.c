@@ -14,27 +14,69 @@ static const char* s[] = {
 	"0000000000000000000000000000000000000000000000000000000000",
 };
 
+json_read_result_t read_string(const char* doc) {
+	FILE* fp = write_temp_file("in.tmp", doc, strlen(doc));
+	set_fp(fp);
+	memset(&json_test_dest, 0, sizeof(json_test_dest_t));
+
+	json_read_result_t rd_result = json_read(
+		read_fp, copy,
+		&json_test_dest, &json_test_docdef,
+		json_test_buf, sizeof(json_test_buf),
+		json_test_tokens, sizeof(json_test_tokens) / sizeof(json_test_tokens[0]));
+	fclose(fp);
+	return rd_result;
+}
+
 void test_malformed_documents(void) {
 	for (int i = 0; i < sizeof(s) / sizeof(s[0]); i++) {
-		FILE* fp = write_temp_file("in.tmp", s[i], strlen(s[i]));
-		set_fp(fp);
-		memset(&json_test_dest, 0, sizeof(json_test_dest_t));
-
-		json_read_result_t rd_result = json_read(
-			read_fp, copy,
-			&json_test_dest, &json_test_docdef,
-			json_test_buf, sizeof(json_test_buf),
-			json_test_tokens, sizeof(json_test_tokens) / sizeof(json_test_tokens[0]));
-		fclose(fp);
-
-		TEST_ASSERT_EQUAL_INT(rd_result, JSON_READ_MALFORMED);
+		TEST_ASSERT_EQUAL_INT(JSON_READ_MALFORMED, read_string(s[i]));
 	}
 }
 
+// numbers that don't fit their field, rather than being truncated into it
+static const char* out_of_range[] = {
+	"{\"ubyte\": 256}",
+	"{\"ubyte\": 300}",
+	"{\"ubyte\": -1}",
+	"{\"sbyte\": 128}",
+	"{\"sbyte\": -129}",
+	"{\"ushort\": 65536}",
+	"{\"ushort\": -1}",
+	"{\"sshort\": 32768}",
+	"{\"sshort\": -32769}",
+	"{\"ulong\": -1}",
+	"{\"slong\": 2147483648}",
+	"{\"slong\": 4294967295}",
+};
+
+void test_scalar_out_of_range(void) {
+	for (int i = 0; i < sizeof(out_of_range) / sizeof(out_of_range[0]); i++) {
+		TEST_ASSERT_EQUAL_INT(JSON_READ_MALFORMED, read_string(out_of_range[i]));
+	}
+
+	// the limits themselves read
+	TEST_ASSERT_EQUAL_INT(JSON_READ_OK, read_string(
+		"{\"ubyte\": 255, \"sbyte\": -128, \"ushort\": 65535, \"sshort\": -32768}"));
+	TEST_ASSERT_EQUAL_UINT8(255, json_test_dest.ubyte);
+	TEST_ASSERT_EQUAL_INT8(-128, json_test_dest.sbyte);
+	TEST_ASSERT_EQUAL_UINT16(65535, json_test_dest.ushort);
+	TEST_ASSERT_EQUAL_INT16(-32768, json_test_dest.sshort);
+	TEST_ASSERT_EQUAL_INT(JSON_READ_OK, read_string(
+		"{\"sbyte\": 127, \"sshort\": 32767, \"ubyte\": -0}"));
+	TEST_ASSERT_EQUAL_INT8(127, json_test_dest.sbyte);
+	TEST_ASSERT_EQUAL_INT16(32767, json_test_dest.sshort);
+	TEST_ASSERT_EQUAL_INT(JSON_READ_OK, read_string(
+		"{\"ulong\": 4294967295, \"slong\": -2147483648}"));
+	TEST_ASSERT_EQUAL_UINT32(4294967295u, json_test_dest.ulong);
+	TEST_ASSERT_EQUAL_INT32(-2147483647 - 1, json_test_dest.slong);
+}
+
 int main(void) {
 	UNITY_BEGIN();
 
 	RUN_TEST(test_malformed_documents);
+	RUN_TEST(test_scalar_out_of_range);
 
 	return UNITY_END();
 }
@@ -0,0 +1,179 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "unity.h"
+
+#include "json_test_common.c"
+#include "json_test_schema.c"
+#include "json_test_bank.c"
+
+// in-memory stream
+char mem[32768];
+size_t mem_len, mem_pos;
+
+void mem_write(const char* src, size_t len) {
+	TEST_ASSERT_TRUE(mem_len + len <= sizeof(mem));
+	memcpy(mem + mem_len, src, len);
+	mem_len += len;
+}
+
+size_t mem_read(char* dst, size_t len) {
+	size_t n = mem_len - mem_pos;
+	if (n > len) n = len;
+	memcpy(dst, mem + mem_pos, n);
+	mem_pos += n;
+	return n;
+}
+
+char textbuf[64];
+
+void write_bank(void) {
+	bank.version = 3;
+	for (int i = 0; i < SLOT_CT; i++) {
+		bank.slots[i].level = i + 1;
+		bank.slots[i].len = 1000 + i;
+		for (int j = 0; j < sizeof(bank.slots[i].steps); j++) {
+			bank.slots[i].steps[j] = i * 7 + j;
+		}
+	}
+	mem_len = 0;
+	TEST_ASSERT_EQUAL_INT(JSON_WRITE_OK, json_write(mem_write, &bank, &bank_docdef));
+}
+
+json_read_result_t read_bank_path(const char* path) {
+	mem_pos = 0;
+	memset(&bank_in, 0, sizeof(bank_in));
+	return json_read_path(mem_read, copy, &bank_in, &bank_docdef, path,
+			      textbuf, sizeof(textbuf));
+}
+
+void test_unknown_keys_not_tokenized(void) {
+	const char s[] = "{\"unknown\": [{\"a\": 1, \"b\": [1, 2, \"]}\"]}, {\"c\": \"\\\"}\"}], "
+		"\"ubyte\": 7, \"skipped\": \"{[\", \"sbyte\": -7}";
+
+	mem_len = 0;
+	mem_write(s, strlen(s));
+	mem_pos = 0;
+	memset(&json_test_dest, 0, sizeof(json_test_dest));
+	TEST_ASSERT_EQUAL_INT(JSON_READ_OK, json_read(
+		mem_read, copy, &json_test_dest, &json_test_docdef,
+		textbuf, sizeof(textbuf), NULL, 0));
+	TEST_ASSERT_EQUAL_UINT8(7, json_test_dest.ubyte);
+	TEST_ASSERT_EQUAL_INT8(-7, json_test_dest.sbyte);
+
+	// '{', 4 keys, 2 values and '}'
+	TEST_ASSERT_EQUAL_INT(8, deserialize_state.total_tokens_read);
+}
+
+void test_extra_items_stay_in_bounds(void) {
+	const char s[] = "{\"nested_array\": [{\"ubyte\": 1}, {\"ubyte\": 2}, {\"ubyte\": 3}, "
+		"{\"ubyte\": 4}, {\"ubyte\": 5}, {\"ubyte\": 6}], \"ubyte\": 9}";
+
+	mem_len = 0;
+	mem_write(s, strlen(s));
+	mem_pos = 0;
+	memset(&json_test_dest, 0, sizeof(json_test_dest));
+	TEST_ASSERT_EQUAL_INT(JSON_READ_OK, json_read(
+		mem_read, copy, &json_test_dest, &json_test_docdef,
+		textbuf, sizeof(textbuf), NULL, 0));
+	TEST_ASSERT_EQUAL_UINT8(4, json_test_dest.nested_array[3].ubyte);
+	// the fifth item used to land in the field after the array
+	TEST_ASSERT_EQUAL_INT8(0, json_test_dest.longstring[0]);
+	TEST_ASSERT_EQUAL_UINT8(9, json_test_dest.ubyte);
+}
+
+void test_read_one_slot(void) {
+	write_bank();
+
+	TEST_ASSERT_EQUAL_INT(JSON_READ_OK, read_bank_path("slots/5"));
+	TEST_ASSERT_EQUAL_MEMORY(&bank.slots[5], &bank_in.slots[5], sizeof(slot_t));
+	for (int i = 0; i < SLOT_CT; i++) {
+		if (i != 5) {
+			TEST_ASSERT_EQUAL_UINT8(0, bank_in.slots[i].level);
+		}
+	}
+	TEST_ASSERT_EQUAL_UINT8(0, bank_in.version);
+
+	// reading stops at the end of the slot
+	TEST_ASSERT_TRUE(mem_pos < mem_len / 4);
+}
+
+void test_read_leaf(void) {
+	write_bank();
+
+	TEST_ASSERT_EQUAL_INT(JSON_READ_OK, read_bank_path("/slots/31/len"));
+	TEST_ASSERT_EQUAL_UINT16(1031, bank_in.slots[31].len);
+	TEST_ASSERT_EQUAL_UINT8(0, bank_in.slots[31].level);
+
+	TEST_ASSERT_EQUAL_INT(JSON_READ_OK, read_bank_path("version"));
+	TEST_ASSERT_EQUAL_UINT8(3, bank_in.version);
+}
+
+void test_missing_path(void) {
+	int32_t dst_offset;
+
+	write_bank();
+
+	TEST_ASSERT_NULL(json_docdef_find_path(&bank_docdef, "slots/32", &dst_offset));
+	TEST_ASSERT_NULL(json_docdef_find_path(&bank_docdef, "slots/x", &dst_offset));
+	TEST_ASSERT_NULL(json_docdef_find_path(&bank_docdef, "nothere", &dst_offset));
+	TEST_ASSERT_NULL(json_docdef_find_path(&bank_docdef, "version/1", &dst_offset));
+	TEST_ASSERT_EQUAL_INT(JSON_READ_MALFORMED, read_bank_path("slots/32"));
+
+	// in the docdef but not the document
+	mem_len = 0;
+	mem_write("{\"slots\": [{\"level\": 1}]}", 25);
+	TEST_ASSERT_EQUAL_INT(JSON_READ_MALFORMED, read_bank_path("slots/1"));
+	TEST_ASSERT_EQUAL_INT(JSON_READ_MALFORMED, read_bank_path("version"));
+	TEST_ASSERT_EQUAL_INT(JSON_READ_OK, read_bank_path("slots/0/level"));
+	TEST_ASSERT_EQUAL_UINT8(1, bank_in.slots[0].level);
+}
+
+void test_index_and_seek(void) {
+	uint32_t offsets[SLOT_CT + 4];
+	size_t ct;
+	char path[16];
+
+	write_bank();
+
+	mem_pos = 0;
+	TEST_ASSERT_EQUAL_INT(JSON_READ_OK, json_index_path(
+		mem_read, "slots", offsets, sizeof(offsets) / sizeof(offsets[0]), &ct,
+		textbuf, sizeof(textbuf)));
+	TEST_ASSERT_EQUAL_INT(SLOT_CT, ct);
+
+	for (int i = SLOT_CT - 1; i >= 0; i--) {
+		sprintf(path, "slots/%d", i);
+		mem_pos = offsets[i];
+		memset(&bank_in, 0, sizeof(bank_in));
+		TEST_ASSERT_EQUAL_INT(JSON_READ_OK, json_read_path_at(
+			mem_read, copy, &bank_in, &bank_docdef, path,
+			textbuf, sizeof(textbuf)));
+		TEST_ASSERT_EQUAL_MEMORY(&bank.slots[i], &bank_in.slots[i], sizeof(slot_t));
+	}
+
+	// an object's offsets are of its values
+	mem_pos = 0;
+	TEST_ASSERT_EQUAL_INT(JSON_READ_OK, json_index_path(
+		mem_read, "", offsets, 1, &ct, textbuf, sizeof(textbuf)));
+	TEST_ASSERT_EQUAL_INT(1, ct);
+	mem_pos = offsets[0];
+	memset(&bank_in, 0, sizeof(bank_in));
+	TEST_ASSERT_EQUAL_INT(JSON_READ_OK, json_read_path_at(
+		mem_read, copy, &bank_in, &bank_docdef, "version",
+		textbuf, sizeof(textbuf)));
+	TEST_ASSERT_EQUAL_UINT8(3, bank_in.version);
+}
+
+int main(void) {
+	UNITY_BEGIN();
+
+	RUN_TEST(test_unknown_keys_not_tokenized);
+	RUN_TEST(test_extra_items_stay_in_bounds);
+	RUN_TEST(test_read_one_slot);
+	RUN_TEST(test_read_leaf);
+	RUN_TEST(test_missing_path);
+	RUN_TEST(test_index_and_seek);
+
+	return UNITY_END();
+}
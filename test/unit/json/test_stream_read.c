@@ -0,0 +1,225 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "unity.h"
+
+#include "json_test_common.c"
+#include "json_test_schema.c"
+
+// in-memory stream, optionally handing out short reads
+char mem[8192];
+size_t mem_len, mem_pos, mem_chunk;
+uint32_t mem_reads;
+
+void mem_write(const char* src, size_t len) {
+	TEST_ASSERT_TRUE(mem_len + len <= sizeof(mem));
+	memcpy(mem + mem_len, src, len);
+	mem_len += len;
+}
+
+void mem_set(const char* s) {
+	mem_len = 0;
+	mem_write(s, strlen(s));
+}
+
+size_t mem_read(char* dst, size_t len) {
+	size_t n = mem_len - mem_pos;
+	if (n > len) n = len;
+	if (n > mem_chunk) n = mem_chunk;
+	memcpy(dst, mem + mem_pos, n);
+	mem_pos += n;
+	mem_reads++;
+	return n;
+}
+
+char textbuf[1024];
+
+json_read_result_t read_mem(size_t textbuf_len, size_t chunk) {
+	mem_pos = 0;
+	mem_chunk = chunk;
+	mem_reads = 0;
+	memset(&json_test_dest, 0, sizeof(json_test_dest));
+	return json_read(mem_read, copy, &json_test_dest, &json_test_docdef,
+			 textbuf, textbuf_len, NULL, 0);
+}
+
+json_test_dest_t sample;
+
+void fill_sample(void) {
+	memset(&sample, 0, sizeof(sample));
+	sample.ubyte = 200;
+	sample.sbyte = -100;
+	sample.ushort = 60000;
+	sample.sshort = -30000;
+	sample.ulong = 123456789;
+	sample.slong = -2147483647 - 1;
+	sample.boolean = true;
+	sample.test_enum = TEST_ENUM_TWO;
+	for (int i = 0; i < sizeof(sample.buffer); i++) sample.buffer[i] = i * 17;
+	sample.nested.ubyte = 11;
+	sample.nested_cached.ubyte = 22;
+	for (int i = 0; i < 4; i++) sample.nested_array[i].ubyte = 30 + i;
+	memcpy(sample.longstring, LONG_STRING, sizeof(sample.longstring));
+	for (int i = 0; i < sizeof(sample.longbuffer); i++) sample.longbuffer[i] = 255 - i;
+}
+
+void write_sample(void) {
+	fill_sample();
+	mem_len = 0;
+	TEST_ASSERT_EQUAL_INT(JSON_WRITE_OK, json_write(mem_write, &sample, &json_test_docdef));
+}
+
+// "nested_cached" is the longest key, so 14 bytes is the smallest buffer
+// that fits every key and number of the test schema
+#define MIN_TEXTBUF 14
+
+void test_any_buffer_size(void) {
+	size_t chunks[] = { 1, 3, sizeof(mem) };
+
+	write_sample();
+	for (int c = 0; c < sizeof(chunks) / sizeof(chunks[0]); c++) {
+		for (size_t len = MIN_TEXTBUF; len <= 300; len++) {
+			TEST_ASSERT_EQUAL_INT(JSON_READ_OK, read_mem(len, chunks[c]));
+			TEST_ASSERT_EQUAL_MEMORY(&sample, &json_test_dest, sizeof(sample));
+		}
+	}
+}
+
+void test_text_read_once(void) {
+	write_sample();
+
+	// every byte comes from the stream exactly once, and with the buffer
+	// holding the whole document there is no second pass over it
+	TEST_ASSERT_EQUAL_INT(JSON_READ_OK, read_mem(sizeof(textbuf), sizeof(mem)));
+	TEST_ASSERT_EQUAL_INT(mem_len, deserialize_state.total_bytes_read);
+	TEST_ASSERT_EQUAL_INT(1, mem_reads);
+
+	// a small buffer only adds the pieces of the long values
+	uint32_t tokens = deserialize_state.total_tokens_read;
+	TEST_ASSERT_EQUAL_INT(JSON_READ_OK, read_mem(64, sizeof(mem)));
+	TEST_ASSERT_EQUAL_INT(mem_len, deserialize_state.total_bytes_read);
+	TEST_ASSERT_TRUE(deserialize_state.total_tokens_read > tokens);
+	TEST_ASSERT_TRUE(deserialize_state.total_tokens_read < tokens + 2 * mem_len / 64 + 2);
+}
+
+void test_escapes_split_anywhere(void) {
+	mem_set("{\"unknown\": \"a\\u00e9\\\"\\n\\/\", \"ubyte\": 5, \"skipped\": [\"\\\\\", 1.5e3]}");
+
+	for (size_t len = MIN_TEXTBUF; len <= mem_len; len++) {
+		TEST_ASSERT_EQUAL_INT(JSON_READ_OK, read_mem(len, 5));
+		TEST_ASSERT_EQUAL_UINT8(5, json_test_dest.ubyte);
+	}
+}
+
+void test_number_at_wrap(void) {
+	mem_set("{\"sshort\":     -12345, \"ulong\":  4000000, \"boolean\": false}");
+
+	for (size_t len = MIN_TEXTBUF; len <= mem_len; len++) {
+		TEST_ASSERT_EQUAL_INT(JSON_READ_OK, read_mem(len, sizeof(mem)));
+		TEST_ASSERT_EQUAL_INT16(-12345, json_test_dest.sshort);
+		TEST_ASSERT_EQUAL_UINT32(4000000, json_test_dest.ulong);
+	}
+}
+
+static const char* malformed[] = {
+	"{]",
+	"{\"ubyte\": 1]",
+	"{\"nested\": {\"ubyte\": 1]}",
+	"{\"longstring\": \"\\x\"}",
+	"{\"longstring\": \"\\u12G4\"}",
+	"{\"ubyte\": 1\x01}",
+	"{\"ubyte\": 1",
+	"{\"ubyte\": \"1",
+	"",
+};
+
+void test_malformed_structure(void) {
+	for (int i = 0; i < sizeof(malformed) / sizeof(malformed[0]); i++) {
+		mem_set(malformed[i]);
+		TEST_ASSERT_EQUAL_INT(JSON_READ_MALFORMED, read_mem(64, sizeof(mem)));
+		TEST_ASSERT_EQUAL_INT(JSON_READ_MALFORMED, read_mem(MIN_TEXTBUF, 1));
+	}
+}
+
+// arrays of one item nested DEPTH_DOCDEF_CT deep, holding a byte
+#define DEPTH_DOCDEF_CT (JSON_READ_MAX_DEPTH + 1)
+
+json_docdef_t depth_docdefs[DEPTH_DOCDEF_CT + 1];
+json_read_array_params_t depth_array_params[DEPTH_DOCDEF_CT];
+json_read_array_state_t depth_array_states[DEPTH_DOCDEF_CT];
+json_read_scalar_params_t depth_scalar_params = { .dst_size = 1 };
+
+json_docdef_t* depth_docdef(int depth) {
+	json_docdef_t* d = &depth_docdefs[DEPTH_DOCDEF_CT - depth];
+
+	for (int i = DEPTH_DOCDEF_CT - depth; i < DEPTH_DOCDEF_CT; i++) {
+		depth_array_params[i] = (json_read_array_params_t) {
+			.array_len = 1,
+			.item_size = 1,
+			.item_docdef = &depth_docdefs[i + 1],
+		};
+		depth_docdefs[i] = (json_docdef_t) {
+			.read = json_read_array,
+			.state = &depth_array_states[i],
+			.params = &depth_array_params[i],
+		};
+	}
+	depth_docdefs[DEPTH_DOCDEF_CT] = (json_docdef_t) {
+		.read = json_read_scalar,
+		.params = &depth_scalar_params,
+	};
+	return d;
+}
+
+json_read_result_t read_nested(int depth) {
+	uint8_t dst = 0;
+	json_read_result_t result;
+
+	mem_len = 0;
+	for (int i = 0; i < depth; i++) mem_write("[", 1);
+	mem_write("7", 1);
+	for (int i = 0; i < depth; i++) mem_write("]", 1);
+	mem_pos = 0;
+	mem_chunk = sizeof(mem);
+	result = json_read(mem_read, copy, &dst, depth_docdef(depth),
+			   textbuf, sizeof(textbuf), NULL, 0);
+	if (result == JSON_READ_OK) {
+		TEST_ASSERT_EQUAL_UINT8(7, dst);
+	}
+	return result;
+}
+
+void test_nesting_depth(void) {
+	TEST_ASSERT_EQUAL_INT(JSON_READ_OK, read_nested(JSON_READ_MAX_DEPTH));
+	TEST_ASSERT_EQUAL_INT(JSON_READ_MALFORMED, read_nested(JSON_READ_MAX_DEPTH + 1));
+
+	// skipped values are only bracket counted, so aren't held to the limit
+	mem_len = 0;
+	mem_write("{\"unknown\": ", 12);
+	for (int i = 0; i <= JSON_READ_MAX_DEPTH; i++) mem_write("[", 1);
+	for (int i = 0; i <= JSON_READ_MAX_DEPTH; i++) mem_write("]", 1);
+	mem_write(", \"ubyte\": 3}", 13);
+	TEST_ASSERT_EQUAL_INT(JSON_READ_OK, read_mem(64, sizeof(mem)));
+	TEST_ASSERT_EQUAL_UINT8(3, json_test_dest.ubyte);
+}
+
+void test_token_longer_than_buffer(void) {
+	mem_set("{\"a_very_long_unknown_key\": 1, \"ubyte\": 2}");
+	TEST_ASSERT_EQUAL_INT(JSON_READ_MALFORMED, read_mem(16, sizeof(mem)));
+	TEST_ASSERT_EQUAL_INT(JSON_READ_OK, read_mem(32, sizeof(mem)));
+	TEST_ASSERT_EQUAL_UINT8(2, json_test_dest.ubyte);
+}
+
+int main(void) {
+	UNITY_BEGIN();
+
+	RUN_TEST(test_any_buffer_size);
+	RUN_TEST(test_text_read_once);
+	RUN_TEST(test_escapes_split_anywhere);
+	RUN_TEST(test_number_at_wrap);
+	RUN_TEST(test_malformed_structure);
+	RUN_TEST(test_nesting_depth);
+	RUN_TEST(test_token_longer_than_buffer);
+
+	return UNITY_END();
+}
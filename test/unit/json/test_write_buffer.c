@@ -0,0 +1,140 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "unity.h"
+
+#include "json_test_common.c"
+#include "json_test_schema.c"
+
+// the underlying writer: records every call, as the filesystem would see it
+char out[8192];
+size_t out_len;
+uint32_t out_calls;
+size_t out_sizes[1024];
+
+void out_reset(void) {
+	out_len = 0;
+	out_calls = 0;
+}
+
+void out_write(const char* src, size_t len) {
+	memcpy(out + out_len, src, len);
+	out_len += len;
+	if (out_calls < sizeof(out_sizes) / sizeof(out_sizes[0])) {
+		out_sizes[out_calls] = len;
+	}
+	out_calls++;
+}
+
+void fill_dest(void) {
+	memset(&json_test_dest, 0, sizeof(json_test_dest));
+	json_test_dest.ulong = 123456789;
+	json_test_dest.sshort = -42;
+	json_test_dest.test_enum = TEST_ENUM_ONE;
+	for (int i = 0; i < sizeof(json_test_dest.buffer); i++) json_test_dest.buffer[i] = i;
+	memcpy(json_test_dest.longstring, LONG_STRING, sizeof(json_test_dest.longstring));
+}
+
+void test_same_output_in_blocks(void) {
+	char expected[sizeof(out)];
+	size_t expected_len;
+	uint32_t unbuffered_calls;
+	size_t block_sizes[] = { 1, 7, 64, 512, 4096 };
+	char buf[4096];
+
+	fill_dest();
+	out_reset();
+	json_write(out_write, &json_test_dest, &json_test_docdef);
+	memcpy(expected, out, out_len);
+	expected_len = out_len;
+	unbuffered_calls = out_calls;
+
+	for (int s = 0; s < sizeof(block_sizes) / sizeof(block_sizes[0]); s++) {
+		size_t block = block_sizes[s];
+
+		out_reset();
+		TEST_ASSERT_EQUAL_INT(JSON_WRITE_OK, json_write_buffered(
+			out_write, buf, block, &json_test_dest, &json_test_docdef));
+		TEST_ASSERT_EQUAL_INT(expected_len, out_len);
+		TEST_ASSERT_EQUAL_MEMORY(expected, out, expected_len);
+
+		// every write but the last is a whole number of blocks
+		for (uint32_t i = 0; i + 1 < out_calls; i++) {
+			TEST_ASSERT_EQUAL_INT(0, out_sizes[i] % block);
+		}
+		TEST_ASSERT_TRUE(out_calls <= expected_len / block + 1);
+		if (block > 1) {
+			TEST_ASSERT_TRUE(out_calls < unbuffered_calls);
+		}
+	}
+}
+
+void test_large_writes_pass_through(void) {
+	json_puts_buffer_t b;
+	char buf[16];
+	char src[100];
+
+	for (int i = 0; i < sizeof(src); i++) src[i] = i;
+
+	out_reset();
+	json_puts_buffer_init(&b, out_write, buf, sizeof(buf));
+
+	// with nothing pending, whole blocks skip the copy
+	json_puts_buffered(src, 40);
+	TEST_ASSERT_EQUAL_INT(1, out_calls);
+	TEST_ASSERT_EQUAL_INT(32, out_sizes[0]);
+	TEST_ASSERT_EQUAL_INT(8, b.pos);
+
+	// with something pending, the block is topped up first
+	json_puts_buffered(src + 40, 60);
+	TEST_ASSERT_EQUAL_INT(3, out_calls);
+	TEST_ASSERT_EQUAL_INT(16, out_sizes[1]);
+	TEST_ASSERT_EQUAL_INT(48, out_sizes[2]);
+	TEST_ASSERT_EQUAL_INT(4, b.pos);
+
+	json_puts_buffer_flush(&b);
+	TEST_ASSERT_EQUAL_INT(4, out_calls);
+	TEST_ASSERT_EQUAL_INT(4, out_sizes[3]);
+	TEST_ASSERT_EQUAL_INT(100, out_len);
+	TEST_ASSERT_EQUAL_MEMORY(src, out, sizeof(src));
+
+	// nothing left, nothing written
+	json_puts_buffer_flush(&b);
+	TEST_ASSERT_EQUAL_INT(4, out_calls);
+}
+
+void test_zero_length_and_nesting(void) {
+	json_puts_buffer_t b, zero;
+	char buf[16];
+
+	fill_dest();
+	out_reset();
+	TEST_ASSERT_TRUE(json_puts_buffer_init(&b, out_write, buf, sizeof(buf)));
+	json_puts_buffered("{", 1);
+
+	// a zero length buffer is turned down and b stays active
+	TEST_ASSERT_FALSE(json_puts_buffer_init(&zero, out_write, buf, 0));
+	TEST_ASSERT_EQUAL_INT(JSON_WRITE_ERROR, json_write_buffered(
+		out_write, buf, 0, &json_test_dest, &json_test_docdef));
+	TEST_ASSERT_EQUAL_INT(0, out_calls);
+
+	// so is b after a buffered write of its own
+	char inner[64];
+	TEST_ASSERT_EQUAL_INT(JSON_WRITE_OK, json_write_buffered(
+		out_write, inner, sizeof(inner), &json_test_dest, &json_test_docdef));
+	size_t written = out_len;
+	json_puts_buffered("}", 1);
+	json_puts_buffer_flush(&b);
+	TEST_ASSERT_EQUAL_INT(written + 2, out_len);
+	TEST_ASSERT_EQUAL_INT('}', out[out_len - 1]);
+}
+
+int main(void) {
+	UNITY_BEGIN();
+
+	RUN_TEST(test_same_output_in_blocks);
+	RUN_TEST(test_large_writes_pass_through);
+	RUN_TEST(test_zero_length_and_nesting);
+
+	return UNITY_END();
+}
@@ -0,0 +1,279 @@
+#include "unity.h"
+
+#define MOD_TRILOGY
+
+// this
+#include "adc.c"
+
+//
+// mocks
+//
+
+volatile avr32_spi_t AVR32_SPI;
+
+// simulated ad7923; returns the previously addressed channel's value
+u16 adc_in[4];
+u8 adc_addr;
+
+spi_status_t spi_selectChip(volatile avr32_spi_t *spi, uint8_t chip) {
+	return SPI_OK;
+}
+
+spi_status_t spi_unselectChip(volatile avr32_spi_t *spi, uint8_t chip) {
+	return SPI_OK;
+}
+
+u8 adc_next_addr;
+
+spi_status_t spi_write(volatile avr32_spi_t *spi, uint16_t data) {
+	adc_addr = adc_next_addr;
+	adc_next_addr = (data >> 10) & 3;
+	return SPI_OK;
+}
+
+spi_status_t spi_read(volatile avr32_spi_t *spi, uint16_t *data) {
+	*data = 0xf000 | adc_in[adc_addr];
+	return SPI_OK;
+}
+
+u8 irqs_pause(void) {
+	return 0;
+}
+
+void irqs_resume(u8 irq_flags) {
+}
+
+#define EVENTS_MAX 256
+event_t events[EVENTS_MAX];
+u16 event_ct;
+
+u8 event_post(event_t *e) {
+	if (event_ct < EVENTS_MAX) events[event_ct++] = *e;
+	return 1;
+}
+
+softTimer_t* timer_added;
+u32 timer_added_ticks;
+
+u8 timer_add(softTimer_t* t, u32 ticks, timer_callback_t callback, void* caller) {
+	timer_added = t;
+	timer_added_ticks = ticks;
+	t->callback = callback;
+	t->caller = caller;
+	return 1;
+}
+
+u8 timer_remove(softTimer_t* t) {
+	timer_added = NULL;
+	return 1;
+}
+
+// run the service timer n times
+void fire(u16 n) {
+	while (n--) timer_added->callback(timer_added->caller);
+}
+
+u16 events_for(u8 ch) {
+	u16 ct = 0;
+	for (u16 i = 0; i < event_ct; i++) {
+		if (events[i].type == kEventAdc0 + ch) ct++;
+	}
+	return ct;
+}
+
+// noise in [-amp, amp]
+static u32 noise_state = 1;
+s16 noise(s16 amp) {
+	noise_state = noise_state * 1103515245 + 12345;
+	return (s16)((noise_state >> 16) % (2 * amp + 1)) - amp;
+}
+
+void reset(void) {
+	for (u8 i = 0; i < ADC_CHANNELS; i++) {
+		adc_set_filter(i, kAdcFilterNone, 0);
+		adc_set_threshold(i, ADC_THRESHOLD_DEFAULT);
+		adc_in[i] = 0;
+	}
+	event_ct = 0;
+}
+
+//
+// tests
+//
+
+void test_convert_reads_each_channel(void) {
+	u16 raw[4];
+
+	reset();
+	adc_in[0] = 100;
+	adc_in[1] = 2000;
+	adc_in[2] = 3000;
+	adc_in[3] = 4095;
+	adc_convert(&raw);
+	TEST_ASSERT_EQUAL_UINT16(100, raw[0]);
+	TEST_ASSERT_EQUAL_UINT16(2000, raw[1]);
+	TEST_ASSERT_EQUAL_UINT16(3000, raw[2]);
+	TEST_ASSERT_EQUAL_UINT16(4095, raw[3]);
+}
+
+void test_first_values_post_once(void) {
+	reset();
+	adc_in[2] = 1234;
+	adc_service_start(5, 0);
+	TEST_ASSERT_NOT_NULL(timer_added);
+	TEST_ASSERT_EQUAL_UINT32(5, timer_added_ticks);
+
+	fire(1);
+	TEST_ASSERT_EQUAL_UINT16(4, event_ct);
+	TEST_ASSERT_EQUAL(kEventAdc2, events[2].type);
+	TEST_ASSERT_EQUAL_INT32(1234, events[2].data);
+
+	// steady input posts nothing more
+	fire(50);
+	TEST_ASSERT_EQUAL_UINT16(4, event_ct);
+	adc_service_stop();
+	TEST_ASSERT_NULL(timer_added);
+}
+
+void test_oversampling_averages(void) {
+	reset();
+	adc_service_start(1, 2);
+	for (u8 i = 0; i < 3; i++) {
+		adc_in[0] = 1000 + i * 4;
+		fire(1);
+		TEST_ASSERT_EQUAL_UINT16(0, event_ct);
+	}
+	adc_in[0] = 1012;
+	fire(1);
+	TEST_ASSERT_EQUAL_UINT16(4, event_ct);
+	TEST_ASSERT_EQUAL_UINT16(1006, adc_get_value(0));
+	adc_service_stop();
+}
+
+void test_threshold_hysteresis(void) {
+	reset();
+	adc_in[1] = 2000;
+	adc_set_threshold(1, 10);
+	adc_service_start(1, 0);
+	fire(1);
+	event_ct = 0;
+
+	// wobbling inside the band posts nothing, leaving it posts once
+	adc_in[1] = 2009;
+	fire(1);
+	adc_in[1] = 1991;
+	fire(1);
+	TEST_ASSERT_EQUAL_UINT16(0, events_for(1));
+	adc_in[1] = 2010;
+	fire(3);
+	TEST_ASSERT_EQUAL_UINT16(1, events_for(1));
+	TEST_ASSERT_EQUAL_INT32(2010, events[0].data);
+
+	// the band follows the posted value
+	adc_in[1] = 2001;
+	fire(1);
+	TEST_ASSERT_EQUAL_UINT16(1, events_for(1));
+	adc_service_stop();
+}
+
+void test_median_rejects_spikes(void) {
+	reset();
+	adc_in[3] = 500;
+	adc_set_filter(3, kAdcFilterMedian, 0);
+	adc_service_start(1, 0);
+	fire(3);
+	event_ct = 0;
+
+	adc_in[3] = 4000;
+	fire(1);
+	adc_in[3] = 500;
+	fire(5);
+	TEST_ASSERT_EQUAL_UINT16(0, events_for(3));
+
+	// a real step gets through a sample late
+	adc_in[3] = 3000;
+	fire(1);
+	TEST_ASSERT_EQUAL_UINT16(0, events_for(3));
+	fire(1);
+	TEST_ASSERT_EQUAL_UINT16(1, events_for(3));
+	TEST_ASSERT_EQUAL_UINT16(3000, adc_get_value(3));
+	adc_service_stop();
+}
+
+void test_iir_quiets_noise(void) {
+	u16 raw_posts, filtered_posts;
+
+	reset();
+	// noise of +/-12 around a still knob, unfiltered
+	adc_service_start(1, 0);
+	fire(1);
+	event_ct = 0;
+	for (u16 i = 0; i < 1000; i++) {
+		adc_in[0] = 2048 + noise(12);
+		fire(1);
+	}
+	raw_posts = events_for(0);
+	adc_service_stop();
+
+	// the same with 4x oversampling and a lowpass
+	adc_set_filter(0, kAdcFilterIir, 3);
+	adc_service_start(1, 2);
+	fire(4);
+	event_ct = 0;
+	for (u16 i = 0; i < 1000; i++) {
+		adc_in[0] = 2048 + noise(12);
+		fire(1);
+	}
+	filtered_posts = events_for(0);
+
+	TEST_ASSERT_TRUE(raw_posts > 100);
+	TEST_ASSERT_TRUE(filtered_posts <= 2);
+
+	// and still settles on a moved knob
+	adc_in[0] = 1000;
+	fire(4 * 80);
+	TEST_ASSERT_INT_WITHIN(1, 1000, adc_get_value(0));
+	adc_service_stop();
+}
+
+void test_iir_settles_exactly(void) {
+	reset();
+	adc_in[2] = 2000;
+	adc_set_filter(2, kAdcFilterIir, 8);
+	adc_service_start(1, 0);
+	fire(1);
+	event_ct = 0;
+
+	// the heaviest lowpass still arrives at a step of just the threshold,
+	// and posts it
+	adc_in[2] = 2000 + ADC_THRESHOLD_DEFAULT;
+	fire(4000);
+	TEST_ASSERT_EQUAL_UINT16(1, events_for(2));
+	TEST_ASSERT_EQUAL_INT32(2000 + ADC_THRESHOLD_DEFAULT, events[0].data);
+
+	// from either side
+	adc_set_threshold(2, 1);
+	adc_in[2] = 3000;
+	fire(8000);
+	TEST_ASSERT_EQUAL_UINT16(3000, adc_get_value(2));
+	TEST_ASSERT_EQUAL_UINT16(3000, adc_ch[2].posted);
+	adc_in[2] = 1001;
+	fire(8000);
+	TEST_ASSERT_EQUAL_UINT16(1001, adc_get_value(2));
+	TEST_ASSERT_EQUAL_UINT16(1001, adc_ch[2].posted);
+	adc_service_stop();
+}
+
+int main(void) {
+	UNITY_BEGIN();
+
+	RUN_TEST(test_convert_reads_each_channel);
+	RUN_TEST(test_first_values_post_once);
+	RUN_TEST(test_oversampling_averages);
+	RUN_TEST(test_threshold_hysteresis);
+	RUN_TEST(test_median_rejects_spikes);
+	RUN_TEST(test_iir_quiets_noise);
+	RUN_TEST(test_iir_settles_exactly);
+
+	return UNITY_END();
+}
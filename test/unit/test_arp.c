@@ -5,7 +5,6 @@
 #include "notes.c"
 
 // this
-#include "euclidean/data.c"
 #include "euclidean/euclidean.c"
 #include "arp.c"
 
@@ -328,6 +327,421 @@ void test_seq_build_random(void) {
 	TEST_ASSERT_EQUAL_INT8(3, seq.length);
 }
 
+void assert_seq_equal(arp_seq_t *expected, arp_seq_t *actual) {
+	TEST_ASSERT_EQUAL_UINT8_MESSAGE(expected->length, actual->length,
+																	"incremental length doesn't match rebuild");
+	for (u8 i = 0; i < expected->length; i++) {
+		TEST_ASSERT_EQUAL_UINT8_MESSAGE(expected->notes[i].note.num, actual->notes[i].note.num,
+																		"incremental step doesn't match rebuild");
+	}
+}
+
+void test_seq_buf_matches_rebuild(void) {
+	arp_style styles[] = {
+		eStyleUp, eStyleDown, eStyleUpDown, eStyleUpAndDown,
+		eStyleConverge, eStyleDiverge
+	};
+	arp_seq_buf_t buf;
+	random_state_t r;
+	chord_t chord, check;
+	u8 num;
+
+	for (u8 i = 0; i < sizeof(styles) / sizeof(styles[0]); i++) {
+		chord_init(&chord);
+		arp_seq_buf_init(&buf, styles[i]);
+		random_seed(&r, 4321 + i);
+
+		for (u16 n = 0; n < 500; n++) {
+			num = random_next(&r) % 24;
+			if (chord_contains(&chord, num)) {
+				TEST_ASSERT_TRUE(arp_seq_buf_note_release(&buf, &chord, num, NULL, 0));
+			}
+			else {
+				arp_seq_buf_note_add(&buf, &chord, num, 64, NULL, 0);
+			}
+
+			check = chord;
+			arp_seq_init(&seq);
+			arp_seq_build(&seq, styles[i], &check, NULL);
+			assert_seq_equal(&seq, arp_seq_buf_front(&buf));
+			TEST_ASSERT_TRUE(arp_seq_buf_front(&buf)->state != eSeqBuilding);
+		}
+	}
+}
+
+void test_seq_buf_played_and_random(void) {
+	arp_seq_buf_t buf;
+	arp_seq_t *s;
+	chord_t chord;
+
+	// played keeps insert order
+	chord_init(&chord);
+	arp_seq_buf_init(&buf, eStylePlayed);
+	arp_seq_buf_note_add(&buf, &chord, 50, 1, NULL, 0);
+	arp_seq_buf_note_add(&buf, &chord, 40, 2, NULL, 0);
+	arp_seq_buf_note_add(&buf, &chord, 60, 3, NULL, 0);
+	arp_seq_buf_note_release(&buf, &chord, 40, NULL, 0);
+	s = arp_seq_buf_front(&buf);
+	TEST_ASSERT_EQUAL_UINT8(2, s->length);
+	TEST_ASSERT_EQUAL_UINT8(50, s->notes[0].note.num);
+	TEST_ASSERT_EQUAL_UINT8(60, s->notes[1].note.num);
+	TEST_ASSERT_EQUAL_UINT8(3, s->notes[1].note.vel);
+
+	// random holds every chord note exactly once, and existing notes keep
+	// their relative order across edits
+	chord_init(&chord);
+	arp_seq_buf_init(&buf, eStyleRandom);
+	for (u8 n = 0; n < 8; n++) {
+		arp_seq_buf_note_add(&buf, &chord, n, 1, NULL, 0);
+	}
+	s = arp_seq_buf_front(&buf);
+	TEST_ASSERT_EQUAL_UINT8(8, s->length);
+	for (u8 n = 0; n < 8; n++) {
+		TEST_ASSERT_TRUE(arp_seq_find(s, n) >= 0);
+	}
+	seq = *s;
+	arp_seq_buf_note_release(&buf, &chord, seq.notes[3].note.num, NULL, 0);
+	s = arp_seq_buf_front(&buf);
+	TEST_ASSERT_EQUAL_UINT8(7, s->length);
+	TEST_ASSERT_EQUAL_UINT8(seq.notes[2].note.num, s->notes[2].note.num);
+	TEST_ASSERT_EQUAL_UINT8(seq.notes[4].note.num, s->notes[3].note.num);
+}
+
+void test_seq_buf_keeps_player_position(void) {
+	arp_seq_buf_t buf;
+	arp_player_t p;
+	chord_t chord;
+	arp_seq_t *s;
+
+	chord_init(&chord);
+	arp_seq_buf_init(&buf, eStyleUp);
+	arp_player_init(&p, 0, 1);
+
+	arp_seq_buf_note_add(&buf, &chord, 10, 1, &p, 1);
+	arp_seq_buf_note_add(&buf, &chord, 30, 1, &p, 1);
+	arp_seq_buf_note_add(&buf, &chord, 50, 1, &p, 1);
+
+	// next step to play is 50
+	p.index = 2;
+
+	// insert below the play position; 50 is still next
+	arp_seq_buf_note_add(&buf, &chord, 20, 1, &p, 1);
+	s = arp_seq_buf_front(&buf);
+	TEST_ASSERT_EQUAL_UINT8(3, p.index);
+	TEST_ASSERT_EQUAL_UINT8(50, s->notes[p.index].note.num);
+
+	// insert above the play position; unaffected
+	arp_seq_buf_note_add(&buf, &chord, 60, 1, &p, 1);
+	TEST_ASSERT_EQUAL_UINT8(3, p.index);
+
+	// remove below the play position
+	arp_seq_buf_note_release(&buf, &chord, 10, &p, 1);
+	s = arp_seq_buf_front(&buf);
+	TEST_ASSERT_EQUAL_UINT8(2, p.index);
+	TEST_ASSERT_EQUAL_UINT8(50, s->notes[p.index].note.num);
+
+	// remove the next step; the one after it plays instead
+	arp_seq_buf_note_release(&buf, &chord, 50, &p, 1);
+	s = arp_seq_buf_front(&buf);
+	TEST_ASSERT_EQUAL_UINT8(2, p.index);
+	TEST_ASSERT_EQUAL_UINT8(60, s->notes[p.index].note.num);
+
+	// insert at the play position; 60 is still next
+	arp_seq_buf_note_add(&buf, &chord, 40, 1, &p, 1);
+	s = arp_seq_buf_front(&buf);
+	TEST_ASSERT_EQUAL_UINT8(40, s->notes[2].note.num);
+	TEST_ASSERT_EQUAL_UINT8(3, p.index);
+	TEST_ASSERT_EQUAL_UINT8(60, s->notes[p.index].note.num);
+}
+
+void test_player_gate_mask_matches_euclidean(void) {
+	arp_player_t p;
+
+	arp_player_init(&p, 0, 1);
+
+	for (u8 div = 1; div <= 32; div++) {
+		arp_player_set_division(&p, div, NULL);
+		for (u8 fill = 1; fill <= div; fill++) {
+			arp_player_set_fill(&p, fill);
+			for (s8 rot = -3; rot <= 3; rot++) {
+				arp_player_set_rotation(&p, rot);
+				for (p.div_count = 0; p.div_count < div; p.div_count++) {
+					TEST_ASSERT_EQUAL_INT(euclidean(fill, div, p.div_count - rot),
+																arp_player_gate(&p));
+				}
+			}
+		}
+	}
+}
+
+#define EVENT_LOG_MAX 64
+
+arp_event_t event_log[EVENT_LOG_MAX];
+u8 event_log_count;
+
+void log_note_on(u8 ch, u8 num, u8 vel) {
+	arp_event_t *ev = &event_log[event_log_count++];
+	ev->type = eArpNoteOn;
+	ev->ch = ch;
+	ev->num = num;
+	ev->vel = vel;
+}
+
+void log_note_off(u8 ch, u8 num, u8 vel) {
+	arp_event_t *ev = &event_log[event_log_count++];
+	ev->type = eArpNoteOff;
+	ev->ch = ch;
+	ev->num = num;
+	ev->vel = vel;
+}
+
+midi_behavior_t log_behavior = {
+	.note_on = log_note_on,
+	.note_off = log_note_off,
+};
+
+void test_engine_pulse_matches_players(void) {
+	arp_engine_t e;
+	arp_player_t ref[4];
+	u8 fills[4] = { 1, 3, 2, 5 };
+	u8 divs[4] = { 1, 4, 3, 8 };
+	u8 widths[4] = { 64, 0, 100, 32 };
+
+	arp_engine_init(&e, 4, eStyleUp, 1);
+	for (u8 lane = 0; lane < 4; lane++) {
+		arp_player_t *p = arp_engine_player(&e, lane);
+		arp_player_set_division(p, divs[lane], NULL);
+		arp_player_set_fill(p, fills[lane]);
+		arp_player_set_rotation(p, lane);
+		arp_player_set_gate_width(p, widths[lane]);
+		arp_player_set_steps(p, lane);
+		ref[lane] = *p;
+	}
+	TEST_ASSERT_NULL(arp_engine_player(&e, 4));
+
+	arp_engine_note_add(&e, 40, 100);
+	arp_engine_note_add(&e, 47, 90);
+	arp_engine_note_add(&e, 52, 80);
+
+	for (u16 tick = 0; tick < 200; tick++) {
+		u8 phase = tick & 1;
+
+		event_log_count = 0;
+		for (u8 lane = 0; lane < 4; lane++) {
+			arp_player_pulse(&ref[lane], arp_seq_buf_front(&e.seq), &log_behavior, phase);
+		}
+
+		TEST_ASSERT_EQUAL_UINT8(event_log_count, arp_engine_pulse(&e, phase));
+		for (u8 i = 0; i < event_log_count; i++) {
+			TEST_ASSERT_EQUAL_INT(event_log[i].type, e.events[i].type);
+			TEST_ASSERT_EQUAL_UINT8(event_log[i].ch, e.events[i].ch);
+			TEST_ASSERT_EQUAL_UINT8(event_log[i].ch, e.events[i].lane);
+			TEST_ASSERT_EQUAL_UINT8(event_log[i].num, e.events[i].num);
+			TEST_ASSERT_EQUAL_UINT8(event_log[i].vel, e.events[i].vel);
+		}
+	}
+
+	// dispatch hands the batch to the behavior and empties it
+	arp_engine_reset(&e);
+	event_log_count = 0;
+	arp_engine_pulse(&e, 1);
+	TEST_ASSERT_TRUE(e.event_count > 0);
+	arp_engine_dispatch(&e, &log_behavior);
+	TEST_ASSERT_EQUAL_UINT8(0, e.event_count);
+	TEST_ASSERT_TRUE(event_log_count > 0);
+	TEST_ASSERT_EQUAL_INT(eArpNoteOn, event_log[0].type);
+	TEST_ASSERT_EQUAL_UINT8(40, event_log[0].num);
+}
+
+// run a player for a number of ticks, recording the tick each event happens on
+u16 event_ticks[EVENT_LOG_MAX];
+
+void run_ticks(arp_player_t *p, arp_seq_t *s, u16 ticks) {
+	event_log_count = 0;
+	for (u16 t = 0; t < ticks; t++) {
+		u8 before = event_log_count;
+		arp_player_tick(p, s, &log_behavior);
+		for (u8 i = before; i < event_log_count; i++) {
+			event_ticks[i] = t;
+		}
+	}
+}
+
+void setup_tick_player(arp_player_t *p) {
+	setup_seq();
+	arp_seq_build(&seq, eStyleUp, &two, NULL);
+	arp_player_init(p, 0, 1);
+	arp_player_set_gate_width(p, 64);
+	p->velocity = eVelocityFixed;
+}
+
+void test_player_tick_gate(void) {
+	arp_player_t p;
+
+	setup_tick_player(&p);
+	run_ticks(&p, &seq, 2 * ARP_PPQ);
+
+	// half width gate; each note releases half way through its step
+	TEST_ASSERT_EQUAL_UINT8(4, event_log_count);
+	TEST_ASSERT_EQUAL_INT(eArpNoteOn, event_log[0].type);
+	TEST_ASSERT_EQUAL_UINT8(10, event_log[0].num);
+	TEST_ASSERT_EQUAL_UINT16(0, event_ticks[0]);
+	TEST_ASSERT_EQUAL_INT(eArpNoteOff, event_log[1].type);
+	TEST_ASSERT_EQUAL_UINT16(ARP_PPQ / 2, event_ticks[1]);
+	TEST_ASSERT_EQUAL_INT(eArpNoteOn, event_log[2].type);
+	TEST_ASSERT_EQUAL_UINT8(20, event_log[2].num);
+	TEST_ASSERT_EQUAL_UINT16(ARP_PPQ, event_ticks[2]);
+	TEST_ASSERT_EQUAL_UINT16(ARP_PPQ + ARP_PPQ / 2, event_ticks[3]);
+}
+
+void test_player_tick_ratchet(void) {
+	arp_player_t p;
+
+	setup_tick_player(&p);
+	arp_player_set_ratchet(&p, 3);
+	run_ticks(&p, &seq, ARP_PPQ);
+
+	TEST_ASSERT_EQUAL_UINT8(6, event_log_count);
+	for (u8 r = 0; r < 3; r++) {
+		TEST_ASSERT_EQUAL_INT(eArpNoteOn, event_log[2 * r].type);
+		TEST_ASSERT_EQUAL_UINT8(10, event_log[2 * r].num);
+		TEST_ASSERT_EQUAL_UINT16(r * ARP_PPQ / 3, event_ticks[2 * r]);
+		TEST_ASSERT_EQUAL_INT(eArpNoteOff, event_log[2 * r + 1].type);
+		TEST_ASSERT_EQUAL_UINT16(r * ARP_PPQ / 3 + ARP_PPQ / 6, event_ticks[2 * r + 1]);
+	}
+}
+
+void test_player_tick_swing(void) {
+	arp_player_t p;
+
+	setup_tick_player(&p);
+	arp_player_set_division(&p, 2, NULL);
+	arp_player_set_fill(&p, 2);
+	arp_player_set_swing(&p, 4);
+	run_ticks(&p, &seq, 2 * ARP_PPQ);
+
+	// second step is late by the swing amount
+	TEST_ASSERT_EQUAL_UINT16(0, event_ticks[0]);
+	TEST_ASSERT_EQUAL_UINT8(20, event_log[2].num);
+	TEST_ASSERT_EQUAL_UINT16(ARP_PPQ + 4, event_ticks[2]);
+
+	// at the default division every second step is late
+	setup_tick_player(&p);
+	arp_player_set_swing(&p, 4);
+	run_ticks(&p, &seq, 4 * ARP_PPQ);
+	TEST_ASSERT_EQUAL_UINT8(8, event_log_count);
+	for (u8 n = 0; n < 4; n++) {
+		TEST_ASSERT_EQUAL_INT(eArpNoteOn, event_log[2 * n].type);
+		TEST_ASSERT_EQUAL_UINT16(n * ARP_PPQ + (n & 1 ? 4 : 0), event_ticks[2 * n]);
+	}
+
+	// swing is limited to half a step
+	arp_player_set_swing(&p, ARP_PPQ);
+	TEST_ASSERT_EQUAL_UINT8(ARP_PPQ / 2, arp_player_get_swing(&p));
+}
+
+void test_player_tick_ratchet_swing(void) {
+	arp_player_t p;
+	u8 ons = 0;
+
+	setup_tick_player(&p);
+	arp_player_set_ratchet(&p, 3);
+	arp_player_set_swing(&p, ARP_PPQ / 2);
+	run_ticks(&p, &seq, 3 * ARP_PPQ);
+
+	// repeats of the swung step squeeze in before the next step starts
+	for (u8 i = 0; i < event_log_count; i++) {
+		if (event_log[i].type != eArpNoteOn) continue;
+		ons++;
+		if (event_log[i].num == 20) {
+			TEST_ASSERT_TRUE(event_ticks[i] >= ARP_PPQ + ARP_PPQ / 2);
+			TEST_ASSERT_TRUE(event_ticks[i] < 2 * ARP_PPQ);
+		}
+	}
+	TEST_ASSERT_EQUAL_UINT8(9, ons);
+}
+
+void test_player_tick_gate_division(void) {
+	arp_player_t p;
+
+	// a full width gate ties over the rests, as it does when pulsed
+	setup_tick_player(&p);
+	arp_player_set_division(&p, 4, NULL);
+	arp_player_set_fill(&p, 2);
+	arp_player_set_gate_width(&p, 128);
+	run_ticks(&p, &seq, 4 * ARP_PPQ);
+
+	TEST_ASSERT_EQUAL_UINT8(3, event_log_count);
+	TEST_ASSERT_EQUAL_INT(eArpNoteOn, event_log[0].type);
+	TEST_ASSERT_EQUAL_INT(eArpNoteOff, event_log[1].type);
+	TEST_ASSERT_EQUAL_UINT8(10, event_log[1].num);
+	TEST_ASSERT_EQUAL_UINT16(2 * ARP_PPQ, event_ticks[1]);
+	TEST_ASSERT_EQUAL_INT(eArpNoteOn, event_log[2].type);
+	TEST_ASSERT_EQUAL_UINT16(2 * ARP_PPQ, event_ticks[2]);
+
+	// shorter widths are measured against the division too
+	setup_tick_player(&p);
+	arp_player_set_division(&p, 4, NULL);
+	arp_player_set_fill(&p, 2);
+	arp_player_set_gate_width(&p, 32);
+	run_ticks(&p, &seq, 2 * ARP_PPQ);
+
+	TEST_ASSERT_EQUAL_INT(eArpNoteOff, event_log[1].type);
+	TEST_ASSERT_EQUAL_UINT16(ARP_PPQ, event_ticks[1]);
+}
+
+void test_player_tick_probability(void) {
+	arp_player_t p;
+	u8 ons = 0;
+
+	setup_tick_player(&p);
+	arp_player_set_probability(&p, 0);
+	run_ticks(&p, &seq, 8 * ARP_PPQ);
+	TEST_ASSERT_EQUAL_UINT8(0, event_log_count);
+
+	arp_player_set_probability(&p, ARP_PROBABILITY_MAX / 2);
+	run_ticks(&p, &seq, 32 * ARP_PPQ);
+	for (u8 i = 0; i < event_log_count; i++) {
+		if (event_log[i].type == eArpNoteOn) ons++;
+	}
+	TEST_ASSERT_TRUE(ons > 4 && ons < 28);
+}
+
+void test_player_tick_variable_gate(void) {
+	arp_player_t p;
+
+	setup_tick_player(&p);
+	p.gate = eGateVariable;
+	seq.notes[0].gate_length = 3;
+	seq.notes[0].ratchet = 1;
+	seq.notes[1].gate_length = 0; // tie
+	run_ticks(&p, &seq, 3 * ARP_PPQ);
+
+	TEST_ASSERT_EQUAL_UINT16(3, event_ticks[1]);
+	TEST_ASSERT_EQUAL_INT(eArpNoteOff, event_log[1].type);
+
+	// tied note is only released by the following step
+	TEST_ASSERT_EQUAL_INT(eArpNoteOn, event_log[2].type);
+	TEST_ASSERT_EQUAL_UINT8(20, event_log[2].num);
+	TEST_ASSERT_EQUAL_INT(eArpNoteOff, event_log[3].type);
+	TEST_ASSERT_EQUAL_UINT8(20, event_log[3].num);
+	TEST_ASSERT_EQUAL_UINT16(2 * ARP_PPQ, event_ticks[3]);
+}
+
+void test_player_pulse_variable_gate(void) {
+	arp_player_t p;
+
+	setup_tick_player(&p);
+	arp_player_set_division(&p, 4, NULL);
+	arp_player_set_fill(&p, 4);
+	p.gate = eGateVariable;
+	seq.notes[0].gate_length = ARP_PPQ / 2;
+
+	// variable gate takes the note's length, not fixed_gate
+	arp_player_pulse(&p, &seq, &log_behavior, 1);
+	TEST_ASSERT_EQUAL_UINT8(2, p.active_gate);
+}
+
 int main(void) {
 	UNITY_BEGIN();
 
@@ -343,6 +757,22 @@ int main(void) {
 	RUN_TEST(test_seq_build_diverge);
 	RUN_TEST(test_seq_build_random);
 
+	RUN_TEST(test_seq_buf_matches_rebuild);
+	RUN_TEST(test_seq_buf_played_and_random);
+	RUN_TEST(test_seq_buf_keeps_player_position);
+
+	RUN_TEST(test_player_gate_mask_matches_euclidean);
+	RUN_TEST(test_engine_pulse_matches_players);
+
+	RUN_TEST(test_player_tick_gate);
+	RUN_TEST(test_player_tick_ratchet);
+	RUN_TEST(test_player_tick_swing);
+	RUN_TEST(test_player_tick_ratchet_swing);
+	RUN_TEST(test_player_tick_gate_division);
+	RUN_TEST(test_player_tick_probability);
+	RUN_TEST(test_player_tick_variable_gate);
+	RUN_TEST(test_player_pulse_variable_gate);
+
 	return UNITY_END();
 }
 
@@ -0,0 +1,566 @@
+#include "unity.h"
+
+// this
+#include "dac.c"
+#include "dac_cal.c"
+#include "random.c"
+#include "libfixmath/fix16.c"
+#include "libfixmath/fix16_sqrt.c"
+#include "libfixmath/fix16_trig.c"
+
+#include "json/jsmn/jsmn.c"
+#include "json/encoding.c"
+#include "json/serdes.c"
+
+//
+// mocks
+//
+
+volatile avr32_spi_t AVR32_SPI;
+
+// simulated spi; records the bytes of each chip select frame
+#define SPI_FRAMES_MAX 512
+#define SPI_FRAME_LEN 6
+
+u8 spi_frames[SPI_FRAMES_MAX][SPI_FRAME_LEN];
+u16 spi_frame_count;
+u8 spi_frame_pos;
+bool spi_selected;
+u32 spi_write_count;
+
+u8 irq_depth;
+u8 irq_writes;          // spi writes during the current irqs_pause
+u8 irq_writes_max;      // most spi writes seen under one irqs_pause
+
+void spi_reset_log(void) {
+	spi_frame_count = 0;
+	spi_write_count = 0;
+	irq_writes_max = 0;
+}
+
+spi_status_t spi_selectChip(volatile avr32_spi_t *spi, uint8_t chip) {
+	TEST_ASSERT_FALSE(spi_selected);
+	spi_selected = true;
+	spi_frame_pos = 0;
+	return SPI_OK;
+}
+
+spi_status_t spi_unselectChip(volatile avr32_spi_t *spi, uint8_t chip) {
+	TEST_ASSERT_TRUE(spi_selected);
+	spi_selected = false;
+	if (spi_frame_count < SPI_FRAMES_MAX) spi_frame_count++;
+	return SPI_OK;
+}
+
+spi_status_t spi_write(volatile avr32_spi_t *spi, uint16_t data) {
+	TEST_ASSERT_TRUE(spi_selected);
+	if (spi_frame_count < SPI_FRAMES_MAX && spi_frame_pos < SPI_FRAME_LEN) {
+		spi_frames[spi_frame_count][spi_frame_pos++] = data & 0xff;
+	}
+	spi_write_count++;
+	if (irq_depth) {
+		irq_writes++;
+		if (irq_writes > irq_writes_max) irq_writes_max = irq_writes;
+	}
+	return SPI_OK;
+}
+
+u8 irqs_pause(void) {
+	if (irq_depth++ == 0) irq_writes = 0;
+	return 0;
+}
+
+void irqs_resume(u8 irq_flags) {
+	irq_depth--;
+}
+
+u16 frame_code(u16 frame, u8 slot) {
+	return (spi_frames[frame][slot * 3 + 1] << 4) | (spi_frames[frame][slot * 3 + 2] >> 4);
+}
+
+//
+// tests
+//
+
+// run the dac tick until channel n stops slewing, returns the number of ticks
+u16 run_slew(u8 n, u16 *trace, u16 trace_len) {
+	u16 ticks = 0;
+	do {
+		dac_timer_update();
+		if (ticks < trace_len) trace[ticks] = aout[n].now;
+		ticks++;
+	} while (dac_is_slewing(n) && ticks < 10000);
+	return ticks;
+}
+
+void test_noslew_is_immediate(void) {
+	reset_dacs();
+	dac_set_value_noslew(0, 1000);
+	TEST_ASSERT_EQUAL_UINT16(1000, aout[0].now);
+	dac_timer_update();
+	TEST_ASSERT_FALSE(dac_is_slewing(0));
+	TEST_ASSERT_EQUAL_UINT16(1000, aout[0].now);
+}
+
+void test_zero_slew_lands_next_tick(void) {
+	reset_dacs();
+	dac_set_value(1, 5000);
+	dac_timer_update();
+	TEST_ASSERT_EQUAL_UINT16(5000, aout[1].now);
+	TEST_ASSERT_FALSE(dac_is_slewing(1));
+}
+
+void test_slew_time_keeps_fraction(void) {
+	u16 trace[64];
+
+	// 100ms at 3ms per tick is 33.3 ticks; the old integer slew took 33
+	reset_dacs();
+	dac_set_slew(0, 100);
+	dac_set_value(0, 8000);
+	TEST_ASSERT_EQUAL_UINT16(34, run_slew(0, trace, 64));
+	TEST_ASSERT_EQUAL_UINT16(8000, aout[0].now);
+
+	// linear moves in even steps
+	TEST_ASSERT_INT_WITHIN(2, 240, trace[0]);
+	TEST_ASSERT_INT_WITHIN(2, 2400, trace[9]);
+}
+
+void test_slew_shapes(void) {
+	u16 lin[64], ex[64], lg[64], sc[64];
+	u16 ticks;
+
+	for (u8 shape = 0; shape < DAC_SLEW_SHAPE_COUNT; shape++) {
+		u16 *trace = shape == kDacSlewLinear ? lin :
+			shape == kDacSlewExp ? ex :
+			shape == kDacSlewLog ? lg : sc;
+
+		reset_dacs();
+		dac_set_slew(2, 150);
+		dac_set_slew_shape(2, shape);
+		TEST_ASSERT_EQUAL_INT(shape, dac_get_slew_shape(2));
+		dac_set_value(2, 16000);
+		ticks = run_slew(2, trace, 64);
+
+		// shape doesn't change the duration, and every shape lands on target
+		TEST_ASSERT_EQUAL_UINT16(50, ticks);
+		TEST_ASSERT_EQUAL_UINT16(16000, aout[2].now);
+
+		// monotonic towards target
+		for (u8 i = 1; i < ticks; i++) {
+			TEST_ASSERT_TRUE(trace[i] >= trace[i - 1]);
+		}
+	}
+
+	// a quarter of the way through: exp lags, log leads
+	TEST_ASSERT_TRUE(ex[12] < lin[12]);
+	TEST_ASSERT_TRUE(lg[12] > lin[12]);
+	TEST_ASSERT_TRUE(sc[12] < lin[12]);
+	// half way, s-curve crosses linear
+	TEST_ASSERT_INT_WITHIN(200, lin[24], sc[24]);
+}
+
+void test_slew_down_and_retarget(void) {
+	u16 trace[64];
+
+	reset_dacs();
+	dac_set_value_noslew(3, 12000);
+	dac_set_slew(3, 60);
+	dac_set_slew_shape(3, kDacSlewLog);
+	dac_set_value(3, 2000);
+
+	dac_timer_update();
+	dac_timer_update();
+	TEST_ASSERT_TRUE(aout[3].now < 12000 && aout[3].now > 2000);
+
+	// retarget mid slew continues from the current position
+	u16 from = aout[3].now;
+	dac_set_value(3, 4000);
+	dac_timer_update();
+	TEST_ASSERT_TRUE(aout[3].now < from);
+	run_slew(3, trace, 64);
+	TEST_ASSERT_EQUAL_UINT16(4000, aout[3].now);
+}
+
+void test_reset_writes_every_output(void) {
+	reset_dacs();
+
+	// reset forces both frames out even though the values didn't change
+	spi_reset_log();
+	reset_dacs();
+	TEST_ASSERT_EQUAL_UINT16(2, spi_frame_count);
+	for (u8 slot = 0; slot < 2; slot++) {
+		TEST_ASSERT_EQUAL_UINT16(0, frame_code(0, slot));
+		TEST_ASSERT_EQUAL_UINT16(0, frame_code(1, slot));
+	}
+
+	// and nothing more until something changes
+	spi_reset_log();
+	dac_timer_update();
+	TEST_ASSERT_EQUAL_UINT16(0, spi_frame_count);
+}
+
+void test_only_changed_frame_is_sent(void) {
+	reset_dacs();
+	dac_timer_update();
+	spi_reset_log();
+
+	// channel 0 lives in the a frame, alongside channel 2
+	dac_set_value_noslew(2, 400);
+	dac_set_value_noslew(0, 16383);
+	dac_timer_update();
+	TEST_ASSERT_EQUAL_UINT16(1, spi_frame_count);
+	TEST_ASSERT_EQUAL_HEX8(DAC_CMD_WRITE_A, spi_frames[0][0]);
+	TEST_ASSERT_EQUAL_HEX8(DAC_CMD_WRITE_A, spi_frames[0][3]);
+	TEST_ASSERT_EQUAL_UINT16(100, frame_code(0, 0));
+	TEST_ASSERT_EQUAL_UINT16(4095, frame_code(0, 1));
+
+	// channel 3 lives in the b frame, alongside channel 1
+	spi_reset_log();
+	dac_set_value_noslew(3, 8000);
+	dac_timer_update();
+	TEST_ASSERT_EQUAL_UINT16(1, spi_frame_count);
+	TEST_ASSERT_EQUAL_HEX8(DAC_CMD_WRITE_B, spi_frames[0][0]);
+	TEST_ASSERT_EQUAL_UINT16(2000, frame_code(0, 0));
+	TEST_ASSERT_EQUAL_UINT16(0, frame_code(0, 1));
+
+	// setting the same value again sends nothing
+	spi_reset_log();
+	dac_set_value_noslew(3, 8000);
+	dac_timer_update();
+	TEST_ASSERT_EQUAL_UINT16(0, spi_frame_count);
+}
+
+void test_slow_slew_traffic(void) {
+	u32 ticks = 0;
+
+	reset_dacs();
+	dac_timer_update();
+	spi_reset_log();
+
+	// 10s slew over 400 codes: most ticks don't move the code
+	dac_set_slew(1, 10000);
+	dac_set_value(1, 1600);
+	while (dac_is_slewing(1) || ticks == 0) {
+		dac_timer_update();
+		ticks++;
+	}
+
+	TEST_ASSERT_TRUE(ticks > 3000);
+	TEST_ASSERT_EQUAL_UINT16(400, spi_frame_count);
+	TEST_ASSERT_EQUAL_UINT32(400 * SPI_FRAME_LEN, spi_write_count);
+	for (u16 f = 0; f < spi_frame_count; f++) {
+		TEST_ASSERT_EQUAL_HEX8(DAC_CMD_WRITE_B, spi_frames[f][0]);
+		TEST_ASSERT_EQUAL_UINT16(f + 1, frame_code(f, 1));
+	}
+
+	// irqs are only held off for a single frame at a time
+	TEST_ASSERT_EQUAL_UINT8(SPI_FRAME_LEN, irq_writes_max);
+}
+
+void clear_cal(void) {
+	dac_cal_t zero = { { 0 } };
+	for (u8 i = 0; i < 4; i++) dac_set_cal(i, &zero);
+}
+
+// synthetic calibration: a bit of offset, gain error and bow
+void make_cal(dac_cal_t *c, s16 offset, s16 gain) {
+	for (u8 i = 0; i < DAC_CAL_POINTS; i++) {
+		c->trim[i] = offset + gain * i + (i * (10 - i)) / 2;
+	}
+}
+
+void test_cal_zero_is_identity(void) {
+	clear_cal();
+	for (u32 v = 0; v <= DAC_10V; v++) {
+		TEST_ASSERT_EQUAL_UINT16(v, dac_cal_apply(2, v));
+	}
+}
+
+void test_cal_interpolates_points(void) {
+	dac_cal_t c;
+	s32 expect;
+
+	clear_cal();
+	make_cal(&c, 12, -5);
+	dac_set_cal(1, &c);
+
+	// exact at each volt
+	for (u8 i = 0; i < DAC_CAL_POINTS - 1; i++) {
+		TEST_ASSERT_EQUAL_UINT16(cal_x[i] + c.trim[i], dac_cal_apply(1, cal_x[i]));
+	}
+
+	// linear in between, and never moves backwards
+	for (u32 v = 1; v <= DAC_10V; v++) {
+		u8 i = (v * 10) / 16384;
+		expect = v + c.trim[i] +
+			(s32)(v - cal_x[i]) * (c.trim[i + 1] - c.trim[i]) / (s32)(cal_x[i + 1] - cal_x[i]);
+		TEST_ASSERT_INT_WITHIN(1, expect, dac_cal_apply(1, v));
+		TEST_ASSERT_TRUE(dac_cal_apply(1, v) >= dac_cal_apply(1, v - 1));
+	}
+
+	// other channels are untouched, and the ends clamp
+	TEST_ASSERT_EQUAL_UINT16(5000, dac_cal_apply(0, 5000));
+	make_cal(&c, -30, 0);
+	dac_set_cal(1, &c);
+	TEST_ASSERT_EQUAL_UINT16(0, dac_cal_apply(1, 10));
+	make_cal(&c, 30, 0);
+	dac_set_cal(1, &c);
+	TEST_ASSERT_EQUAL_UINT16(DAC_10V, dac_cal_apply(1, DAC_10V - 10));
+	clear_cal();
+}
+
+void test_cal_applies_at_set_time(void) {
+	dac_cal_t c;
+
+	reset_dacs();
+	clear_cal();
+	dac_set_value_noslew(3, 8192);
+	TEST_ASSERT_EQUAL_UINT16(8192, aout[3].now);
+
+	// a settled output moves straight onto the calibrated value
+	make_cal(&c, 0, 4);
+	dac_set_cal(3, &c);
+	TEST_ASSERT_EQUAL_UINT16(8192 + c.trim[5], aout[3].now);
+	TEST_ASSERT_EQUAL_UINT16(8192, dac_get_value(3));
+
+	// offset is applied before the correction
+	dac_set_off(3, cal_x[1]);
+	dac_set_value(3, cal_x[3] - cal_x[1]);
+	dac_timer_update();
+	TEST_ASSERT_EQUAL_UINT16(cal_x[3] + c.trim[3], aout[3].now);
+
+	dac_set_off(3, 0);
+	clear_cal();
+}
+
+char cal_json[1024];
+size_t cal_json_len, cal_json_pos;
+
+void cal_json_puts(const char* src, size_t len) {
+	TEST_ASSERT_TRUE(cal_json_len + len < sizeof(cal_json));
+	memcpy(cal_json + cal_json_len, src, len);
+	cal_json_len += len;
+}
+
+size_t cal_json_gets(char* dst, size_t len) {
+	if (len > cal_json_len - cal_json_pos) len = cal_json_len - cal_json_pos;
+	memcpy(dst, cal_json + cal_json_pos, len);
+	cal_json_pos += len;
+	return len;
+}
+
+void cal_json_copy(char* dst, const char* src, size_t len) {
+	memcpy(dst, src, len);
+}
+
+void test_cal_json_round_trip(void) {
+	dac_cal_doc_t doc;
+	dac_cal_t c;
+	char textbuf[32];
+	jsmntok_t tokbuf[8];
+
+	for (u8 i = 0; i < 4; i++) {
+		make_cal(&c, i * 7 - 9, 3 - 2 * i);
+		dac_set_cal(i, &c);
+	}
+	dac_cal_store(&doc);
+
+	cal_json_len = 0;
+	TEST_ASSERT_EQUAL(JSON_WRITE_OK, json_write(cal_json_puts, &doc, &dac_cal_docdef));
+	cal_json[cal_json_len] = 0;
+	TEST_ASSERT_EQUAL_STRING_LEN("{\"channels\": [[-9, ", cal_json, 19);
+
+	// read it back through small buffers, onto cleared dacs
+	clear_cal();
+	memset(&doc, 0, sizeof(doc));
+	cal_json_pos = 0;
+	TEST_ASSERT_EQUAL(JSON_READ_OK, json_read(
+		cal_json_gets, cal_json_copy, &doc, &dac_cal_docdef,
+		textbuf, sizeof(textbuf), tokbuf, 8));
+	dac_cal_load(&doc);
+
+	for (u8 i = 0; i < 4; i++) {
+		make_cal(&c, i * 7 - 9, 3 - 2 * i);
+		dac_get_cal(i, &doc.channels[i]);
+		TEST_ASSERT_EQUAL_INT16_ARRAY(c.trim, doc.channels[i].trim, DAC_CAL_POINTS);
+		TEST_ASSERT_EQUAL_UINT16(cal_x[4] + c.trim[4], dac_cal_apply(i, cal_x[4]));
+	}
+	clear_cal();
+}
+
+// run n dac ticks, returns the output's last dac value
+u16 run_ticks(u8 ch, u16 n) {
+	while (n--) dac_timer_update();
+	return aout[ch].sent << 2;
+}
+
+void test_mod_sine(void) {
+	reset_dacs();
+	dac_set_value_noslew(0, 8000);
+
+	// 300ms is 100 ticks a cycle
+	dac_set_mod_rate(0, 300);
+	dac_set_mod_depth(0, 1000);
+	dac_set_mod_source(0, kDacModSine);
+	TEST_ASSERT_INT_WITHIN(8, 9000, run_ticks(0, 25));
+	TEST_ASSERT_INT_WITHIN(8, 1000, dac_get_mod(0));
+	TEST_ASSERT_INT_WITHIN(8, 8000, run_ticks(0, 25));
+	TEST_ASSERT_INT_WITHIN(8, 7000, run_ticks(0, 25));
+	TEST_ASSERT_INT_WITHIN(8, 8000, run_ticks(0, 25));
+
+	// the base value still slews underneath
+	dac_set_mod_depth(0, 0);
+	dac_set_slew(0, 30);
+	dac_set_value(0, 10000);
+	TEST_ASSERT_EQUAL_UINT16(10000, run_ticks(0, 10));
+
+	// off stops contributing straight away
+	dac_set_mod_depth(0, 1000);
+	run_ticks(0, 10);
+	dac_set_mod_source(0, kDacModOff);
+	TEST_ASSERT_EQUAL_INT16(0, dac_get_mod(0));
+	TEST_ASSERT_EQUAL_UINT16(10000, run_ticks(0, 1));
+}
+
+void test_mod_triangle_and_saw(void) {
+	reset_dacs();
+	dac_set_value_noslew(1, 4000);
+	dac_set_value_noslew(2, 4000);
+	dac_set_mod_rate(1, 300);
+	dac_set_mod_rate(2, 300);
+	dac_set_mod_depth(1, 400);
+	dac_set_mod_depth(2, -400);
+	dac_set_mod_source(1, kDacModTriangle);
+	dac_set_mod_source(2, kDacModSaw);
+
+	// triangle starts from the bottom, saw (inverted here) from the top
+	run_ticks(1, 1);
+	TEST_ASSERT_INT_WITHIN(20, -400, dac_get_mod(1));
+	TEST_ASSERT_INT_WITHIN(20, 400, dac_get_mod(2));
+	run_ticks(1, 49);
+	TEST_ASSERT_INT_WITHIN(12, 400, dac_get_mod(1));
+	TEST_ASSERT_INT_WITHIN(12, 0, dac_get_mod(2));
+	run_ticks(1, 25);
+	TEST_ASSERT_INT_WITHIN(12, 0, dac_get_mod(1));
+	TEST_ASSERT_INT_WITHIN(12, -200, dac_get_mod(2));
+
+	// the ends clamp to the dac's range
+	dac_set_value_noslew(2, 100);
+	dac_mod_sync(2);
+	TEST_ASSERT_INT_WITHIN(20, 500, run_ticks(2, 1));
+	TEST_ASSERT_EQUAL_UINT16(0, run_ticks(2, 74));
+}
+
+void test_mod_random_walk(void) {
+	s16 lo = 0, hi = 0;
+
+	reset_dacs();
+	dac_set_value_noslew(3, 8000);
+	dac_set_mod_rate(3, 100);
+	dac_set_mod_depth(3, 2000);
+	dac_set_mod_source(3, kDacModRandom);
+	for (u16 i = 0; i < 5000; i++) {
+		dac_timer_update();
+		if (dac_get_mod(3) < lo) lo = dac_get_mod(3);
+		if (dac_get_mod(3) > hi) hi = dac_get_mod(3);
+	}
+	TEST_ASSERT_TRUE(lo >= -2000 && lo < -500);
+	TEST_ASSERT_TRUE(hi <= 2000 && hi > 500);
+}
+
+void test_mod_env(void) {
+	reset_dacs();
+	dac_set_value_noslew(0, 2000);
+
+	// 10 tick attack and decay to half, 20 tick release
+	dac_set_mod_env(0, 30, 30, DAC_MOD_FULL / 2, 60);
+	dac_set_mod_depth(0, 4000);
+	dac_set_mod_source(0, kDacModEnv);
+	TEST_ASSERT_EQUAL_UINT16(2000, run_ticks(0, 5));
+
+	dac_mod_gate(0, true);
+	TEST_ASSERT_INT_WITHIN(4, 2000 + 2000, run_ticks(0, 5));
+	TEST_ASSERT_INT_WITHIN(4, 2000 + 4000, run_ticks(0, 5));
+	TEST_ASSERT_INT_WITHIN(4, 2000 + 3000, run_ticks(0, 5));
+	TEST_ASSERT_INT_WITHIN(4, 2000 + 2000, run_ticks(0, 5));
+	TEST_ASSERT_INT_WITHIN(4, 2000 + 2000, run_ticks(0, 50));
+
+	dac_mod_gate(0, false);
+	TEST_ASSERT_INT_WITHIN(4, 2000 + 1000, run_ticks(0, 5));
+	TEST_ASSERT_EQUAL_UINT16(2000, run_ticks(0, 5));
+	TEST_ASSERT_EQUAL_INT16(0, dac_get_mod(0));
+}
+
+// ticks the attack stage lasts
+u16 attack_ticks(u8 ch) {
+	u16 t = 0;
+	while (mod[ch].stage == kEnvAttack && t < 60000) {
+		dac_timer_update();
+		t++;
+	}
+	return t;
+}
+
+void test_mod_env_attack_times(void) {
+	u16 ms[] = { 1, 4, 7, 30, 100, 1000, 10000 };
+
+	reset_dacs();
+	dac_set_mod_depth(0, DAC_MOD_FULL);
+	dac_set_mod_source(0, kDacModEnv);
+	for (u8 i = 0; i < sizeof(ms) / sizeof(ms[0]); i++) {
+		// every attack ends at the top, on time
+		dac_set_mod_env(0, ms[i], 1000, DAC_MOD_FULL / 2, 1000);
+		mod[0].level = 0;
+		dac_mod_gate(0, true);
+		TEST_ASSERT_INT_WITHIN(1, (ms[i] + DAC_RATE_CV - 1) / DAC_RATE_CV, attack_ticks(0));
+		TEST_ASSERT_EQUAL_INT(kEnvDecay, mod[0].stage);
+		TEST_ASSERT_INT_WITHIN(8, DAC_MOD_FULL, dac_get_mod(0));
+		dac_mod_gate(0, false);
+	}
+}
+
+void test_mod_env_retrigger_from_sustain(void) {
+	u16 ticks;
+
+	reset_dacs();
+	dac_set_mod_env(0, 300, 30, DAC_MOD_FULL / 2, 300);
+	dac_set_mod_depth(0, DAC_MOD_FULL);
+	dac_set_mod_source(0, kDacModEnv);
+	dac_mod_gate(0, true);
+	run_ticks(0, 200);
+	TEST_ASSERT_EQUAL_INT(kEnvSustain, mod[0].stage);
+
+	// climbs the rest of the way from sustain, in half the attack time
+	dac_mod_gate(0, true);
+	ticks = attack_ticks(0);
+	TEST_ASSERT_INT_WITHIN(1, 50, ticks);
+	TEST_ASSERT_INT_WITHIN(8, DAC_MOD_FULL, dac_get_mod(0));
+	run_ticks(0, 20);
+	TEST_ASSERT_EQUAL_INT(kEnvSustain, mod[0].stage);
+	TEST_ASSERT_INT_WITHIN(8, DAC_MOD_FULL / 2, dac_get_mod(0));
+}
+
+int main(void) {
+	UNITY_BEGIN();
+
+	RUN_TEST(test_noslew_is_immediate);
+	RUN_TEST(test_zero_slew_lands_next_tick);
+	RUN_TEST(test_slew_time_keeps_fraction);
+	RUN_TEST(test_slew_shapes);
+	RUN_TEST(test_slew_down_and_retarget);
+	RUN_TEST(test_reset_writes_every_output);
+	RUN_TEST(test_only_changed_frame_is_sent);
+	RUN_TEST(test_slow_slew_traffic);
+	RUN_TEST(test_cal_zero_is_identity);
+	RUN_TEST(test_cal_interpolates_points);
+	RUN_TEST(test_cal_applies_at_set_time);
+	RUN_TEST(test_cal_json_round_trip);
+	RUN_TEST(test_mod_sine);
+	RUN_TEST(test_mod_triangle_and_saw);
+	RUN_TEST(test_mod_random_walk);
+	RUN_TEST(test_mod_env);
+	RUN_TEST(test_mod_env_attack_times);
+	RUN_TEST(test_mod_env_retrigger_from_sustain);
+
+	return UNITY_END();
+}
@@ -0,0 +1,83 @@
+#include "unity.h"
+
+// this
+#include "euclidean/euclidean.c"
+
+#include "euclidean_table.c"
+
+void test_mask_matches_table(void) {
+    for (int len = 1; len <= 32; len++) {
+        for (int fill = 0; fill <= len; fill++) {
+            u32 mask = euclidean_mask(fill, len, 0);
+            for (int step = 0; step < len; step++) {
+                TEST_ASSERT_EQUAL_INT_MESSAGE(table_lookup(fill, len, step),
+                                              euclidean_mask_step(mask, step),
+                                              "mask doesn't match table");
+            }
+            if (len < 32) {
+                TEST_ASSERT_EQUAL_UINT32(0, mask >> len);
+            }
+        }
+    }
+}
+
+void test_rotated_mask_matches_table(void) {
+    for (int len = 1; len <= 32; len++) {
+        for (int fill = 1; fill <= len; fill++) {
+            for (int rot = -40; rot <= 40; rot += 3) {
+                u32 mask = euclidean_mask(fill, len, rot);
+                for (int step = 0; step < len; step++) {
+                    TEST_ASSERT_EQUAL_INT(table_lookup(fill, len, step - rot),
+                                          euclidean_mask_step(mask, step));
+                }
+            }
+        }
+    }
+}
+
+void test_euclidean_matches_table(void) {
+    for (int len = -1; len <= 33; len++) {
+        for (int fill = -1; fill <= len + 1; fill++) {
+            for (int step = -70; step <= 70; step++) {
+                TEST_ASSERT_EQUAL_INT(table_lookup(fill, len, step),
+                                      euclidean(fill, len, step));
+            }
+        }
+    }
+}
+
+void test_mask_out_of_range(void) {
+    TEST_ASSERT_EQUAL_UINT32(0, euclidean_mask(1, 0, 0));
+    TEST_ASSERT_EQUAL_UINT32(0, euclidean_mask(1, 33, 0));
+    TEST_ASSERT_EQUAL_UINT32(0, euclidean_mask(0, 16, 0));
+    TEST_ASSERT_EQUAL_UINT32(0, euclidean_mask(17, 16, 0));
+    TEST_ASSERT_EQUAL_UINT32(0xffffffff, euclidean_mask(32, 32, 5));
+}
+
+void test_euclidean_switching_patterns(void) {
+    // alternating between patterns rebuilds each time, never mixing them up
+    for (int len = 1; len <= 32; len++) {
+        for (int fill = 1; fill <= len; fill++) {
+            for (int step = 0; step < len; step++) {
+                TEST_ASSERT_EQUAL_INT(table_lookup(fill, len, step),
+                                      euclidean(fill, len, step));
+                TEST_ASSERT_EQUAL_INT(table_lookup(len - fill + 1, len, step),
+                                      euclidean(len - fill + 1, len, step));
+                TEST_ASSERT_EQUAL_INT(table_lookup(1, 32, step),
+                                      euclidean(1, 32, step));
+            }
+        }
+    }
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_mask_matches_table);
+    RUN_TEST(test_rotated_mask_matches_table);
+    RUN_TEST(test_euclidean_matches_table);
+    RUN_TEST(test_mask_out_of_range);
+    RUN_TEST(test_euclidean_switching_patterns);
+
+    return UNITY_END();
+}
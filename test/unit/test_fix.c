@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "unity.h"
+
+// this
+#include "fix.c"
+
+#include "fix_reference.c"
+
+//
+// tests
+//
+
+void test_itoa_whole_matches(void) {
+	char a[12], b[12];
+	int len;
+	s32 v;
+
+	for (len = 1; len <= 11; len++) {
+		for (v = -70000; v <= 70000; v++) {
+			memset(a, 'x', sizeof(a));
+			memset(b, 'x', sizeof(b));
+			old_itoa_whole(v, a, len);
+			itoa_whole(v, b, len);
+			TEST_ASSERT_EQUAL_MEMORY(a, b, sizeof(a));
+		}
+	}
+
+	// extremes, including digits that don't fit
+	s32 edge[] = { 2147483647, -2147483647 - 1, 1000000000, -999999999, 123456789 };
+	for (len = 1; len <= 11; len++) {
+		for (u8 i = 0; i < sizeof(edge) / sizeof(edge[0]); i++) {
+			memset(a, 'x', sizeof(a));
+			memset(b, 'x', sizeof(b));
+			old_itoa_whole(edge[i], a, len);
+			itoa_whole(edge[i], b, len);
+			TEST_ASSERT_EQUAL_MEMORY(a, b, sizeof(a));
+		}
+	}
+}
+
+void test_itoa_fract_matches(void) {
+	char a[FIX_DIG_LO], b[FIX_DIG_LO];
+
+	for (s32 v = 0; v <= 0xffff; v++) {
+		old_itoa_fract(v, a);
+		itoa_fract(v, b);
+		TEST_ASSERT_EQUAL_MEMORY(a, b, FIX_DIG_LO);
+	}
+}
+
+void test_print_fix16_matches(void) {
+	char a[FIX_DIG_TOTAL + 2], b[FIX_DIG_TOTAL + 2];
+	u32 x;
+
+	// every whole part, with a spread of fractions
+	for (x = 0; x < 0xffff; x++) {
+		for (u32 f = 0; f <= 0xffff; f += 0x1111) {
+			memset(a, 'x', sizeof(a));
+			memset(b, 'x', sizeof(b));
+			old_print_fix16(a, (x << 16) | f);
+			print_fix16(b, (x << 16) | f);
+			TEST_ASSERT_EQUAL_MEMORY(a, b, sizeof(a));
+		}
+	}
+
+	// every fraction around zero
+	for (x = 0; x <= 0x1ffff; x++) {
+		fix16_t v = (fix16_t)x - 0x10000;
+		old_print_fix16(a, v);
+		print_fix16(b, v);
+		TEST_ASSERT_EQUAL_MEMORY(a, b, sizeof(a));
+	}
+}
+
+void test_itoa_whole_lj(void) {
+	char a[16], b[16], c[16];
+	int la, lb;
+	s32 v;
+
+	// same as before for non-negative values
+	for (v = 0; v <= 1 << 20; v++) {
+		la = old_itoa_whole_lj(v, a);
+		lb = itoa_whole_lj(v, b);
+		TEST_ASSERT_EQUAL_INT(la, lb);
+		TEST_ASSERT_EQUAL_MEMORY(a, b, la);
+	}
+
+	// negatives used to be off by one; check them against printf
+	for (v = -(1 << 20); v < 0; v++) {
+		lb = itoa_whole_lj(v, b);
+		TEST_ASSERT_EQUAL_INT(sprintf(c, "%d", v), lb);
+		TEST_ASSERT_EQUAL_MEMORY(c, b, lb);
+	}
+	lb = itoa_whole_lj(-2147483647 - 1, b);
+	TEST_ASSERT_EQUAL_INT(11, lb);
+	TEST_ASSERT_EQUAL_MEMORY("-2147483648", b, 11);
+	lb = itoa_whole_lj(2147483647, b);
+	TEST_ASSERT_EQUAL_INT(10, lb);
+	TEST_ASSERT_EQUAL_MEMORY("2147483647", b, 10);
+}
+
+int main(void) {
+	UNITY_BEGIN();
+
+	RUN_TEST(test_itoa_whole_matches);
+	RUN_TEST(test_itoa_fract_matches);
+	RUN_TEST(test_print_fix16_matches);
+	RUN_TEST(test_itoa_whole_lj);
+
+	return UNITY_END();
+}
@@ -0,0 +1,106 @@
+#include "unity.h"
+
+#include "types.h"
+
+#define FIXMATH_BATCH_VECTOR
+
+// this
+#include "libfixmath/fix16_batch.c"
+
+#include "libfixmath/fix16.c"
+#include "libfixmath/fix16_sqrt.c"
+#include "libfixmath/fix16_trig.c"
+
+// odd, so the vector paths leave a remainder
+#define N 1027
+
+fix16_t a[N], b[N], out[N];
+
+static u32 rand_state = 1;
+fix16_t rand_fix16(void) {
+	rand_state ^= rand_state << 13;
+	rand_state ^= rand_state >> 17;
+	rand_state ^= rand_state << 5;
+	return (fix16_t)rand_state;
+}
+
+// a mix of small values, full range values and the edges
+void fill(fix16_t* x, u8 shift) {
+	for (u16 i = 0; i < N; i++) {
+		x[i] = rand_fix16() >> (i % 4 == 0 ? 0 : shift);
+	}
+	x[0] = fix16_max;
+	x[1] = fix16_min;
+	x[2] = 0;
+	x[3] = -1;
+}
+
+void test_mul_matches_scalar(void) {
+	for (u8 shift = 0; shift < 24; shift += 4) {
+		fill(a, shift);
+		fill(b, shift);
+		fix16_mul_n(out, a, b, N);
+		for (u16 i = 0; i < N; i++) {
+			TEST_ASSERT_EQUAL_INT32(fix16_mul(a[i], b[i]), out[i]);
+		}
+		fix16_scale_n(out, a, b[7], N);
+		for (u16 i = 0; i < N; i++) {
+			TEST_ASSERT_EQUAL_INT32(fix16_mul(a[i], b[7]), out[i]);
+		}
+	}
+}
+
+void test_lerp_matches_scalar(void) {
+	u16 fracts[] = { 0, 1, 0x8000, 0xffff, 12345 };
+
+	fill(a, 4);
+	fill(b, 4);
+	for (u8 f = 0; f < sizeof(fracts) / sizeof(fracts[0]); f++) {
+		fix16_lerp_n(out, a, b, fracts[f], N);
+		for (u16 i = 0; i < N; i++) {
+			TEST_ASSERT_EQUAL_INT32(fix16_lerp16(a[i], b[i], fracts[f]), out[i]);
+		}
+	}
+}
+
+void test_sin_matches_scalar(void) {
+	fill(a, 8);
+	for (u16 i = 4; i < 64; i++) {
+		a[i] = (i - 34) * (fix16_pi / 8);
+	}
+	fix16_sin_n(out, a, N);
+	for (u16 i = 0; i < N; i++) {
+		TEST_ASSERT_EQUAL_INT32(fix16_sin(a[i]), out[i]);
+	}
+}
+
+void test_sadd_matches_scalar(void) {
+	for (u8 shift = 0; shift < 8; shift += 1) {
+		fill(a, shift);
+		fill(b, shift);
+		b[4] = fix16_max;
+		b[5] = fix16_min;
+		fix16_sadd_n(out, a, b, N);
+		for (u16 i = 0; i < N; i++) {
+			TEST_ASSERT_EQUAL_INT32(fix16_sadd(a[i], b[i]), out[i]);
+		}
+	}
+
+	// in place
+	fill(a, 2);
+	fill(b, 2);
+	for (u16 i = 0; i < N; i++) out[i] = fix16_sadd(a[i], b[i]);
+	fix16_sadd_n(a, a, b, N);
+	TEST_ASSERT_EQUAL_MEMORY(out, a, sizeof(out));
+}
+
+int main(void) {
+	UNITY_BEGIN();
+
+	RUN_TEST(test_mul_matches_scalar);
+	RUN_TEST(test_lerp_matches_scalar);
+	RUN_TEST(test_sin_matches_scalar);
+	RUN_TEST(test_sadd_matches_scalar);
+
+	return UNITY_END();
+}
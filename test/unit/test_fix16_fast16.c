@@ -0,0 +1,3 @@
+#define FIXMATH_FAST_BITS 16
+
+#include "fix16_fast_cases.c"
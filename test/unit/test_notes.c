@@ -22,18 +22,58 @@ void test_pool_init(void) {
 	TEST_ASSERT_EQUAL_INT(0, p.elements[0].note.num);
 	TEST_ASSERT_EQUAL_INT(0, p.elements[0].note.vel);
 	TEST_ASSERT_NULL(p.elements[0].next);
+	TEST_ASSERT_NULL(p.elements[0].prev);
 	TEST_ASSERT_TRUE(p.elements[0].is_free);
 
 	// check last element
 	TEST_ASSERT_EQUAL_INT(0, p.elements[NOTE_POOL_SIZE-1].note.num);
 	TEST_ASSERT_EQUAL_INT(0, p.elements[NOTE_POOL_SIZE-1].note.vel);
 	TEST_ASSERT_NULL(p.elements[NOTE_POOL_SIZE-1].next);
+	TEST_ASSERT_NULL(p.elements[NOTE_POOL_SIZE-1].prev);
 	TEST_ASSERT_TRUE(p.elements[NOTE_POOL_SIZE-1].is_free);
 
 	// check pool level info
 	TEST_ASSERT_EQUAL_INT(0, p.count);
 	TEST_ASSERT_NULL(p.head);
-	TEST_ASSERT_NULL(p.last_free);
+	TEST_ASSERT_NULL(p.tail);
+	TEST_ASSERT_EQUAL_INT(NOTE_POOL_SIZE, p.free_count);
+	for (u8 i = 0; i < NOTE_POOL_MAP_WORDS; i++) {
+		TEST_ASSERT_EQUAL_UINT32(0, p.held[i]);
+	}
+}
+
+void test_pool_take_and_return(void) {
+	note_pool_t p;
+	pool_element_t *a, *b, *c;
+
+	pool_init(&p);
+
+	a = pool_take(&p);
+	b = pool_take(&p);
+	c = pool_take(&p);
+	TEST_ASSERT_EQUAL_INT(3, p.count);
+	TEST_ASSERT_TRUE(p.head == c);
+	TEST_ASSERT_TRUE(p.tail == a);
+
+	// unlink from the middle keeps both directions intact
+	pool_return(&p, b);
+	TEST_ASSERT_EQUAL_INT(2, p.count);
+	TEST_ASSERT_TRUE(c->next == a);
+	TEST_ASSERT_TRUE(a->prev == c);
+	TEST_ASSERT_TRUE(b->is_free);
+
+	// returned element is the next one handed out
+	TEST_ASSERT_TRUE(pool_take(&p) == b);
+	TEST_ASSERT_TRUE(p.head == b);
+
+	pool_return(&p, a);
+	TEST_ASSERT_TRUE(p.tail == c);
+	pool_return(&p, c);
+	pool_return(&p, b);
+	TEST_ASSERT_EQUAL_INT(0, p.count);
+	TEST_ASSERT_NULL(p.head);
+	TEST_ASSERT_NULL(p.tail);
+	TEST_ASSERT_EQUAL_INT(NOTE_POOL_SIZE, p.free_count);
 }
 
 
@@ -46,12 +86,92 @@ void test_notes_init(void) {
 	notes_init(&p);
 }
 
+void test_notes_hold_and_release(void) {
+	note_pool_t p;
+	note_pool_iter_t i;
+	const held_note_t *n;
+
+	notes_init(&p);
+
+	notes_hold(&p, 60, 100);
+	notes_hold(&p, 64, 101);
+	notes_hold(&p, 67, 102);
+	TEST_ASSERT_EQUAL_INT(3, notes_count(&p));
+	TEST_ASSERT_TRUE(notes_is_held(&p, 64));
+	TEST_ASSERT_FALSE(notes_is_held(&p, 65));
+
+	// re-holding moves the note to the front without duplicating it
+	notes_hold(&p, 60, 110);
+	TEST_ASSERT_EQUAL_INT(3, notes_count(&p));
+	n = notes_get(&p, kNotePriorityLast);
+	TEST_ASSERT_EQUAL_INT(60, n->num);
+	TEST_ASSERT_EQUAL_INT(110, n->vel);
+
+	notes_release(&p, 64);
+	notes_release(&p, 99); // not held, no-op
+	TEST_ASSERT_EQUAL_INT(2, notes_count(&p));
+	TEST_ASSERT_FALSE(notes_is_held(&p, 64));
+
+	// iteration is most to least recent
+	notes_iter_init(&i, &p);
+	TEST_ASSERT_EQUAL_INT(60, notes_iter_next(&i)->num);
+	TEST_ASSERT_EQUAL_INT(67, notes_iter_next(&i)->num);
+	TEST_ASSERT_NULL(notes_iter_next(&i));
+
+	notes_release(&p, 60);
+	notes_release(&p, 67);
+	TEST_ASSERT_EQUAL_INT(0, notes_count(&p));
+	TEST_ASSERT_NULL(notes_get(&p, kNotePriorityLast));
+}
+
+void test_notes_hold_at_capacity_drops_oldest(void) {
+	note_pool_t p;
+
+	notes_init(&p);
+
+	for (u8 n = 0; n < NOTE_POOL_SIZE; n++) {
+		notes_hold(&p, n, 1);
+	}
+	TEST_ASSERT_EQUAL_INT(NOTE_POOL_SIZE, notes_count(&p));
+
+	notes_hold(&p, 127, 1);
+	TEST_ASSERT_EQUAL_INT(NOTE_POOL_SIZE, notes_count(&p));
+	TEST_ASSERT_FALSE(notes_is_held(&p, 0));
+	TEST_ASSERT_TRUE(notes_is_held(&p, 1));
+	TEST_ASSERT_TRUE(notes_is_held(&p, 127));
+}
+
+void test_notes_get_priority(void) {
+	note_pool_t p;
+
+	notes_init(&p);
+	TEST_ASSERT_NULL(notes_get(&p, kNotePriorityHigh));
+	TEST_ASSERT_NULL(notes_get(&p, kNotePriorityLow));
+
+	notes_hold(&p, 40, 1);
+	notes_hold(&p, 100, 2);
+	notes_hold(&p, 3, 3);
+	notes_hold(&p, 64, 4);
+
+	TEST_ASSERT_EQUAL_INT(100, notes_get(&p, kNotePriorityHigh)->num);
+	TEST_ASSERT_EQUAL_INT(3, notes_get(&p, kNotePriorityLow)->num);
+	TEST_ASSERT_EQUAL_INT(64, notes_get(&p, kNotePriorityLast)->num);
+
+	notes_release(&p, 100);
+	notes_release(&p, 3);
+	TEST_ASSERT_EQUAL_INT(64, notes_get(&p, kNotePriorityHigh)->num);
+	TEST_ASSERT_EQUAL_INT(40, notes_get(&p, kNotePriorityLow)->num);
+}
 
 int main(void) {
 	UNITY_BEGIN();
 
 	RUN_TEST(test_pool_init);
+	RUN_TEST(test_pool_take_and_return);
 	RUN_TEST(test_notes_init);
+	RUN_TEST(test_notes_hold_and_release);
+	RUN_TEST(test_notes_hold_at_capacity_drops_oldest);
+	RUN_TEST(test_notes_get_priority);
 
 	return UNITY_END();
 }
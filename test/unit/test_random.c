@@ -2,6 +2,7 @@
 
 // this
 #include "random.c"
+#include "util.c"
 
 #define BAD_SEED -12345
 #define GOOD_SEED 12345
@@ -23,21 +24,18 @@ void test_random_init_and_seed(void) {
 
 	//TEST_ASSERT_EQUAL_INT(-1000, r.min);
 	//TEST_ASSERT_EQUAL_INT(1000, r.max);
-	TEST_ASSERT_EQUAL_INT(GOOD_SEED, r.w);
 
 	u32 values[VALUE_COUNT];
 
 	for (i = 0; i < VALUE_COUNT; i++) {
-		values[i] = random_next(&r);
+		values[i] = random_next32(&r);
 	}
 
 	random_seed(&r, GOOD_SEED);
 
-	TEST_ASSERT_EQUAL_INT(GOOD_SEED, r.w);
-
 	// re-seeding should produce the same sequence
 	for (i = 0; i < VALUE_COUNT; i++) {
-		TEST_ASSERT_EQUAL_INT(values[i], random_next(&r));
+		TEST_ASSERT_EQUAL_INT(values[i], random_next32(&r));
 	}
 
 	// different seeds should produce sequences
@@ -45,89 +43,228 @@ void test_random_init_and_seed(void) {
 	//random_init(&r, BAD_SEED, -1000, 1000);
 	random_seed(&r, BAD_SEED);
 	for (i = 0; i < VALUE_COUNT; i++) {
-		if (values[i] != random_next(&r)) {
+		if (values[i] != random_next32(&r)) {
 			differences++;
 		}
 	}
 	TEST_ASSERT_TRUE(differences > VALUE_COUNT / 2);
 }
 
-/*
+void test_random_reference(void) {
+	// the published xoshiro128** sequence from state { 1, 2, 3, 4 }
+	u32 expected[] = { 11520, 0, 5927040, 70819200, 2031721883, 1637235492 };
+	random_state_t r = {{ 1, 2, 3, 4 }};
+
+	for (u8 i = 0; i < sizeof(expected) / sizeof(expected[0]); i++) {
+		TEST_ASSERT_EQUAL_UINT32(expected[i], random_next32(&r));
+	}
+
+	// and seeding is pinned too, so stored seeds replay the same patterns
+	random_seed(&r, GOOD_SEED);
+	TEST_ASSERT_EQUAL_HEX32(0x1eea3cc1, random_next32(&r));
+	TEST_ASSERT_EQUAL_HEX32(0x1a40a62e, random_next32(&r));
+	TEST_ASSERT_EQUAL_HEX32(0xfc4cd240, random_next32(&r));
+}
+
+void test_random_widths(void) {
+	random_state_t a, b;
+	u32 i, high = 0, rnd_or = 0;
+
+	random_seed(&a, GOOD_SEED);
+	random_seed(&b, GOOD_SEED);
+
+	// random_next keeps the 31 bit range callers cast to s32, and rnd()
+	// the 16 bits it always had
+	for (i = 0; i < MAX_ITERATIONS; i++) {
+		u32 v = random_next(&a);
+		TEST_ASSERT_EQUAL_HEX32(random_next32(&b) >> 1, v);
+		high |= v;
+		rnd_or |= rnd();
+	}
+	TEST_ASSERT_EQUAL_HEX32(0x7fffffff, high);
+	TEST_ASSERT_EQUAL_HEX32(0xffff, rnd_or);
+}
+
+void test_random_zero_seed(void) {
+	random_state_t r;
+	random_seed(&r, 0);
+	TEST_ASSERT_TRUE(r.s[0] | r.s[1] | r.s[2] | r.s[3]);
+	TEST_ASSERT_TRUE(random_next32(&r) | random_next32(&r));
+}
+
 void test_random_range(void) {
+	s32 bounds[][2] = { { 0, 1 }, { -1, 2 }, { -100, -80 }, { 5, 5 } };
+	random_state_t r;
 	u32 i;
 	s32 v;
 	int got_min, got_max;
-	random_state_t r;
 
-	// [0,1]
-	random_init(&r, GOOD_SEED, 0, 1);
+	random_seed(&r, GOOD_SEED);
 
-	got_min = got_max = FALSE;
-	i = 0;
-	do {
-		v = random_next(&r);
-		if (v == r.min) {
-			got_min = TRUE;
-		}
-		if (v == r.max) {
-			got_max = TRUE;
+	for (u8 b = 0; b < sizeof(bounds) / sizeof(bounds[0]); b++) {
+		got_min = got_max = FALSE;
+		for (i = 0; i < MAX_ITERATIONS; i++) {
+			v = random_between(&r, bounds[b][0], bounds[b][1]);
+			TEST_ASSERT_TRUE(v >= bounds[b][0] && v <= bounds[b][1]);
+			if (v == bounds[b][0]) got_min = TRUE;
+			if (v == bounds[b][1]) got_max = TRUE;
 		}
-		i++;
+		TEST_ASSERT_TRUE_MESSAGE(got_min, "didn't hit min");
+		TEST_ASSERT_TRUE_MESSAGE(got_max, "didn't hit max");
 	}
-	while (i < MAX_ITERATIONS && !(got_min && got_max));
 
-	TEST_ASSERT_TRUE_MESSAGE(got_min, "didn't hit 0");
-	TEST_ASSERT_TRUE_MESSAGE(got_min, "didn't hit 1");
+	TEST_ASSERT_EQUAL_UINT32(0, random_range(&r, 0));
+	TEST_ASSERT_EQUAL_UINT32(0, random_range(&r, 1));
 
+	// the whole s32 range doesn't fit in a span
+	random_between(&r, INT32_MIN, INT32_MAX);
+}
 
-	// [-1,2]
-	random_init(&r, GOOD_SEED, -1, 2);
+void test_random_range_unbiased(void) {
+	random_state_t r;
+	u32 i, low = 0;
 
-	got_min = got_max = FALSE;
-	i = 0;
-	do {
-		v = random_next(&r);
-		if (v == r.min) {
-			got_min = TRUE;
-		}
-		if (v == r.max) {
-			got_max = TRUE;
-		}
-		i++;
+	random_seed(&r, GOOD_SEED);
+
+	// with % the bottom third of this range would come up half the time
+	for (i = 0; i < MAX_ITERATIONS; i++) {
+		if (random_range(&r, 0xC0000000) < 0x40000000) low++;
+	}
+	TEST_ASSERT_UINT32_WITHIN(MAX_ITERATIONS / 100, MAX_ITERATIONS / 3, low);
+}
+
+// chi-squared over k buckets; callers compare against the 99.9th
+// percentile so a change of seed won't trip them
+static double chi_squared(u32 *counts, u32 k, u32 total) {
+	double expected = (double)total / k, chi = 0, d;
+	for (u32 i = 0; i < k; i++) {
+		d = counts[i] - expected;
+		chi += d * d / expected;
+	}
+	return chi;
+}
+
+void test_random_distribution(void) {
+	random_state_t r;
+	u32 bytes[256] = { 0 };
+	u32 sevens[7] = { 0 };
+	u32 bits[32] = { 0 };
+	u32 i, b, x;
+
+	random_seed(&r, GOOD_SEED);
+
+	for (i = 0; i < MAX_ITERATIONS; i++) {
+		x = random_next32(&r);
+		for (b = 0; b < 32; b++) bits[b] += (x >> b) & 1;
+		bytes[x & 0xff]++;
+		bytes[x >> 24]++;
+		sevens[random_range(&r, 7)]++;
 	}
-	while (i < MAX_ITERATIONS && !(got_min && got_max));
 
-	TEST_ASSERT_TRUE_MESSAGE(got_min, "didn't hit -1");
-	TEST_ASSERT_TRUE_MESSAGE(got_min, "didn't hit 2");
+	// every bit is a fair coin: 4.5 sigma is 711 flips either way
+	for (b = 0; b < 32; b++) {
+		TEST_ASSERT_UINT32_WITHIN(711, MAX_ITERATIONS / 2, bits[b]);
+	}
 
+	// 255 dof: 99.9th percentile is ~330; 6 dof: ~22.5
+	TEST_ASSERT_TRUE(chi_squared(bytes, 256, 2 * MAX_ITERATIONS) < 330);
+	TEST_ASSERT_TRUE(chi_squared(sevens, 7, MAX_ITERATIONS) < 22.5);
+}
 
-	// [-100,-80]
-	random_init(&r, GOOD_SEED, -100, -80);
+void test_random_serial_correlation(void) {
+	random_state_t r;
+	double sum = 0, prev, cur;
+	u32 i;
 
-	got_min = got_max = FALSE;
-	i = 0;
-	do {
-		v = random_next(&r);
-		if (v == r.min) {
-			got_min = TRUE;
-		}
-		if (v == r.max) {
-			got_max = TRUE;
-		}
-		i++;
+	random_seed(&r, GOOD_SEED);
+
+	// uniform [-1, 1): successive draws should be uncorrelated
+	prev = (s32)random_next32(&r) / 2147483648.0;
+	for (i = 0; i < MAX_ITERATIONS; i++) {
+		cur = (s32)random_next32(&r) / 2147483648.0;
+		sum += prev * cur;
+		prev = cur;
+	}
+	// the mean product has sd 1/(3 sqrt(n)), ~0.001
+	TEST_ASSERT_TRUE(sum / MAX_ITERATIONS < 0.005 && sum / MAX_ITERATIONS > -0.005);
+}
+
+void test_random_fill(void) {
+	random_state_t a, b;
+	u32 buf[VALUE_COUNT + 1];
+
+	random_seed(&a, GOOD_SEED);
+	random_seed(&b, GOOD_SEED);
+
+	buf[VALUE_COUNT] = 0xdeadbeef;
+	random_fill(&a, buf, VALUE_COUNT);
+	for (u16 i = 0; i < VALUE_COUNT; i++) {
+		TEST_ASSERT_EQUAL_HEX32(random_next32(&b), buf[i]);
 	}
-	while (i < MAX_ITERATIONS && !(got_min && got_max));
+	TEST_ASSERT_EQUAL_HEX32(0xdeadbeef, buf[VALUE_COUNT]);
+
+	// and leaves the state where the draws would have
+	TEST_ASSERT_EQUAL_HEX32(random_next32(&b), random_next32(&a));
+
+	random_fill(&a, buf, 0);
+	TEST_ASSERT_EQUAL_HEX32(random_next32(&b), random_next32(&a));
+}
+
+void test_random_jump_and_streams(void) {
+	random_state_t a, b;
+	u32 values[VALUE_COUNT];
+	u16 i, j;
+	int matches;
 
-	TEST_ASSERT_TRUE_MESSAGE(got_min, "didn't hit -100");
-	TEST_ASSERT_TRUE_MESSAGE(got_min, "didn't hit -80");
+	// the jump is linear, so it commutes with stepping
+	random_seed(&a, GOOD_SEED);
+	random_seed(&b, GOOD_SEED);
+	random_jump(&a);
+	for (i = 0; i < 100; i++) {
+		random_next32(&a);
+		random_next32(&b);
+	}
+	random_jump(&b);
+	TEST_ASSERT_EQUAL_MEMORY(&a, &b, sizeof(a));
+
+	// stream 0 is the plain seed
+	random_seed(&a, GOOD_SEED);
+	random_seed_stream(&b, GOOD_SEED, 0);
+	TEST_ASSERT_EQUAL_MEMORY(&a, &b, sizeof(a));
+
+	// stream n is n jumps along, and repeatable
+	random_jump(&a);
+	random_jump(&a);
+	random_seed_stream(&b, GOOD_SEED, 2);
+	TEST_ASSERT_EQUAL_MEMORY(&a, &b, sizeof(a));
+
+	// neighbouring streams share no values in a window
+	random_seed_stream(&a, GOOD_SEED, 3);
+	random_fill(&a, values, VALUE_COUNT);
+	random_seed_stream(&b, GOOD_SEED, 4);
+	matches = 0;
+	for (i = 0; i < VALUE_COUNT; i++) {
+		u32 v = random_next32(&b);
+		for (j = 0; j < VALUE_COUNT; j++) {
+			if (values[j] == v) matches++;
+		}
+	}
+	TEST_ASSERT_EQUAL_INT(0, matches);
 }
-*/
 
 int main(void) {
 	UNITY_BEGIN();
 
 	RUN_TEST(test_random_init_and_seed);
-	//RUN_TEST(test_random_range);
+	RUN_TEST(test_random_reference);
+	RUN_TEST(test_random_widths);
+	RUN_TEST(test_random_zero_seed);
+	RUN_TEST(test_random_range);
+	RUN_TEST(test_random_range_unbiased);
+	RUN_TEST(test_random_distribution);
+	RUN_TEST(test_random_serial_correlation);
+	RUN_TEST(test_random_fill);
+	RUN_TEST(test_random_jump_and_streams);
 
 	return UNITY_END();
 }
@@ -0,0 +1,187 @@
+#include "unity.h"
+
+// this
+#include "scale.c"
+#include "music.c"
+
+#include "json/jsmn/jsmn.c"
+#include "json/encoding.c"
+#include "json/serdes.c"
+
+#define MAJOR 0xab5
+
+// reference: scan every note for the closest one in the scale
+u8 nearest(const scale_t* s, u8 n) {
+	s16 best = n, best_d = 1000;
+	for (s16 m = 0; m < SCALE_NOTES; m++) {
+		s16 d = m > n ? m - n : n - m;
+		if (((s->mask >> ((m + 132 - s->root) % 12)) & 1) && d < best_d) {
+			best = m;
+			best_d = d;
+		}
+	}
+	return best;
+}
+
+void test_modes_match_scale_int(void) {
+	scale_t s;
+
+	scale_from_mode(&s, 0, 0);
+	TEST_ASSERT_EQUAL_HEX16(MAJOR, s.mask);
+	scale_from_mode(&s, 5, 9);
+	TEST_ASSERT_EQUAL_HEX16(0x5ad, s.mask);
+	TEST_ASSERT_EQUAL_UINT8(9, s.root);
+}
+
+void test_note_table_is_nearest(void) {
+	scale_t s;
+	scale_quantizer_t q;
+
+	for (u8 mode = 0; mode < SCALE_MODES; mode++) {
+		for (u8 root = 0; root < 12; root++) {
+			scale_from_mode(&s, mode, root);
+			scale_compile(&q, &s);
+			for (u8 n = 0; n < SCALE_NOTES; n++) {
+				TEST_ASSERT_EQUAL_UINT8(nearest(&s, n), scale_quantize_note(&q, n));
+			}
+		}
+	}
+
+	// sparse custom scale: root and fifth of d
+	s.mask = 0x81;
+	s.root = 2;
+	scale_compile(&q, &s);
+	for (u8 n = 0; n < SCALE_NOTES; n++) {
+		TEST_ASSERT_EQUAL_UINT8(nearest(&s, n), scale_quantize_note(&q, n));
+	}
+
+	// an empty mask passes notes through
+	s.mask = 0;
+	scale_compile(&q, &s);
+	TEST_ASSERT_EQUAL_UINT8(61, scale_quantize_note(&q, 61));
+}
+
+void test_dac_values(void) {
+	scale_t s;
+	scale_quantizer_t q;
+
+	scale_from_mode(&s, 0, 0);
+	scale_compile(&q, &s);
+	TEST_ASSERT_EQUAL_UINT16(ET[60], scale_quantize_dac(&q, ET[60] + 50));
+	TEST_ASSERT_EQUAL_UINT16(ET[60], scale_quantize_dac(&q, ET[61]));
+	TEST_ASSERT_EQUAL_UINT16(ET[62], scale_quantize_dac(&q, ET[61] + 69));
+	TEST_ASSERT_EQUAL_UINT16(ET[0], scale_quantize_dac(&q, 0));
+	TEST_ASSERT_EQUAL_UINT16(DAC_10V, scale_quantize_dac(&q, 16383));
+	TEST_ASSERT_EQUAL_UINT16(ET[62], scale_note_dac(&q, 63));
+	TEST_ASSERT_EQUAL_UINT16(ET[64], scale_note_dac(&q, 64));
+
+	// every dac value lands on a scale note no further than the next one
+	for (u32 v = 0; v < 16384; v++) {
+		u16 out = scale_quantize_dac(&q, v);
+		s32 d = (s32)out - (s32)v;
+		TEST_ASSERT_TRUE(d < 274 && d > -274);
+	}
+}
+
+void test_microtonal_tuning(void) {
+	scale_t s;
+	scale_quantizer_t q;
+
+	// quarter tone flat third and seventh
+	scale_from_mode(&s, 0, 7);
+	s.tune[4] = -50;
+	s.tune[11] = -50;
+	scale_compile(&q, &s);
+	TEST_ASSERT_EQUAL_UINT16(ET[67], scale_note_dac(&q, 67));
+	TEST_ASSERT_INT_WITHIN(1, ET[71] - 68, scale_note_dac(&q, 71));
+	TEST_ASSERT_INT_WITHIN(1, ET[66] - 68, scale_note_dac(&q, 66));
+	TEST_ASSERT_EQUAL_UINT16(ET[69], scale_note_dac(&q, 69));
+}
+
+void test_tuning_limits(void) {
+	scale_t s;
+	scale_quantizer_t q;
+
+	// pitches stay within the dac however far they are tuned, and tuning
+	// is limited to the whole range
+	scale_from_mode(&s, 0, 0);
+	s.tune[0] = 1200;
+	s.tune[2] = 32767;
+	s.tune[4] = -32768;
+	scale_compile(&q, &s);
+	TEST_ASSERT_EQUAL_UINT16(DAC_10V, scale_note_dac(&q, 120));
+	TEST_ASSERT_EQUAL_UINT16(DAC_10V, scale_note_dac(&q, 2));
+	TEST_ASSERT_EQUAL_UINT16(DAC_10V, scale_note_dac(&q, 62));
+	TEST_ASSERT_EQUAL_UINT16(0, scale_note_dac(&q, 4));
+	TEST_ASSERT_EQUAL_UINT16(0, scale_note_dac(&q, 64));
+	TEST_ASSERT_INT_WITHIN(1, ET[4], scale_note_dac(&q, 124));
+	TEST_ASSERT_INT_WITHIN(1, ET[72], scale_note_dac(&q, 60));
+}
+
+char scale_json[256];
+size_t scale_json_len, scale_json_pos;
+
+size_t scale_json_gets(char* dst, size_t len) {
+	if (len > scale_json_len - scale_json_pos) len = scale_json_len - scale_json_pos;
+	memcpy(dst, scale_json + scale_json_pos, len);
+	scale_json_pos += len;
+	return len;
+}
+
+void scale_json_puts(const char* src, size_t len) {
+	memcpy(scale_json + scale_json_len, src, len);
+	scale_json_len += len;
+}
+
+void scale_json_copy(char* dst, const char* src, size_t len) {
+	memcpy(dst, src, len);
+}
+
+void test_load_from_json(void) {
+	const char in[] =
+		"{\"mask\": 1171, \"root\": 4, "
+		"\"tune\": [0, 0, 0, 0, 0, -14, 0, 0, 0, 0, -31, 0]}";
+	scale_t s, t;
+	scale_quantizer_t q;
+	char textbuf[32];
+	jsmntok_t tokbuf[8];
+
+	memset(&s, 0, sizeof(s));
+	strcpy(scale_json, in);
+	scale_json_len = strlen(in);
+	scale_json_pos = 0;
+	TEST_ASSERT_EQUAL(JSON_READ_OK, json_read(
+		scale_json_gets, scale_json_copy, &s, &scale_docdef,
+		textbuf, sizeof(textbuf), tokbuf, 8));
+	TEST_ASSERT_EQUAL_HEX16(1171, s.mask);
+	TEST_ASSERT_EQUAL_UINT8(4, s.root);
+	TEST_ASSERT_EQUAL_INT16(-14, s.tune[5]);
+	TEST_ASSERT_EQUAL_INT16(-31, s.tune[10]);
+
+	scale_compile(&q, &s);
+	TEST_ASSERT_EQUAL_UINT8(65, scale_quantize_note(&q, 66));
+	TEST_ASSERT_INT_WITHIN(1, ET[62] - 42, scale_note_dac(&q, 62));
+
+	// and back out again
+	scale_json_len = 0;
+	TEST_ASSERT_EQUAL(JSON_WRITE_OK, json_write(scale_json_puts, &s, &scale_docdef));
+	scale_json_pos = 0;
+	memset(&t, 0, sizeof(t));
+	TEST_ASSERT_EQUAL(JSON_READ_OK, json_read(
+		scale_json_gets, scale_json_copy, &t, &scale_docdef,
+		textbuf, sizeof(textbuf), tokbuf, 8));
+	TEST_ASSERT_EQUAL_MEMORY(&s, &t, sizeof(s));
+}
+
+int main(void) {
+	UNITY_BEGIN();
+
+	RUN_TEST(test_modes_match_scale_int);
+	RUN_TEST(test_note_table_is_nearest);
+	RUN_TEST(test_dac_values);
+	RUN_TEST(test_microtonal_tuning);
+	RUN_TEST(test_tuning_limits);
+	RUN_TEST(test_load_from_json);
+
+	return UNITY_END();
+}